@@ -39,6 +39,9 @@
 #include <string>
 
 #include <quacode/qspaceinfo.hh>
+#include <quacode/search/qdistributed.hh>
+#include <quacode/support/checkpoint.hh>
+#include <quacode/support/telemetry.hh>
 #include <gecode/minimodel.hh>
 #include <gecode/driver.hh>
 
@@ -75,6 +78,20 @@ protected:
   Gecode::Driver::UnsignedIntOption _row;
   /// Optional number of cols
   Gecode::Driver::UnsignedIntOption _col;
+  /// Destination of the telemetry
+  Gecode::Driver::StringValueOption _telemetry;
+  /// Interval of the telemetry
+  Gecode::Driver::UnsignedIntOption _telemetryInterval;
+  /// File of the checkpoints
+  Gecode::Driver::StringValueOption _checkpoint;
+  /// Interval of the checkpoints
+  Gecode::Driver::UnsignedIntOption _checkpointInterval;
+  /// Resume from the checkpoint or not
+  Gecode::Driver::BoolOption _resume;
+  /// Number of worker processes of the distributed search
+  Gecode::Driver::UnsignedIntOption _workers;
+  /// Depth of the jobs of the distributed search
+  Gecode::Driver::UnsignedIntOption _splitDepth;
 public:
   /// Initialize options for example with name \a s
   ConnectFourOptions(const char* s)
@@ -84,7 +101,14 @@ public:
       _heuristic("-heuristic","Use heuristic when branching (only for model + and ++)",true),
       _file("-file","File name of recorded moves"),
       _row("-row","Number of rows (minimum 4)",6),
-      _col("-col","Number of cols (minimum 4)",7) {
+      _col("-col","Number of cols (minimum 4)",7),
+      _telemetry("-telemetry","File (or unix:PATH socket) receiving the progress as JSON lines"),
+      _telemetryInterval("-telemetryInterval","Interval of the telemetry (in ms)",1000),
+      _checkpoint("-checkpoint","File receiving the checkpoints of the search"),
+      _checkpointInterval("-checkpointInterval","Interval of the checkpoints (in ms)",60000),
+      _resume("-resume","Resume the search from the checkpoint",false),
+      _workers("-workers","Number of worker processes of the distributed search (0 for a single process)",0),
+      _splitDepth("-splitDepth","Depth of the jobs given to the workers",4) {
     _QCSPmodel.add(1,"AllState","Model with all states as defined by P. Nightingale. Without Pure Value and heuristic setup.");
     _QCSPmodel.add(2,"AllState+","Model with all states as defined by P. Nightingale. With cut.");
     _QCSPmodel.add(3,"AllState++","Model with all states as defined by P. Nightingale. With cut and additional constraints.");
@@ -94,6 +118,13 @@ public:
     add(_file);
     add(_row);
     add(_col);
+    add(_telemetry);
+    add(_telemetryInterval);
+    add(_checkpoint);
+    add(_checkpointInterval);
+    add(_resume);
+    add(_workers);
+    add(_splitDepth);
   }
   /// Return true if the strategy must be printed
   bool printStrategy(void) const {
@@ -119,6 +150,34 @@ public:
   int col(void) const {
     return _col.value();
   }
+  /// Return destination of the telemetry (NULL if none)
+  const char *telemetry(void) const {
+    return _telemetry.value();
+  }
+  /// Return interval of the telemetry
+  unsigned int telemetryInterval(void) const {
+    return _telemetryInterval.value();
+  }
+  /// Return file of the checkpoints (NULL if none)
+  const char *checkpoint(void) const {
+    return _checkpoint.value();
+  }
+  /// Return interval of the checkpoints
+  unsigned int checkpointInterval(void) const {
+    return _checkpointInterval.value();
+  }
+  /// Return true if the search must be resumed from the checkpoint
+  bool resume(void) const {
+    return _resume.value();
+  }
+  /// Return the number of worker processes
+  unsigned int workers(void) const {
+    return _workers.value();
+  }
+  /// Return the depth of the jobs
+  unsigned int splitDepth(void) const {
+    return _splitDepth.value();
+  }
 };
 
 /// Succeed the space
@@ -574,7 +633,41 @@ int main(int argc, char* argv[])
 
   ConnectFourOptions opt("QCSP Connect-Four-Game");
   opt.parse(argc,argv);
+  if (opt.workers() > 0) {
+    // The tree is split into jobs solved by forked worker processes
+    Support::Timer t;
+    t.start();
+    // The limits of the script options apply to the whole search, an
+    // interrupt simply ends every process
+    Search::Options so;
+    so.stop = Driver::CombinedStop::create(opt.node(),opt.fail(),opt.time(),false);
+    QDistributed d(new ConnectFourAllState(opt),opt.workers(),opt.splitDepth(),so);
+    int r = d.solve();
+    std::cout << ((r < 0) ? "Search stopped" : ((r == 1) ? "Problem true" : "Problem false"))
+              << std::endl;
+    if (opt.printStrategy()) d.print(std::cout);
+    std::cout << "\tjobs: " << d.frontier() << " (" << d.cancelled() << " cancelled)" << std::endl
+              << "\tnodes: " << d.qstatistics().node << std::endl
+              << "\tfailures: " << d.qstatistics().fail << std::endl
+              << "\truntime: " << t.stop() << " ms" << std::endl;
+    delete so.stop;
+    return 0;
+  }
+  Support::Telemetry* tm = NULL;
+  Support::TelemetryProbe* tp = NULL;
+  if (opt.telemetry() != NULL) {
+    tm = new Support::Telemetry(opt.telemetry(),opt.telemetryInterval());
+    if (!tm->ok())
+      std::cerr << "Cannot write telemetry to '" << opt.telemetry() << "'" << std::endl;
+    tp = new Support::TelemetryProbe(*tm);
+  }
+  Support::Checkpoint* cp = NULL;
+  if (opt.checkpoint() != NULL)
+    cp = new Support::Checkpoint(opt.checkpoint(),opt.checkpointInterval(),opt.resume());
   Script::run<ConnectFourAllState,QDFS,ConnectFourOptions>(opt);
+  delete cp;
+  delete tp;
+  delete tm;
 
   return 0;
 }
@@ -68,6 +68,8 @@ protected:
   Gecode::Driver::BoolOption _printStrategy;
   /// Flag to known if we have to print initial board
   Driver::BoolOption _printBoard;
+  /// Number of random boards solved in batch
+  Driver::UnsignedIntOption _batch;
 public:
   int n; /// Parameter to be given on the command line
   /// Initialize options for example with name \a s
@@ -76,10 +78,12 @@ public:
       _printStrategy("-printStrategy","Print strategy",false),
       _printBoard("-printBoard",
                    "whether to print initial board",pb0),
+      _batch("-batch","number of random boards solved from one template (0 for a single run)",0),
       n(n0) {
     add(_file);
     add(_printStrategy);
     add(_printBoard);
+    add(_batch);
   }
   /// Parse options from arguments \a argv (number is \a argc)
   void parse(int& argc, char* argv[]) {
@@ -106,10 +110,24 @@ public:
   bool printBoard(void) const {
     return _printBoard.value();
   }
+  /// Return the number of boards solved in batch
+  unsigned int batch(void) const {
+    return _batch.value();
+  }
 };
 
+/// Return a random board of size \a boardSize
+std::vector<int> randomBoard(int boardSize) {
+  std::vector<int> board(boardSize*boardSize);
+  for (int i=0; i<boardSize*boardSize; i++)
+    board[i] = (int)( (double)rand()  /  ((double)RAND_MAX + 1) * 50 ) < 25 ? 0:1;
+  return board;
+}
+
 class QCSPMatrixGame : public Script, public QSpaceInfo {
   IntVarArray X;
+  /// Cells of the board, only in batch mode (the board is then given by setBoard)
+  IntVarArray B;
 
 public:
 
@@ -122,29 +140,30 @@ public:
     int boardSize = (int)pow((double)2,(double)depth);
     std::srand(static_cast<unsigned int>(std::time(NULL)));
 
-    // If a file is given we take the matrix from the file
-    bool bFile = false;
-    std::vector<int> tab;
-    if (opt.file() != NULL) {
-      std::ifstream inS(opt.file());
-      if(!inS.is_open())
-        bFile = false;
-      else {
-        bFile = true;
-        int x;
-        while (inS >> x) tab.push_back(x);
-        boardSize = (int)sqrt(tab.size());
-        depth = (int) (log(boardSize) / log(2));
+    // In batch mode the board is given to each instance by setBoard
+    IntArgs board;
+    if (opt.batch() == 0) {
+      // If a file is given we take the matrix from the file
+      bool bFile = false;
+      std::vector<int> tab;
+      if (opt.file() != NULL) {
+        std::ifstream inS(opt.file());
+        if(!inS.is_open())
+          bFile = false;
+        else {
+          bFile = true;
+          int x;
+          while (inS >> x) tab.push_back(x);
+          boardSize = (int)sqrt(tab.size());
+          depth = (int) (log(boardSize) / log(2));
+        }
       }
-    }
 
-    IntArgs board(boardSize*boardSize);
-    for (int i=0; i<boardSize; i++)
-      for (int j=0; j<boardSize; j++)
-        if (bFile)
-          board[j*boardSize+i] = tab[j*boardSize+i];
-        else
-          board[j*boardSize+i] = (int)( (double)rand()  /  ((double)RAND_MAX + 1) * 50 ) < 25 ? 0:1;
+      if (!bFile) tab = randomBoard(boardSize);
+      board = IntArgs(boardSize*boardSize);
+      for (int i=0; i<boardSize*boardSize; i++)
+        board[i] = tab[i];
+    }
 
     int nbDecisionVar = 2*depth;
     IntArgs access(nbDecisionVar);
@@ -154,7 +173,7 @@ public:
       access[i]=access[i+2]*2;
 
     // Print initial board
-    if (opt.printBoard()) {
+    if (opt.printBoard() && (opt.batch() == 0)) {
       for (int i=0; i<boardSize; i++)
       {
         for (int j=0; j<boardSize; j++)
@@ -177,7 +196,12 @@ public:
     IntVar cstUn(*this,1,1);
     IntVar boardIdx(*this,0,boardSize*boardSize);
     linear(*this, access, x, IRT_EQ, boardIdx, IPL_DOM);
-    element(*this, board, boardIdx, cstUn, IPL_DOM);
+    if (opt.batch() > 0) {
+      B = IntVarArray(*this,boardSize*boardSize,0,1);
+      element(*this, B, boardIdx, cstUn, IPL_DOM);
+    } else {
+      element(*this, board, boardIdx, cstUn, IPL_DOM);
+    }
 
     branch(*this, X, INT_VAR_NONE(), INT_VAL_MIN());
   }
@@ -186,6 +210,13 @@ public:
     : Script(share,p), QSpaceInfo(*this,share,p)
   {
     X.update(*this,share,p.X);
+    B.update(*this,share,p.B);
+  }
+
+  /// Set the cells of the board to \a board (batch mode)
+  void setBoard(const std::vector<int>& board) {
+    for (int i=0; i<B.size(); i++)
+      rel(*this, B[i], IRT_EQ, board[i]);
   }
 
   virtual Space* copy(bool share) { return new QCSPMatrixGame(share,*this); }
@@ -196,11 +227,46 @@ public:
   }
 };
 
+/// Delta giving the board of an instance of the batch
+class BoardDelta {
+  /// Cells of the board
+  const std::vector<int>& board;
+public:
+  /// Initialize with the cells \a b
+  BoardDelta(const std::vector<int>& b) : board(b) {}
+  /// Set the board of \a s
+  void operator ()(QCSPMatrixGame& s) const {
+    s.setBoard(board);
+  }
+};
+
 int main(int argc, char* argv[])
 {
 
   MatrixGameOptions opt("QCSP Matrix-Game",5,false);
   opt.parse(argc,argv);
+  if (opt.batch() > 0) {
+    // The model is posted once, each board is solved on a clone of it
+    Support::Timer t;
+    t.start();
+    QTemplate<QCSPMatrixGame> tpl(new QCSPMatrixGame(opt));
+    int boardSize = 1 << opt.n;
+    unsigned int nWin = 0;
+    unsigned long int nodes = 0;
+    for (unsigned int i=0; i<opt.batch(); i++) {
+      std::vector<int> board = randomBoard(boardSize);
+      QCSPMatrixGame* s = tpl.solve(BoardDelta(board));
+      if (s) {
+        nWin++;
+        delete s;
+      }
+      nodes += tpl.qstatistics().node;
+    }
+    std::cout << nWin << " winning boards out of " << opt.batch() << std::endl
+              << "\tnodes: " << nodes << std::endl
+              << "\truntime: " << t.stop() << " ms" << std::endl;
+    return 0;
+  }
   Script::run<QCSPMatrixGame,QDFS,MatrixGameOptions>(opt);
 
   return 0;
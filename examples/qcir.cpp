@@ -0,0 +1,218 @@
+/* -*- mode: C++; c-basic-offset: 2; indent-tabs-mode: nil -*- */
+/*
+ *  Main authors:
+ *     Vincent Barichard <Vincent.Barichard@univ-angers.fr>
+ *
+ *  Copyright:
+ *     Vincent Barichard, 2014
+ *
+ *  Last modified:
+ *     $Date$ by $Author$
+ *     $Revision$
+ *
+ *  This file is part of Quacode:
+ *     http://quacode.barichard.com
+ *
+ *  Permission is hereby granted, free of charge, to any person obtaining
+ *  a copy of this software and associated documentation files (the
+ *  "Software"), to deal in the Software without restriction, including
+ *  without limitation the rights to use, copy, modify, merge, publish,
+ *  distribute, sublicense, and/or sell copies of the Software, and to
+ *  permit persons to whom the Software is furnished to do so, subject to
+ *  the following conditions:
+ *
+ *  The above copyright notice and this permission notice shall be
+ *  included in all copies or substantial portions of the Software.
+ *
+ *  THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND,
+ *  EXPRESS OR IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF
+ *  MERCHANTABILITY, FITNESS FOR A PARTICULAR PURPOSE AND
+ *  NONINFRINGEMENT. IN NO EVENT SHALL THE AUTHORS OR COPYRIGHT HOLDERS BE
+ *  LIABLE FOR ANY CLAIM, DAMAGES OR OTHER LIABILITY, WHETHER IN AN ACTION
+ *  OF CONTRACT, TORT OR OTHERWISE, ARISING FROM, OUT OF OR IN CONNECTION
+ *  WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE SOFTWARE.
+ *
+ */
+
+#include <string>
+#include <vector>
+
+#include <quacode/qspaceinfo.hh>
+#include <quacode/qbf/qcir.hh>
+#include <gecode/driver.hh>
+
+
+using namespace Gecode;
+
+
+#ifdef GECODE_HAS_GIST
+namespace Gecode { namespace Driver {
+  /// Specialization for QDFS
+  template<typename S>
+  class GistEngine<QDFS<S> > {
+  public:
+    static void explore(S* root, const Gist::Options& opt) {
+      (void) Gist::explore(root, false, opt);
+    }
+  };
+}}
+#endif
+
+/** \brief Options for %QCIR problems
+ *
+ */
+class QCirOptions : public Options {
+public:
+  /// Print strategy or not
+  Gecode::Driver::BoolOption _printStrategy;
+  /// Minimize the printed strategy or not
+  Gecode::Driver::BoolOption _minimizeStrategy;
+  /// Method used to build the printed strategy
+  Gecode::Driver::StringOption _strategyMethod;
+  /// Parameter to decide between optimized quantified constraints or usual ones
+  Driver::BoolOption _qConstraint;
+  /// Name of the QCIR file to parse
+  std::string filename;
+  /// Initialize options with file name \a s
+  QCirOptions(const char* s, bool _qConstraint0)
+    : Options(s),
+      _printStrategy("-printStrategy","Print strategy",false),
+      _minimizeStrategy("-minimizeStrategy","Minimize the strategy before printing it",false),
+      _strategyMethod("-strategyMethod","method used to build the printed strategy",
+                      StrategyMethodValues::BUILD | StrategyMethodValues::FAILTHROUGH),
+      _qConstraint("-quantifiedConstraints",
+                   "whether to use quantified optimized constraints",
+                   _qConstraint0)
+  {
+    add(_printStrategy);
+    add(_minimizeStrategy);
+    _strategyMethod.add(StrategyMethodValues::BUILD | StrategyMethodValues::FAILTHROUGH, "static",
+                        "static data structure, dynamic one if it can't be allocated");
+    _strategyMethod.add(StrategyMethodValues::BUILD | StrategyMethodValues::DYNAMIC, "dynamic",
+                        "dynamic data structure");
+    _strategyMethod.add(StrategyMethodValues::BUILD | StrategyMethodValues::AUTO, "auto",
+                        "data structure chosen with the worst case size of the strategy and half of the memory");
+    add(_strategyMethod);
+    add(_qConstraint);
+  }
+  /// Parse options from arguments \a argv (number is \a argc)
+  void parse(int& argc, char* argv[]) {
+    // Parse regular options
+    Options::parse(argc,argv);
+    // Filename, should be at position 1
+    if (argc == 1) {
+      help();
+      exit(1);
+    }
+    filename = argv[1];
+    argc--;
+  }
+  /// Return true if the strategy must be printed
+  bool printStrategy(void) const {
+    return _printStrategy.value();
+  }
+  /// Print help message
+  virtual void help(void) {
+    Options::help();
+    std::cerr << "\t(string) " << std::endl
+              << "\t\tqcir file to parse (.qcir)" << std::endl;
+  }
+};
+
+/**
+ * \brief %Example: circuit QSAT solver
+ *
+ * This example parses a QCIR file (prenex circuit QBF, see
+ * QCirReader). Each gate of the circuit is posted as a
+ * quantified Boolean propagator whose output is an auxiliary
+ * variable, no CNF conversion is done.
+ *
+ * #QCIR-G14
+ * forall(1, 2)
+ * exists(3)
+ * output(5)
+ * 4 = and(1, -3)
+ * 5 = or(4, 2, 3)
+ *
+ * \ingroup Example
+ */
+class QCir : public Script, public QSpaceInfo {
+private:
+  /// The Boolean variables
+  typedef std::vector< BoolVarArray > QBoolVarArray;
+  QBoolVarArray qx;
+public:
+  /// The actual problem
+  QCir(const QCirOptions& opt) : Script(opt), QSpaceInfo() {
+    if (!opt.printStrategy()) strategyMethod(0); // disable build and print strategy
+    else if (opt._minimizeStrategy.value())
+      strategyMethod(opt._strategyMethod.value() | StrategyMethodValues::MINIMIZE);
+    else
+      strategyMethod(opt._strategyMethod.value());
+    parseQCIR(opt.filename.c_str(),opt._qConstraint.value());
+  }
+
+  /// Constructor for cloning
+  QCir(bool share, QCir& s) : Script(share,s), QSpaceInfo(*this,share,s), qx(s.qx) {
+    for (unsigned int i=0; i<qx.size(); i++)
+      qx[i].update(*this,share,s.qx[i]);
+  }
+
+  /// Perform copying during cloning
+  virtual Space*
+  copy(bool share) {
+    return new QCir(share,*this);
+  }
+
+
+  /// Post constraints according to QCIR file \a f
+  void parseQCIR(const char* f, bool usedQuantifiedConstraint) {
+    QCirReader reader;
+    try {
+      reader.parse(f);
+    } catch (QCirError& e) {
+      std::cerr << "error in QCIR file '" << f << "' at line " << reader.line()
+                << ": " << e.what() << std::endl;
+      std::exit(EXIT_FAILURE);
+    }
+    std::cout << "Solving problem from QCIR file '" << f << "'"
+              << std::endl;
+    std::cout << "(" << reader.identifiers() << " variables and gates, "
+              << reader.circuit().size() << " gates)" << std::endl << std::endl;
+    for (unsigned int i=0; i<reader.blocks().size(); i++) {
+      std::cout << "( " << reader.blocks()[i].size << " ";
+      std::cout << ((reader.blocks()[i].q==EXISTS)?"existential":"universal");
+      std::cout << "variables )"<< std::endl;
+    }
+
+    BoolVarArray x;
+    reader.post(*this, *this, x, qx, usedQuantifiedConstraint);
+
+    for (unsigned int i=0; i<qx.size(); i++)
+      branch(*this, qx[i], INT_VAR_NONE(), INT_VAL_MIN());
+
+    // FIN DESCRIPTION PB
+  }
+};
+
+
+/** \brief Main-function
+ */
+int main(int argc, char* argv[]) {
+
+  QCirOptions opt("QCIR",true);
+  opt.parse(argc,argv);
+
+  // Check whether all arguments are successfully parsed
+  if (argc > 1) {
+    std::cerr << "Could not parse all arguments." << std::endl;
+    opt.help();
+    std::exit(EXIT_FAILURE);
+  }
+
+  // Run SAT solver
+  Script::run<QCir,QDFS,QCirOptions>(opt);
+  return 0;
+}
+
+// STATISTICS: example-any
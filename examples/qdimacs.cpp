@@ -49,11 +49,20 @@
  *
  */
 
+#include <cstdlib>
 #include <fstream>
+#include <sstream>
 #include <string>
+#include <unordered_map>
 #include <vector>
 
 #include <quacode/qspaceinfo.hh>
+#include <quacode/qbf/qdimacs.hh>
+#include <quacode/qbf/qpreprocess.hh>
+#include <quacode/qbf/qdependency.hh>
+#include <quacode/search/qdistributed.hh>
+#include <quacode/support/checkpoint.hh>
+#include <quacode/support/telemetry.hh>
 #include <gecode/driver.hh>
 
 
@@ -66,20 +75,79 @@ class QDimacsOptions : public Options {
 public:
   /// Print strategy or not
   Gecode::Driver::BoolOption _printStrategy;
+  /// Minimize the printed strategy or not
+  Gecode::Driver::BoolOption _minimizeStrategy;
+  /// Method used to build the printed strategy
+  Gecode::Driver::StringOption _strategyMethod;
   /// Parameter to decide between optimized quantified constraints or usual ones
   Driver::BoolOption _qConstraint;
+  /// Preprocess the problem or not
+  Driver::BoolOption _preprocess;
+  /// Relax the prefix with the dependencies or not
+  Driver::BoolOption _dependencies;
+  /// Decompose the problem into independent components or not
+  Driver::BoolOption _components;
+  /// File of queries solved under assumptions
+  Driver::StringValueOption _queries;
+  /// Destination of the telemetry
+  Driver::StringValueOption _telemetry;
+  /// Interval of the telemetry
+  Driver::UnsignedIntOption _telemetryInterval;
+  /// File of the checkpoints
+  Driver::StringValueOption _checkpoint;
+  /// Interval of the checkpoints
+  Driver::UnsignedIntOption _checkpointInterval;
+  /// Resume from the checkpoint or not
+  Driver::BoolOption _resume;
+  /// Number of worker processes
+  Driver::UnsignedIntOption _workers;
+  /// Depth of the jobs of the workers
+  Driver::UnsignedIntOption _splitDepth;
   /// Name of the QDIMACS file to parse
   std::string filename;
   /// Initialize options with file name \a s
   QDimacsOptions(const char* s, bool _qConstraint0)
     : Options(s),
       _printStrategy("-printStrategy","Print strategy",false),
+      _minimizeStrategy("-minimizeStrategy","Minimize the strategy before printing it",false),
+      _strategyMethod("-strategyMethod","method used to build the printed strategy",
+                      StrategyMethodValues::BUILD | StrategyMethodValues::FAILTHROUGH),
       _qConstraint("-quantifiedConstraints",
                    "whether to use quantified optimized constraints",
-                   _qConstraint0)
+                   _qConstraint0),
+      _preprocess("-preprocess","Preprocess the QBF before posting it",false),
+      _dependencies("-dependencies","Relax the prefix with the dependencies of the variables",false),
+      _components("-components","Decompose the problem into independent components during search",false),
+      _queries("-queries","file of queries solved under assumptions (literals ended by 0, one query per line)"),
+      _telemetry("-telemetry","File (or unix:PATH socket) receiving the progress as JSON lines"),
+      _telemetryInterval("-telemetryInterval","Interval of the telemetry (in ms)",1000),
+      _checkpoint("-checkpoint","File receiving the checkpoints of the search"),
+      _checkpointInterval("-checkpointInterval","Interval of the checkpoints (in ms)",60000),
+      _resume("-resume","Resume the search from the checkpoint",false),
+      _workers("-workers","Number of worker processes of the distributed search (0 for a single process)",0),
+      _splitDepth("-splitDepth","Depth of the jobs given to the workers",4)
   {
     add(_printStrategy);
+    add(_minimizeStrategy);
+    _strategyMethod.add(StrategyMethodValues::BUILD | StrategyMethodValues::FAILTHROUGH, "static",
+                        "static data structure, dynamic one if it can't be allocated");
+    _strategyMethod.add(StrategyMethodValues::BUILD | StrategyMethodValues::DYNAMIC, "dynamic",
+                        "dynamic data structure");
+    _strategyMethod.add(StrategyMethodValues::BUILD | StrategyMethodValues::AUTO, "auto",
+                        "data structure chosen with the worst case size of the strategy and half of the memory");
+    add(_strategyMethod);
     add(_qConstraint);
+    add(_preprocess);
+    add(_dependencies);
+    add(_components);
+    add(_queries);
+    add(_telemetry);
+    add(_telemetryInterval);
+    add(_checkpoint);
+    add(_checkpointInterval);
+    add(_resume);
+    add(_workers);
+    add(_splitDepth);
   }
   /// Parse options from arguments \a argv (number is \a argc)
   void parse(int& argc, char* argv[]) {
@@ -97,6 +165,34 @@ public:
   bool printStrategy(void) const {
     return _printStrategy.value();
   }
+  /// Return destination of the telemetry (NULL if none)
+  const char *telemetry(void) const {
+    return _telemetry.value();
+  }
+  /// Return interval of the telemetry
+  unsigned int telemetryInterval(void) const {
+    return _telemetryInterval.value();
+  }
+  /// Return file of the checkpoints (NULL if none)
+  const char *checkpoint(void) const {
+    return _checkpoint.value();
+  }
+  /// Return interval of the checkpoints
+  unsigned int checkpointInterval(void) const {
+    return _checkpointInterval.value();
+  }
+  /// Return true if the search must be resumed from the checkpoint
+  bool resume(void) const {
+    return _resume.value();
+  }
+  /// Return number of worker processes
+  unsigned int workers(void) const {
+    return _workers.value();
+  }
+  /// Return depth of the jobs of the workers
+  unsigned int splitDepth(void) const {
+    return _splitDepth.value();
+  }
   /// Print help message
   virtual void help(void) {
     Options::help();
@@ -113,8 +209,9 @@ public:
  * no such model exists.
  *
  * This example parses a Q-Dimacs CNF file in which
- * the constraints are specified. For each line of
- * the file a clause propagator is posted.
+ * the constraints are specified (see QDimacsReader).
+ * For each clause of the file a clause propagator
+ * is posted.
  *
  * Format of Q-Dimacs CNF files:
  *
@@ -153,11 +250,19 @@ private:
   /// The Boolean variables
   typedef std::vector< BoolVarArray > QBoolVarArray;
   QBoolVarArray qx;
+  /// Id in the binder of each variable of the file (-1 if not branched), not cloned
+  std::vector<int> vIds;
 public:
   /// The actual problem
   QDimacs(const QDimacsOptions& opt) : Script(opt), QSpaceInfo() {
     if (!opt.printStrategy()) strategyMethod(0); // disable build and print strategy
-    parseQDIMACS(opt.filename.c_str(),opt._qConstraint.value());
+    else if (opt._minimizeStrategy.value())
+      strategyMethod(opt._strategyMethod.value() | StrategyMethodValues::MINIMIZE);
+    else
+      strategyMethod(opt._strategyMethod.value());
+    componentDecomposition(opt._components.value());
+    parseQDIMACS(opt.filename.c_str(),opt._qConstraint.value(),opt._preprocess.value(),
+                 opt._dependencies.value());
   }
 
   /// Constructor for cloning
@@ -173,158 +278,119 @@ public:
   }
 
 
-  /// Post constraints according to QDIMACS file \a f
-  void parseQDIMACS(const char* f, bool usedQuantifiedConstraint) {
-    BoolVarArray x;
-    std::vector<int> x_rk;
-    std::vector<Gecode::TQuantifier> x_quant;
-    int variables = 0;
-    int clauses = 0;
-    std::ifstream dimacs(f);
-    if (!dimacs) {
-      std::cerr << "error: file '" << f << "' not found" << std::endl;
-      exit(1);
+  /// Post constraints according to QDIMACS file \a f (simplified before if \a preprocess,
+  /// with a prefix relaxed if \a dependencies)
+  void parseQDIMACS(const char* f, bool usedQuantifiedConstraint, bool preprocess, bool dependencies) {
+    QDimacsReader reader;
+    try {
+      reader.parse(f);
+    } catch (QDimacsError& e) {
+      std::cerr << "error in QDIMACS file '" << f << "' at line " << reader.line()
+                << ": " << e.what() << std::endl;
+      std::exit(EXIT_FAILURE);
     }
     std::cout << "Solving problem from QDIMACS file '" << f << "'"
               << std::endl;
-    std::string line;
-    int c = 0;
-    while (dimacs.good()) {
-      std::getline(dimacs,line);
-      // Comments (ignore them)
-      if (line[0] == 'c' || line == "") {
-      }
-      // Line has format "p cnf <variables> <clauses>"
-      else if (variables == 0 && clauses == 0 &&
-               line[0] == 'p' && line[1] == ' ' &&
-               line[2] == 'c' && line[3] == 'n' &&
-               line[4] == 'f' && line[5] == ' ') {
-        int i = 6;
-        while (line[i] >= '0' && line[i] <= '9') {
-          variables = 10*variables + line[i] - '0';
-          i++;
-        }
-        i++;
-        while (line[i] >= '0' && line[i] <= '9') {
-          clauses = 10*clauses + line[i] - '0';
-          i++;
-        }
-        x = BoolVarArray(*this, variables, 0, 1);
-        x_rk.resize(variables,Int::Limits::max);
-        x_quant.resize(variables,EXISTS);
-        std::cout << "(" << variables << " variables, "
-                  << clauses << " clauses)" << std::endl << std::endl;
-      }
-      // Line has format "a <variables>" or "e <variables>" or "r <variables>"
-      else if ( (line[0] == 'a' && line[1] == ' ') ||
-                (line[0] == 'e' && line[1] == ' ') ||
-                (line[0] == 'r' && line[1] == ' ') ) {
-        if (line[0] == 'r') {
-          std::cerr << "format error in dimacs file, \"r\" quantifier not recognized for now" << std::endl;
-          std::cerr << "context: '" << line << "'" << std::endl;
-          std::exit(EXIT_FAILURE);
-        }
-        BoolVarArgs tmp;
-        Gecode::TQuantifier quant = (line[0]=='e')?EXISTS:FORALL;
-        std::vector<int> values;
-        int i = 2;
-        while (line[i] != 0) {
-          if (line[i] == ' ') {
-            i++;
-            continue;
-          }
-          int value = 0;
-          while (line[i] >= '0' && line[i] <= '9') {
-            value = 10 * value + line[i] - '0';
-            i++;
-          }
-          if (value != 0) {
-            values.push_back(value);
-            tmp << x[value-1];
-            x_rk[value-1] = qx.size();
-            x_quant[value-1] = quant;
-            if (quant == FORALL) setForAll(*this,x[value-1]);
-            i++;
-          }
-        }
-
-        std::cout << "( " << values.size() << " ";
-        std::cout << ((quant==EXISTS)?"existential":"universal");
-        std::cout << "variables )"<< std::endl;
-        qx.push_back( BoolVarArray(*this,tmp) );
-      }
-      // Parse regular clause
-      else if (variables > 0 &&
-      ((line[0] >= '0' && line[0] <= '9') || line[0] == '-' || line[0] == ' ')) {
-        c++;
-        std::vector<int> pos;
-        std::vector<int> neg;
-        int i = 0;
-        while (line[i] != 0) {
-          if (line[i] == ' ') {
-            i++;
-            continue;
-          }
-          bool positive = true;
-          if (line[i] == '-') {
-            positive = false;
-            i++;
-          }
-          int value = 0;
-          while (line[i] >= '0' && line[i] <= '9') {
-            value = 10 * value + line[i] - '0';
-            i++;
-          }
-          if (value != 0) {
-            if (positive)
-              pos.push_back(value-1);
-            else
-              neg.push_back(value-1);
-            i++;
-          }
-        }
-
-        // Create positive BoolVarArgs
-        BoolVarArgs positives(pos.size());
-        QBoolVarArgs qpositives(pos.size());
-        for (int i=pos.size(); i--;) {
-          positives[i] = x[pos[i]];
-          qpositives[i] = QBoolVar(x_quant[pos[i]],x[pos[i]],x_rk[pos[i]]);
-        }
-
-        BoolVarArgs negatives(neg.size());
-        QBoolVarArgs qnegatives(neg.size());
-        for (int i=neg.size(); i--;) {
-          negatives[i] = x[neg[i]];
-          qnegatives[i] = QBoolVar(x_quant[neg[i]],x[neg[i]],x_rk[neg[i]]);
-        }
-
-        // Post propagators
-        if (usedQuantifiedConstraint)
-          qclause(*this, BOT_OR, qpositives, qnegatives, 1);
-        else
-          clause(*this, BOT_OR, positives, negatives, 1);
-      }
-      else {
-        std::cerr << "format error in dimacs file" << std::endl;
-        std::cerr << "context: '" << line << "'" << std::endl;
-        std::exit(EXIT_FAILURE);
-      }
+    std::cout << "(" << reader.variables() << " variables, "
+              << reader.clauses() << " clauses)" << std::endl << std::endl;
+    if (preprocess) {
+      QBFPreprocessor pp;
+      pp.run(reader);
+      pp.statistics().print(std::cout);
+      std::cout << std::endl;
     }
-    dimacs.close();
-    if (clauses != c) {
-      std::cerr << "error: number of specified clauses seems to be wrong."
-                << std::endl;
-      std::exit(EXIT_FAILURE);
+    if (dependencies) {
+      QBFDependencies dp;
+      dp.relax(reader);
+      dp.statistics().print(std::cout);
+      std::cout << std::endl;
+    }
+    for (unsigned int i=0; i<reader.blocks().size(); i++) {
+      std::cout << "( " << reader.blocks()[i].size << " ";
+      std::cout << ((reader.blocks()[i].q==EXISTS)?"existential":"universal");
+      std::cout << "variables )"<< std::endl;
     }
 
+    BoolVarArray x;
+    reader.post(*this, *this, x, qx, usedQuantifiedConstraint);
+
     for (unsigned int i=0; i<qx.size(); i++)
       branch(*this, qx[i], INT_VAR_NONE(), INT_VAL_MIN());
+    if (componentDecomposition()) reader.link(*this, x);
+
+    // The ids in the binder follow the order of the blocks
+    std::unordered_map<const void*,int> ids;
+    int vId = 0;
+    for (unsigned int i=0; i<qx.size(); i++)
+      for (int j=0; j<qx[i].size(); j++)
+        ids[qx[i][j].varimp()] = vId++;
+    vIds.assign(x.size(),-1);
+    for (int k=0; k<x.size(); k++) {
+      std::unordered_map<const void*,int>::const_iterator it = ids.find(x[k].varimp());
+      if (it != ids.end()) vIds[k] = it->second;
+    }
 
     // FIN DESCRIPTION PB
   }
+
+  /// Return the id in the binder of each variable of the file (-1 if not branched)
+  const std::vector<int>& varIds(void) const {
+    return vIds;
+  }
 };
 
+/// Solve the queries of the file \a f under assumptions on the problem given by \a opt
+void solveQueries(const QDimacsOptions& opt, const char* f) {
+  std::ifstream in(f);
+  if (!in.is_open()) {
+    std::cerr << "Could not open queries file '" << f << "'" << std::endl;
+    std::exit(EXIT_FAILURE);
+  }
+  QDimacs* m = new QDimacs(opt);
+  // The ids are read before the model is taken over
+  std::vector<int> vIds(m->varIds());
+  QAssumptions<QDimacs> qa(m);
+  std::string line;
+  unsigned int n = 0;
+  while (std::getline(in,line)) {
+    if (line.empty() || (line[0] == 'c')) continue;
+    // A query is a list of literals ended by 0, each one fixes its variable
+    std::istringstream ls(line);
+    std::vector<int> lits;
+    std::vector<QAssumption> a;
+    int l;
+    while ((ls >> l) && (l != 0)) {
+      unsigned int v = static_cast<unsigned int>(std::abs(l));
+      if ((v > vIds.size()) || (vIds[v-1] < 0)) {
+        std::cerr << "Unknown variable " << v << " in query " << (n+1) << std::endl;
+        std::exit(EXIT_FAILURE);
+      }
+      lits.push_back(l);
+      a.push_back(QAssumption(static_cast<unsigned int>(vIds[v-1]), l > 0, l > 0));
+    }
+    std::vector<QAssumption> core;
+    bool b = qa.solve(a,&core);
+    std::cout << "query " << ++n << ": ";
+    if (qa.stopped()) {
+      std::cout << "stopped" << std::endl;
+    } else if (b) {
+      std::cout << "true" << std::endl;
+    } else {
+      std::cout << "false, core:";
+      for (std::vector<QAssumption>::size_type i=0; i<core.size(); i++)
+        for (std::vector<QAssumption>::size_type j=0; j<a.size(); j++)
+          if (core[i].vId == a[j].vId) {
+            std::cout << " " << lits[j];
+            break;
+          }
+      std::cout << std::endl;
+    }
+  }
+  std::cout << std::endl
+            << "\tqueries: " << qa.queries() << std::endl
+            << "\tsearches: " << qa.searches() << std::endl
+            << "\thits: " << qa.hits() << std::endl;
+}
 
 /** \brief Main-function
  */
@@ -340,8 +406,48 @@ int main(int argc, char* argv[]) {
     std::exit(EXIT_FAILURE);
   }
 
+  if ((opt.workers() > 0) && (opt._queries.value() == NULL)) {
+    // The tree is split into jobs solved by forked worker processes
+    Support::Timer t;
+    t.start();
+    // The limits of the script options apply to the whole search
+    Search::Options so;
+    so.stop = Driver::CombinedStop::create(opt.node(),opt.fail(),opt.time(),false);
+    QDistributed d(new QDimacs(opt),opt.workers(),opt.splitDepth(),so);
+    int r = d.solve();
+    std::cout << ((r < 0) ? "Search stopped" : ((r == 1) ? "Problem true" : "Problem false"))
+              << std::endl;
+    if (opt.printStrategy()) d.print(std::cout);
+    std::cout << "\tjobs: " << d.frontier() << " (" << d.cancelled() << " cancelled)" << std::endl
+              << "\tnodes: " << d.qstatistics().node << std::endl
+              << "\tfailures: " << d.qstatistics().fail << std::endl
+              << "\truntime: " << t.stop() << " ms" << std::endl;
+    delete so.stop;
+    return 0;
+  }
+
+  Support::Telemetry* tm = NULL;
+  Support::TelemetryProbe* tp = NULL;
+  if (opt.telemetry() != NULL) {
+    tm = new Support::Telemetry(opt.telemetry(),opt.telemetryInterval());
+    if (!tm->ok())
+      std::cerr << "Cannot write telemetry to '" << opt.telemetry() << "'" << std::endl;
+    tp = new Support::TelemetryProbe(*tm);
+  }
+
+  // The queries are solved by several searches, they are not checkpointed
+  Support::Checkpoint* cp = NULL;
+  if ((opt.checkpoint() != NULL) && (opt._queries.value() == NULL))
+    cp = new Support::Checkpoint(opt.checkpoint(),opt.checkpointInterval(),opt.resume());
+
   // Run SAT solver
-  Script::run<QDimacs,DFS,QDimacsOptions>(opt);
+  if (opt._queries.value() != NULL)
+    solveQueries(opt,opt._queries.value());
+  else
+    Script::run<QDimacs,QDFS,QDimacsOptions>(opt);
+  delete cp;
+  delete tp;
+  delete tm;
   return 0;
 }
 
@@ -0,0 +1,916 @@
+/* -*- mode: C++; c-basic-offset: 2; indent-tabs-mode: nil -*- */
+/*
+ *  Main authors:
+ *     Vincent Barichard <Vincent.Barichard@univ-angers.fr>
+ *
+ *  Copyright:
+ *     Vincent Barichard, 2014
+ *
+ *  Last modified:
+ *     $Date$ by $Author$
+ *     $Revision$
+ *
+ *  This file is part of Quacode:
+ *     http://quacode.barichard.com
+ *
+ *  Permission is hereby granted, free of charge, to any person obtaining
+ *  a copy of this software and associated documentation files (the
+ *  "Software"), to deal in the Software without restriction, including
+ *  without limitation the rights to use, copy, modify, merge, publish,
+ *  distribute, sublicense, and/or sell copies of the Software, and to
+ *  permit persons to whom the Software is furnished to do so, subject to
+ *  the following conditions:
+ *
+ *  The above copyright notice and this permission notice shall be
+ *  included in all copies or substantial portions of the Software.
+ *
+ *  THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND,
+ *  EXPRESS OR IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF
+ *  MERCHANTABILITY, FITNESS FOR A PARTICULAR PURPOSE AND
+ *  NONINFRINGEMENT. IN NO EVENT SHALL THE AUTHORS OR COPYRIGHT HOLDERS BE
+ *  LIABLE FOR ANY CLAIM, DAMAGES OR OTHER LIABILITY, WHETHER IN AN ACTION
+ *  OF CONTRACT, TORT OR OTHERWISE, ARISING FROM, OUT OF OR IN CONNECTION
+ *  WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE SOFTWARE.
+ *
+ */
+
+#include <quacode/flatzinc/qflatzinc.hh>
+#include <quacode/support/mapped-file.hh>
+#include <algorithm>
+#include <cctype>
+#include <climits>
+#include <cstring>
+#include <map>
+
+namespace Gecode {
+
+  QFlatZincError::QFlatZincError(const char* l, const char* i)
+    : Exception(l,i) {}
+
+  QFlatZincSpace::QFlatZincSpace(void) : Space(), QSpaceInfo() {}
+
+  QFlatZincSpace::QFlatZincSpace(bool share, QFlatZincSpace& s)
+    : Space(share,s), QSpaceInfo(*this,share,s) {
+    iv.update(*this,share,s.iv);
+    bv.update(*this,share,s.bv);
+  }
+
+  Space* QFlatZincSpace::copy(bool share) {
+    return new QFlatZincSpace(share,*this);
+  }
+
+  namespace {
+
+    /// Throw a parse error with information \a i
+    void error(const char* i) {
+      throw QFlatZincError("QFlatZincParser::parse", i);
+    }
+
+    /// Type of tokens
+    enum TokenType { T_EOF, T_IDENT, T_INT, T_FLOAT, T_STRING, T_SYMBOL };
+
+    /// Lexer reading a buffer in place
+    class Lexer {
+    private:
+      /// Current position
+      const char* p;
+      /// End of the buffer
+      const char* e;
+      /// Current line
+      unsigned int& l;
+    public:
+      /// Type of the current token
+      TokenType t;
+      /// Text of the current token
+      const char* s;
+      /// Length of the current token
+      std::size_t n;
+      /// Value of the current token (integers)
+      int v;
+      /// Initialize with the \a n0 characters of \a b, lines are counted in \a l0
+      Lexer(const char* b, std::size_t n0, unsigned int& l0) : p(b), e(b+n0), l(l0) {
+        next();
+      }
+      /// Read the next token
+      void next(void) {
+        // Skip blanks and comments
+        while (p < e) {
+          if (*p == '\n') {
+            l++;
+            p++;
+          } else if (std::isspace(static_cast<unsigned char>(*p))) {
+            p++;
+          } else if (*p == '%') {
+            while ((p < e) && (*p != '\n')) p++;
+          } else {
+            break;
+          }
+        }
+        s = p;
+        n = 0;
+        if (p == e) {
+          t = T_EOF;
+          return;
+        }
+        char c = *p;
+        if (std::isalpha(static_cast<unsigned char>(c)) || (c == '_')) {
+          while ((p < e) && (std::isalnum(static_cast<unsigned char>(*p)) || (*p == '_'))) p++;
+          t = T_IDENT;
+        } else if (std::isdigit(static_cast<unsigned char>(c)) ||
+                   ((c == '-') && (p+1 < e) && std::isdigit(static_cast<unsigned char>(p[1])))) {
+          bool neg = (c == '-');
+          if (neg) p++;
+          long long r = 0;
+          for (; (p < e) && std::isdigit(static_cast<unsigned char>(*p)); p++) {
+            r = 10 * r + (*p - '0');
+            if (r > INT_MAX) error("Integer out of range");
+          }
+          v = static_cast<int>(neg ? -r : r);
+          t = T_INT;
+          // A range "1..3" starts with an integer, a float doesn't
+          if ((p+1 < e) && (*p == '.') && std::isdigit(static_cast<unsigned char>(p[1]))) t = T_FLOAT;
+        } else if (c == '"') {
+          for (p++; (p < e) && (*p != '"'); p++) {
+            if (*p == '\\') p++;
+            else if (*p == '\n') l++;
+          }
+          if (p >= e) error("Unterminated string");
+          p++;
+          t = T_STRING;
+        } else {
+          // Symbols, ".." and "::" are the only ones with two characters
+          if (((c == '.') || (c == ':')) && (p+1 < e) && (p[1] == c)) p += 2;
+          else p++;
+          t = T_SYMBOL;
+        }
+        n = static_cast<std::size_t>(p - s);
+      }
+      /// Return true if the current token is \a w
+      bool is(const char* w) const {
+        return ((t == T_IDENT) || (t == T_SYMBOL)) && (std::strlen(w) == n) &&
+               (std::strncmp(s, w, n) == 0);
+      }
+      /// Read token \a w if it is the current one
+      bool accept(const char* w) {
+        if (!is(w)) return false;
+        next();
+        return true;
+      }
+      /// Read token \a w
+      void expect(const char* w) {
+        if (!accept(w)) error("Syntax error");
+      }
+      /// Read an integer
+      int integer(void) {
+        if (t == T_FLOAT) error("Floats are not supported");
+        if (t != T_INT) error("Integer expected");
+        int r = v;
+        next();
+        return r;
+      }
+      /// Read an identifier
+      std::string ident(void) {
+        if (t != T_IDENT) error("Identifier expected");
+        std::string r(s, n);
+        next();
+        return r;
+      }
+    };
+
+    /// Value of an expression
+    struct Expr {
+      enum Kind { INT, BOOL, SET, ARRAY, IVAR, BVAR, STRING };
+      Kind k;                ///< Kind of expression
+      int v;                 ///< Value of constant or index of variable
+      IntSet is;             ///< Value of a set
+      std::vector<Expr> a;   ///< Elements of an array
+      Expr(Kind k0 = INT, int v0 = 0) : k(k0), v(v0) {}
+    };
+
+    /// Annotations of a declaration
+    struct Ann {
+      int quant;       ///< Quantifier (-1 if none)
+      int level;       ///< Level of the quantifier
+      bool outVar;     ///< True for output_var
+      bool outArray;   ///< True for output_array
+      std::vector< std::pair<int,int> > dims; ///< Index sets of output_array
+      Ann(void) : quant(-1), level(0), outVar(false), outArray(false) {}
+    };
+
+    /// Domain of a variable
+    struct Dom {
+      bool isBool; ///< True for a Boolean variable
+      IntSet d;    ///< Domain of an integer variable
+    };
+
+    /// Quantifier information of a variable
+    struct VarInfo {
+      TQuantifier q;  ///< Quantifier
+      bool annotated; ///< True if a quantifier annotation was given
+      int level;      ///< Level of the annotation
+      int seq;        ///< Order of declaration
+      int rank;       ///< Block of the variable in the prefix
+    };
+
+    /// Block of the prefix
+    struct Block {
+      TQuantifier q;  ///< Quantifier of the block
+      IntVarArgs x;   ///< Integer variables of the block
+      BoolVarArgs y;  ///< Boolean variables of the block
+    };
+
+    /// Variable annotated for sorting by level then declaration
+    struct Entry {
+      int level, seq, idx;
+      bool isBool;
+      bool operator <(const Entry& o) const {
+        return (level < o.level) || ((level == o.level) && (seq < o.seq));
+      }
+    };
+
+    /// Build a model from a FlatZinc buffer
+    class Builder {
+    private:
+      QFlatZincSpace& s;
+      Lexer lx;
+      bool qc;
+      std::vector<QFlatZincParser::Output>& outputs;
+      std::map<std::string,Expr> sym;
+      IntVarArgs ivs;
+      BoolVarArgs bvs;
+      std::vector<VarInfo> ii, bi;
+      std::vector<Block> blocks;
+      int seq;
+      bool finalized;
+      bool solved;
+
+      /// Skip tokens until \a w (included)
+      void skipTo(const char* w) {
+        while (!lx.is(w)) {
+          if (lx.t == T_EOF) error("Unexpected end of file");
+          lx.next();
+        }
+        lx.next();
+      }
+      /// Skip a parenthesized list
+      void skipBalanced(void) {
+        int depth = 0;
+        do {
+          if (lx.t == T_EOF) error("Unexpected end of file");
+          if (lx.is("(") || lx.is("[")) depth++;
+          else if (lx.is(")") || lx.is("]")) depth--;
+          lx.next();
+        } while (depth > 0);
+      }
+
+      /// Read an expression
+      Expr expr(void) {
+        if (lx.t == T_INT) {
+          int lo = lx.integer();
+          if (lx.accept("..")) {
+            Expr r(Expr::SET);
+            r.is = IntSet(lo, lx.integer());
+            return r;
+          }
+          return Expr(Expr::INT, lo);
+        }
+        if (lx.t == T_FLOAT) error("Floats are not supported");
+        if (lx.t == T_STRING) {
+          lx.next();
+          return Expr(Expr::STRING);
+        }
+        if (lx.accept("true")) return Expr(Expr::BOOL, 1);
+        if (lx.accept("false")) return Expr(Expr::BOOL, 0);
+        if (lx.accept("{")) {
+          IntArgs v;
+          if (!lx.accept("}")) {
+            do v << lx.integer(); while (lx.accept(","));
+            lx.expect("}");
+          }
+          Expr r(Expr::SET);
+          r.is = IntSet(v);
+          return r;
+        }
+        if (lx.accept("[")) {
+          Expr r(Expr::ARRAY);
+          if (!lx.accept("]")) {
+            do r.a.push_back(expr()); while (lx.accept(","));
+            lx.expect("]");
+          }
+          return r;
+        }
+        std::map<std::string,Expr>::const_iterator it = sym.find(lx.ident());
+        if (it == sym.end()) error("Undefined identifier");
+        if (lx.accept("[")) {
+          int i = lx.integer();
+          lx.expect("]");
+          if ((it->second.k != Expr::ARRAY) || (i < 1) || (i > static_cast<int>(it->second.a.size())))
+            error("Wrong array access");
+          return it->second.a[i-1];
+        }
+        return it->second;
+      }
+
+      /// Read annotations
+      void anns(Ann& a) {
+        while (lx.accept("::")) {
+          std::string name = lx.ident();
+          if ((name == "forall") || (name == "exists")) {
+            a.quant = (name == "forall") ? FORALL : EXISTS;
+            if (lx.accept("(")) {
+              a.level = lx.integer();
+              lx.expect(")");
+            }
+          } else if (name == "output_var") {
+            a.outVar = true;
+          } else if (name == "output_array") {
+            a.outArray = true;
+            lx.expect("(");
+            Expr d = expr();
+            lx.expect(")");
+            if (d.k != Expr::ARRAY) error("Wrong output_array annotation");
+            for (std::vector<Expr>::size_type i=0; i<d.a.size(); i++) {
+              if (d.a[i].k != Expr::SET) error("Wrong output_array annotation");
+              a.dims.push_back(std::make_pair(d.a[i].is.min(), d.a[i].is.max()));
+            }
+          } else if (lx.is("(")) {
+            skipBalanced();
+          }
+        }
+      }
+
+      /// Read the type of a variable
+      Dom varType(void) {
+        Dom d;
+        d.isBool = false;
+        if (lx.accept("bool")) {
+          d.isBool = true;
+        } else if (lx.accept("int")) {
+          d.d = IntSet(Int::Limits::min, Int::Limits::max);
+        } else if (lx.t == T_INT) {
+          int lo = lx.integer();
+          lx.expect("..");
+          d.d = IntSet(lo, lx.integer());
+        } else if (lx.accept("{")) {
+          IntArgs v;
+          do v << lx.integer(); while (lx.accept(","));
+          lx.expect("}");
+          d.d = IntSet(v);
+        } else {
+          error("Only integer and Boolean variables are supported");
+        }
+        return d;
+      }
+
+      /// Read the type of a parameter
+      void parType(void) {
+        if (lx.accept("bool") || lx.accept("int")) return;
+        if (lx.accept("set")) {
+          lx.expect("of");
+          if (lx.accept("int")) return;
+        }
+        if (lx.t == T_INT) {
+          lx.integer();
+          lx.expect("..");
+          lx.integer();
+          return;
+        }
+        error("Only integer, Boolean and set of integer parameters are supported");
+      }
+
+      /// Create a new variable with domain \a d and annotations \a a
+      Expr newVar(const Dom& d, const Ann& a) {
+        if (finalized) error("Variable declared after constraints");
+        VarInfo vi;
+        vi.q = (a.quant == FORALL) ? FORALL : EXISTS;
+        vi.annotated = (a.quant >= 0);
+        vi.level = a.level;
+        vi.seq = seq++;
+        vi.rank = 0;
+        if (d.isBool) {
+          bvs << BoolVar(s, 0, 1);
+          bi.push_back(vi);
+          return Expr(Expr::BVAR, bvs.size()-1);
+        }
+        ivs << IntVar(s, d.d);
+        ii.push_back(vi);
+        return Expr(Expr::IVAR, ivs.size()-1);
+      }
+
+      /// Give the quantifier of annotations \a a to variable \a x (if not given yet)
+      void annotate(const Expr& x, const Ann& a) {
+        if (a.quant < 0) return;
+        VarInfo* vi = NULL;
+        if (x.k == Expr::IVAR) vi = &ii[x.v];
+        else if (x.k == Expr::BVAR) vi = &bi[x.v];
+        if ((vi == NULL) || vi->annotated) return;
+        vi->q = (a.quant == FORALL) ? FORALL : EXISTS;
+        vi->annotated = true;
+        vi->level = a.level;
+      }
+
+      /// Return a variable with constant value \a e
+      Expr constant(const Dom& d, const Expr& e, const Ann& a) {
+        Expr x = newVar(d, a);
+        if (d.isBool) rel(s, bvs[x.v], IRT_EQ, intval(e));
+        else rel(s, ivs[x.v], IRT_EQ, intval(e));
+        return x;
+      }
+
+      /// Add output item \a name of elements \a e
+      void output(const std::string& name, const Expr& e, const Ann& a) {
+        if (!a.outVar && !a.outArray) return;
+        QFlatZincParser::Output o;
+        o.name = name;
+        o.dims = a.dims;
+        const std::vector<Expr>* el = &e.a;
+        std::vector<Expr> one;
+        if (a.outVar) {
+          one.push_back(e);
+          el = &one;
+        }
+        for (std::vector<Expr>::size_type i=0; i<el->size(); i++) {
+          QFlatZincParser::OutputElement oe;
+          const Expr& x = (*el)[i];
+          oe.kind = (x.k == Expr::INT) ? 0 : (x.k == Expr::BOOL) ? 1 : (x.k == Expr::IVAR) ? 2 : 3;
+          oe.value = x.v;
+          o.elements.push_back(oe);
+        }
+        outputs.push_back(o);
+      }
+
+      /// Read a variable declaration
+      void varDecl(void) {
+        Dom d = varType();
+        lx.expect(":");
+        std::string name = lx.ident();
+        Ann a;
+        anns(a);
+        Expr x;
+        if (lx.accept("=")) {
+          Expr init = expr();
+          if ((init.k == Expr::IVAR) || (init.k == Expr::BVAR)) {
+            // Alias of another variable
+            x = init;
+            annotate(x, a);
+            if (x.k == Expr::IVAR) dom(s, ivs[x.v], d.d);
+          } else {
+            x = constant(d, init, a);
+          }
+        } else {
+          x = newVar(d, a);
+        }
+        lx.expect(";");
+        sym[name] = x;
+        output(name, x, a);
+      }
+
+      /// Read an array declaration
+      void arrayDecl(void) {
+        lx.expect("[");
+        int lo = lx.integer();
+        lx.expect("..");
+        int n = lx.integer();
+        lx.expect("]");
+        lx.expect("of");
+        if (lo != 1) error("Arrays must start at index 1");
+        Expr r(Expr::ARRAY);
+        std::string name;
+        if (lx.accept("var")) {
+          Dom d = varType();
+          lx.expect(":");
+          name = lx.ident();
+          Ann a;
+          anns(a);
+          if (lx.accept("=")) {
+            Expr init = expr();
+            if (init.k != Expr::ARRAY) error("Array expected");
+            for (std::vector<Expr>::size_type i=0; i<init.a.size(); i++) {
+              const Expr& x = init.a[i];
+              if ((x.k == Expr::IVAR) || (x.k == Expr::BVAR)) {
+                annotate(x, a);
+                r.a.push_back(x);
+              } else if ((x.k == Expr::INT) || (x.k == Expr::BOOL)) {
+                r.a.push_back(x);
+              } else {
+                error("Wrong array element");
+              }
+            }
+          } else {
+            for (int i=0; i<n; i++) r.a.push_back(newVar(d, a));
+          }
+          if (a.outArray) output(name, r, a);
+        } else {
+          parType();
+          lx.expect(":");
+          name = lx.ident();
+          Ann a;
+          anns(a);
+          lx.expect("=");
+          r = expr();
+          if (r.k != Expr::ARRAY) error("Array expected");
+        }
+        lx.expect(";");
+        if (static_cast<int>(r.a.size()) != n) error("Wrong array size");
+        sym[name] = r;
+      }
+
+      /// Read a parameter declaration
+      void parDecl(void) {
+        parType();
+        lx.expect(":");
+        std::string name = lx.ident();
+        Ann a;
+        anns(a);
+        lx.expect("=");
+        sym[name] = expr();
+        lx.expect(";");
+      }
+
+      /// Compute the prefix once all variables are declared
+      void finalize(void) {
+        if (finalized) return;
+        finalized = true;
+        // Annotated variables are sorted by level, then by declaration
+        std::vector<Entry> ent;
+        for (std::vector<VarInfo>::size_type i=0; i<ii.size(); i++)
+          if (ii[i].annotated) {
+            Entry e = { ii[i].level, ii[i].seq, static_cast<int>(i), false };
+            ent.push_back(e);
+          }
+        for (std::vector<VarInfo>::size_type i=0; i<bi.size(); i++)
+          if (bi[i].annotated) {
+            Entry e = { bi[i].level, bi[i].seq, static_cast<int>(i), true };
+            ent.push_back(e);
+          }
+        std::stable_sort(ent.begin(), ent.end());
+        for (std::vector<Entry>::size_type i=0; i<ent.size(); i++) {
+          VarInfo& vi = ent[i].isBool ? bi[ent[i].idx] : ii[ent[i].idx];
+          if (blocks.empty() || (blocks.back().q != vi.q)) {
+            Block b;
+            b.q = vi.q;
+            blocks.push_back(b);
+          }
+          vi.rank = static_cast<int>(blocks.size()) - 1;
+          if (ent[i].isBool) {
+            blocks.back().y << bvs[ent[i].idx];
+            if (vi.q == FORALL) s.setForAll(s, bvs[ent[i].idx]);
+          } else {
+            blocks.back().x << ivs[ent[i].idx];
+            if (vi.q == FORALL) s.setForAll(s, ivs[ent[i].idx]);
+          }
+        }
+        // Other variables are existential and innermost
+        if (blocks.empty() || (blocks.back().q != EXISTS)) {
+          Block b;
+          b.q = EXISTS;
+          blocks.push_back(b);
+        }
+        int inner = static_cast<int>(blocks.size()) - 1;
+        for (std::vector<VarInfo>::size_type i=0; i<ii.size(); i++)
+          if (!ii[i].annotated) {
+            ii[i].rank = inner;
+            blocks.back().x << ivs[static_cast<int>(i)];
+          }
+        for (std::vector<VarInfo>::size_type i=0; i<bi.size(); i++)
+          if (!bi[i].annotated) {
+            bi[i].rank = inner;
+            blocks.back().y << bvs[static_cast<int>(i)];
+          }
+      }
+
+      /// \name Access to the arguments of constraints
+      //@{
+      int intval(const Expr& e) {
+        if ((e.k != Expr::INT) && (e.k != Expr::BOOL)) error("Constant expected");
+        return e.v;
+      }
+      IntVar iv(const Expr& e) {
+        if (e.k == Expr::IVAR) return ivs[e.v];
+        if (e.k == Expr::INT) return IntVar(s, e.v, e.v);
+        error("Integer variable expected");
+        GECODE_NEVER;
+        return IntVar();
+      }
+      BoolVar bv(const Expr& e) {
+        if (e.k == Expr::BVAR) return bvs[e.v];
+        if ((e.k == Expr::BOOL) || ((e.k == Expr::INT) && (e.v >= 0) && (e.v <= 1)))
+          return BoolVar(s, e.v, e.v);
+        error("Boolean variable expected");
+        GECODE_NEVER;
+        return BoolVar();
+      }
+      QBoolVar qbv(const Expr& e) {
+        BoolVar x = bv(e);
+        if (e.k == Expr::BVAR) return QBoolVar(bi[e.v].q, x, bi[e.v].rank);
+        return QBoolVar(x);
+      }
+      const std::vector<Expr>& array(const Expr& e) {
+        if (e.k != Expr::ARRAY) error("Array expected");
+        return e.a;
+      }
+      IntArgs ints(const Expr& e) {
+        const std::vector<Expr>& a = array(e);
+        IntArgs r(static_cast<int>(a.size()));
+        for (int i=r.size(); i--; ) r[i] = intval(a[i]);
+        return r;
+      }
+      IntVarArgs ivars(const Expr& e) {
+        const std::vector<Expr>& a = array(e);
+        IntVarArgs r(static_cast<int>(a.size()));
+        for (int i=r.size(); i--; ) r[i] = iv(a[i]);
+        return r;
+      }
+      BoolVarArgs bvars(const Expr& e) {
+        const std::vector<Expr>& a = array(e);
+        BoolVarArgs r(static_cast<int>(a.size()));
+        for (int i=r.size(); i--; ) r[i] = bv(a[i]);
+        return r;
+      }
+      QBoolVarArgs qbvars(const Expr& e) {
+        const std::vector<Expr>& a = array(e);
+        QBoolVarArgs r(static_cast<int>(a.size()));
+        for (int i=r.size(); i--; ) r[i] = qbv(a[i]);
+        return r;
+      }
+      IntSet set(const Expr& e) {
+        if (e.k != Expr::SET) error("Set expected");
+        return e.is;
+      }
+      //@}
+
+      /// Split constraint name \a c into operator \a op after prefix \a pre, \a mode is 1 for reified and 2 for half-reified versions
+      static bool split(const std::string& c, const char* pre, std::string& op, int& mode) {
+        std::size_t n = std::strlen(pre);
+        if (c.compare(0, n, pre) != 0) return false;
+        op = c.substr(n);
+        mode = 0;
+        if ((op.size() > 5) && (op.compare(op.size()-5, 5, "_reif") == 0)) {
+          mode = 1;
+          op.resize(op.size()-5);
+        } else if ((op.size() > 4) && (op.compare(op.size()-4, 4, "_imp") == 0)) {
+          mode = 2;
+          op.resize(op.size()-4);
+        }
+        return true;
+      }
+      /// Return the relation of operator \a op
+      static bool relType(const std::string& op, IntRelType& r) {
+        if (op == "eq") r = IRT_EQ;
+        else if (op == "ne") r = IRT_NQ;
+        else if (op == "le") r = IRT_LQ;
+        else if (op == "lt") r = IRT_LE;
+        else if (op == "ge") r = IRT_GQ;
+        else if (op == "gt") r = IRT_GR;
+        else return false;
+        return true;
+      }
+      /// Return the reification with control variable \a b and mode \a mode
+      Reify reify(const Expr& b, int mode) {
+        return Reify(bv(b), (mode == 1) ? RM_EQV : RM_IMP);
+      }
+      /// Check that the constraint has \a n arguments
+      static void arity(const std::vector<Expr>& x, std::vector<Expr>::size_type n) {
+        if (x.size() != n) error("Wrong number of arguments");
+      }
+      /// Post \a r = \a x \a o \a y
+      void logic(const Expr& x, BoolOpType o, const Expr& y, const Expr& r) {
+        if (qc) qrel(s, qbv(x), o, qbv(y), bv(r));
+        else rel(s, bv(x), o, bv(y), bv(r));
+      }
+      /// Post element constraint of FlatZinc (arrays start at 1)
+      template<class Args>
+      Args shift(const Args& a, const Expr& i) {
+        if (a.size() == 0) {
+          s.fail();
+          return a;
+        }
+        rel(s, iv(i), IRT_GQ, 1);
+        Args r(a.size()+1);
+        r[0] = a[0];
+        for (int k=a.size(); k--; ) r[k+1] = a[k];
+        return r;
+      }
+
+      /// Post constraint \a c with arguments \a x
+      void post(const std::string& c, const std::vector<Expr>& x) {
+        std::string op;
+        int mode;
+        IntRelType irt;
+        if (split(c, "int_lin_", op, mode) && relType(op, irt)) {
+          arity(x, mode ? 4 : 3);
+          if (mode) linear(s, ints(x[0]), ivars(x[1]), irt, intval(x[2]), reify(x[3], mode));
+          else linear(s, ints(x[0]), ivars(x[1]), irt, intval(x[2]));
+        } else if (split(c, "int_", op, mode) && relType(op, irt)) {
+          arity(x, mode ? 3 : 2);
+          if (mode) rel(s, iv(x[0]), irt, iv(x[1]), reify(x[2], mode));
+          else rel(s, iv(x[0]), irt, iv(x[1]));
+        } else if (split(c, "bool_", op, mode) && relType(op, irt)) {
+          arity(x, mode ? 3 : 2);
+          if ((mode == 1) && (irt == IRT_EQ)) logic(x[0], BOT_EQV, x[1], x[2]);
+          else if ((mode == 1) && (irt == IRT_NQ)) logic(x[0], BOT_XOR, x[1], x[2]);
+          else if ((mode == 1) && (irt == IRT_LQ)) logic(x[0], BOT_IMP, x[1], x[2]);
+          else if (mode) rel(s, bv(x[0]), irt, bv(x[1]), reify(x[2], mode));
+          else rel(s, bv(x[0]), irt, bv(x[1]));
+        } else if ((c == "int_plus") || (c == "int_minus")) {
+          arity(x, 3);
+          IntVarArgs y(3);
+          y[0] = iv(x[0]); y[1] = iv(x[1]); y[2] = iv(x[2]);
+          linear(s, IntArgs(3, 1, (c == "int_plus") ? 1 : -1, -1), y, IRT_EQ, 0);
+        } else if (c == "int_times") {
+          arity(x, 3);
+          mult(s, iv(x[0]), iv(x[1]), iv(x[2]));
+        } else if (c == "int_div") {
+          arity(x, 3);
+          div(s, iv(x[0]), iv(x[1]), iv(x[2]));
+        } else if (c == "int_mod") {
+          arity(x, 3);
+          mod(s, iv(x[0]), iv(x[1]), iv(x[2]));
+        } else if (c == "int_min") {
+          arity(x, 3);
+          min(s, iv(x[0]), iv(x[1]), iv(x[2]));
+        } else if (c == "int_max") {
+          arity(x, 3);
+          max(s, iv(x[0]), iv(x[1]), iv(x[2]));
+        } else if (c == "int_abs") {
+          arity(x, 2);
+          abs(s, iv(x[0]), iv(x[1]));
+        } else if (c == "array_int_element") {
+          arity(x, 3);
+          element(s, shift(ints(x[1]), x[0]), iv(x[0]), iv(x[2]));
+        } else if (c == "array_var_int_element") {
+          arity(x, 3);
+          element(s, shift(ivars(x[1]), x[0]), iv(x[0]), iv(x[2]));
+        } else if (c == "array_bool_element") {
+          arity(x, 3);
+          element(s, shift(ints(x[1]), x[0]), iv(x[0]), bv(x[2]));
+        } else if (c == "array_var_bool_element") {
+          arity(x, 3);
+          element(s, shift(bvars(x[1]), x[0]), iv(x[0]), bv(x[2]));
+        } else if (c == "bool2int") {
+          arity(x, 2);
+          channel(s, bv(x[0]), iv(x[1]));
+        } else if (c == "bool_not") {
+          arity(x, 2);
+          rel(s, bv(x[0]), IRT_NQ, bv(x[1]));
+        } else if (c == "bool_and") {
+          arity(x, 3);
+          logic(x[0], BOT_AND, x[1], x[2]);
+        } else if (c == "bool_or") {
+          arity(x, 3);
+          logic(x[0], BOT_OR, x[1], x[2]);
+        } else if (c == "bool_xor") {
+          if (x.size() == 2) rel(s, bv(x[0]), IRT_NQ, bv(x[1]));
+          else {
+            arity(x, 3);
+            logic(x[0], BOT_XOR, x[1], x[2]);
+          }
+        } else if (c == "bool_clause") {
+          arity(x, 2);
+          if (qc) qclause(s, BOT_OR, qbvars(x[0]), qbvars(x[1]), 1);
+          else clause(s, BOT_OR, bvars(x[0]), bvars(x[1]), 1);
+        } else if ((c == "array_bool_and") || (c == "array_bool_or")) {
+          arity(x, 2);
+          BoolOpType o = (c == "array_bool_and") ? BOT_AND : BOT_OR;
+          if (qc) qclause(s, o, qbvars(x[0]), QBoolVarArgs(), bv(x[1]));
+          else rel(s, o, bvars(x[0]), bv(x[1]));
+        } else if (c == "array_bool_xor") {
+          arity(x, 1);
+          rel(s, BOT_XOR, bvars(x[0]), 1);
+        } else if (split(c, "set_in", op, mode) && op.empty()) {
+          arity(x, mode ? 3 : 2);
+          if (mode) dom(s, iv(x[0]), set(x[1]), reify(x[2], mode));
+          else dom(s, iv(x[0]), set(x[1]));
+        } else if ((c == "all_different_int") || (c == "gecode_all_different_int")) {
+          arity(x, 1);
+          distinct(s, ivars(x[0]));
+        } else {
+          error("Unsupported constraint");
+        }
+      }
+
+      /// Read a constraint item
+      void constraint(void) {
+        std::string name = lx.ident();
+        std::vector<Expr> args;
+        lx.expect("(");
+        if (!lx.accept(")")) {
+          do args.push_back(expr()); while (lx.accept(","));
+          lx.expect(")");
+        }
+        Ann a;
+        anns(a);
+        lx.expect(";");
+        if (!s.failed()) post(name, args);
+      }
+
+      /// Read the solve item and post the branchings
+      void solve(void) {
+        if (solved) error("Solve item given twice");
+        solved = true;
+        Ann a;
+        anns(a);
+        if (lx.is("minimize") || lx.is("maximize")) error("Optimization is not supported");
+        lx.expect("satisfy");
+        lx.expect(";");
+        // Search annotations are ignored, we branch on the blocks of the prefix
+        for (std::vector<Block>::size_type i=0; i<blocks.size(); i++) {
+          if (blocks[i].x.size() > 0) s.branch(s, blocks[i].x, INT_VAR_NONE(), INT_VAL_MIN());
+          if (blocks[i].y.size() > 0) s.branch(s, blocks[i].y, INT_VAR_NONE(), INT_VAL_MIN());
+        }
+      }
+
+    public:
+      /// Initialize
+      Builder(QFlatZincSpace& s0, const char* b, std::size_t n, unsigned int& l, bool qc0,
+              std::vector<QFlatZincParser::Output>& o)
+        : s(s0), lx(b, n, l), qc(qc0), outputs(o), seq(0), finalized(false), solved(false) {}
+
+      /// Read the model
+      void run(void) {
+        while (lx.t != T_EOF) {
+          if (lx.accept("predicate")) {
+            skipTo(";");
+          } else if (lx.accept("constraint")) {
+            finalize();
+            constraint();
+          } else if (lx.accept("solve")) {
+            finalize();
+            solve();
+          } else if (lx.accept("array")) {
+            arrayDecl();
+          } else if (lx.accept("var")) {
+            varDecl();
+          } else {
+            parDecl();
+          }
+        }
+        if (!solved) error("Missing solve item");
+        s.iv = IntVarArray(s, ivs);
+        s.bv = BoolVarArray(s, bvs);
+      }
+
+      /// Return the flags of the variables of the outermost existential block
+      void outer(std::vector<char>& io, std::vector<char>& bo) const {
+        io.assign(ii.size(), 0);
+        bo.assign(bi.size(), 0);
+        for (std::vector<VarInfo>::size_type i=0; i<ii.size(); i++)
+          io[i] = (ii[i].rank == 0) && (ii[i].q == EXISTS);
+        for (std::vector<VarInfo>::size_type i=0; i<bi.size(); i++)
+          bo[i] = (bi[i].rank == 0) && (bi[i].q == EXISTS);
+      }
+    };
+  }
+
+  QFlatZincParser::QFlatZincParser(bool qc0) : qc(qc0), _line(0) {}
+
+  void QFlatZincParser::parse(const char* f, QFlatZincSpace& s) {
+    Support::MappedFile mf;
+    if (!mf.open(f)) throw QFlatZincError("QFlatZincParser::parse","Cannot read file");
+    parse(mf.data(), mf.size(), s);
+  }
+
+  void QFlatZincParser::parse(const char* b, std::size_t n, QFlatZincSpace& s) {
+    outputs.clear();
+    _line = 1;
+    Builder bd(s, b, n, _line, qc, outputs);
+    bd.run();
+    bd.outer(iouter, bouter);
+  }
+
+  void QFlatZincParser::print(std::ostream& os, const QFlatZincSpace& s) const {
+    for (std::vector<Output>::size_type i=0; i<outputs.size(); i++) {
+      const Output& o = outputs[i];
+      // Only values of the outermost existential variables are relevant
+      bool relevant = true;
+      for (std::vector<OutputElement>::size_type k=0; k<o.elements.size(); k++) {
+        const OutputElement& e = o.elements[k];
+        if (((e.kind == 2) && !iouter[e.value]) || ((e.kind == 3) && !bouter[e.value]))
+          relevant = false;
+      }
+      if (!relevant) continue;
+      os << o.name << " = ";
+      if (!o.dims.empty()) {
+        os << "array" << o.dims.size() << "d(";
+        for (std::vector< std::pair<int,int> >::size_type k=0; k<o.dims.size(); k++)
+          os << o.dims[k].first << ".." << o.dims[k].second << ", ";
+        os << "[";
+      }
+      for (std::vector<OutputElement>::size_type k=0; k<o.elements.size(); k++) {
+        const OutputElement& e = o.elements[k];
+        if (k > 0) os << ", ";
+        switch (e.kind) {
+        case 0: os << e.value; break;
+        case 1: os << (e.value ? "true" : "false"); break;
+        case 2: os << s.iv[e.value]; break;
+        default: os << (s.bv[e.value].val() ? "true" : "false"); break;
+        }
+      }
+      if (!o.dims.empty()) os << "])";
+      os << ";" << std::endl;
+    }
+  }
+
+}
+
+// STATISTICS: int-post
@@ -0,0 +1,140 @@
+/* -*- mode: C++; c-basic-offset: 2; indent-tabs-mode: nil -*- */
+/*
+ *  Main authors:
+ *     Vincent Barichard <Vincent.Barichard@univ-angers.fr>
+ *
+ *  Copyright:
+ *     Vincent Barichard, 2014
+ *
+ *  Last modified:
+ *     $Date$ by $Author$
+ *     $Revision$
+ *
+ *  This file is part of Quacode:
+ *     http://quacode.barichard.com
+ *
+ *  Permission is hereby granted, free of charge, to any person obtaining
+ *  a copy of this software and associated documentation files (the
+ *  "Software"), to deal in the Software without restriction, including
+ *  without limitation the rights to use, copy, modify, merge, publish,
+ *  distribute, sublicense, and/or sell copies of the Software, and to
+ *  permit persons to whom the Software is furnished to do so, subject to
+ *  the following conditions:
+ *
+ *  The above copyright notice and this permission notice shall be
+ *  included in all copies or substantial portions of the Software.
+ *
+ *  THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND,
+ *  EXPRESS OR IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF
+ *  MERCHANTABILITY, FITNESS FOR A PARTICULAR PURPOSE AND
+ *  NONINFRINGEMENT. IN NO EVENT SHALL THE AUTHORS OR COPYRIGHT HOLDERS BE
+ *  LIABLE FOR ANY CLAIM, DAMAGES OR OTHER LIABILITY, WHETHER IN AN ACTION
+ *  OF CONTRACT, TORT OR OTHERWISE, ARISING FROM, OUT OF OR IN CONNECTION
+ *  WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE SOFTWARE.
+ *
+ */
+
+#ifndef __GECODE_QFLATZINC_HH__
+#define __GECODE_QFLATZINC_HH__
+
+#include <quacode/qspaceinfo.hh>
+#include <cstddef>
+#include <iostream>
+#include <string>
+#include <utility>
+#include <vector>
+
+namespace Gecode {
+
+  /// %Exception: error while reading a FlatZinc model
+  class QUACODE_EXPORT QFlatZincError : public Exception {
+  public:
+    /// Initialize with location \a l and information \a i
+    QFlatZincError(const char* l, const char* i);
+  };
+
+  /**
+   * \brief Space of a quantified FlatZinc model
+   */
+  class QFlatZincSpace : public Space, public QSpaceInfo {
+  public:
+    /// Integer variables of the model
+    IntVarArray iv;
+    /// Boolean variables of the model
+    BoolVarArray bv;
+    /// Constructor
+    QUACODE_EXPORT QFlatZincSpace(void);
+    /// Constructor for cloning \a s
+    QUACODE_EXPORT QFlatZincSpace(bool share, QFlatZincSpace& s);
+    /// Perform copying during cloning
+    QUACODE_EXPORT virtual Space* copy(bool share);
+  };
+
+  /**
+   * \brief Reader of quantified FlatZinc models
+   *
+   * It reads the FlatZinc language (integer and Boolean variables) and
+   * posts the model in a QFlatZincSpace. The quantifier of a variable is
+   * given by an annotation of its declaration:
+   *
+   *    var 0..1: x :: forall;
+   *    array [1..3] of var 1..9: y :: exists;
+   *    var bool: z :: forall(2);
+   *
+   * Annotated variables are branched in the order of their declarations,
+   * unless a level is given as argument of the annotation (variables are
+   * then sorted by level, 0 being the default level). Consecutive variables
+   * with the same quantifier make a block. Variables without annotation
+   * (introduced by the flattening for instance) are existential and
+   * branched last.
+   *
+   * Boolean constraints are posted with the quantified propagators (qrel,
+   * qclause) if asked, with the usual Gecode propagators otherwise. Search
+   * annotations are ignored and optimization is not supported.
+   */
+  class QFlatZincParser {
+  public:
+    /// Element of an output item, a variable or a constant
+    struct OutputElement {
+      int kind;  ///< 0 for a constant integer, 1 for a constant Boolean, 2 for an integer variable, 3 for a Boolean variable
+      int value; ///< Value of the constant or index of the variable
+    };
+    /// Output item (annotation output_var or output_array)
+    struct Output {
+      std::string name;                           ///< Name of the variable
+      std::vector< std::pair<int,int> > dims;     ///< Index sets of the array (empty for a variable)
+      std::vector<OutputElement> elements;        ///< Elements of the item
+    };
+  protected:
+    /// True if the quantified propagators are used
+    bool qc;
+    /// Output items
+    std::vector<Output> outputs;
+    /// Flags of the integer variables of the outermost existential block
+    std::vector<char> iouter;
+    /// Flags of the Boolean variables of the outermost existential block
+    std::vector<char> bouter;
+    /// Current line of the parser
+    unsigned int _line;
+  public:
+    /// Constructor, the quantified propagators are used if \a qc0 is true
+    QUACODE_EXPORT QFlatZincParser(bool qc0 = true);
+    /// Read the model of FlatZinc file \a f and post it in \a s
+    QUACODE_EXPORT void parse(const char* f, QFlatZincSpace& s);
+    /// Read the model given by the \a n characters of buffer \a b and post it in \a s
+    QUACODE_EXPORT void parse(const char* b, std::size_t n, QFlatZincSpace& s);
+    /// Return the line reached by the parser (line of the error if any)
+    unsigned int line(void) const;
+    /// Print the output items of solution \a s. Only the variables of the
+    /// outermost existential block have a meaning, other items are skipped.
+    QUACODE_EXPORT void print(std::ostream& os, const QFlatZincSpace& s) const;
+  };
+
+  forceinline unsigned int
+  QFlatZincParser::line(void) const {
+    return _line;
+  }
+
+}
+
+#endif
@@ -0,0 +1,198 @@
+/* -*- mode: C++; c-basic-offset: 2; indent-tabs-mode: nil -*- */
+/*
+ *  Main authors:
+ *     Vincent Barichard <Vincent.Barichard@univ-angers.fr>
+ *
+ *  Copyright:
+ *     Vincent Barichard, 2014
+ *
+ *  Last modified:
+ *     $Date$ by $Author$
+ *     $Revision$
+ *
+ *  This file is part of Quacode:
+ *     http://quacode.barichard.com
+ *
+ *  Permission is hereby granted, free of charge, to any person obtaining
+ *  a copy of this software and associated documentation files (the
+ *  "Software"), to deal in the Software without restriction, including
+ *  without limitation the rights to use, copy, modify, merge, publish,
+ *  distribute, sublicense, and/or sell copies of the Software, and to
+ *  permit persons to whom the Software is furnished to do so, subject to
+ *  the following conditions:
+ *
+ *  The above copyright notice and this permission notice shall be
+ *  included in all copies or substantial portions of the Software.
+ *
+ *  THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND,
+ *  EXPRESS OR IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF
+ *  MERCHANTABILITY, FITNESS FOR A PARTICULAR PURPOSE AND
+ *  NONINFRINGEMENT. IN NO EVENT SHALL THE AUTHORS OR COPYRIGHT HOLDERS BE
+ *  LIABLE FOR ANY CLAIM, DAMAGES OR OTHER LIABILITY, WHETHER IN AN ACTION
+ *  OF CONTRACT, TORT OR OTHERWISE, ARISING FROM, OUT OF OR IN CONNECTION
+ *  WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE SOFTWARE.
+ *
+ */
+
+#include <cstdlib>
+#include <iostream>
+#include <string>
+
+#include <quacode/flatzinc/qflatzinc.hh>
+#include <quacode/support/telemetry.hh>
+#include <gecode/driver.hh>
+
+
+using namespace Gecode;
+
+/** \brief Options for quantified FlatZinc models
+ *
+ */
+class QFlatZincOptions : public Options {
+public:
+  /// Print strategy or not
+  Driver::BoolOption _printStrategy;
+  /// Parameter to decide between optimized quantified constraints or usual ones
+  Driver::BoolOption _qConstraint;
+  /// Order the universal values by their refutations or not
+  Driver::BoolOption _refutation;
+  /// Order the variables of the blocks by their activity or not
+  Driver::BoolOption _activity;
+  /// File of the search trace
+  Driver::StringValueOption _trace;
+  /// Destination of the telemetry
+  Driver::StringValueOption _telemetry;
+  /// Interval of the telemetry
+  Driver::UnsignedIntOption _telemetryInterval;
+  /// Name of the FlatZinc file to parse
+  std::string filename;
+  /// Initialize options with file name \a s
+  QFlatZincOptions(const char* s, bool _qConstraint0)
+    : Options(s),
+      _printStrategy("-printStrategy","Print strategy",false),
+      _qConstraint("-quantifiedConstraints",
+                   "whether to use quantified optimized constraints",
+                   _qConstraint0),
+      _refutation("-refutation","whether to try first the universal values which refuted the existential player",false),
+      _activity("-activity","whether to branch first on the most active variable of each block",false),
+      _trace("-trace","File of the search trace (see qtrace)"),
+      _telemetry("-telemetry","File (or unix:PATH socket) receiving the progress as JSON lines"),
+      _telemetryInterval("-telemetryInterval","Interval of the telemetry (in ms)",1000)
+  {
+    add(_printStrategy);
+    add(_qConstraint);
+    add(_refutation);
+    add(_activity);
+    add(_trace);
+    add(_telemetry);
+    add(_telemetryInterval);
+  }
+  /// Parse options from arguments \a argv (number is \a argc)
+  void parse(int& argc, char* argv[]) {
+    // Parse regular options
+    Options::parse(argc,argv);
+    // Filename, should be at position 1
+    if (argc == 1) {
+      help();
+      exit(1);
+    }
+    filename = argv[1];
+    argc--;
+  }
+  /// Return true if the strategy must be printed
+  bool printStrategy(void) const {
+    return _printStrategy.value();
+  }
+  /// Print help message
+  virtual void help(void) {
+    Options::help();
+    std::cerr << "\t(string) " << std::endl
+              << "\t\tFlatZinc file to parse (.fzn)" << std::endl;
+  }
+};
+
+/** \brief Main-function
+ *
+ * Solve a quantified FlatZinc model (see QFlatZincParser) and print
+ * the values of the outermost existential variables in the format of
+ * the FlatZinc solvers, so the program can be used as backend of
+ * MiniZinc.
+ */
+int main(int argc, char* argv[]) {
+
+  QFlatZincOptions opt("QFlatZinc",true);
+  opt.parse(argc,argv);
+
+  // Check whether all arguments are successfully parsed
+  if (argc > 1) {
+    std::cerr << "Could not parse all arguments." << std::endl;
+    opt.help();
+    std::exit(EXIT_FAILURE);
+  }
+
+  QFlatZincSpace* s = new QFlatZincSpace();
+  if (!opt.printStrategy()) s->strategyMethod(0); // disable build and print strategy
+  s->refutationOrder(opt._refutation.value());
+  s->activityOrder(opt._activity.value());
+  QFlatZincParser parser(opt._qConstraint.value());
+  try {
+    parser.parse(opt.filename.c_str(), *s);
+  } catch (QFlatZincError& e) {
+    std::cerr << "error in FlatZinc file '" << opt.filename << "' at line "
+              << parser.line() << ": " << e.what() << std::endl;
+    delete s;
+    std::exit(EXIT_FAILURE);
+  }
+
+  Search::Options o;
+  o.c_d = opt.c_d();
+  o.a_d = opt.a_d();
+  Support::Tracer* tracer = NULL;
+  Support::TraceBuffer* tb = NULL;
+  if (opt._trace.value() != NULL) {
+    tracer = new Support::Tracer(opt._trace.value());
+    if (!tracer->ok())
+      std::cerr << "Cannot write trace file '" << opt._trace.value() << "'" << std::endl;
+    tb = new Support::TraceBuffer(*tracer);
+  }
+  Support::Telemetry* tm = NULL;
+  Support::TelemetryProbe* tp = NULL;
+  if (opt._telemetry.value() != NULL) {
+    tm = new Support::Telemetry(opt._telemetry.value(),opt._telemetryInterval.value());
+    if (!tm->ok())
+      std::cerr << "Cannot write telemetry to '" << opt._telemetry.value() << "'" << std::endl;
+    tp = new Support::TelemetryProbe(*tm);
+  }
+  Support::Timer t;
+  t.start();
+  QDFS<QFlatZincSpace> e(s, o);
+  delete s;
+  QFlatZincSpace* sol = e.next();
+  double time = t.stop();
+  delete tb;
+  delete tracer;
+  delete tp;
+  delete tm;
+
+  if (sol != NULL) {
+    parser.print(std::cout, *sol);
+    std::cout << "----------" << std::endl;
+    if (opt.printStrategy()) sol->strategyPrint(std::cerr);
+    delete sol;
+  } else if (e.stopped()) {
+    std::cout << "=====UNKNOWN=====" << std::endl;
+  } else {
+    std::cout << "=====UNSATISFIABLE=====" << std::endl;
+  }
+
+  Search::QStatistics stat = e.qstatistics();
+  std::cerr << "%% runtime:       " << time << " ms" << std::endl
+            << "%% propagations:  " << stat.propagate << std::endl
+            << "%% nodes:         " << stat.node << std::endl
+            << "%% failures:      " << stat.fail << std::endl
+            << "%% peak depth:    " << stat.depth << std::endl;
+  stat.print(std::cerr);
+  return 0;
+}
+
+// STATISTICS: example-any
@@ -0,0 +1,364 @@
+/* -*- mode: C++; c-basic-offset: 2; indent-tabs-mode: nil -*- */
+/*
+ *  Main authors:
+ *     Vincent Barichard <Vincent.Barichard@univ-angers.fr>
+ *
+ *  Copyright:
+ *     Vincent Barichard, 2014
+ *
+ *  Last modified:
+ *     $Date$ by $Author$
+ *     $Revision$
+ *
+ *  This file is part of Quacode:
+ *     http://quacode.barichard.com
+ *
+ *  Permission is hereby granted, free of charge, to any person obtaining
+ *  a copy of this software and associated documentation files (the
+ *  "Software"), to deal in the Software without restriction, including
+ *  without limitation the rights to use, copy, modify, merge, publish,
+ *  distribute, sublicense, and/or sell copies of the Software, and to
+ *  permit persons to whom the Software is furnished to do so, subject to
+ *  the following conditions:
+ *
+ *  The above copyright notice and this permission notice shall be
+ *  included in all copies or substantial portions of the Software.
+ *
+ *  THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND,
+ *  EXPRESS OR IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF
+ *  MERCHANTABILITY, FITNESS FOR A PARTICULAR PURPOSE AND
+ *  NONINFRINGEMENT. IN NO EVENT SHALL THE AUTHORS OR COPYRIGHT HOLDERS BE
+ *  LIABLE FOR ANY CLAIM, DAMAGES OR OTHER LIABILITY, WHETHER IN AN ACTION
+ *  OF CONTRACT, TORT OR OTHERWISE, ARISING FROM, OUT OF OR IN CONNECTION
+ *  WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE SOFTWARE.
+ *
+ */
+
+#include <quacode/qbf/qcir.hh>
+#include <quacode/support/mapped-file.hh>
+#include <cstring>
+
+namespace Gecode {
+
+  QCirError::QCirError(const char* l, const char* i)
+    : Exception(l,i) {}
+
+  namespace {
+    /// Tokenizer reading a buffer in place
+    class Tokenizer {
+    private:
+      /// Current position
+      const char* p;
+      /// End of the buffer
+      const char* e;
+      /// Current line
+      unsigned int& l;
+    public:
+      /// Initialize with the \a n characters of \a b, lines are counted in \a l0
+      Tokenizer(const char* b, std::size_t n, unsigned int& l0) : p(b), e(b+n), l(l0) {}
+      /// Return true if \a c is a character of identifiers
+      static bool ident(char c) {
+        return ((c >= 'a') && (c <= 'z')) || ((c >= 'A') && (c <= 'Z')) ||
+               ((c >= '0') && (c <= '9')) || (c == '_');
+      }
+      /// Skip blanks of the current line, return false at the end of the line
+      bool skip(void) {
+        while ((p < e) && ((*p == ' ') || (*p == '\t') || (*p == '\r'))) p++;
+        return (p < e) && (*p != '\n') && (*p != '#');
+      }
+      /// Go to the next non empty line (comments are skipped), return false at the end of the buffer
+      bool nextLine(void) {
+        while (p < e) {
+          if (skip()) return true;
+          while ((p < e) && (*p != '\n')) p++;
+          if (p < e) {
+            p++;
+            l++;
+          }
+        }
+        return false;
+      }
+      /// Read character \a c
+      bool symbol(char c) {
+        if (!skip() || (*p != c)) return false;
+        p++;
+        return true;
+      }
+      /// Read an identifier, return its position in \a b and its length in \a n
+      bool identifier(const char*& b, std::size_t& n) {
+        if (!skip() || !ident(*p)) return false;
+        b = p;
+        while ((p < e) && ident(*p)) p++;
+        n = static_cast<std::size_t>(p - b);
+        return true;
+      }
+      /// Return true if the identifier \a b of length \a n is \a w
+      static bool is(const char* b, std::size_t n, const char* w) {
+        return (std::strlen(w) == n) && (std::strncmp(b, w, n) == 0);
+      }
+    };
+  }
+
+  QCirReader::QCirReader(void) : out(0), outNeg(false), _line(0) {}
+
+  int QCirReader::id(const char* name, std::size_t n) {
+    std::pair<std::unordered_map<std::string,int>::iterator,bool> r =
+      ids.insert(std::make_pair(std::string(name, n), static_cast<int>(isGate.size()) + 1));
+    if (r.second) isGate.push_back(0);
+    return r.first->second;
+  }
+
+  void QCirReader::parse(const char* f) {
+    Support::MappedFile mf;
+    if (!mf.open(f)) throw QCirError("QCirReader::parse","Cannot read file");
+    parse(mf.data(), mf.size());
+  }
+
+  void QCirReader::parse(const char* b, std::size_t n) {
+    ids.clear();
+    isGate.clear();
+    gates.clear();
+    lits.clear();
+    prefix.clear();
+    blockVars.clear();
+    out = 0;
+    outName.clear();
+    outNeg = false;
+    _line = 1;
+
+    // Flags of the identifiers already quantified
+    std::vector<char> quantified;
+    Tokenizer t(b, n, _line);
+    const char* w;
+    std::size_t wn;
+    while (t.nextLine()) {
+      if (!t.identifier(w, wn))
+        throw QCirError("QCirReader::parse","Identifier expected");
+      bool freeBlock = Tokenizer::is(w, wn, "free");
+      if (freeBlock || Tokenizer::is(w, wn, "exists") || Tokenizer::is(w, wn, "forall")) {
+        // Line has format "exists(<variables>)" or "forall(<variables>)"
+        if (!gates.empty() || !outName.empty())
+          throw QCirError("QCirReader::parse","Quantifier line out of the prefix");
+        if (freeBlock && !prefix.empty())
+          throw QCirError("QCirReader::parse","Free variables must come first");
+        TQuantifier q = Tokenizer::is(w, wn, "forall") ? FORALL : EXISTS;
+        if (prefix.empty() || (prefix.back().q != q)) {
+          Block bl;
+          bl.q = q;
+          bl.first = static_cast<int>(blockVars.size());
+          bl.size = 0;
+          prefix.push_back(bl);
+        }
+        if (!t.symbol('('))
+          throw QCirError("QCirReader::parse","Wrong quantifier line");
+        if (!t.symbol(')')) {
+          do {
+            if (!t.identifier(w, wn))
+              throw QCirError("QCirReader::parse","Wrong variable in quantifier line");
+            int v = id(w, wn);
+            quantified.resize(isGate.size(), 0);
+            if (quantified[v-1])
+              throw QCirError("QCirReader::parse","Variable quantified twice");
+            quantified[v-1] = 1;
+            blockVars.push_back(v);
+            prefix.back().size++;
+          } while (t.symbol(','));
+          if (!t.symbol(')'))
+            throw QCirError("QCirReader::parse","Wrong quantifier line");
+        }
+      } else if (Tokenizer::is(w, wn, "output")) {
+        // Line has format "output(<literal>)", the gate may be defined later
+        if (!outName.empty())
+          throw QCirError("QCirReader::parse","Output given twice");
+        if (!t.symbol('('))
+          throw QCirError("QCirReader::parse","Wrong output line");
+        outNeg = t.symbol('-');
+        if (!t.identifier(w, wn) || !t.symbol(')'))
+          throw QCirError("QCirReader::parse","Wrong output line");
+        outName.assign(w, wn);
+      } else {
+        // Line has format "<gate> = <type>(<literals>)"
+        std::size_t nIds = isGate.size();
+        int g = id(w, wn);
+        if (isGate.size() == nIds)
+          throw QCirError("QCirReader::parse","Gate defined twice or used before its definition");
+        isGate[g-1] = 1;
+        if (!t.symbol('=') || !t.identifier(w, wn))
+          throw QCirError("QCirReader::parse","Wrong gate definition");
+        Gate gt;
+        gt.id = g;
+        if (Tokenizer::is(w, wn, "and")) gt.t = AND;
+        else if (Tokenizer::is(w, wn, "or")) gt.t = OR;
+        else if (Tokenizer::is(w, wn, "xor")) gt.t = XOR;
+        else if (Tokenizer::is(w, wn, "ite")) gt.t = ITE;
+        else if (Tokenizer::is(w, wn, "exists") || Tokenizer::is(w, wn, "forall"))
+          throw QCirError("QCirReader::parse","Quantified gates (non-prenex circuits) not supported");
+        else
+          throw QCirError("QCirReader::parse","Unknown gate type");
+        gt.first = static_cast<int>(lits.size());
+        if (!t.symbol('('))
+          throw QCirError("QCirReader::parse","Wrong gate definition");
+        if (!t.symbol(')')) {
+          do {
+            bool neg = t.symbol('-');
+            if (!t.identifier(w, wn))
+              throw QCirError("QCirReader::parse","Wrong literal");
+            int v = id(w, wn);
+            if (v == g)
+              throw QCirError("QCirReader::parse","Gate used in its own definition");
+            lits.push_back(neg ? -v : v);
+          } while (t.symbol(','));
+          if (!t.symbol(')'))
+            throw QCirError("QCirReader::parse","Wrong gate definition");
+        }
+        gt.size = static_cast<int>(lits.size()) - gt.first;
+        if ((gt.t == ITE) && (gt.size != 3))
+          throw QCirError("QCirReader::parse","Gate ite needs three inputs");
+        gates.push_back(gt);
+      }
+      if (t.skip())
+        throw QCirError("QCirReader::parse","Unexpected characters at the end of the line");
+    }
+    if (outName.empty())
+      throw QCirError("QCirReader::parse","Missing output line");
+    std::unordered_map<std::string,int>::const_iterator it = ids.find(outName);
+    if (it == ids.end())
+      throw QCirError("QCirReader::parse","Undefined output");
+    out = outNeg ? -it->second : it->second;
+  }
+
+  namespace {
+    /// Post \a z = \a o ( \a l[0], ..., \a l[n-1] ) with \a o being BOT_AND or BOT_OR
+    void
+    postClause(Home home, BoolVarArray& x, const std::vector<int>& rk,
+               const std::vector<TQuantifier>& quant, BoolOpType o,
+               const int* l, int n, BoolVar z, bool qc) {
+      if (n == 0) {
+        rel(home, z, IRT_EQ, (o == BOT_AND) ? 1 : 0);
+        return;
+      }
+      int nPos = 0;
+      for (int i=n; i--; )
+        if (l[i] > 0) nPos++;
+      if (qc) {
+        QBoolVarArgs pos(nPos), neg(n - nPos);
+        for (int i=0, ip=0, in=0; i<n; i++) {
+          int v = ((l[i] > 0) ? l[i] : -l[i]) - 1;
+          QBoolVar qx(quant[v], x[v], rk[v]);
+          if (l[i] > 0) pos[ip++] = qx; else neg[in++] = qx;
+        }
+        qclause(home, o, pos, neg, z);
+      } else {
+        BoolVarArgs pos(nPos), neg(n - nPos);
+        for (int i=0, ip=0, in=0; i<n; i++) {
+          if (l[i] > 0) pos[ip++] = x[l[i]-1]; else neg[in++] = x[-l[i]-1];
+        }
+        clause(home, o, pos, neg, z);
+      }
+    }
+  }
+
+  void QCirReader::post(Home home, QSpaceInfo& qsi, BoolVarArray& x,
+                        std::vector<BoolVarArray>& b, bool qc) const {
+    int nIds = identifiers();
+    x = BoolVarArray(home, nIds, 0, 1);
+    b.clear();
+
+    // Rank and quantifier of each variable, free variables are existential
+    // and outermost, gates are existential and innermost
+    std::vector<int> rk(nIds, Int::Limits::max);
+    std::vector<TQuantifier> quant(nIds, EXISTS);
+    std::vector<char> quantified(nIds, 0);
+    for (std::vector<int>::size_type i=0; i<blockVars.size(); i++)
+      quantified[blockVars[i]-1] = 1;
+    BoolVarArgs freeVars;
+    for (int i=0; i<nIds; i++)
+      if (!quantified[i] && !isGate[i]) {
+        freeVars << x[i];
+        rk[i] = 0;
+      }
+    if (freeVars.size() > 0) b.push_back(BoolVarArray(home, freeVars));
+
+    for (std::vector<Block>::size_type i=0; i<prefix.size(); i++) {
+      const Block& bl = prefix[i];
+      int r = static_cast<int>(b.size());
+      BoolVarArgs vars(bl.size);
+      for (int j=0; j<bl.size; j++) {
+        int v = blockVars[bl.first + j] - 1;
+        vars[j] = x[v];
+        rk[v] = r;
+        quant[v] = bl.q;
+      }
+      if (bl.q == FORALL) qsi.setForAll(home, vars);
+      b.push_back(BoolVarArray(home, vars));
+    }
+
+    for (std::vector<Gate>::size_type g=0; g<gates.size(); g++) {
+      const Gate& gt = gates[g];
+      const int* l = lits.data() + gt.first;
+      BoolVar z = x[gt.id-1];
+      switch (gt.t) {
+      case AND:
+        postClause(home, x, rk, quant, BOT_AND, l, gt.size, z, qc);
+        break;
+      case OR:
+        postClause(home, x, rk, quant, BOT_OR, l, gt.size, z, qc);
+        break;
+      case XOR:
+        {
+          // Negated inputs are taken into account by the parity of the last operation
+          bool parity = false;
+          for (int i=gt.size; i--; )
+            if (l[i] < 0) parity = !parity;
+          if (gt.size == 0) {
+            rel(home, z, IRT_EQ, 0);
+            break;
+          }
+          int v0 = ((l[0] > 0) ? l[0] : -l[0]) - 1;
+          BoolVar acc = x[v0];
+          QBoolVar qacc(quant[v0], acc, rk[v0]);
+          if (gt.size == 1) {
+            rel(home, acc, parity ? IRT_NQ : IRT_EQ, z);
+            break;
+          }
+          for (int i=1; i<gt.size; i++) {
+            int v = ((l[i] > 0) ? l[i] : -l[i]) - 1;
+            bool last = (i == gt.size-1);
+            BoolVar r = last ? z : BoolVar(home, 0, 1);
+            BoolOpType o = (last && parity) ? BOT_EQV : BOT_XOR;
+            if (qc)
+              qrel(home, qacc, o, QBoolVar(quant[v], x[v], rk[v]), r);
+            else
+              rel(home, acc, o, x[v], r);
+            acc = r;
+            qacc = QBoolVar(acc);
+          }
+        }
+        break;
+      case ITE:
+        {
+          // z = (c & t) | (-c & e)
+          int ct[2] = { l[0], l[1] };
+          int ce[2] = { -l[0], l[2] };
+          BoolVar g1(home, 0, 1), g2(home, 0, 1);
+          postClause(home, x, rk, quant, BOT_AND, ct, 2, g1, qc);
+          postClause(home, x, rk, quant, BOT_AND, ce, 2, g2, qc);
+          if (qc)
+            qrel(home, QBoolVar(g1), BOT_OR, QBoolVar(g2), z);
+          else
+            rel(home, g1, BOT_OR, g2, z);
+        }
+        break;
+      default:
+        GECODE_NEVER;
+      }
+      if (home.failed()) return;
+    }
+
+    // The circuit must be true
+    rel(home, x[(out > 0 ? out : -out) - 1], IRT_EQ, (out > 0) ? 1 : 0);
+  }
+
+}
+
+// STATISTICS: int-post
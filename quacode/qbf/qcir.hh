@@ -0,0 +1,193 @@
+/* -*- mode: C++; c-basic-offset: 2; indent-tabs-mode: nil -*- */
+/*
+ *  Main authors:
+ *     Vincent Barichard <Vincent.Barichard@univ-angers.fr>
+ *
+ *  Copyright:
+ *     Vincent Barichard, 2014
+ *
+ *  Last modified:
+ *     $Date$ by $Author$
+ *     $Revision$
+ *
+ *  This file is part of Quacode:
+ *     http://quacode.barichard.com
+ *
+ *  Permission is hereby granted, free of charge, to any person obtaining
+ *  a copy of this software and associated documentation files (the
+ *  "Software"), to deal in the Software without restriction, including
+ *  without limitation the rights to use, copy, modify, merge, publish,
+ *  distribute, sublicense, and/or sell copies of the Software, and to
+ *  permit persons to whom the Software is furnished to do so, subject to
+ *  the following conditions:
+ *
+ *  The above copyright notice and this permission notice shall be
+ *  included in all copies or substantial portions of the Software.
+ *
+ *  THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND,
+ *  EXPRESS OR IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF
+ *  MERCHANTABILITY, FITNESS FOR A PARTICULAR PURPOSE AND
+ *  NONINFRINGEMENT. IN NO EVENT SHALL THE AUTHORS OR COPYRIGHT HOLDERS BE
+ *  LIABLE FOR ANY CLAIM, DAMAGES OR OTHER LIABILITY, WHETHER IN AN ACTION
+ *  OF CONTRACT, TORT OR OTHERWISE, ARISING FROM, OUT OF OR IN CONNECTION
+ *  WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE SOFTWARE.
+ *
+ */
+
+#ifndef __GECODE_QBF_QCIR_HH__
+#define __GECODE_QBF_QCIR_HH__
+
+#include <quacode/qspaceinfo.hh>
+#include <cstddef>
+#include <string>
+#include <unordered_map>
+#include <vector>
+
+namespace Gecode {
+
+  /// %Exception: format error while reading a QCIR problem
+  class QUACODE_EXPORT QCirError : public Exception {
+  public:
+    /// Initialize with location \a l and information \a i
+    QCirError(const char* l, const char* i);
+  };
+
+  /**
+   * \brief Reader of QBF circuits in (prenex) QCIR format
+   *
+   * A QCIR file gives the quantifier prefix, the output and the gates of
+   * the circuit:
+   *
+   *    #QCIR-G14
+   *    forall(x, y)
+   *    exists(z)
+   *    output(g2)
+   *    g1 = and(x, -z)
+   *    g2 = or(g1, y)
+   *
+   * Gates \c and, \c or, \c xor and \c ite are supported. Each gate is posted
+   * as a (quantified) Boolean propagator whose output is a new variable, so
+   * the circuit is not converted to CNF. Non-prenex quantified gates are
+   * not supported.
+   *
+   * Identifiers are numbered from 1 in their order of appearance, a literal
+   * is an identifier number, negated for negative literals.
+   *
+   * Format errors are reported by throwing QCirError, line() gives the line
+   * of the error.
+   */
+  class QCirReader {
+  public:
+    /// Type of gates
+    enum GateType { AND, OR, XOR, ITE };
+    /// Gate of the circuit
+    struct Gate {
+      int id;     ///< Identifier of the output of the gate
+      GateType t; ///< Type of the gate
+      int first;  ///< Position of the first input of the gate in lits
+      int size;   ///< Number of inputs of the gate
+    };
+    /// Block of variables with the same quantifier in the prefix
+    struct Block {
+      TQuantifier q; ///< Quantifier of the block
+      int first;     ///< Position of the first variable of the block in blockVars
+      int size;      ///< Number of variables of the block
+    };
+  protected:
+    /// Identifiers of the names
+    std::unordered_map<std::string,int> ids;
+    /// True for the identifiers defined by a gate
+    std::vector<char> isGate;
+    /// Gates of the circuit, in the order of their definitions
+    std::vector<Gate> gates;
+    /// Inputs of all gates
+    std::vector<int> lits;
+    /// Blocks of the prefix (outermost first)
+    std::vector<Block> prefix;
+    /// Variables of the blocks of the prefix
+    std::vector<int> blockVars;
+    /// Output literal (0 if none)
+    int out;
+    /// Name of the output, it may be defined after the output line
+    std::string outName;
+    /// True if the output is negated
+    bool outNeg;
+    /// Current line of the parser
+    unsigned int _line;
+    /// Return the identifier of \a name (of length \a n), create it if needed
+    int id(const char* name, std::size_t n);
+  public:
+    /// Constructor
+    QUACODE_EXPORT QCirReader(void);
+    /// Read the circuit of the QCIR file \a f
+    QUACODE_EXPORT void parse(const char* f);
+    /// Read the circuit given by the \a n characters of buffer \a b
+    QUACODE_EXPORT void parse(const char* b, std::size_t n);
+
+    /// Return the number of identifiers (variables and gates)
+    int identifiers(void) const;
+    /// Return the gates of the circuit
+    const std::vector<Gate>& circuit(void) const;
+    /// Return the input at position \a i of the gates
+    int input(int i) const;
+    /// Return the blocks of the prefix
+    const std::vector<Block>& blocks(void) const;
+    /// Return the variable at position \a i of the blocks of the prefix
+    int blockVar(int i) const;
+    /// Return the output literal
+    int output(void) const;
+    /// Return the line reached by the parser (line of the error if any)
+    unsigned int line(void) const;
+
+    /**
+     * \brief Post the circuit in \a home
+     *
+     * Variables are created in \a x for all identifiers (identifier i is
+     * x[i-1]) and the variables of each block of the prefix are stored in
+     * \a blocks. Variables which are neither gates nor in the prefix are
+     * gathered in an outermost existential block. Universal variables are
+     * declared to \a qsi. Gates are posted with qrel and qclause if \a qc
+     * is true, with rel and clause otherwise.
+     */
+    QUACODE_EXPORT void post(Home home, QSpaceInfo& qsi, BoolVarArray& x,
+                             std::vector<BoolVarArray>& blocks, bool qc) const;
+  };
+
+  forceinline int
+  QCirReader::identifiers(void) const {
+    return static_cast<int>(isGate.size());
+  }
+
+  forceinline const std::vector<QCirReader::Gate>&
+  QCirReader::circuit(void) const {
+    return gates;
+  }
+
+  forceinline int
+  QCirReader::input(int i) const {
+    return lits[i];
+  }
+
+  forceinline const std::vector<QCirReader::Block>&
+  QCirReader::blocks(void) const {
+    return prefix;
+  }
+
+  forceinline int
+  QCirReader::blockVar(int i) const {
+    return blockVars[i];
+  }
+
+  forceinline int
+  QCirReader::output(void) const {
+    return out;
+  }
+
+  forceinline unsigned int
+  QCirReader::line(void) const {
+    return _line;
+  }
+
+}
+
+#endif
@@ -0,0 +1,219 @@
+/* -*- mode: C++; c-basic-offset: 2; indent-tabs-mode: nil -*- */
+/*
+ *  Main authors:
+ *     Vincent Barichard <Vincent.Barichard@univ-angers.fr>
+ *
+ *  Copyright:
+ *     Vincent Barichard, 2014
+ *
+ *  Last modified:
+ *     $Date$ by $Author$
+ *     $Revision$
+ *
+ *  This file is part of Quacode:
+ *     http://quacode.barichard.com
+ *
+ *  Permission is hereby granted, free of charge, to any person obtaining
+ *  a copy of this software and associated documentation files (the
+ *  "Software"), to deal in the Software without restriction, including
+ *  without limitation the rights to use, copy, modify, merge, publish,
+ *  distribute, sublicense, and/or sell copies of the Software, and to
+ *  permit persons to whom the Software is furnished to do so, subject to
+ *  the following conditions:
+ *
+ *  The above copyright notice and this permission notice shall be
+ *  included in all copies or substantial portions of the Software.
+ *
+ *  THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND,
+ *  EXPRESS OR IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF
+ *  MERCHANTABILITY, FITNESS FOR A PARTICULAR PURPOSE AND
+ *  NONINFRINGEMENT. IN NO EVENT SHALL THE AUTHORS OR COPYRIGHT HOLDERS BE
+ *  LIABLE FOR ANY CLAIM, DAMAGES OR OTHER LIABILITY, WHETHER IN AN ACTION
+ *  OF CONTRACT, TORT OR OTHERWISE, ARISING FROM, OUT OF OR IN CONNECTION
+ *  WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE SOFTWARE.
+ *
+ */
+
+#include <quacode/qbf/qdependency.hh>
+#include <algorithm>
+
+namespace Gecode {
+
+  void QBFDependencyStatistics::print(std::ostream& os) const {
+    os << "Dependencies:" << std::endl
+       << "\tblocks:             " << blocksIn << " -> " << blocksOut << std::endl
+       << "\tdependency groups:  " << groups << std::endl
+       << "\tindependent vars:   " << independent << std::endl
+       << "\tmoved vars:         " << moved << std::endl
+       << "\ttime:               " << time << " ms" << std::endl;
+  }
+
+  QBFDependencies::QBFDependencies(void) : nVars(0) {}
+
+  void QBFDependencies::groups(int l, const std::vector< std::vector<int> >& byLevel) {
+    if (byLevel[l].empty()) return;
+    std::vector<int> touched;
+    // Gather the variables of level l by group of linked clauses
+    for (std::vector<int>::size_type i=0; i<byLevel[l].size(); i++) {
+      int x = byLevel[l][i];
+      for (std::vector<int>::size_type k=0; k<occ[x].size(); k++) {
+        int r = find(occ[x][k]);
+        if (rootGroup[r] < 0) {
+          rootGroup[r] = static_cast<int>(groupVars.size());
+          groupVars.push_back(std::vector<int>());
+          touched.push_back(r);
+        }
+        std::vector<int>& g = groupVars[rootGroup[r]];
+        if (g.empty() || (g.back() != x)) g.push_back(x);
+      }
+    }
+    // The inner variables of the other quantifier in a group depend on its
+    // variables. A variable is listed once by each clause it had when it
+    // became inner: the duplicates met are removed from the list.
+    int s = (quant[byLevel[l][0]] == EXISTS) ? 1 : 0;
+    for (std::vector<int>::size_type i=0; i<touched.size(); i++) {
+      int r = touched[i];
+      int g = rootGroup[r];
+      std::vector<int>& in = inner[s][r];
+      std::vector<int>::size_type n = 0;
+      for (std::vector<int>::size_type k=0; k<in.size(); k++) {
+        int y = in[k];
+        if (lastGroup[y] == g) continue;
+        lastGroup[y] = g;
+        deps[y].push_back(g);
+        in[n++] = y;
+      }
+      in.resize(n);
+      rootGroup[r] = -1;
+    }
+  }
+
+  void QBFDependencies::inward(int v) {
+    std::vector< std::vector<int> >& in = inner[(quant[v] == EXISTS) ? 0 : 1];
+    int last = -1;
+    for (std::vector<int>::size_type k=0; k<occ[v].size(); k++) {
+      int r = find(occ[v][k]);
+      if (r != last) in[r].push_back(v);
+      last = r;
+    }
+  }
+
+  unsigned long int QBFDependencies::relax(QDimacsReader& r) {
+    Support::Timer t;
+    t.start();
+    st = QBFDependencyStatistics();
+    st.blocksIn = r.prefix.size();
+    nVars = r.nVars;
+    level.assign(nVars+1, 0);
+    quant.assign(nVars+1, EXISTS);
+    occ.assign(nVars+1, std::vector<int>());
+    deps.assign(nVars+1, std::vector<int>());
+    groupVars.clear();
+
+    // Free variables are at level 0, blocks of the prefix start at level 1
+    int nLevels = static_cast<int>(r.prefix.size()) + 1;
+    std::vector< std::vector<int> > byLevel(nLevels);
+    for (std::vector<QDimacsReader::Block>::size_type b=0; b<r.prefix.size(); b++)
+      for (int k=0; k<r.prefix[b].size; k++) {
+        int v = r.blockVars[r.prefix[b].first + k];
+        level[v] = static_cast<int>(b) + 1;
+        quant[v] = r.prefix[b].q;
+        byLevel[b+1].push_back(v);
+      }
+    int nClauses = r.clauses();
+    for (int i=0; i<nClauses; i++) {
+      int n;
+      const int* l = r.clause(i, n);
+      for (int k=0; k<n; k++) {
+        int v = (l[k] > 0) ? l[k] : -l[k];
+        if (occ[v].empty() || (occ[v].back() != i)) occ[v].push_back(i);
+      }
+    }
+    for (int v=1; v<=nVars; v++)
+      if ((level[v] == 0) && !occ[v].empty()) byLevel[0].push_back(v);
+
+    // Dependency groups, from the innermost level. Before computing the
+    // groups of level l, the clauses are linked by the existential
+    // variables inner than l
+    parent.resize(nClauses);
+    for (int c=0; c<nClauses; c++) parent[c] = c;
+    rootGroup.assign(nClauses, -1);
+    inner[0].assign(nClauses, std::vector<int>());
+    inner[1].assign(nClauses, std::vector<int>());
+    lastGroup.assign(nVars+1, -1);
+    for (int l=nLevels-2; l>=0; l--) {
+      for (std::vector<int>::size_type i=0; i<byLevel[l+1].size(); i++) {
+        int v = byLevel[l+1][i];
+        if (quant[v] != EXISTS) continue;
+        for (std::vector<int>::size_type k=1; k<occ[v].size(); k++)
+          unite(occ[v][k], occ[v][0]);
+      }
+      for (std::vector<int>::size_type i=0; i<byLevel[l+1].size(); i++)
+        inward(byLevel[l+1][i]);
+      groups(l, byLevel);
+    }
+    st.groups = groupVars.size();
+
+    // New level of each variable, from the outermost one: even levels are
+    // existential, odd levels are universal. The old levels are numbered
+    // the same way to count the moved variables.
+    std::vector<int> newLevel(nVars+1, 0);
+    std::vector<int> groupMax(groupVars.size(), -1);
+    int oldLevel = -1;
+    TQuantifier oldQ = EXISTS;
+    for (int l=0; l<nLevels; l++) {
+      if (byLevel[l].empty()) continue;
+      TQuantifier q = quant[byLevel[l][0]];
+      if (oldLevel < 0) oldLevel = (q == EXISTS) ? 0 : 1;
+      else if (q != oldQ) oldLevel++;
+      oldQ = q;
+      for (std::vector<int>::size_type i=0; i<byLevel[l].size(); i++) {
+        int v = byLevel[l][i];
+        int m = -1;
+        for (std::vector<int>::size_type k=0; k<deps[v].size(); k++) {
+          int g = deps[v][k];
+          // The variables of a group are outer, their level is known
+          if (groupMax[g] < 0)
+            for (std::vector<int>::size_type j=0; j<groupVars[g].size(); j++)
+              groupMax[g] = std::max(groupMax[g], newLevel[groupVars[g][j]]);
+          m = std::max(m, groupMax[g]);
+        }
+        newLevel[v] = (m < 0) ? ((quant[v] == EXISTS) ? 0 : 1) : m + 1;
+        if (l == 0) continue;
+        if (m < 0) st.independent++;
+        if (newLevel[v] < oldLevel) st.moved++;
+      }
+    }
+
+    // Replace the prefix of the reader, the order of the variables in a
+    // block follows the old prefix
+    std::vector< std::vector<int> > byNewLevel;
+    for (int l=1; l<nLevels; l++)
+      for (std::vector<int>::size_type i=0; i<byLevel[l].size(); i++) {
+        int v = byLevel[l][i];
+        if (newLevel[v] >= static_cast<int>(byNewLevel.size())) byNewLevel.resize(newLevel[v]+1);
+        byNewLevel[newLevel[v]].push_back(v);
+      }
+    r.prefix.clear();
+    r.blockVars.clear();
+    for (std::vector< std::vector<int> >::size_type nl=0; nl<byNewLevel.size(); nl++) {
+      if (byNewLevel[nl].empty()) continue;
+      TQuantifier q = ((nl % 2) == 0) ? EXISTS : FORALL;
+      if (r.prefix.empty() || (r.prefix.back().q != q)) {
+        QDimacsReader::Block bl;
+        bl.q = q;
+        bl.first = static_cast<int>(r.blockVars.size());
+        bl.size = 0;
+        r.prefix.push_back(bl);
+      }
+      r.blockVars.insert(r.blockVars.end(), byNewLevel[nl].begin(), byNewLevel[nl].end());
+      r.prefix.back().size += static_cast<int>(byNewLevel[nl].size());
+    }
+    st.blocksOut = r.prefix.size();
+    st.time = t.stop();
+    return st.moved;
+  }
+
+}
+
+// STATISTICS: int-post
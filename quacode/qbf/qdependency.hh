@@ -0,0 +1,167 @@
+/* -*- mode: C++; c-basic-offset: 2; indent-tabs-mode: nil -*- */
+/*
+ *  Main authors:
+ *     Vincent Barichard <Vincent.Barichard@univ-angers.fr>
+ *
+ *  Copyright:
+ *     Vincent Barichard, 2014
+ *
+ *  Last modified:
+ *     $Date$ by $Author$
+ *     $Revision$
+ *
+ *  This file is part of Quacode:
+ *     http://quacode.barichard.com
+ *
+ *  Permission is hereby granted, free of charge, to any person obtaining
+ *  a copy of this software and associated documentation files (the
+ *  "Software"), to deal in the Software without restriction, including
+ *  without limitation the rights to use, copy, modify, merge, publish,
+ *  distribute, sublicense, and/or sell copies of the Software, and to
+ *  permit persons to whom the Software is furnished to do so, subject to
+ *  the following conditions:
+ *
+ *  The above copyright notice and this permission notice shall be
+ *  included in all copies or substantial portions of the Software.
+ *
+ *  THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND,
+ *  EXPRESS OR IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF
+ *  MERCHANTABILITY, FITNESS FOR A PARTICULAR PURPOSE AND
+ *  NONINFRINGEMENT. IN NO EVENT SHALL THE AUTHORS OR COPYRIGHT HOLDERS BE
+ *  LIABLE FOR ANY CLAIM, DAMAGES OR OTHER LIABILITY, WHETHER IN AN ACTION
+ *  OF CONTRACT, TORT OR OTHERWISE, ARISING FROM, OUT OF OR IN CONNECTION
+ *  WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE SOFTWARE.
+ *
+ */
+
+#ifndef __GECODE_QBF_QDEPENDENCY_HH__
+#define __GECODE_QBF_QDEPENDENCY_HH__
+
+#include <quacode/qbf/qdimacs.hh>
+#include <iostream>
+#include <vector>
+
+namespace Gecode {
+
+  /// Statistics of the relaxation of the prefix
+  class QBFDependencyStatistics {
+  public:
+    unsigned long int blocksIn;    ///< Number of blocks of the prefix before relaxation
+    unsigned long int blocksOut;   ///< Number of blocks of the prefix after relaxation
+    unsigned long int groups;      ///< Number of dependency groups computed
+    unsigned long int independent; ///< Number of quantified variables without dependency
+    unsigned long int moved;       ///< Number of variables moved to an outer block
+    double time;                   ///< Time of the analysis (in ms)
+    /// Constructor
+    QBFDependencyStatistics(void);
+    /// Print statistics
+    QUACODE_EXPORT void print(std::ostream& os) const;
+  };
+
+  /**
+   * \brief Relaxation of the prefix of QBF problems with the standard dependency scheme
+   *
+   * The linear prefix of a QBF in prenex CNF orders all the variables, but
+   * a variable \f$y\f$ only depends on an outer variable \f$x\f$ of the other
+   * quantifier if they are connected in the matrix: there is a sequence of
+   * clauses from a clause of \f$x\f$ to a clause of \f$y\f$ in which two
+   * consecutive clauses share an existential variable inner than \f$x\f$
+   * (the standard dependency scheme of Samer and Szeider).
+   *
+   * The variables are then moved to the outermost block allowed by their
+   * dependencies: a variable without dependency goes to the first block of
+   * its quantifier, any other one goes just below the innermost block of its
+   * dependencies. The new prefix respects the dependencies, so the problem
+   * has the same truth value, and it has no more blocks than the original
+   * one. As the blocks get larger, the branchers are free to pick their
+   * variables in more orders (see QSpaceInfo::activityOrder).
+   *
+   * The dependencies are computed level by level, from the innermost one,
+   * with a union-find of the clauses linked by the inner existential
+   * variables. The clauses of a level linked together form a dependency
+   * group: the variables of the level in the group are dependencies of the
+   * inner variables of the other quantifier in the group. The inner
+   * variables of each quantifier are kept in lists attached to the
+   * representative clauses and merged by the union-find, so a level only
+   * visits the inner variables of its own groups.
+   *
+   * Only the prefix of the reader is changed (the numbering of the variables
+   * and the clauses are kept), it can be used after QBFPreprocessor.
+   */
+  class QBFDependencies {
+  protected:
+    /// Number of variables
+    int nVars;
+    /// Level of the variables in the prefix (0 for free variables)
+    std::vector<int> level;
+    /// Quantifier of the variables
+    std::vector<TQuantifier> quant;
+    /// Clauses of each variable
+    std::vector< std::vector<int> > occ;
+    /// Parent of each clause in the union-find
+    std::vector<int> parent;
+    /// Dependency group of each representative clause for the current level (-1 if none)
+    std::vector<int> rootGroup;
+    /// Inner existential (0) and universal (1) variables of each representative clause
+    std::vector< std::vector<int> > inner[2];
+    /// Last dependency group given to each variable (-1 if none)
+    std::vector<int> lastGroup;
+    /// Variables of each dependency group
+    std::vector< std::vector<int> > groupVars;
+    /// Dependency groups of each variable
+    std::vector< std::vector<int> > deps;
+    /// Statistics
+    QBFDependencyStatistics st;
+
+    /// Return the representative of clause \a c
+    int find(int c);
+    /// Link the clauses \a c and \a d, merging their inner variables
+    void unite(int c, int d);
+    /// Add the variable \a v to the inner variables of the representatives of its clauses
+    void inward(int v);
+    /// Compute the dependency groups of the variables of level \a l
+    void groups(int l, const std::vector< std::vector<int> >& byLevel);
+  public:
+    /// Constructor
+    QUACODE_EXPORT QBFDependencies(void);
+    /// Relax the prefix of \a r, return the number of variables moved to an outer block
+    QUACODE_EXPORT unsigned long int relax(QDimacsReader& r);
+    /// Return the statistics of the last relaxation
+    const QBFDependencyStatistics& statistics(void) const;
+  };
+
+  forceinline
+  QBFDependencyStatistics::QBFDependencyStatistics(void)
+    : blocksIn(0), blocksOut(0), groups(0), independent(0), moved(0), time(0) {}
+
+  forceinline int
+  QBFDependencies::find(int c) {
+    while (parent[c] != c) {
+      parent[c] = parent[parent[c]];
+      c = parent[c];
+    }
+    return c;
+  }
+
+  forceinline void
+  QBFDependencies::unite(int c, int d) {
+    c = find(c);
+    d = find(d);
+    if (c == d) return;
+    parent[c] = d;
+    for (int s=0; s<2; s++) {
+      // The shortest list is appended to the longest one
+      if (inner[s][c].size() > inner[s][d].size()) inner[s][c].swap(inner[s][d]);
+      inner[s][d].insert(inner[s][d].end(), inner[s][c].begin(), inner[s][c].end());
+      std::vector<int>().swap(inner[s][c]);
+    }
+  }
+
+  forceinline const QBFDependencyStatistics&
+  QBFDependencies::statistics(void) const {
+    return st;
+  }
+
+}
+
+#endif
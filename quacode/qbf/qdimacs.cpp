@@ -0,0 +1,274 @@
+/* -*- mode: C++; c-basic-offset: 2; indent-tabs-mode: nil -*- */
+/*
+ *  Main authors:
+ *     Vincent Barichard <Vincent.Barichard@univ-angers.fr>
+ *
+ *  Copyright:
+ *     Vincent Barichard, 2014
+ *
+ *  Last modified:
+ *     $Date$ by $Author$
+ *     $Revision$
+ *
+ *  This file is part of Quacode:
+ *     http://quacode.barichard.com
+ *
+ *  Permission is hereby granted, free of charge, to any person obtaining
+ *  a copy of this software and associated documentation files (the
+ *  "Software"), to deal in the Software without restriction, including
+ *  without limitation the rights to use, copy, modify, merge, publish,
+ *  distribute, sublicense, and/or sell copies of the Software, and to
+ *  permit persons to whom the Software is furnished to do so, subject to
+ *  the following conditions:
+ *
+ *  The above copyright notice and this permission notice shall be
+ *  included in all copies or substantial portions of the Software.
+ *
+ *  THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND,
+ *  EXPRESS OR IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF
+ *  MERCHANTABILITY, FITNESS FOR A PARTICULAR PURPOSE AND
+ *  NONINFRINGEMENT. IN NO EVENT SHALL THE AUTHORS OR COPYRIGHT HOLDERS BE
+ *  LIABLE FOR ANY CLAIM, DAMAGES OR OTHER LIABILITY, WHETHER IN AN ACTION
+ *  OF CONTRACT, TORT OR OTHERWISE, ARISING FROM, OUT OF OR IN CONNECTION
+ *  WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE SOFTWARE.
+ *
+ */
+
+#include <quacode/qbf/qdimacs.hh>
+#include <quacode/support/mapped-file.hh>
+#include <climits>
+
+namespace Gecode {
+
+  QDimacsError::QDimacsError(const char* l, const char* i)
+    : Exception(l,i) {}
+
+  namespace {
+    /// Tokenizer reading a buffer in place
+    class Tokenizer {
+    private:
+      /// Current position
+      const char* p;
+      /// End of the buffer
+      const char* e;
+      /// Current line
+      unsigned int& l;
+    public:
+      /// Initialize with the \a n characters of \a b, lines are counted in \a l0
+      Tokenizer(const char* b, std::size_t n, unsigned int& l0) : p(b), e(b+n), l(l0) {}
+      /// Return true if \a c is a blank character
+      static bool blank(char c) {
+        return (c == ' ') || (c == '\t') || (c == '\r') || (c == '\n');
+      }
+      /// Skip blank characters, return false at the end of the buffer
+      bool skip(void) {
+        while ((p < e) && blank(*p)) {
+          if (*p == '\n') l++;
+          p++;
+        }
+        return p < e;
+      }
+      /// Skip the end of the current line
+      void skipLine(void) {
+        while ((p < e) && (*p != '\n')) p++;
+      }
+      /// Return the current character
+      char peek(void) const {
+        return *p;
+      }
+      /// Go to the next character, return false if it is not followed by a blank
+      bool next(void) {
+        p++;
+        return (p == e) || blank(*p);
+      }
+      /// Skip blanks and read the word \a w
+      bool word(const char* w) {
+        if (!skip()) return false;
+        for (; *w; w++, p++)
+          if ((p == e) || (*p != *w)) return false;
+        return (p == e) || blank(*p);
+      }
+      /// Skip blanks and read integer \a v
+      bool integer(int& v) {
+        if (!skip()) return false;
+        bool neg = (*p == '-');
+        if (neg) p++;
+        if ((p == e) || (*p < '0') || (*p > '9')) return false;
+        long long r = 0;
+        for (; (p < e) && (*p >= '0') && (*p <= '9'); p++) {
+          r = 10 * r + (*p - '0');
+          if (r > INT_MAX) return false;
+        }
+        if ((p < e) && !blank(*p)) return false;
+        v = static_cast<int>(neg ? -r : r);
+        return true;
+      }
+    };
+  }
+
+  QDimacsReader::QDimacsReader(void) : nVars(0), nClauses(0), _line(0) {}
+
+  void QDimacsReader::parse(const char* f) {
+    Support::MappedFile mf;
+    if (!mf.open(f)) throw QDimacsError("QDimacsReader::parse","Cannot read file");
+    parse(mf.data(), mf.size());
+  }
+
+  void QDimacsReader::parse(const char* b, std::size_t n) {
+    nVars = 0;
+    nClauses = 0;
+    lits.clear();
+    start.assign(1,0);
+    prefix.clear();
+    blockVars.clear();
+    _line = 1;
+
+    bool header = false;
+    // Flags of the variables already quantified
+    std::vector<char> quantified;
+    Tokenizer t(b, n, _line);
+    while (t.skip()) {
+      char c = t.peek();
+      if (c == 'c') {
+        // Comments (ignore them)
+        t.skipLine();
+      } else if (c == 'p') {
+        // Line has format "p cnf <variables> <clauses>"
+        if (header || !t.next() || !t.word("cnf") ||
+            !t.integer(nVars) || !t.integer(nClauses) || (nVars < 0) || (nClauses < 0))
+          throw QDimacsError("QDimacsReader::parse","Wrong problem line");
+        header = true;
+        quantified.resize(nVars+1,0);
+        start.reserve(nClauses+1);
+        // Rough estimation of the number of literals from the size of the buffer
+        lits.reserve(n / 4);
+      } else if ((c == 'a') || (c == 'e') || (c == 'r')) {
+        // Line has format "a <variables> 0" or "e <variables> 0"
+        if (!header || (start.size() > 1))
+          throw QDimacsError("QDimacsReader::parse","Quantifier line out of the prefix");
+        if (c == 'r')
+          throw QDimacsError("QDimacsReader::parse","Quantifier r not supported");
+        if (!t.next())
+          throw QDimacsError("QDimacsReader::parse","Wrong quantifier line");
+        TQuantifier q = (c == 'e') ? EXISTS : FORALL;
+        if (prefix.empty() || (prefix.back().q != q)) {
+          Block bl;
+          bl.q = q;
+          bl.first = static_cast<int>(blockVars.size());
+          bl.size = 0;
+          prefix.push_back(bl);
+        }
+        int v;
+        while (true) {
+          if (!t.integer(v) || (v < 0) || (v > nVars))
+            throw QDimacsError("QDimacsReader::parse","Wrong variable in quantifier line");
+          if (v == 0) break;
+          if (quantified[v])
+            throw QDimacsError("QDimacsReader::parse","Variable quantified twice");
+          quantified[v] = 1;
+          blockVars.push_back(v);
+          prefix.back().size++;
+        }
+      } else if ((c == '-') || ((c >= '0') && (c <= '9'))) {
+        // Clause terminated by 0, it may span several lines
+        if (!header)
+          throw QDimacsError("QDimacsReader::parse","Clause before problem line");
+        int l;
+        while (true) {
+          if (!t.skip())
+            throw QDimacsError("QDimacsReader::parse","Clause not terminated by 0");
+          if (!t.integer(l) || (l < -nVars) || (l > nVars))
+            throw QDimacsError("QDimacsReader::parse","Wrong literal");
+          if (l == 0) break;
+          lits.push_back(l);
+        }
+        start.push_back(static_cast<int>(lits.size()));
+      } else {
+        throw QDimacsError("QDimacsReader::parse","Unexpected character");
+      }
+    }
+    if (!header)
+      throw QDimacsError("QDimacsReader::parse","Missing problem line");
+    if (clauses() != nClauses)
+      throw QDimacsError("QDimacsReader::parse","Wrong number of clauses");
+  }
+
+  void QDimacsReader::post(Home home, QSpaceInfo& qsi, BoolVarArray& x,
+                           std::vector<BoolVarArray>& b, bool qc) const {
+    x = BoolVarArray(home, nVars, 0, 1);
+    b.clear();
+
+    // Rank and quantifier of each variable, free variables are
+    // existential and outermost
+    std::vector<int> rk(nVars, 0);
+    std::vector<TQuantifier> quant(nVars, EXISTS);
+    std::vector<char> quantified(nVars, 0);
+    for (std::vector<int>::size_type i=0; i<blockVars.size(); i++)
+      quantified[blockVars[i]-1] = 1;
+    // Variables which appear nowhere are left aside
+    std::vector<char> used(nVars, 0);
+    for (std::vector<int>::size_type i=0; i<lits.size(); i++)
+      used[((lits[i] > 0) ? lits[i] : -lits[i]) - 1] = 1;
+    BoolVarArgs freeVars;
+    for (int i=0; i<nVars; i++)
+      if (!quantified[i] && used[i]) freeVars << x[i];
+    if (freeVars.size() > 0) b.push_back(BoolVarArray(home, freeVars));
+
+    for (std::vector<Block>::size_type i=0; i<prefix.size(); i++) {
+      const Block& bl = prefix[i];
+      int r = static_cast<int>(b.size());
+      BoolVarArgs vars(bl.size);
+      for (int j=0; j<bl.size; j++) {
+        int v = blockVars[bl.first + j] - 1;
+        vars[j] = x[v];
+        rk[v] = r;
+        quant[v] = bl.q;
+      }
+      if (bl.q == FORALL) qsi.setForAll(home, vars);
+      b.push_back(BoolVarArray(home, vars));
+    }
+
+    // Post clauses, short arrays of arguments are allocated on the stack
+    for (int c=0; c<clauses(); c++) {
+      int n;
+      const int* l = clause(c, n);
+      if (n == 0) {
+        static_cast<Space&>(home).fail();
+        return;
+      }
+      int nPos = 0;
+      for (int i=n; i--; )
+        if (l[i] > 0) nPos++;
+      if (qc) {
+        QBoolVarArgs pos(nPos), neg(n - nPos);
+        for (int i=0, ip=0, in=0; i<n; i++) {
+          int v = ((l[i] > 0) ? l[i] : -l[i]) - 1;
+          QBoolVar qx(quant[v], x[v], rk[v]);
+          if (l[i] > 0) pos[ip++] = qx; else neg[in++] = qx;
+        }
+        qclause(home, BOT_OR, pos, neg, 1);
+      } else {
+        BoolVarArgs pos(nPos), neg(n - nPos);
+        for (int i=0, ip=0, in=0; i<n; i++) {
+          if (l[i] > 0) pos[ip++] = x[l[i]-1]; else neg[in++] = x[-l[i]-1];
+        }
+        Gecode::clause(home, BOT_OR, pos, neg, 1);
+      }
+      if (home.failed()) return;
+    }
+  }
+
+  void QDimacsReader::link(QSpaceInfo& qsi, const BoolVarArray& x) const {
+    for (int c=0; c<clauses(); c++) {
+      int n;
+      const int* l = clause(c, n);
+      BoolVarArgs vars(n);
+      for (int i=0; i<n; i++)
+        vars[i] = x[((l[i] > 0) ? l[i] : -l[i]) - 1];
+      qsi.link(vars);
+    }
+  }
+
+}
+
+// STATISTICS: int-post
@@ -0,0 +1,161 @@
+/* -*- mode: C++; c-basic-offset: 2; indent-tabs-mode: nil -*- */
+/*
+ *  Main authors:
+ *     Vincent Barichard <Vincent.Barichard@univ-angers.fr>
+ *
+ *  Copyright:
+ *     Vincent Barichard, 2014
+ *
+ *  Last modified:
+ *     $Date$ by $Author$
+ *     $Revision$
+ *
+ *  This file is part of Quacode:
+ *     http://quacode.barichard.com
+ *
+ *  Permission is hereby granted, free of charge, to any person obtaining
+ *  a copy of this software and associated documentation files (the
+ *  "Software"), to deal in the Software without restriction, including
+ *  without limitation the rights to use, copy, modify, merge, publish,
+ *  distribute, sublicense, and/or sell copies of the Software, and to
+ *  permit persons to whom the Software is furnished to do so, subject to
+ *  the following conditions:
+ *
+ *  The above copyright notice and this permission notice shall be
+ *  included in all copies or substantial portions of the Software.
+ *
+ *  THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND,
+ *  EXPRESS OR IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF
+ *  MERCHANTABILITY, FITNESS FOR A PARTICULAR PURPOSE AND
+ *  NONINFRINGEMENT. IN NO EVENT SHALL THE AUTHORS OR COPYRIGHT HOLDERS BE
+ *  LIABLE FOR ANY CLAIM, DAMAGES OR OTHER LIABILITY, WHETHER IN AN ACTION
+ *  OF CONTRACT, TORT OR OTHERWISE, ARISING FROM, OUT OF OR IN CONNECTION
+ *  WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE SOFTWARE.
+ *
+ */
+
+#ifndef __GECODE_QBF_QDIMACS_HH__
+#define __GECODE_QBF_QDIMACS_HH__
+
+#include <quacode/qspaceinfo.hh>
+#include <cstddef>
+#include <vector>
+
+namespace Gecode {
+
+  /// %Exception: format error while reading a QDIMACS problem
+  class QUACODE_EXPORT QDimacsError : public Exception {
+  public:
+    /// Initialize with location \a l and information \a i
+    QDimacsError(const char* l, const char* i);
+  };
+
+  /**
+   * \brief Reader of QBF problems in QDIMACS format
+   *
+   * The file is mapped in memory (when the system allows it) and read
+   * without copy: tokens are parsed in place, and clauses are stored in a
+   * single flat array of literals. A problem can also be read from a buffer
+   * in memory. Once read, the problem is posted with post().
+   *
+   * Format errors are reported by throwing QDimacsError, line() gives the
+   * line of the error.
+   */
+  class QDimacsReader {
+    friend class QBFPreprocessor;
+    friend class QBFDependencies;
+  public:
+    /// Block of variables with the same quantifier in the prefix
+    struct Block {
+      TQuantifier q; ///< Quantifier of the block
+      int first;     ///< Position of the first variable of the block in blockVars
+      int size;      ///< Number of variables of the block
+    };
+  protected:
+    /// Number of variables given in the header
+    int nVars;
+    /// Number of clauses given in the header
+    int nClauses;
+    /// Literals of all clauses, clause i is made of lits[start[i]] ... lits[start[i+1]-1]
+    std::vector<int> lits;
+    /// Position of the first literal of each clause (and of the end of the last clause)
+    std::vector<int> start;
+    /// Blocks of the prefix (outermost first)
+    std::vector<Block> prefix;
+    /// Variables (starting from 1) of the blocks of the prefix
+    std::vector<int> blockVars;
+    /// Current line of the parser
+    unsigned int _line;
+  public:
+    /// Constructor
+    QUACODE_EXPORT QDimacsReader(void);
+    /// Read the problem of the QDIMACS file \a f
+    QUACODE_EXPORT void parse(const char* f);
+    /// Read the problem given by the \a n characters of buffer \a b
+    QUACODE_EXPORT void parse(const char* b, std::size_t n);
+
+    /// Return the number of variables
+    int variables(void) const;
+    /// Return the number of clauses
+    int clauses(void) const;
+    /// Return the literals of clause \a i (variables start from 1, negative
+    /// literals are negated), its size is stored in \a n
+    const int* clause(int i, int& n) const;
+    /// Return the blocks of the prefix
+    const std::vector<Block>& blocks(void) const;
+    /// Return the variable at position \a i of the blocks of the prefix
+    int blockVar(int i) const;
+    /// Return the line reached by the parser (line of the error if any)
+    unsigned int line(void) const;
+
+    /**
+     * \brief Post the problem in \a home
+     *
+     * The Boolean variables are created in \a x (variable i of the problem is
+     * x[i-1]) and the variables of each block of the prefix are stored in
+     * \a blocks. Variables of the clauses which do not appear in the prefix
+     * are gathered in an outermost existential block. Universal variables are declared to
+     * \a qsi. Clauses are posted with qclause if \a qc is true, with clause
+     * otherwise.
+     */
+    QUACODE_EXPORT void post(Home home, QSpaceInfo& qsi, BoolVarArray& x,
+                             std::vector<BoolVarArray>& blocks, bool qc) const;
+    /// Declare the clauses posted on \a x to \a qsi for the component
+    /// decomposition (see QSpaceInfo::link), once the blocks are branched
+    QUACODE_EXPORT void link(QSpaceInfo& qsi, const BoolVarArray& x) const;
+  };
+
+  forceinline int
+  QDimacsReader::variables(void) const {
+    return nVars;
+  }
+
+  forceinline int
+  QDimacsReader::clauses(void) const {
+    return static_cast<int>(start.size()) - 1;
+  }
+
+  forceinline const int*
+  QDimacsReader::clause(int i, int& n) const {
+    n = start[i+1] - start[i];
+    return lits.data() + start[i];
+  }
+
+  forceinline const std::vector<QDimacsReader::Block>&
+  QDimacsReader::blocks(void) const {
+    return prefix;
+  }
+
+  forceinline int
+  QDimacsReader::blockVar(int i) const {
+    return blockVars[i];
+  }
+
+  forceinline unsigned int
+  QDimacsReader::line(void) const {
+    return _line;
+  }
+
+}
+
+#endif
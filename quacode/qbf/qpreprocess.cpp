@@ -0,0 +1,397 @@
+/* -*- mode: C++; c-basic-offset: 2; indent-tabs-mode: nil -*- */
+/*
+ *  Main authors:
+ *     Vincent Barichard <Vincent.Barichard@univ-angers.fr>
+ *
+ *  Copyright:
+ *     Vincent Barichard, 2014
+ *
+ *  Last modified:
+ *     $Date$ by $Author$
+ *     $Revision$
+ *
+ *  This file is part of Quacode:
+ *     http://quacode.barichard.com
+ *
+ *  Permission is hereby granted, free of charge, to any person obtaining
+ *  a copy of this software and associated documentation files (the
+ *  "Software"), to deal in the Software without restriction, including
+ *  without limitation the rights to use, copy, modify, merge, publish,
+ *  distribute, sublicense, and/or sell copies of the Software, and to
+ *  permit persons to whom the Software is furnished to do so, subject to
+ *  the following conditions:
+ *
+ *  The above copyright notice and this permission notice shall be
+ *  included in all copies or substantial portions of the Software.
+ *
+ *  THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND,
+ *  EXPRESS OR IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF
+ *  MERCHANTABILITY, FITNESS FOR A PARTICULAR PURPOSE AND
+ *  NONINFRINGEMENT. IN NO EVENT SHALL THE AUTHORS OR COPYRIGHT HOLDERS BE
+ *  LIABLE FOR ANY CLAIM, DAMAGES OR OTHER LIABILITY, WHETHER IN AN ACTION
+ *  OF CONTRACT, TORT OR OTHERWISE, ARISING FROM, OUT OF OR IN CONNECTION
+ *  WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE SOFTWARE.
+ *
+ */
+
+#include <quacode/qbf/qpreprocess.hh>
+#include <algorithm>
+
+namespace Gecode {
+
+  void QBFPreprocessStatistics::print(std::ostream& os) const {
+    os << "Preprocessing:" << std::endl
+       << "\tvariables:          " << varsIn << " -> " << varsOut << std::endl
+       << "\tclauses:            " << clausesIn << " -> " << clausesOut << std::endl
+       << "\tuniversal literals: " << reduced << " reduced" << std::endl
+       << "\tunit literals:      " << units << std::endl
+       << "\tpure literals:      " << pures << std::endl
+       << "\tequivalences:       " << equivalences << std::endl
+       << "\tblocked clauses:    " << blocked << std::endl
+       << "\teliminated vars:    " << eliminated << std::endl
+       << "\ttime:               " << time << " ms" << std::endl;
+  }
+
+  namespace {
+    /// Remove one occurrence of \a x from \a v (order is not kept)
+    void erase(std::vector<int>& v, int x) {
+      std::vector<int>::iterator it = std::find(v.begin(), v.end(), x);
+      if (it != v.end()) {
+        *it = v.back();
+        v.pop_back();
+      }
+    }
+  }
+
+  QBFPreprocessor::QBFPreprocessor(void)
+    : nVars(0), conflict(false), maxResolvents(16), maxResolventSize(24) {}
+
+  bool QBFPreprocessor::normalize(std::vector<int>& c) {
+    // Sort literals by variable, remove duplicates and detect tautologies
+    std::sort(c.begin(), c.end(), [](int a, int b) {
+      return (var(a) < var(b)) || ((var(a) == var(b)) && (a < b));
+    });
+    c.erase(std::unique(c.begin(), c.end()), c.end());
+    for (std::vector<int>::size_type i=1; i<c.size(); i++)
+      if (c[i] == -c[i-1]) return false;
+    // Universal reduction: a universal literal is removed if no
+    // existential literal of the clause is inner
+    int maxE = -1;
+    for (std::vector<int>::size_type i=0; i<c.size(); i++)
+      if (quant[var(c[i])] == EXISTS) maxE = std::max(maxE, lev(c[i]));
+    std::vector<int>::size_type j = 0;
+    for (std::vector<int>::size_type i=0; i<c.size(); i++)
+      if ((quant[var(c[i])] == EXISTS) || (lev(c[i]) < maxE)) c[j++] = c[i];
+    st.reduced += c.size() - j;
+    c.resize(j);
+    return true;
+  }
+
+  void QBFPreprocessor::addClause(std::vector<int>& c) {
+    if (!normalize(c)) return;
+    if (c.empty()) {
+      conflict = true;
+      return;
+    }
+    int i = static_cast<int>(cls.size());
+    cls.push_back(c);
+    removed.push_back(0);
+    for (std::vector<int>::size_type k=0; k<c.size(); k++)
+      occ[idx(c[k])].push_back(i);
+    queue.push_back(i);
+  }
+
+  void QBFPreprocessor::removeClause(int i) {
+    removed[i] = 1;
+    for (std::vector<int>::size_type k=0; k<cls[i].size(); k++)
+      erase(occ[idx(cls[i][k])], i);
+    std::vector<int>().swap(cls[i]);
+  }
+
+  void QBFPreprocessor::removeLiteral(int i, int l) {
+    std::vector<int>& c = cls[i];
+    c.erase(std::find(c.begin(), c.end(), l));
+    erase(occ[idx(l)], i);
+    // The clause may now be reduced
+    int maxE = -1;
+    for (std::vector<int>::size_type k=0; k<c.size(); k++)
+      if (quant[var(c[k])] == EXISTS) maxE = std::max(maxE, lev(c[k]));
+    std::vector<int>::size_type j = 0;
+    for (std::vector<int>::size_type k=0; k<c.size(); k++)
+      if ((quant[var(c[k])] == EXISTS) || (lev(c[k]) < maxE)) {
+        c[j++] = c[k];
+      } else {
+        erase(occ[idx(c[k])], i);
+        st.reduced++;
+      }
+    c.resize(j);
+    if (c.empty()) conflict = true;
+    queue.push_back(i);
+  }
+
+  void QBFPreprocessor::assign(int l) {
+    gone[var(l)] = 1;
+    std::vector<int> sat(occ[idx(l)]);
+    for (std::vector<int>::size_type k=0; k<sat.size(); k++)
+      removeClause(sat[k]);
+    std::vector<int> unsat(occ[idx(-l)]);
+    for (std::vector<int>::size_type k=0; k<unsat.size(); k++)
+      removeLiteral(unsat[k], -l);
+  }
+
+  void QBFPreprocessor::substitute(int v, int l) {
+    gone[v] = 1;
+    std::vector<int> cs(occ[idx(v)]);
+    cs.insert(cs.end(), occ[idx(-v)].begin(), occ[idx(-v)].end());
+    for (std::vector<int>::size_type k=0; k<cs.size(); k++) {
+      std::vector<int> c(cls[cs[k]]);
+      for (std::vector<int>::size_type j=0; j<c.size(); j++)
+        if (c[j] == v) c[j] = l;
+        else if (c[j] == -v) c[j] = -l;
+      removeClause(cs[k]);
+      addClause(c);
+    }
+  }
+
+  bool QBFPreprocessor::isBlocked(int i, int l) {
+    const std::vector<int>& c = cls[i];
+    for (std::vector<int>::size_type k=0; k<c.size(); k++) mark[idx(c[k])] = 1;
+    bool blocked = true;
+    const std::vector<int>& o = occ[idx(-l)];
+    for (std::vector<int>::size_type k=0; blocked && (k<o.size()); k++) {
+      // The resolvent on l must be a tautology on a literal not inner than l
+      const std::vector<int>& d = cls[o[k]];
+      bool taut = false;
+      for (std::vector<int>::size_type j=0; !taut && (j<d.size()); j++)
+        taut = (d[j] != -l) && mark[idx(-d[j])] && (lev(d[j]) <= lev(l));
+      blocked = taut;
+    }
+    for (std::vector<int>::size_type k=0; k<c.size(); k++) mark[idx(c[k])] = 0;
+    return blocked;
+  }
+
+  bool QBFPreprocessor::eliminate(int v) {
+    const std::vector<int>& p = occ[idx(v)];
+    const std::vector<int>& n = occ[idx(-v)];
+    if (p.size() * n.size() > maxResolvents) return false;
+    // Elimination is only done if it doesn't increase the number of clauses
+    std::vector< std::vector<int> > res;
+    bool ok = true;
+    for (std::vector<int>::size_type i=0; ok && (i<p.size()); i++) {
+      const std::vector<int>& c = cls[p[i]];
+      for (std::vector<int>::size_type k=0; k<c.size(); k++) mark[idx(c[k])] = 1;
+      for (std::vector<int>::size_type j=0; ok && (j<n.size()); j++) {
+        const std::vector<int>& d = cls[n[j]];
+        std::vector<int> r;
+        bool taut = false;
+        for (std::vector<int>::size_type k=0; !taut && (k<d.size()); k++) {
+          if (d[k] == -v) continue;
+          if (mark[idx(-d[k])]) taut = true;
+          else if (!mark[idx(d[k])]) r.push_back(d[k]);
+        }
+        if (taut) continue;
+        for (std::vector<int>::size_type k=0; k<c.size(); k++)
+          if (c[k] != v) r.push_back(c[k]);
+        res.push_back(r);
+        ok = (r.size() <= maxResolventSize) && (res.size() <= p.size() + n.size());
+      }
+      for (std::vector<int>::size_type k=0; k<c.size(); k++) mark[idx(c[k])] = 0;
+    }
+    if (!ok) return false;
+    std::vector<int> cs(p);
+    cs.insert(cs.end(), n.begin(), n.end());
+    for (std::vector<int>::size_type k=0; k<cs.size(); k++)
+      removeClause(cs[k]);
+    for (std::vector< std::vector<int> >::size_type k=0; k<res.size(); k++)
+      addClause(res[k]);
+    gone[v] = 1;
+    return true;
+  }
+
+  void QBFPreprocessor::units(void) {
+    while (!conflict && !queue.empty()) {
+      int i = queue.back();
+      queue.pop_back();
+      // After universal reduction a unit clause is existential
+      if (!removed[i] && (cls[i].size() == 1)) {
+        st.units++;
+        assign(cls[i][0]);
+      }
+    }
+  }
+
+  bool QBFPreprocessor::pures(void) {
+    bool found = false;
+    for (int v=1; !conflict && (v<=nVars); v++) {
+      if (gone[v]) continue;
+      bool p = !occ[idx(v)].empty();
+      bool n = !occ[idx(-v)].empty();
+      if (p == n) continue;
+      // A pure existential literal is set to true, a pure universal literal to false
+      int l = p ? v : -v;
+      assign((quant[v] == EXISTS) ? l : -l);
+      st.pures++;
+      found = true;
+      units();
+    }
+    return found;
+  }
+
+  bool QBFPreprocessor::equivalences(void) {
+    bool found = false;
+    for (std::vector< std::vector<int> >::size_type i=0; !conflict && (i<cls.size()); i++) {
+      if (removed[i] || (cls[i].size() != 2)) continue;
+      int a = cls[i][0];
+      int b = cls[i][1];
+      // Look for clause (-a | -b), then a = -b
+      bool eq = false;
+      const std::vector<int>& o = occ[idx(-a)];
+      for (std::vector<int>::size_type k=0; !eq && (k<o.size()); k++) {
+        const std::vector<int>& d = cls[o[k]];
+        eq = (d.size() == 2) && ((d[0] == -b) || (d[1] == -b));
+      }
+      if (!eq) continue;
+      // The inner variable is substituted, it must be existential
+      bool subA = lev(a) > lev(b);
+      int v = subA ? var(a) : var(b);
+      if (quant[v] == FORALL) {
+        conflict = true;
+        break;
+      }
+      if (subA) substitute(v, (a > 0) ? -b : b);
+      else substitute(v, (b > 0) ? -a : a);
+      st.equivalences++;
+      found = true;
+      units();
+    }
+    return found;
+  }
+
+  bool QBFPreprocessor::blockedClauses(void) {
+    bool found = false;
+    for (std::vector< std::vector<int> >::size_type i=0; i<cls.size(); i++) {
+      if (removed[i]) continue;
+      for (std::vector<int>::size_type k=0; k<cls[i].size(); k++) {
+        int l = cls[i][k];
+        if ((quant[var(l)] == EXISTS) && (occ[idx(-l)].size() <= 64) &&
+            isBlocked(static_cast<int>(i), l)) {
+          removeClause(static_cast<int>(i));
+          st.blocked++;
+          found = true;
+          break;
+        }
+      }
+    }
+    return found;
+  }
+
+  bool QBFPreprocessor::eliminations(void) {
+    // Only variables of the innermost block can be eliminated, if it is existential
+    int inner = -1;
+    TQuantifier q = EXISTS;
+    for (int v=1; v<=nVars; v++)
+      if (!gone[v] && (level[v] > inner) && (!occ[idx(v)].empty() || !occ[idx(-v)].empty())) {
+        inner = level[v];
+        q = quant[v];
+      }
+    if ((inner < 0) || (q != EXISTS)) return false;
+    bool found = false;
+    for (int v=1; !conflict && (v<=nVars); v++) {
+      if (gone[v] || (level[v] != inner) || (quant[v] != EXISTS)) continue;
+      if (eliminate(v)) {
+        st.eliminated++;
+        found = true;
+        units();
+      }
+    }
+    return found;
+  }
+
+  bool QBFPreprocessor::run(QDimacsReader& r) {
+    Support::Timer t;
+    t.start();
+    st = QBFPreprocessStatistics();
+    nVars = r.nVars;
+    conflict = false;
+    level.assign(nVars+1, 0);
+    quant.assign(nVars+1, EXISTS);
+    gone.assign(nVars+1, 0);
+    occ.assign(2*nVars+2, std::vector<int>());
+    mark.assign(2*nVars+2, 0);
+    cls.clear();
+    removed.clear();
+    queue.clear();
+
+    // Free variables are at level 0, blocks of the prefix start at level 1
+    for (std::vector<QDimacsReader::Block>::size_type b=0; b<r.prefix.size(); b++)
+      for (int k=0; k<r.prefix[b].size; k++) {
+        int v = r.blockVars[r.prefix[b].first + k];
+        level[v] = static_cast<int>(b) + 1;
+        quant[v] = r.prefix[b].q;
+      }
+
+    st.clausesIn = r.clauses();
+    for (int i=0; !conflict && (i<r.clauses()); i++) {
+      int n;
+      const int* l = r.clause(i, n);
+      std::vector<int> c(l, l+n);
+      addClause(c);
+    }
+    for (int v=1; v<=nVars; v++)
+      if (!occ[idx(v)].empty() || !occ[idx(-v)].empty()) st.varsIn++;
+
+    units();
+    while (!conflict) {
+      bool changed = pures();
+      if (!conflict && equivalences()) changed = true;
+      if (!conflict && blockedClauses()) changed = true;
+      if (!conflict && eliminations()) changed = true;
+      if (!changed) break;
+    }
+
+    // Replace the problem of the reader
+    r.lits.clear();
+    r.start.assign(1, 0);
+    r.prefix.clear();
+    r.blockVars.clear();
+    if (conflict) {
+      // The empty clause
+      r.start.push_back(0);
+    } else {
+      for (std::vector< std::vector<int> >::size_type i=0; i<cls.size(); i++) {
+        if (removed[i]) continue;
+        r.lits.insert(r.lits.end(), cls[i].begin(), cls[i].end());
+        r.start.push_back(static_cast<int>(r.lits.size()));
+      }
+      // The simplified prefix is made of the variables still in the clauses
+      int nLevels = 1;
+      for (int v=1; v<=nVars; v++) nLevels = std::max(nLevels, level[v]+1);
+      std::vector< std::vector<int> > byLevel(nLevels);
+      for (int v=1; v<=nVars; v++)
+        if (!occ[idx(v)].empty() || !occ[idx(-v)].empty()) {
+          byLevel[level[v]].push_back(v);
+          st.varsOut++;
+        }
+      for (int lv=0; lv<nLevels; lv++) {
+        if (byLevel[lv].empty()) continue;
+        TQuantifier q = quant[byLevel[lv][0]];
+        if (r.prefix.empty() || (r.prefix.back().q != q)) {
+          QDimacsReader::Block bl;
+          bl.q = q;
+          bl.first = static_cast<int>(r.blockVars.size());
+          bl.size = 0;
+          r.prefix.push_back(bl);
+        }
+        r.blockVars.insert(r.blockVars.end(), byLevel[lv].begin(), byLevel[lv].end());
+        r.prefix.back().size += static_cast<int>(byLevel[lv].size());
+      }
+    }
+    r.nClauses = r.clauses();
+    st.clausesOut = r.clauses();
+    st.time = t.stop();
+    return !conflict;
+  }
+
+}
+
+// STATISTICS: int-post
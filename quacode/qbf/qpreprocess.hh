@@ -0,0 +1,189 @@
+/* -*- mode: C++; c-basic-offset: 2; indent-tabs-mode: nil -*- */
+/*
+ *  Main authors:
+ *     Vincent Barichard <Vincent.Barichard@univ-angers.fr>
+ *
+ *  Copyright:
+ *     Vincent Barichard, 2014
+ *
+ *  Last modified:
+ *     $Date$ by $Author$
+ *     $Revision$
+ *
+ *  This file is part of Quacode:
+ *     http://quacode.barichard.com
+ *
+ *  Permission is hereby granted, free of charge, to any person obtaining
+ *  a copy of this software and associated documentation files (the
+ *  "Software"), to deal in the Software without restriction, including
+ *  without limitation the rights to use, copy, modify, merge, publish,
+ *  distribute, sublicense, and/or sell copies of the Software, and to
+ *  permit persons to whom the Software is furnished to do so, subject to
+ *  the following conditions:
+ *
+ *  The above copyright notice and this permission notice shall be
+ *  included in all copies or substantial portions of the Software.
+ *
+ *  THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND,
+ *  EXPRESS OR IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF
+ *  MERCHANTABILITY, FITNESS FOR A PARTICULAR PURPOSE AND
+ *  NONINFRINGEMENT. IN NO EVENT SHALL THE AUTHORS OR COPYRIGHT HOLDERS BE
+ *  LIABLE FOR ANY CLAIM, DAMAGES OR OTHER LIABILITY, WHETHER IN AN ACTION
+ *  OF CONTRACT, TORT OR OTHERWISE, ARISING FROM, OUT OF OR IN CONNECTION
+ *  WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE SOFTWARE.
+ *
+ */
+
+#ifndef __GECODE_QBF_QPREPROCESS_HH__
+#define __GECODE_QBF_QPREPROCESS_HH__
+
+#include <quacode/qbf/qdimacs.hh>
+#include <iostream>
+#include <vector>
+
+namespace Gecode {
+
+  /// Statistics of the QBF preprocessing
+  class QBFPreprocessStatistics {
+  public:
+    unsigned long int varsIn;      ///< Number of quantified variables before preprocessing
+    unsigned long int varsOut;     ///< Number of quantified variables after preprocessing
+    unsigned long int clausesIn;   ///< Number of clauses before preprocessing
+    unsigned long int clausesOut;  ///< Number of clauses after preprocessing
+    unsigned long int reduced;     ///< Number of literals removed by universal reduction
+    unsigned long int units;       ///< Number of unit literals
+    unsigned long int pures;       ///< Number of pure literals
+    unsigned long int equivalences;///< Number of variables substituted by an equivalent literal
+    unsigned long int blocked;     ///< Number of blocked clauses removed
+    unsigned long int eliminated;  ///< Number of variables removed by resolution
+    double time;                   ///< Time of the preprocessing (in ms)
+    /// Constructor
+    QBFPreprocessStatistics(void);
+    /// Print statistics
+    QUACODE_EXPORT void print(std::ostream& os) const;
+  };
+
+  /**
+   * \brief Preprocessing of QBF problems in prenex CNF
+   *
+   * It simplifies the problem read by a QDimacsReader before it is posted:
+   *  - universal reduction,
+   *  - unit and pure literals (with respect to the prefix),
+   *  - substitution of equivalent literals (found with pairs of binary
+   *    clauses) when the substituted variable is existential and not
+   *    outer than its representative,
+   *  - blocked clause elimination (QBCE),
+   *  - bounded elimination of innermost existential variables by resolution.
+   *
+   * The problem of the reader is replaced by the simplified problem, which
+   * has the same truth value. Variables which disappear are removed from the
+   * prefix (their numbering is unchanged). If the problem is found false, it
+   * is replaced by the empty clause.
+   */
+  class QBFPreprocessor {
+  protected:
+    /// Number of variables
+    int nVars;
+    /// Level of the variables in the prefix (0 for free variables)
+    std::vector<int> level;
+    /// Quantifier of the variables
+    std::vector<TQuantifier> quant;
+    /// Clauses
+    std::vector< std::vector<int> > cls;
+    /// Flags of removed clauses
+    std::vector<char> removed;
+    /// Clauses of each literal (see idx)
+    std::vector< std::vector<int> > occ;
+    /// Flags of the variables removed from the problem
+    std::vector<char> gone;
+    /// Clauses to check for unit propagation
+    std::vector<int> queue;
+    /// Marks of literals (see idx)
+    std::vector<char> mark;
+    /// True if the problem is false
+    bool conflict;
+    /// Maximal number of resolvents tried to eliminate a variable
+    unsigned int maxResolvents;
+    /// Maximal size of a resolvent
+    unsigned int maxResolventSize;
+    /// Statistics
+    QBFPreprocessStatistics st;
+
+    /// Index of literal \a l in occ and mark
+    static int idx(int l);
+    /// Variable of literal \a l
+    static int var(int l);
+    /// Level of literal \a l
+    int lev(int l) const;
+    /// Remove universal literals of \a c which can be reduced, return false if \a c is a tautology
+    bool normalize(std::vector<int>& c);
+    /// Add clause \a c
+    void addClause(std::vector<int>& c);
+    /// Remove clause \a i
+    void removeClause(int i);
+    /// Remove literal \a l from clause \a i
+    void removeLiteral(int i, int l);
+    /// Set literal \a l to true
+    void assign(int l);
+    /// Replace variable \a v by literal \a l
+    void substitute(int v, int l);
+    /// Return true if clause \a i is blocked on literal \a l
+    bool isBlocked(int i, int l);
+    /// Try to eliminate variable \a v by resolution
+    bool eliminate(int v);
+
+    /// Propagate unit clauses
+    void units(void);
+    /// Propagate pure literals, return true if a literal has been found
+    bool pures(void);
+    /// Substitute equivalent literals, return true if a variable has been substituted
+    bool equivalences(void);
+    /// Remove blocked clauses, return true if a clause has been removed
+    bool blockedClauses(void);
+    /// Eliminate innermost existential variables, return true if a variable has been eliminated
+    bool eliminations(void);
+  public:
+    /// Constructor
+    QUACODE_EXPORT QBFPreprocessor(void);
+    /// Set the limits of the variable elimination: at most \a r resolvents of size at most \a s
+    void eliminationLimits(unsigned int r, unsigned int s);
+    /// Simplify the problem of \a r, return false if the problem is found false
+    QUACODE_EXPORT bool run(QDimacsReader& r);
+    /// Return the statistics of the last run
+    const QBFPreprocessStatistics& statistics(void) const;
+  };
+
+  forceinline
+  QBFPreprocessStatistics::QBFPreprocessStatistics(void)
+    : varsIn(0), varsOut(0), clausesIn(0), clausesOut(0), reduced(0), units(0),
+      pures(0), equivalences(0), blocked(0), eliminated(0), time(0) {}
+
+  forceinline int
+  QBFPreprocessor::idx(int l) {
+    return (l > 0) ? 2*l : -2*l+1;
+  }
+
+  forceinline int
+  QBFPreprocessor::var(int l) {
+    return (l > 0) ? l : -l;
+  }
+
+  forceinline int
+  QBFPreprocessor::lev(int l) const {
+    return level[var(l)];
+  }
+
+  forceinline void
+  QBFPreprocessor::eliminationLimits(unsigned int r, unsigned int s) {
+    maxResolvents = r;
+    maxResolventSize = s;
+  }
+
+  forceinline const QBFPreprocessStatistics&
+  QBFPreprocessor::statistics(void) const {
+    return st;
+  }
+
+}
+
+#endif
@@ -0,0 +1,483 @@
+/* -*- mode: C++; c-basic-offset: 2; indent-tabs-mode: nil -*- */
+/*
+ *  Main authors:
+ *     Vincent Barichard <Vincent.Barichard@univ-angers.fr>
+ *
+ *  Copyright:
+ *     Vincent Barichard, 2014
+ *
+ *  Last modified:
+ *     $Date$ by $Author$
+ *     $Revision$
+ *
+ *  This file is part of Quacode:
+ *     http://quacode.barichard.com
+ *
+ *  Permission is hereby granted, free of charge, to any person obtaining
+ *  a copy of this software and associated documentation files (the
+ *  "Software"), to deal in the Software without restriction, including
+ *  without limitation the rights to use, copy, modify, merge, publish,
+ *  distribute, sublicense, and/or sell copies of the Software, and to
+ *  permit persons to whom the Software is furnished to do so, subject to
+ *  the following conditions:
+ *
+ *  The above copyright notice and this permission notice shall be
+ *  included in all copies or substantial portions of the Software.
+ *
+ *  THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND,
+ *  EXPRESS OR IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF
+ *  MERCHANTABILITY, FITNESS FOR A PARTICULAR PURPOSE AND
+ *  NONINFRINGEMENT. IN NO EVENT SHALL THE AUTHORS OR COPYRIGHT HOLDERS BE
+ *  LIABLE FOR ANY CLAIM, DAMAGES OR OTHER LIABILITY, WHETHER IN AN ACTION
+ *  OF CONTRACT, TORT OR OTHERWISE, ARISING FROM, OUT OF OR IN CONNECTION
+ *  WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE SOFTWARE.
+ *
+ */
+
+#include <quacode/qcheck.hh>
+#include <algorithm>
+#include <cstdlib>
+#include <sstream>
+
+namespace Gecode {
+
+  namespace {
+    /// Merge report \a from into report \a to
+    void mergeReport(StrategyCheckReport& to, const StrategyCheckReport& from) {
+      to.nodes += from.nodes;
+      to.leaves += from.leaves;
+      to.completed += from.completed;
+      to.errors += from.errors;
+      for (unsigned int i=0; (i<from.messages.size()) && (to.messages.size()<StrategyChecker::maxMessages); i++)
+        to.messages.push_back(from.messages[i]);
+    }
+
+    /// Print error \a msg found at line \a l of the strategy, and return false
+    bool loadError(unsigned int l, const char* msg) {
+      std::cerr << "error: line " << l << " of strategy: " << msg << std::endl;
+      return false;
+    }
+
+    /// Set \a v to the first value of ranges \a d not covered by sorted ranges \a r
+    template<class I>
+    bool firstUncovered(I& d, const std::vector< std::pair<int,int> >& r, int& v) {
+      std::vector< std::pair<int,int> >::size_type j = 0;
+      for ( ; d(); ++d) {
+        int a = d.min();
+        while (true) {
+          while ((j < r.size()) && (r[j].second < a)) j++;
+          if ((j == r.size()) || (r[j].first > a)) {
+            v = a;
+            return true;
+          }
+          if (r[j].second >= d.max()) break;
+          a = r[j].second + 1;
+        }
+      }
+      return false;
+    }
+  }
+
+  void
+  StrategyCheckReport::print(std::ostream& os) const {
+    os << "Strategy check: " << (valid()?"valid":"INVALID") << std::endl
+       << "\tnodes: " << nodes << std::endl
+       << "\tleaves: " << leaves << " (" << completed << " proved by search)" << std::endl
+       << "\terrors: " << errors << std::endl;
+    for (unsigned int i=0; i<messages.size(); i++)
+      os << "\t" << messages[i] << std::endl;
+    if (errors > messages.size()) os << "\t..." << std::endl;
+  }
+
+  /*
+   * Access to the branched variables of a space
+   */
+  unsigned int
+  StrategyChecker::variables(const Space& home) {
+    const QSpaceInfo& qsi = dynamic_cast<const QSpaceInfo&>(home);
+    unsigned int n = qsi.sharedInfo.linkIdVars().size();
+    // The branched variables are known only if they were maintained during cloning
+    if (n != static_cast<unsigned int>(qsi._boolVars.size() + qsi._intVars.size())) return 0;
+    return n;
+  }
+
+  TQuantifier
+  StrategyChecker::quantifier(const Space& home, int vId) {
+    const QSpaceInfo& qsi = dynamic_cast<const QSpaceInfo&>(home);
+    return qsi.sharedInfo.varQuantifier(vId);
+  }
+
+  void
+  StrategyChecker::post(Space& home, int vId, int inf, int sup) {
+    QSpaceInfo& qsi = dynamic_cast<QSpaceInfo&>(home);
+    const QSpaceInfo::LkBinderVarObj& lk = qsi.sharedInfo.linkIdVars()[vId];
+    if (lk.type == QSpaceInfo::LkBinderVarObj::BOOL)
+      dom(home, qsi._boolVars[lk.id], inf, sup);
+    else
+      dom(home, qsi._intVars[lk.id], inf, sup);
+  }
+
+  bool
+  StrategyChecker::uncovered(const Space& home, int vId, const std::vector< std::pair<int,int> >& r, int& v) {
+    const QSpaceInfo& qsi = dynamic_cast<const QSpaceInfo&>(home);
+    const QSpaceInfo::LkBinderVarObj& lk = qsi.sharedInfo.linkIdVars()[vId];
+    if (lk.type == QSpaceInfo::LkBinderVarObj::BOOL) {
+      Iter::Ranges::Singleton d(qsi._boolVars[lk.id].min(), qsi._boolVars[lk.id].max());
+      return firstUncovered(d, r, v);
+    } else {
+      IntVarRanges d(qsi._intVars[lk.id]);
+      return firstUncovered(d, r, v);
+    }
+  }
+
+  /*
+   * Replay of a sub-strategy
+   */
+  class StrategyChecker::Explorer {
+  public:
+    /// Value posted on the path from the root
+    struct Step {
+      int vId, inf, sup;
+      Step(int v, int i, int s) : vId(v), inf(i), sup(s) {}
+    };
+    /// The checker
+    const StrategyChecker& sc;
+    /// Report of the explored sub-strategies
+    StrategyCheckReport r;
+    /// If not NULL, nodes below are not explored but stored as jobs
+    std::vector<Job>* jobs;
+    /// Path from the root to the current node
+    std::vector<Step> path;
+
+    /// Constructor
+    Explorer(const StrategyChecker& sc0) : sc(sc0), jobs(NULL) {}
+    /// Record error \a msg at node \a n
+    void error(int n, const std::string& msg);
+    /// Check that space \a s of status \a st is a winning position, \a s is deleted
+    void leaf(Space* s, SpaceStatus st, int n);
+    /// Replay node \a n in the stable space \a s, \a s is deleted
+    void explore(Space* s, int n);
+  };
+
+  /// Sub-strategy to check
+  class StrategyChecker::Job {
+  public:
+    /// Stable space corresponding to the root of the sub-strategy
+    Space* s;
+    /// Node of the root of the sub-strategy
+    int n;
+    /// Path from the root of the strategy
+    std::vector<Explorer::Step> path;
+    /// Constructors
+    Job(void) : s(NULL), n(-1) {}
+    Job(Space* s0, int n0, const std::vector<Explorer::Step>& p0) : s(s0), n(n0), path(p0) {}
+  };
+
+  void
+  StrategyChecker::Explorer::error(int n, const std::string& msg) {
+    r.errors++;
+    if (r.messages.size() >= maxMessages) return;
+    std::ostringstream oss;
+    if (n >= 0) oss << "line " << sc.nodes[n].line << ": ";
+    oss << msg << ", path:";
+    if (path.empty()) oss << " (root)";
+    for (unsigned int i=0; i<path.size(); i++) {
+      oss << " v_" << path[i].vId << "=";
+      if (path[i].inf == path[i].sup) oss << path[i].inf;
+      else oss << "[" << path[i].inf << "," << path[i].sup << "]";
+    }
+    r.messages.push_back(oss.str());
+  }
+
+  void
+  StrategyChecker::Explorer::leaf(Space* s, SpaceStatus st, int n) {
+    r.leaves++;
+    QSpaceInfo& qsi = dynamic_cast<QSpaceInfo&>(*s);
+    // Same success condition as the QDFS engine
+    if ((st == SS_SOLVED) || (Home(*s).propagatorgroup().size(*s) == qsi.watchConstraints())) {
+      delete s;
+      return;
+    }
+    // The leaf isn't solved (don't-care choices were removed from the
+    // strategy), the remaining sub-problem is proved by search.
+    r.completed++;
+    qsi.strategyMethod(0);
+    Search::Options o;
+    o.clone = false;
+    Search::Engine* e = Search::qdfs(s,o);
+    Space* sol = e->next();
+    if (sol == NULL) error(n, "leaf is not a winning position");
+    delete sol;
+    delete e;
+  }
+
+  void
+  StrategyChecker::Explorer::explore(Space* s, int n) {
+    r.nodes++;
+    const Node& nd = sc.nodes[n];
+    if ((nd.vId < 0) || (static_cast<unsigned int>(nd.vId) >= variables(*s))) {
+      error(n, "unknown variable");
+      delete s;
+      return;
+    }
+
+    TQuantifier q = quantifier(*s, nd.vId);
+    if (q == EXISTS) {
+      if (nd.nbValues != 1) {
+        error(n, "existential variable must have exactly one value");
+        delete s;
+        return;
+      }
+    } else {
+      // All the values of the universal variable must be covered
+      std::vector< std::pair<int,int> > rg;
+      for (int i = nd.firstValue; i >= 0; i = sc.values[i].next)
+        rg.push_back(std::make_pair(sc.values[i].inf,sc.values[i].sup));
+      std::sort(rg.begin(),rg.end());
+      int v;
+      if (uncovered(*s, nd.vId, rg, v)) {
+        std::ostringstream oss;
+        oss << "value " << v << " of universal variable v_" << nd.vId << " is not covered";
+        error(n, oss.str());
+      }
+    }
+
+    for (int i = nd.firstValue; i >= 0; i = sc.values[i].next) {
+      const Value& val = sc.values[i];
+      // The last value is replayed in the space itself. Spaces given to jobs
+      // are handed to other threads, so they must not share data.
+      Space* c = (val.next < 0) ? s : s->clone(jobs == NULL);
+      post(*c, nd.vId, val.inf, val.sup);
+      path.push_back(Step(nd.vId, val.inf, val.sup));
+      SpaceStatus st = c->status();
+      if (st == SS_FAILED) {
+        error(n, (q == EXISTS) ? "existential value leads to a failure" : "universal value leads to a failure");
+        delete c;
+      } else if (val.child < 0) {
+        leaf(c, st, n);
+      } else if (jobs) {
+        jobs->push_back(Job(c, val.child, path));
+      } else {
+        explore(c, val.child);
+      }
+      path.pop_back();
+    }
+    if (nd.firstValue < 0) delete s;
+  }
+
+  /*
+   * Pool of threads
+   */
+  class StrategyChecker::Worker : public Support::Runnable {
+  public:
+    /// Data shared by all workers
+    class Pool {
+    public:
+      /// Mutex protecting the pool
+      Support::Mutex m;
+      /// Event signaled when the last worker ends
+      Support::Event e;
+      /// Sub-strategies left to check
+      std::vector<Job> jobs;
+      /// Merged reports of workers
+      StrategyCheckReport r;
+      /// Number of running workers (not counting the calling thread)
+      unsigned int running;
+      Pool(void) : running(0) {}
+    };
+    /// The checker
+    const StrategyChecker& sc;
+    /// The pool
+    Pool& p;
+    /// Constructor
+    Worker(const StrategyChecker& sc0, Pool& p0) : sc(sc0), p(p0) {}
+    /// Check the sub-strategies of the pool until there is no one left
+    void work(void);
+    /// Run the worker in its own thread
+    virtual void run(void);
+  };
+
+  void
+  StrategyChecker::Worker::work(void) {
+    Explorer ex(sc);
+    while (true) {
+      Job j;
+      {
+        Support::Lock l(p.m);
+        if (p.jobs.empty()) break;
+        j = p.jobs.back();
+        p.jobs.pop_back();
+      }
+      ex.path = j.path;
+      ex.explore(j.s, j.n);
+    }
+    Support::Lock l(p.m);
+    mergeReport(p.r, ex.r);
+  }
+
+  void
+  StrategyChecker::Worker::run(void) {
+    work();
+    Support::Lock l(p.m);
+    if (--p.running == 0) p.e.signal();
+  }
+
+  /*
+   * Strategy checker
+   */
+  StrategyChecker::StrategyChecker(void) {}
+
+  bool
+  StrategyChecker::load(std::istream& is) {
+    nodes.clear();
+    values.clear();
+    // Last node opened at each depth
+    std::vector<int> nodeAtDepth;
+    std::string line;
+    unsigned int nl = 0;
+    while (std::getline(is,line)) {
+      nl++;
+      // Each level of depth is printed in a cell of 4 characters starting with '|'
+      std::string::size_type i = 0;
+      unsigned int depth = 0;
+      while ((i < line.size()) && (line[i] == '|')) {
+        depth++;
+        i += 4;
+      }
+      std::string rest = (i < line.size()) ? line.substr(i) : std::string();
+      while (!rest.empty() && ((rest[rest.size()-1] == ' ') || (rest[rest.size()-1] == '\r')))
+        rest.erase(rest.size()-1);
+
+      if (rest.empty()) {
+        // A blank line ends the strategy
+        if (!nodes.empty()) break;
+        continue;
+      }
+
+      char* e;
+      if ((rest.size() > 2) && (rest[0] == 'v') && (rest[1] == '_')) {
+        // Node: "v_<id>(<number of values>)"
+        Node nd;
+        nd.vId = static_cast<int>(std::strtol(rest.c_str()+2,&e,10));
+        if (*e != '(') return loadError(nl,"malformed node");
+        nd.nbAlt = static_cast<unsigned int>(std::strtol(e+1,&e,10));
+        if (*e != ')') return loadError(nl,"malformed node");
+        nd.nbValues = 0;
+        nd.firstValue = nd.lastValue = -1;
+        nd.line = nl;
+        if (nodes.empty()) {
+          if (depth != 0) return loadError(nl,"the root node must be at depth 0");
+        } else {
+          // Only the first strategy of the stream is read
+          if (depth == 0) break;
+          if (depth > nodeAtDepth.size()) return loadError(nl,"node is too deep");
+          int parent = nodes[nodeAtDepth[depth-1]].lastValue;
+          if ((parent < 0) || (values[parent].child >= 0))
+            return loadError(nl,"node without value above");
+          values[parent].child = nodes.size();
+        }
+        nodeAtDepth.resize(depth);
+        nodeAtDepth.push_back(nodes.size());
+        nodes.push_back(nd);
+      } else {
+        // Lines before the strategy are ignored
+        if (nodes.empty()) continue;
+        // Value: "<v>" or "[<inf>,<sup>]"
+        Value val;
+        if (rest[0] == '[') {
+          val.inf = static_cast<int>(std::strtol(rest.c_str()+1,&e,10));
+          if (*e != ',') return loadError(nl,"malformed value");
+          val.sup = static_cast<int>(std::strtol(e+1,&e,10));
+          if (*e != ']') return loadError(nl,"malformed value");
+        } else {
+          val.inf = val.sup = static_cast<int>(std::strtol(rest.c_str(),&e,10));
+          if ((*e != 0) || (e == rest.c_str())) return loadError(nl,"malformed value");
+        }
+        if (val.inf > val.sup) return loadError(nl,"empty range");
+        if (depth >= nodeAtDepth.size()) return loadError(nl,"value without node");
+        val.child = val.next = -1;
+        nodeAtDepth.resize(depth+1);
+        Node& nd = nodes[nodeAtDepth[depth]];
+        int iv = values.size();
+        if (nd.lastValue < 0) nd.firstValue = iv;
+        else values[nd.lastValue].next = iv;
+        nd.lastValue = iv;
+        nd.nbValues++;
+        values.push_back(val);
+      }
+    }
+
+    for (unsigned int i=0; i<nodes.size(); i++)
+      if (nodes[i].nbValues != nodes[i].nbAlt)
+        return loadError(nodes[i].line,"the number of values doesn't match the node");
+    return true;
+  }
+
+  bool
+  StrategyChecker::load(const QSpaceInfo& qsi) {
+    std::stringstream ss;
+    qsi.strategyPrint(ss);
+    return load(ss);
+  }
+
+  StrategyCheckReport
+  StrategyChecker::check(Space* root, unsigned int threads) const {
+    Explorer ex(*this);
+    dynamic_cast<QSpaceInfo&>(*root).trackVariables(true);
+    SpaceStatus st = root->status();
+    if (st == SS_FAILED) {
+      ex.error(-1, "the root space is failed");
+      return ex.r;
+    }
+    if (!nodes.empty() && (variables(*root) == 0)) {
+      ex.error(-1, "the branched variables of the root space are unknown");
+      return ex.r;
+    }
+    Space* s = root->clone(false);
+    // An empty strategy is only valid for a solved problem
+    if (nodes.empty()) {
+      ex.leaf(s, st, -1);
+      return ex.r;
+    }
+
+#ifndef GECODE_HAS_THREADS
+    threads = 1;
+#endif
+    if (threads <= 1) {
+      ex.explore(s, 0);
+      return ex.r;
+    }
+
+    // Split the strategy in disjoint sub-strategies, level by level
+    Worker::Pool p;
+    p.jobs.push_back(Job(s, 0, ex.path));
+    while (!p.jobs.empty() && (p.jobs.size() < 4 * threads)) {
+      std::vector<Job> next;
+      ex.jobs = &next;
+      for (unsigned int i=0; i<p.jobs.size(); i++) {
+        ex.path = p.jobs[i].path;
+        ex.explore(p.jobs[i].s, p.jobs[i].n);
+      }
+      p.jobs.swap(next);
+    }
+    p.r = ex.r;
+
+    // Check sub-strategies with the calling thread and threads-1 workers
+    p.running = threads - 1;
+    for (unsigned int i=1; i<threads; i++)
+      Support::Thread::run(new Worker(*this,p));
+    Worker w(*this,p);
+    w.work();
+    while (true) {
+      {
+        Support::Lock l(p.m);
+        if (p.running == 0) break;
+      }
+      p.e.wait();
+    }
+    return p.r;
+  }
+
+}
+
+// STATISTICS: search-other
@@ -0,0 +1,150 @@
+/* -*- mode: C++; c-basic-offset: 2; indent-tabs-mode: nil -*- */
+/*
+ *  Main authors:
+ *     Vincent Barichard <Vincent.Barichard@univ-angers.fr>
+ *
+ *  Copyright:
+ *     Vincent Barichard, 2014
+ *
+ *  Last modified:
+ *     $Date$ by $Author$
+ *     $Revision$
+ *
+ *  This file is part of Quacode:
+ *     http://quacode.barichard.com
+ *
+ *  Permission is hereby granted, free of charge, to any person obtaining
+ *  a copy of this software and associated documentation files (the
+ *  "Software"), to deal in the Software without restriction, including
+ *  without limitation the rights to use, copy, modify, merge, publish,
+ *  distribute, sublicense, and/or sell copies of the Software, and to
+ *  permit persons to whom the Software is furnished to do so, subject to
+ *  the following conditions:
+ *
+ *  The above copyright notice and this permission notice shall be
+ *  included in all copies or substantial portions of the Software.
+ *
+ *  THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND,
+ *  EXPRESS OR IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF
+ *  MERCHANTABILITY, FITNESS FOR A PARTICULAR PURPOSE AND
+ *  NONINFRINGEMENT. IN NO EVENT SHALL THE AUTHORS OR COPYRIGHT HOLDERS BE
+ *  LIABLE FOR ANY CLAIM, DAMAGES OR OTHER LIABILITY, WHETHER IN AN ACTION
+ *  OF CONTRACT, TORT OR OTHERWISE, ARISING FROM, OUT OF OR IN CONNECTION
+ *  WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE SOFTWARE.
+ *
+ */
+
+#ifndef __GECODE_QCHECK_HH__
+#define __GECODE_QCHECK_HH__
+
+#include <quacode/qspaceinfo.hh>
+#include <iostream>
+#include <string>
+#include <vector>
+
+namespace Gecode {
+
+  /**
+   * \brief Result of the check of a strategy
+   */
+  class StrategyCheckReport {
+  public:
+    /// Number of checked nodes of the strategy
+    unsigned long int nodes;
+    /// Number of checked leaves of the strategy
+    unsigned long int leaves;
+    /// Number of leaves which are not solved spaces and were proved by search
+    unsigned long int completed;
+    /// Number of errors found
+    unsigned long int errors;
+    /// Description of the first errors found
+    std::vector<std::string> messages;
+
+    /// Constructor
+    StrategyCheckReport(void) : nodes(0), leaves(0), completed(0), errors(0) {}
+    /// Return true if no error was found
+    bool valid(void) const { return errors == 0; }
+    /// Print the report
+    QUACODE_EXPORT void print(std::ostream& os) const;
+  };
+
+  /**
+   * \brief Checker of a winning strategy
+   *
+   * The strategy is loaded in the format printed by QSpaceInfo::strategyPrint.
+   * It is then replayed on clones of the model: each value of the strategy is
+   * posted on the corresponding branched variable and the space is propagated.
+   * The checker reports:
+   *  - existential values leading to a failure,
+   *  - universal values leading to a failure,
+   *  - values of universal variables which are not covered by the strategy,
+   *  - leaves of the strategy which are not winning positions.
+   *
+   * A leaf of the strategy is a winning position if only watch constraints remain
+   * in the space. Otherwise (for example after StrategyMethodValues::MINIMIZE has
+   * removed don't-care choices) the leaf is proved by a QDFS search.
+   *
+   * Disjoint sub-strategies are checked in parallel by a pool of threads.
+   */
+  class StrategyChecker {
+  public:
+    /// Maximum number of error messages kept in a report
+    static const unsigned int maxMessages = 100;
+  protected:
+    /// Node of the loaded strategy
+    struct Node {
+      int vId; ///< Id of the variable
+      unsigned int nbAlt; ///< Number of values announced for the node
+      unsigned int nbValues; ///< Number of values read for the node
+      int firstValue; ///< Index of the first value (-1 if none)
+      int lastValue; ///< Index of the last value (-1 if none)
+      unsigned int line; ///< Line of the node in the input stream
+    };
+    /// Value of a node of the loaded strategy
+    struct Value {
+      int inf; ///< Inf value of the range
+      int sup; ///< Sup value of the range
+      int child; ///< Index of the node below (-1 for a leaf)
+      int next; ///< Index of the next value of the same node (-1 if last)
+    };
+    /// Nodes of the strategy, the root is the first one
+    std::vector<Node> nodes;
+    /// Values of the strategy
+    std::vector<Value> values;
+
+    /// Return the number of branched variables of \a home
+    static unsigned int variables(const Space& home);
+    /// Return the quantifier of the branched variable \a vId of \a home
+    static TQuantifier quantifier(const Space& home, int vId);
+    /// Restrict the branched variable \a vId of \a home to [ \a inf , \a sup ]
+    static void post(Space& home, int vId, int inf, int sup);
+    /// Return true if a value \a v of the branched variable \a vId of \a home is
+    /// not covered by the sorted ranges \a r
+    static bool uncovered(const Space& home, int vId, const std::vector< std::pair<int,int> >& r, int& v);
+
+    /// Sub-strategy to check (defined in qcheck.cpp)
+    class Job;
+    /// Replay of a sub-strategy (defined in qcheck.cpp)
+    class Explorer;
+    /// Thread of the pool of checkers (defined in qcheck.cpp)
+    class Worker;
+  public:
+    /// Constructor
+    QUACODE_EXPORT StrategyChecker(void);
+    /// Load the strategy printed by QSpaceInfo::strategyPrint from \a is.
+    /// Return false (and print the reason on std::cerr) if the format is wrong.
+    QUACODE_EXPORT bool load(std::istream& is);
+    /// Load the strategy recorded by \a qsi
+    QUACODE_EXPORT bool load(const QSpaceInfo& qsi);
+    /// Return the number of nodes of the loaded strategy
+    unsigned int size(void) const { return nodes.size(); }
+    /// Check the loaded strategy against model \a root using \a threads threads.
+    /// The space \a root must be the model as built by its constructor (its
+    /// branched variables are used to replay the strategy). It is not modified
+    /// except that its branched variables will be maintained during cloning.
+    QUACODE_EXPORT StrategyCheckReport check(Space* root, unsigned int threads = 1) const;
+  };
+
+}
+
+#endif
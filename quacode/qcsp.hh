@@ -232,6 +232,31 @@ namespace Gecode {
 }
 
 #include <gecode/search.hh>
+#include <quacode/search/qstatistics.hh>
+namespace Gecode { namespace Support {
+  class Checkpoint;
+
+  /**
+   * \brief Hide the checkpoint of the calling thread
+   *
+   * The engines created while the object exists don't find the
+   * checkpoint of the thread (see Checkpoint), they don't solve the
+   * search it saves. It is used by the searches run for a caller, such
+   * as the instances of QTemplate.
+   */
+  class QUACODE_EXPORT CheckpointHide {
+  private:
+    /// Hidden checkpoint
+    Checkpoint* cp;
+  public:
+    /// Hide the checkpoint of the calling thread
+    CheckpointHide(void);
+    /// Restore the checkpoint of the calling thread
+    ~CheckpointHide(void);
+  };
+
+}}
+
 namespace Gecode {
   /**
    * \brief Depth-first search engine for quantified variables
@@ -254,12 +279,158 @@ namespace Gecode {
     T* next(void);
     /// Return statistics
     Search::Statistics statistics(void) const;
+    /// Return statistics detailed by block and depth
+    Search::QStatistics qstatistics(void) const;
     /// Check whether engine has been stopped
     bool stopped(void) const;
     /// Destructor
     ~QDFS(void);
   };
+
+  /**
+   * \brief Template of quantified problems solved in batch
+   *
+   * The model \a T is posted and propagated once. Each instance of the
+   * batch is then solved by QDFS on a clone of the model, once a delta
+   * has been applied to it. The delta is a function object called with
+   * the clone (as \a T&) which may only constrain it: fix the constants
+   * modeled as variables, restrict a universal domain through its
+   * unwatched variable (see QSpaceInfo::getUnWatched),... Parsing and
+   * posting are thus done once for the whole batch.
+   *
+   * The clones are made without sharing, so the strategy and the
+   * history of an instance are not seen by the other ones. A template
+   * must not be used by several threads at the same time.
+   * \ingroup TaskModelSearch
+   */
+  template<class T>
+  class QTemplate {
+  private:
+    /// The propagated model (NULL if failed)
+    T* root;
+    /// Number of solved instances
+    unsigned long int n;
+    /// Detailed statistics of the last instance
+    Search::QStatistics qs;
+    /// Whether the search of the last instance has been stopped
+    bool bStopped;
+    /// Copy constructor (disabled)
+    QTemplate(const QTemplate&);
+  public:
+    /// Initialize with the model \a s, the template takes it over and propagates it
+    QTemplate(T* s);
+    /// Return true if the model is failed, every instance is then false
+    bool failed(void) const;
+    /// Solve the instance given by applying \a d to the model, with options \a o.
+    /// Return the solved space (NULL if the instance is false or the search has
+    /// been stopped), it belongs to the caller
+    template<class Delta>
+    T* solve(Delta d, const Search::Options& o=Search::Options::def);
+    /// Return the number of solved instances
+    unsigned long int instances(void) const;
+    /// Return the detailed statistics of the last instance
+    const Search::QStatistics& qstatistics(void) const;
+    /// Check whether the search of the last instance has been stopped
+    bool stopped(void) const;
+    /// Destructor
+    ~QTemplate(void);
+  };
+
+  /// Restriction of the branched variable \a vId to [\a min, \a max]
+  class QAssumption {
+  public:
+    /// Id of the variable in the binder
+    unsigned int vId;
+    /// Lower bound
+    int min;
+    /// Upper bound
+    int max;
+    /// Initialize for variable \a v restricted to [\a l, \a u]
+    QAssumption(unsigned int v, int l, int u);
+  };
+
+  /**
+   * \brief Solving of a quantified problem under assumptions
+   *
+   * The model \a T is posted and propagated once. Each query gives
+   * assumptions, restrictions of the domains of branched variables (see
+   * QSpaceInfo::assume), and is solved by QDFS on a clone of the model.
+   *
+   * The answers are kept across the queries. Restricting an existential
+   * variable can only make the problem false and restricting a universal
+   * one can only make it true, so a query whose assumptions are
+   * dominated by the ones of a previous answer is answered without
+   * search. The history of the search is kept as well, so the refutation
+   * and the activity orders go on from one query to the next.
+   *
+   * The answers only hold for non-empty domains, because an empty
+   * universal domain also makes the problem false. The assumptions are
+   * therefore propagated before the previous answers are looked up.
+   *
+   * When a query is false, a core can be computed: a subset of its
+   * assumptions for which the problem is still false. The assumptions
+   * are removed one by one while the problem stays false, the universal
+   * ones first, since their removal is mostly answered without search.
+   * \ingroup TaskModelSearch
+   */
+  template<class T>
+  class QAssumptions {
+  private:
+    /// Previous answer
+    struct Answer {
+      /// Normalized assumptions
+      std::vector<QAssumption> a;
+      /// Truth value
+      bool value;
+    };
+    /// The propagated model (NULL if failed)
+    T* root;
+    /// Previous answers
+    std::vector<Answer> answers;
+    /// Number of queries
+    unsigned long int nQueries;
+    /// Number of searches (queries and core computation)
+    unsigned long int nSearches;
+    /// Number of searches avoided by the previous answers
+    unsigned long int nHits;
+    /// Detailed statistics of all the searches
+    Search::QStatistics qs;
+    /// Whether a search of the last query has been stopped
+    bool bStopped;
+    /// Order of the assumptions by variable
+    static bool less(const QAssumption& a, const QAssumption& b);
+    /// Return the assumptions \a a sorted by variable, one per variable
+    std::vector<QAssumption> normalize(const std::vector<QAssumption>& a) const;
+    /// Return true if the problem under \a q is at least as hard as under \a e
+    bool harder(const std::vector<QAssumption>& q, const std::vector<QAssumption>& e) const;
+    /// Solve under the normalized assumptions \a a, return 1 if true, 0 if false, -1 if stopped
+    int run(const std::vector<QAssumption>& a, const Search::Options& o);
+    /// Copy constructor (disabled)
+    QAssumptions(const QAssumptions&);
+  public:
+    /// Initialize with the model \a s, the object takes it over and propagates it
+    QAssumptions(T* s);
+    /// Return true if the problem is true under the assumptions \a a, with
+    /// options \a o. If false and \a core is not NULL, a core is stored in it.
+    /// Throws Int::OutOfLimits if an assumption is not on a branched variable.
+    bool solve(const std::vector<QAssumption>& a, std::vector<QAssumption>* core=NULL,
+               const Search::Options& o=Search::Options::def);
+    /// Return the number of queries
+    unsigned long int queries(void) const;
+    /// Return the number of searches
+    unsigned long int searches(void) const;
+    /// Return the number of searches avoided by the previous answers
+    unsigned long int hits(void) const;
+    /// Return the detailed statistics of all the searches
+    const Search::QStatistics& qstatistics(void) const;
+    /// Check whether a search of the last query has been stopped (its answer is then false)
+    bool stopped(void) const;
+    /// Destructor
+    ~QAssumptions(void);
+  };
 }
 #include <quacode/search/qdfs.hpp>
+#include <quacode/search/qtemplate.hpp>
+#include <quacode/search/qassumptions.hpp>
 
 #endif
@@ -54,6 +54,7 @@
 
 #include <gecode/int.hh>
 #include <quacode/qcsp.hh>
+#include <quacode/support/profile.hh>
 
 /**
  * \namespace Gecode::Int::Bool
@@ -93,6 +94,8 @@ namespace Gecode { namespace Int { namespace Bool {
     virtual Actor* copy(Space& home, bool share);
     /// Perform propagation
     virtual ExecStatus propagate(Space& home, const ModEventDelta& med);
+    /// Propagation itself, profiled by propagate
+    ExecStatus doPropagate(Space& home, const ModEventDelta& med);
     /// Post propagator \f$ V/E x_0 = V/E x_1\f$
     static  ExecStatus post(Home home, BVA b0, TQuantifier _q0, int _r0, BVB b1, TQuantifier _q1, int _r1);
     static  ExecStatus post(Home home, QBoolVar x0, QBoolVar x1);
@@ -129,6 +132,8 @@ namespace Gecode { namespace Int { namespace Bool {
     virtual Actor* copy(Space& home, bool share);
     /// Perform propagation
     virtual ExecStatus propagate(Space& home, const ModEventDelta& med);
+    /// Propagation itself, profiled by propagate
+    ExecStatus doPropagate(Space& home, const ModEventDelta& med);
     /// Post propagator \f$ V/E x_0 <> V/E x_1\f$
     static  ExecStatus post(Home home, BVA b0, TQuantifier _q0, int _r0, BVB b1, TQuantifier _q1, int _r1);
     static  ExecStatus post(Home home, QBoolVar x0, QBoolVar x1);
@@ -169,6 +174,8 @@ namespace Gecode { namespace Int { namespace Bool {
     virtual Actor* copy(Space& home, bool share);
     /// Perform propagation
     virtual ExecStatus propagate(Space& home, const ModEventDelta& med);
+    /// Propagation itself, profiled by propagate
+    ExecStatus doPropagate(Space& home, const ModEventDelta& med);
     /// Post propagator \f$ V/E b_0 \lor V/E b_1 = 1 \f$
     static  ExecStatus post(Home home, BVA b0, TQuantifier _q0, int _r0, BVB b1, TQuantifier _q1, int _r1);
   };
@@ -204,6 +211,8 @@ namespace Gecode { namespace Int { namespace Bool {
     virtual Actor* copy(Space& home, bool share);
     /// Perform propagation
     virtual ExecStatus propagate(Space& home, const ModEventDelta& med);
+    /// Propagation itself, profiled by propagate
+    ExecStatus doPropagate(Space& home, const ModEventDelta& med);
     /// Post propagator \f$ V/E b_0 \lor V/E b_1 = b_2 \f$
     static  ExecStatus post(Home home, BVA b0, TQuantifier _q0, int _r0, BVB b1, TQuantifier _q1, int _r1, BVC b2);
   };
@@ -241,6 +250,8 @@ namespace Gecode { namespace Int { namespace Bool {
     virtual PropCost cost(const Space& home, const ModEventDelta& med) const;
     /// Perform propagation
     virtual ExecStatus propagate(Space& home, const ModEventDelta& med);
+    /// Propagation itself, profiled by propagate
+    ExecStatus doPropagate(Space& home, const ModEventDelta& med);
     /// Post propagator \f$ \bigvee_{i=0}^{|x|-1} V/E x_i = y\f$
     static  ExecStatus post(Home home, ViewArray<VX>& x, QuantArgs q, IntArgs r, VY y);
     /// Delete propagator and return its size
@@ -286,6 +297,8 @@ namespace Gecode { namespace Int { namespace Bool {
     virtual PropCost cost(const Space& home, const ModEventDelta& med) const;
     /// Perform propagation
     virtual ExecStatus propagate(Space& home, const ModEventDelta& med);
+    /// Propagation itself, profiled by propagate
+    ExecStatus doPropagate(Space& home, const ModEventDelta& med);
     /// Post propagator \f$ \bigvee_{i=0}^{|b|-1} V/E b_i = 0\f$
     static  ExecStatus post(Home home, ViewArray<BV>& b, QuantArgs q, IntArgs r);
     /// Delete propagator and return its size
@@ -322,6 +335,8 @@ namespace Gecode { namespace Int { namespace Bool {
     virtual Actor* copy(Space& home, bool share);
     /// Perform propagation
     virtual ExecStatus propagate(Space& home, const ModEventDelta& med);
+    /// Propagation itself, profiled by propagate
+    ExecStatus doPropagate(Space& home, const ModEventDelta& med);
     /// Post propagator \f$ V/E b_0 \Leftrightarrow V/E b_1 = b_2 \f$ (equivalence)
     static  ExecStatus post(Home home, BVA b0, TQuantifier _q0, int _r0, BVB b1, TQuantifier _q1, int _r1, BVC b2);
     static  ExecStatus post(Home home, QBoolVar b0, QBoolVar b1, BVC b2);
@@ -356,6 +371,8 @@ namespace Gecode { namespace Int { namespace Bool {
     virtual Actor* copy(Space& home, bool share);
     /// Perform propagation
     virtual ExecStatus propagate(Space& home, const ModEventDelta& med);
+    /// Propagation itself, profiled by propagate
+    ExecStatus doPropagate(Space& home, const ModEventDelta& med);
     /// Post propagator \f$ V/E b_0 <> V/E b_1 = b_2 \f$ (equivalence)
     static  ExecStatus post(Home home, BVA b0, TQuantifier _q0, int _r0, BVB b1, TQuantifier _q1, int _r1, BVC b2);
     static  ExecStatus post(Home home, QBoolVar b0, QBoolVar b1, BVC b2);
@@ -415,6 +432,8 @@ namespace Gecode { namespace Int { namespace Bool {
     virtual PropCost cost(const Space& home, const ModEventDelta& med) const;
     /// Perform propagation
     virtual ExecStatus propagate(Space& home, const ModEventDelta& med);
+    /// Propagation itself, profiled by propagate
+    ExecStatus doPropagate(Space& home, const ModEventDelta& med);
     /// Post propagator \f$ \bigvee_{i=0}^{|x|-1} V/E x_i \vee \bigvee_{i=0}^{|x|-1} V/E y_i = z\f$
     static  ExecStatus post(Home home, ViewArray<VX>& x, QuantArgs qx, IntArgs rx, ViewArray<VY>& y, QuantArgs qy, IntArgs ry,
                             VX z);
@@ -465,6 +484,8 @@ namespace Gecode { namespace Int { namespace Bool {
     virtual PropCost cost(const Space& home, const ModEventDelta& med) const;
     /// Perform propagation
     virtual ExecStatus propagate(Space& home, const ModEventDelta& med);
+    /// Propagation itself, profiled by propagate
+    ExecStatus doPropagate(Space& home, const ModEventDelta& med);
     /// Post propagator \f$ \bigvee_{i=0}^{|x|-1} V/E x_i \vee \bigvee_{i=0}^{|y|-1} V/E y_i = 1\f$
     static  ExecStatus post(Home home, ViewArray<VX>& x, QuantArgs qx, IntArgs rx, ViewArray<VY>& y, QuantArgs qy, IntArgs ry);
     /// Delete propagator and return its size
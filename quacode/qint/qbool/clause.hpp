@@ -99,6 +99,8 @@ namespace Gecode { namespace Int { namespace Bool {
     }
     x.update(home,share,p.x);
     y.update(home,share,p.y);
+    QUACODE_PROFILE_COPY(QCLAUSETRUE,sizeof(*this)+x.size()*(sizeof(VX)+sizeof(TQuantifier)+sizeof(int))+
+                                       y.size()*(sizeof(VY)+sizeof(TQuantifier)+sizeof(int)));
   }
 
   template<class VX, class VY>
@@ -207,6 +209,7 @@ namespace Gecode { namespace Int { namespace Bool {
           // Rewrite if there is just one view left
           if ((i == 0) && (y.size() == 0)) {
             VX z = x[0]; x.size(0);
+            QUACODE_PROFILE_REWRITE();
             GECODE_REWRITE(p,(QBinOrTrue<VX,VY>::post(home(p),z,qx[0],rx[0],x1,c_qy,c_ry)));
           }
           // Move to x0 and subscribe
@@ -225,6 +228,7 @@ namespace Gecode { namespace Int { namespace Bool {
         z[i]=y[i]; qz[i]=qy[i]; rz[i]=ry[i];
       }
       z[y.size()] = x1; qz[y.size()] = c_qy;; rz[y.size()] = c_ry;
+      QUACODE_PROFILE_REWRITE();
       GECODE_REWRITE(p,(QNaryOrTrue<VY>::post(home(p),z,qz,rz)));
     }
     return ES_FIX;
@@ -232,7 +236,13 @@ namespace Gecode { namespace Int { namespace Bool {
 
   template<class VX, class VY>
   ExecStatus
-  QClauseTrue<VX,VY>::propagate(Space& home, const ModEventDelta&) {
+  QClauseTrue<VX,VY>::propagate(Space& home, const ModEventDelta& med) {
+    QUACODE_PROFILE_PROPAGATE(QCLAUSETRUE,doPropagate(home,med));
+  }
+
+  template<class VX, class VY>
+  forceinline ExecStatus
+  QClauseTrue<VX,VY>::doPropagate(Space& home, const ModEventDelta&) {
     if (x0.one() || x1.one())
       return home.ES_SUBSUMED(*this);
     GECODE_ES_CHECK(resubscribe(home,*this,x0,x,c_qx,qx,c_rx,rx,x1,y,c_qy,qy,c_ry,ry));
@@ -299,6 +309,8 @@ namespace Gecode { namespace Int { namespace Bool {
     y.update(home,share,p.y);
     z.update(home,share,p.z);
     c.update(home,share,p.c);
+    QUACODE_PROFILE_COPY(QCLAUSE,sizeof(*this)+x.size()*(sizeof(VX)+sizeof(TQuantifier)+sizeof(int))+
+                                   y.size()*(sizeof(VY)+sizeof(TQuantifier)+sizeof(int)));
   }
 
   template<class VX>
@@ -434,9 +446,17 @@ namespace Gecode { namespace Int { namespace Bool {
 
   template<class VX, class VY>
   ExecStatus
-  QClause<VX,VY>::propagate(Space& home, const ModEventDelta&) {
-    if (z.one())
+  QClause<VX,VY>::propagate(Space& home, const ModEventDelta& med) {
+    QUACODE_PROFILE_PROPAGATE(QCLAUSE,doPropagate(home,med));
+  }
+
+  template<class VX, class VY>
+  forceinline ExecStatus
+  QClause<VX,VY>::doPropagate(Space& home, const ModEventDelta&) {
+    if (z.one()) {
+      QUACODE_PROFILE_REWRITE();
       GECODE_REWRITE(*this,(QClauseTrue<VX,VY>::post(home(*this),x,QuantArgs(x.size(),qx),IntArgs(x.size(),rx),y,QuantArgs(y.size(),qy),IntArgs(y.size(),ry))));
+    }
     if (z.zero()) {
       for (int i = x.size(); i--; )
       {
@@ -64,14 +64,18 @@ namespace Gecode { namespace Int { namespace Bool {
   template<class BVA, class BVB>
   forceinline
   QBinOrTrue<BVA,BVB>::QBinOrTrue(Space& home, bool share, QBinOrTrue<BVA,BVB>& p)
-    : BoolBinary<BVA,BVB>(home,share,p) {}
+    : BoolBinary<BVA,BVB>(home,share,p) {
+    QUACODE_PROFILE_COPY(QBINORTRUE,sizeof(*this));
+  }
 
   template<class BVA, class BVB>
   forceinline
   QBinOrTrue<BVA,BVB>::QBinOrTrue(Space& home, bool share, Propagator& p,
                                   BVA b0, TQuantifier _q0, int _r0,
                                   BVB b1, TQuantifier _q1, int _r1)
-    : BoolBinary<BVA,BVB>(home,share,p,b0,b1), q0(_q0), r0(_r0), q1(_q1), r1(_r1) {}
+    : BoolBinary<BVA,BVB>(home,share,p,b0,b1), q0(_q0), r0(_r0), q1(_q1), r1(_r1) {
+    QUACODE_PROFILE_COPY(QBINORTRUE,sizeof(*this));
+  }
 
   template<class BVA, class BVB>
   Actor*
@@ -111,7 +115,13 @@ namespace Gecode { namespace Int { namespace Bool {
 
   template<class BVA, class BVB>
   ExecStatus
-  QBinOrTrue<BVA,BVB>::propagate(Space& home, const ModEventDelta&) {
+  QBinOrTrue<BVA,BVB>::propagate(Space& home, const ModEventDelta& med) {
+    QUACODE_PROFILE_PROPAGATE(QBINORTRUE,doPropagate(home,med));
+  }
+
+  template<class BVA, class BVB>
+  forceinline ExecStatus
+  QBinOrTrue<BVA,BVB>::doPropagate(Space& home, const ModEventDelta&) {
 #define GECODE_INT_STATUS(S0,S1) \
   ((BVA::S0<<(1*BVA::BITS))|(BVB::S1<<(0*BVB::BITS)))
     switch ((x0.status() << (1*BVA::BITS)) | (x1.status() << (0*BVB::BITS))) {
@@ -150,14 +160,18 @@ namespace Gecode { namespace Int { namespace Bool {
   template<class BVA, class BVB, class BVC>
   forceinline
   QOr<BVA,BVB,BVC>::QOr(Space& home, bool share, QOr<BVA,BVB,BVC>& p)
-    : BoolTernary<BVA,BVB,BVC>(home,share,p), q0(p.q0), r0(p.r0), q1(p.q1), r1(p.r1) {}
+    : BoolTernary<BVA,BVB,BVC>(home,share,p), q0(p.q0), r0(p.r0), q1(p.q1), r1(p.r1) {
+    QUACODE_PROFILE_COPY(QOR,sizeof(*this));
+  }
 
   template<class BVA, class BVB, class BVC>
   forceinline
   QOr<BVA,BVB,BVC>::QOr(Space& home, bool share, Propagator& p,
                          BVA b0, TQuantifier _q0, int _r0,
                          BVB b1, TQuantifier _q1, int _r1, BVC b2)
-    : BoolTernary<BVA,BVB,BVC>(home,share,p,b0,b1,b2), q0(_q0), r0(_r0), q1(_q1), r1(_r1) {}
+    : BoolTernary<BVA,BVB,BVC>(home,share,p,b0,b1,b2), q0(_q0), r0(_r0), q1(_q1), r1(_r1) {
+    QUACODE_PROFILE_COPY(QOR,sizeof(*this));
+  }
 
   template<class BVA, class BVB, class BVC>
   Actor*
@@ -213,7 +227,13 @@ namespace Gecode { namespace Int { namespace Bool {
 
   template<class BVA, class BVB, class BVC>
   ExecStatus
-  QOr<BVA,BVB,BVC>::propagate(Space& home, const ModEventDelta&) {
+  QOr<BVA,BVB,BVC>::propagate(Space& home, const ModEventDelta& med) {
+    QUACODE_PROFILE_PROPAGATE(QOR,doPropagate(home,med));
+  }
+
+  template<class BVA, class BVB, class BVC>
+  forceinline ExecStatus
+  QOr<BVA,BVB,BVC>::doPropagate(Space& home, const ModEventDelta&) {
     assert((q0 == EXISTS) || (q1 == EXISTS));
 #define GECODE_INT_STATUS(S0,S1,S2) \
   ((BVA::S0<<(2*BVA::BITS))|(BVB::S1<<(1*BVB::BITS))|(BVC::S2<<(0*BVC::BITS)))
@@ -333,6 +353,7 @@ namespace Gecode { namespace Int { namespace Bool {
     rx = home.alloc<int>(p.x.size());
     for (int n=p.x.size(); --n ; ) { qx[n] = p.qx[n]; rx[n] = p.rx[n]; }
     x.update(home,share,p.x);
+    QUACODE_PROFILE_COPY(QNARYORTRUE,sizeof(*this)+x.size()*(sizeof(BV)+sizeof(TQuantifier)+sizeof(int)));
   }
 
   template<class BV>
@@ -421,7 +442,13 @@ namespace Gecode { namespace Int { namespace Bool {
 
   template<class BV>
   ExecStatus
-  QNaryOrTrue<BV>::propagate(Space& home, const ModEventDelta&) {
+  QNaryOrTrue<BV>::propagate(Space& home, const ModEventDelta& med) {
+    QUACODE_PROFILE_PROPAGATE(QNARYORTRUE,doPropagate(home,med));
+  }
+
+  template<class BV>
+  forceinline ExecStatus
+  QNaryOrTrue<BV>::doPropagate(Space& home, const ModEventDelta&) {
     if (x0.one())
       return home.ES_SUBSUMED(*this);
     if (x1.one())
@@ -457,6 +484,7 @@ namespace Gecode { namespace Int { namespace Bool {
     r = home.alloc<int>(p.x.size());
     for (int n=p.x.size(); --n ; ) { q[n] = p.q[n]; r[n] = p.r[n]; }
     c.update(home,share,p.c);
+    QUACODE_PROFILE_COPY(QNARYOR,sizeof(*this)+x.size()*(sizeof(VX)+sizeof(TQuantifier)+sizeof(int)));
   }
 
   template<class VX, class VY>
@@ -542,9 +570,17 @@ namespace Gecode { namespace Int { namespace Bool {
 
   template<class VX, class VY>
   ExecStatus
-  QNaryOr<VX,VY>::propagate(Space& home, const ModEventDelta&) {
-    if (y.one())
+  QNaryOr<VX,VY>::propagate(Space& home, const ModEventDelta& med) {
+    QUACODE_PROFILE_PROPAGATE(QNARYOR,doPropagate(home,med));
+  }
+
+  template<class VX, class VY>
+  forceinline ExecStatus
+  QNaryOr<VX,VY>::doPropagate(Space& home, const ModEventDelta&) {
+    if (y.one()) {
+      QUACODE_PROFILE_REWRITE();
       GECODE_REWRITE(*this,QNaryOrTrue<VX>::post(home(*this),x,QuantArgs(x.size(),q),IntArgs(x.size(),r)));
+    }
     if (y.zero()) {
       // Note that this might trigger the advisor of this propagator!
       for (int i = x.size(); i--; )
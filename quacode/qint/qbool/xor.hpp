@@ -57,13 +57,17 @@ namespace Gecode { namespace Int { namespace Bool {
   template<class BVA, class BVB>
   forceinline
   QXor<BVA,BVB>::QXor(Space& home, bool share, QXor<BVA,BVB>& p)
-    : BoolBinary<BVA,BVB>(home,share,p), q0(p.q0), r0(p.r0), q1(p.q1), r1(p.r1) {}
+    : BoolBinary<BVA,BVB>(home,share,p), q0(p.q0), r0(p.r0), q1(p.q1), r1(p.r1) {
+    QUACODE_PROFILE_COPY(QXOR,sizeof(*this));
+  }
 
   template<class BVA, class BVB>
   forceinline
   QXor<BVA,BVB>::QXor(Space& home, bool share, Propagator& p,
                     BVA b0, TQuantifier _q0, int _r0, BVB b1, TQuantifier _q1, int _r1)
-    : BoolBinary<BVA,BVB>(home,share,p,b0,b1), q0(_q0), r0(_r0), q1(_q1), r1(_r1) {}
+    : BoolBinary<BVA,BVB>(home,share,p,b0,b1), q0(_q0), r0(_r0), q1(_q1), r1(_r1) {
+    QUACODE_PROFILE_COPY(QXOR,sizeof(*this));
+  }
 
   template<class BVA, class BVB>
   Actor*
@@ -111,7 +115,13 @@ namespace Gecode { namespace Int { namespace Bool {
 
   template<class BVA, class BVB>
   ExecStatus
-  QXor<BVA,BVB>::propagate(Space& home, const ModEventDelta&) {
+  QXor<BVA,BVB>::propagate(Space& home, const ModEventDelta& med) {
+    QUACODE_PROFILE_PROPAGATE(QXOR,doPropagate(home,med));
+  }
+
+  template<class BVA, class BVB>
+  forceinline ExecStatus
+  QXor<BVA,BVB>::doPropagate(Space& home, const ModEventDelta&) {
 #define GECODE_INT_STATUS(S0,S1) \
   ((BVA::S0<<(1*BVA::BITS))|(BVB::S1<<(0*BVB::BITS)))
     switch ((x0.status() << (1*BVA::BITS)) | (x1.status() << (0*BVB::BITS))) {
@@ -62,7 +62,9 @@ namespace Gecode { namespace Int { namespace Bool {
   template<class BVA, class BVB, class BVC>
   forceinline
   QXorv<BVA,BVB,BVC>::QXorv(Space& home, bool share, QXorv<BVA,BVB,BVC>& p)
-    : BoolTernary<BVA,BVB,BVC>(home,share,p), q0(p.q0), r0(p.r0), q1(p.q1), r1(p.r1) {}
+    : BoolTernary<BVA,BVB,BVC>(home,share,p), q0(p.q0), r0(p.r0), q1(p.q1), r1(p.r1) {
+    QUACODE_PROFILE_COPY(QXORV,sizeof(*this));
+  }
 
   template<class BVA, class BVB, class BVC>
   inline ExecStatus
@@ -119,7 +121,13 @@ namespace Gecode { namespace Int { namespace Bool {
 
   template<class BVA, class BVB, class BVC>
   ExecStatus
-  QXorv<BVA,BVB,BVC>::propagate(Space& home, const ModEventDelta&) {
+  QXorv<BVA,BVB,BVC>::propagate(Space& home, const ModEventDelta& med) {
+    QUACODE_PROFILE_PROPAGATE(QXORV,doPropagate(home,med));
+  }
+
+  template<class BVA, class BVB, class BVC>
+  forceinline ExecStatus
+  QXorv<BVA,BVB,BVC>::doPropagate(Space& home, const ModEventDelta&) {
 #define GECODE_INT_STATUS(S0,S1,S2) \
   ((BVA::S0<<(2*BVA::BITS))|(BVB::S1<<(1*BVB::BITS))|(BVC::S2<<(0*BVC::BITS)))
     switch ((x0.status() << (2*BVA::BITS)) | (x1.status() << (1*BVB::BITS)) |
@@ -64,7 +64,9 @@ namespace Gecode { namespace Int {
   template<class View>
   forceinline
   Watch<View>::Watch(Space& home, bool share, Watch<View>& p)
-    : BinaryPropagator<View,PC_INT_DOM>(home,share,p), x0Size(p.x0Size) {}
+    : BinaryPropagator<View,PC_INT_DOM>(home,share,p), x0Size(p.x0Size) {
+    QUACODE_PROFILE_COPY(WATCH,sizeof(*this));
+  }
 
   template<class View>
   Actor*
@@ -80,7 +82,13 @@ namespace Gecode { namespace Int {
 
   template<class View>
   ExecStatus
-  Watch<View>::propagate(Space& home, const ModEventDelta&) {
+  Watch<View>::propagate(Space& home, const ModEventDelta& med) {
+    QUACODE_PROFILE_PROPAGATE(WATCH,doPropagate(home,med));
+  }
+
+  template<class View>
+  forceinline ExecStatus
+  Watch<View>::doPropagate(Space& home, const ModEventDelta&) {
     if (x0.size() != x0Size) return ES_FAILED;
     if (x1.assigned()) {
       GECODE_ME_CHECK(x0.eq(home,x1.val()));
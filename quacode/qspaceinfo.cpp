@@ -35,8 +35,16 @@
  */
 
 #include <quacode/qspaceinfo.hh>
+#include <quacode/support/log.hh>
+#include <algorithm>
+#include <cstring>
+#include <string>
 #include <vector>
 
+#if defined(__unix__) || defined(__APPLE__)
+#include <unistd.h>
+#endif
+
 using namespace std;
 
 namespace Gecode {
@@ -45,9 +53,13 @@ namespace Gecode {
 
   bool Strategy::strategyInit() {
     assert(bx == NULL);
+    // The whole strategy must fit in the memory budget
+    if (memoryBudget && (worstCaseMemory() > memoryBudget)) return false;
     strategyTotalSize = 0;
     for (int i = domSize.size(); i--; )
-      if (domSize[i] > 0) strategyTotalSize = 1 + domSize[i] * (1 + strategyTotalSize);
+      if (domSize[i] > 0) strategyTotalSize = nodeSize(domSize[i],strategyTotalSize);
+    // The size of the strategy can't be stored in an unsigned int
+    if (strategyTotalSize == UINT_MAX) return false;
     bx = new (std::nothrow) Box[strategyTotalSize];
     cur = bx;
     curDepth = 0;
@@ -55,18 +67,43 @@ namespace Gecode {
     return (bx != NULL);
   }
 
+  double Strategy::worstCaseMemory(void) const {
+    double size = 0;
+    for (int i = domSize.size(); i--; )
+      if (domSize[i] > 0) size = 1 + domSize[i] * (1 + size);
+    return size * sizeof(Box);
+  }
+
   void Strategy::strategyReset() {
     if (bx == NULL) return;
     cur = bx;
     curDepth = 0;
     lastEvent = Strategy::NONE;
+    wideValues.clear();
+    wideIndex.clear();
+  }
+
+  unsigned int Strategy::wideValue(int vInf, int vSup) {
+    std::pair<int,int> v(vInf,vSup);
+    std::map< std::pair<int,int>, unsigned int >::const_iterator it = wideIndex.find(v);
+    if (it != wideIndex.end()) return it->second;
+    unsigned int i = static_cast<unsigned int>(wideValues.size());
+    wideValues.push_back(v);
+    wideIndex[v] = i;
+    return i;
   }
 
-  void Strategy::add(unsigned int id, unsigned int size) {
+  void Strategy::add(unsigned int id, TQuantifier q, unsigned int size, int min, int max) {
     curBranch.resize(static_cast<unsigned int>(curBranch.size())+1);
     domSize.resize(std::max(static_cast<unsigned int>(domSize.size()),id+1),0);
+    domMin.resize(std::max(static_cast<unsigned int>(domMin.size()),id+1),0);
+    domMax.resize(std::max(static_cast<unsigned int>(domMax.size()),id+1),0);
+    domQuant.resize(std::max(static_cast<unsigned int>(domQuant.size()),id+1),EXISTS);
     idxInCurBranch.resize(std::max(static_cast<unsigned int>(idxInCurBranch.size()),id+1),-1);
     domSize[id] = size;
+    domMin[id] = min;
+    domMax[id] = max;
+    domQuant[id] = q;
   }
 
   void Strategy::print(std::ostream& os, Box* p, unsigned int curRemainingStrategySize, int depth) const {
@@ -84,10 +121,9 @@ namespace Gecode {
 
       // Print value
       for (int i=depth; i--; ) os << std::setfill(' ') << std::setw(4) << std::left << "|";
-      if (p->val.inf == p->val.sup) os << p->val.inf << std::endl;
-      else os << "[" << p->val.inf << "," << p->val.sup << "]" << std::endl;
+      if (p->val.width == 0) os << valInf(*p,vId) << std::endl;
+      else os << "[" << valInf(*p,vId) << "," << valSup(*p,vId) << "]" << std::endl;
 
-      assert(p->val.inf <= p->val.sup);
       if (!p->val.leaf) print(os, p+1, newRemainingSize, depth+1);
       p += 1 + newRemainingSize;
     }
@@ -97,9 +133,183 @@ namespace Gecode {
     if (bx && (cur != bx)) print(os,bx,strategyTotalSize,0); os << std::endl;
   }
 
+  bool Strategy::sameSubtree(const Box* p, unsigned int sp, const Box* q, unsigned int sq) const {
+    // Follow the links to new blocks (dynamic strategies)
+    if (p->var.needNewBlock) { sp = static_cast<unsigned int>(p->var.id); p = (p+1)->nextBlock; }
+    if (q->var.needNewBlock) { sq = static_cast<unsigned int>(q->var.id); q = (q+1)->nextBlock; }
+    int vId = p->var.id;
+    if ((q->var.id != vId) || (q->var.nbAlt != p->var.nbAlt)) return false;
+    if (vId < 0) return true;
+    unsigned int strideP = (sp - 1) / domSize[vId];
+    unsigned int strideQ = (sq - 1) / domSize[vId];
+    const Box* vp = p + 1;
+    const Box* vq = q + 1;
+    for (unsigned int i=p->var.nbAlt; i--; ) {
+      // Both values belong to the same variable, we can compare encoded values
+      if ((vp->val.inf != vq->val.inf) || (vp->val.width != vq->val.width) || (vp->val.leaf != vq->val.leaf))
+        return false;
+      if (!vp->val.leaf && !sameSubtree(vp+1, strideP-1, vq+1, strideQ-1)) return false;
+      vp += strideP;
+      vq += strideQ;
+    }
+    return true;
+  }
+
+  bool Strategy::minimize(Box* p, unsigned int size) {
+    if (p->var.needNewBlock) {
+      size = static_cast<unsigned int>(p->var.id);
+      p = (p+1)->nextBlock;
+    }
+    int vId = p->var.id;
+    if (vId < 0) return false;
+    unsigned int nbAlt = p->var.nbAlt;
+    unsigned int stride = (size - 1) / domSize[vId];
+    Box* v = p + 1;
+
+    // Minimize sub-strategies first, a value above a don't-care node becomes a leaf
+    for (unsigned int i=0; i<nbAlt; i++)
+      if (!v[i*stride].val.leaf && minimize(v + i*stride + 1, stride - 1))
+        v[i*stride].val.leaf = 1;
+
+    if (domQuant[vId] == FORALL) {
+      // Sort values of the universal variable in increasing order, it may
+      // not be the case if the value heuristic doesn't enumerate them in order
+      bool sorted = true;
+      for (unsigned int i=1; sorted && (i<nbAlt); i++)
+        sorted = (valInf(v[(i-1)*stride],vId) <= valInf(v[i*stride],vId));
+      if (!sorted) {
+        std::vector< std::pair<int,unsigned int> > order(nbAlt);
+        for (unsigned int i=0; i<nbAlt; i++) order[i] = std::make_pair(valInf(v[i*stride],vId),i);
+        std::sort(order.begin(),order.end());
+        std::vector<Box> tmp(v, v + nbAlt*stride);
+        for (unsigned int i=0; i<nbAlt; i++)
+          std::copy(tmp.begin() + order[i].second*stride, tmp.begin() + (order[i].second+1)*stride, v + i*stride);
+      }
+
+      // Merge consecutive values leading to the same sub-strategy in one range.
+      // Values between them which don't appear in the strategy were removed
+      // from the domain of the universal variable, so they can't be played.
+      unsigned int w = 0;
+      for (unsigned int i=1; i<nbAlt; i++) {
+        Box* bw = v + w*stride;
+        Box* bi = v + i*stride;
+        if ((bw->val.leaf == bi->val.leaf) &&
+            (bw->val.leaf || sameSubtree(bw+1, stride-1, bi+1, stride-1))) {
+          int sup = std::max(valSup(*bw,vId), valSup(*bi,vId));
+          valSet(*bw, vId, valInf(*bw,vId), sup);
+        } else {
+          w++;
+          if (w != i) std::copy(bi, bi + stride, v + w*stride);
+        }
+      }
+      nbAlt = w + 1;
+      p->var.nbAlt = nbAlt;
+    }
+
+    // A node with only one leaf value is a don't-care node if any value of the
+    // variable is a right answer: always true for a universal variable (any move of
+    // the opponent leads to a win) and true for an existential variable if the
+    // recorded range is the whole initial domain.
+    if ((nbAlt == 1) && v->val.leaf)
+      return (domQuant[vId] == FORALL) ||
+             ((valInf(*v,vId) == domMin[vId]) && (valSup(*v,vId) == domMax[vId]));
+    return false;
+  }
+
+  void Strategy::minimize(void) {
+    if (bOverBudget) return;
+    // The root node is kept even if it is a don't-care node
+    if (bx && (cur != bx)) minimize(bx,firstBlockSize());
+  }
+
+  namespace {
+    /// Return the offset of \a p in the boxes starting at \a bx, -1 if \a p is NULL
+    template<class Box>
+    long long int boxOffset(const Box* bx, const Box* p) {
+      return p ? static_cast<long long int>(p - bx) : -1;
+    }
+    /// Return the box at offset \a o (-1 for NULL) of the \a n boxes starting at \a bx,
+    /// set \a ok to false if the offset is out of range
+    template<class Box>
+    Box* boxAt(Box* bx, unsigned int n, long long int o, bool& ok) {
+      if (o == -1) return NULL;
+      if ((o < 0) || (o > static_cast<long long int>(n))) { ok = false; return NULL; }
+      return bx + o;
+    }
+  }
+
+  bool Strategy::save(std::ostream& os) const {
+    if (bx == NULL) return false;
+    os << "static " << strategyTotalSize << " " << boxOffset(bx,cur) << " " << curDepth
+       << " " << lastEvent << " " << bOverBudget << std::endl;
+    os << wideValues.size();
+    for (std::vector< std::pair<int,int> >::size_type i=0; i<wideValues.size(); i++)
+      os << " " << wideValues[i].first << " " << wideValues[i].second;
+    os << std::endl << idxInCurBranch.size();
+    for (std::vector<int>::size_type i=0; i<idxInCurBranch.size(); i++)
+      os << " " << idxInCurBranch[i];
+    os << std::endl << curBranch.size() << std::endl;
+    for (std::vector<BPtr>::size_type i=0; i<curBranch.size(); i++) {
+      const BPtr& b = curBranch[i];
+      os << b.id << " " << b.vInf << " " << b.vSup << " " << boxOffset(bx,b.ptrId)
+         << " " << boxOffset(bx,b.ptrCur) << " " << b.curRemainingStrategySize << std::endl;
+    }
+    // A box is packed in 64 bits, it is written as a whole
+    for (unsigned int i=0; i<strategyTotalSize; i++) {
+      unsigned long long int w = 0;
+      std::memcpy(&w, &bx[i], sizeof(Box));
+      os << w << ((i % 8 == 7) ? "\n" : " ");
+    }
+    os << std::endl;
+    return true;
+  }
+
+  bool Strategy::load(std::istream& is) {
+    std::string kind;
+    unsigned int total;
+    long long int c;
+    if (!(is >> kind >> total >> c) || (kind != "static") ||
+        (bx == NULL) || (total != strategyTotalSize))
+      return false;
+    bool ok = true;
+    Box* nCur = boxAt(bx,strategyTotalSize,c,ok);
+    std::vector< std::pair<int,int> >::size_type nw;
+    if (!(is >> curDepth >> lastEvent >> bOverBudget >> nw) || !ok)
+      return false;
+    wideValues.resize(nw);
+    wideIndex.clear();
+    for (std::vector< std::pair<int,int> >::size_type i=0; i<nw; i++) {
+      if (!(is >> wideValues[i].first >> wideValues[i].second)) return false;
+      wideIndex[wideValues[i]] = static_cast<unsigned int>(i);
+    }
+    std::vector<int>::size_type ni;
+    if (!(is >> ni) || (ni != idxInCurBranch.size()))
+      return false;
+    for (std::vector<int>::size_type i=0; i<ni; i++)
+      if (!(is >> idxInCurBranch[i])) return false;
+    std::vector<BPtr>::size_type nb;
+    if (!(is >> nb) || (nb != curBranch.size())) return false;
+    for (std::vector<BPtr>::size_type i=0; i<nb; i++) {
+      BPtr& b = curBranch[i];
+      long long int pId, pCur;
+      if (!(is >> b.id >> b.vInf >> b.vSup >> pId >> pCur >> b.curRemainingStrategySize))
+        return false;
+      b.ptrId = boxAt(bx,strategyTotalSize,pId,ok);
+      b.ptrCur = boxAt(bx,strategyTotalSize,pCur,ok);
+    }
+    for (unsigned int i=0; ok && (i<strategyTotalSize); i++) {
+      unsigned long long int w;
+      if (!(is >> w)) return false;
+      std::memcpy(&bx[i], &w, sizeof(Box));
+    }
+    cur = nCur;
+    return ok;
+  }
+
   bool StaticExpandStrategy::strategyInit() {
     if (Strategy::strategyInit()) {
       cur->var.id = -1;
+      cur->var.needNewBlock = 0;
       cur->var.nbAlt = 1;
       return true;
     }
@@ -111,7 +321,7 @@ namespace Gecode {
     strategyTotalSize = 0;
     int k = domSize.size();
     for (int i = k; i--; )
-      if (domSize[i] > 0) strategyTotalSize = 1 + domSize[i] * (1 + strategyTotalSize);
+      if (domSize[i] > 0) strategyTotalSize = nodeSize(domSize[i],strategyTotalSize);
     k--;
 
     bxBlockSize = strategyTotalSize;
@@ -122,8 +332,8 @@ namespace Gecode {
       bxBlockSize = 2; // We save space for writing the flag to know that we have to allocate a new block plus the ptr to the new block
       for (int i = k; i--;  )
         if (domSize[i] > 0) {
-          strategyTotalSize = 1 + domSize[i] * (1 + strategyTotalSize);
-          bxBlockSize = 1 + domSize[i] * (1 + bxBlockSize);
+          strategyTotalSize = nodeSize(domSize[i],strategyTotalSize);
+          bxBlockSize = nodeSize(domSize[i],bxBlockSize);
         }
     }
     bx = new (std::nothrow) Box[bxBlockSize];
@@ -134,6 +344,7 @@ namespace Gecode {
   bool DynamicExpandStrategy::strategyInit() {
     if (DynamicStrategy::strategyInit()) {
       cur->var.id = -1;
+      cur->var.needNewBlock = 0;
       cur->var.nbAlt = 1;
       return true;
     }
@@ -147,7 +358,7 @@ namespace Gecode {
       if (!curBranch[i].blocks.empty()) {
         std::vector<Box*>::iterator it = curBranch[i].blocks.begin();
         std::vector<Box*>::iterator itEnd = curBranch[i].blocks.end();
-        for ( ; it != itEnd; ++it) delete [] *it;
+        for ( ; it != itEnd; ++it) deleteBlock(*it);
         curBranch[i].blocks.clear();
       }
       i--;
@@ -155,12 +366,15 @@ namespace Gecode {
     cur = bx;
     curDepth = 0;
     lastEvent = Strategy::NONE;
+    wideValues.clear();
+    wideIndex.clear();
   }
 
   void DynamicStrategy::print(std::ostream& os, Box* p, unsigned int curRemainingBlockSize, int depth) const {
     if (p->var.needNewBlock) {
+      unsigned int newBlockSize = static_cast<unsigned int>(p->var.id);
       p++;
-      print(os,p->nextBlock.ptr,p->nextBlock.size,depth);
+      print(os,p->nextBlock,newBlockSize,depth);
       return;
     }
     int vId = p->var.id;
@@ -177,21 +391,109 @@ namespace Gecode {
 
       // Print value
       for (int i=depth; i--; ) os << std::setfill(' ') << std::setw(4) << std::left << "|";
-      if (p->val.inf == p->val.sup) os << p->val.inf << std::endl;
-      else os << "[" << p->val.inf << "," << p->val.sup << "]" << std::endl;
+      if (p->val.width == 0) os << valInf(*p,vId) << std::endl;
+      else os << "[" << valInf(*p,vId) << "," << valSup(*p,vId) << "]" << std::endl;
 
-      assert(p->val.inf <= p->val.sup);
       if (!p->val.leaf) print(os, p+1, newRemainingSize, depth+1);
       p += 1 + newRemainingSize;
     }
   }
 
   void DynamicStrategy::print(std::ostream& os) const {
-    if (bx && (cur != bx)) print(os,bx,bxBlockSize,0); os << std::endl;
+    if (bOverBudget) os << "Strategy dropped: memory budget exceeded" << std::endl;
+    else if (bx && (cur != bx)) print(os,bx,bxBlockSize,0);
+    os << std::endl;
+  }
+
+  const double BranchHistory::decay = 0.95;
+
+  void BranchHistory::refute(int k) {
+    for (int i=k; i<static_cast<int>(branch.size()); i++)
+      if (branch[i].universal && branch[i].assigned)
+        scores[key(branch[i].vId,branch[i].val)] += bump;
+    // Bumping more and more is the same as decaying all the scores
+    bump /= decay;
+    if (bump > 1e100) {
+      for (std::unordered_map<unsigned long long,double>::iterator it = scores.begin(); it != scores.end(); ++it)
+        it->second *= 1e-100;
+      bump *= 1e-100;
+    }
+  }
+
+  void BranchHistory::conflict(void) {
+    // The failure involves the last round of the game: the last universal
+    // choice and the existential choices below it
+    int k = static_cast<int>(branch.size());
+    while ((k > 0) && !branch[k-1].universal) k--;
+    if (k > 0) k--;
+    for (int i=k; i<static_cast<int>(branch.size()); i++) {
+      int vId = branch[i].vId;
+      if (vId >= static_cast<int>(activities.size())) activities.resize(vId+1,0.0);
+      activities[vId] += activityBump;
+    }
+    activityBump /= decay;
+    if (activityBump > 1e100) {
+      for (std::vector<double>::iterator it = activities.begin(); it != activities.end(); ++it)
+        *it *= 1e-100;
+      activityBump *= 1e-100;
+    }
+  }
+
+  void BranchHistory::choice(int vId, bool u, int vInf, int vSup) {
+    if ((lastEvent == Strategy::FAILURE) || (lastEvent == Strategy::SUCCESS)) {
+      // The search backtracks to the choice on vId, after a failure all the
+      // universal values below it are refuted: none of them let the existential
+      // player win
+      int k = find(vId);
+      if (lastEvent == Strategy::FAILURE) refute(k+1);
+      if (k < 0) {
+        branch.clear();
+        branch.push_back(Choice(vId,u));
+      } else {
+        branch.erase(branch.begin()+k+1, branch.end());
+      }
+    } else if (branch.empty() || (branch.back().vId != vId)) {
+      branch.push_back(Choice(vId,u));
+    }
+    // Otherwise we branch again on the same variable, we overwrite the last value
+    branch.back().val = vInf;
+    branch.back().assigned = (vInf == vSup);
+    lastEvent = Strategy::CHOICE;
+  }
+
+  int BranchHistory::value(int vId, IntVar x) const {
+    int best = x.min();
+    double bestScore = score(vId,best);
+    for (IntVarValues i(x); i(); ++i) {
+      double sc = score(vId,i.val());
+      if (sc > bestScore) {
+        best = i.val();
+        bestScore = sc;
+      }
+    }
+    return best;
+  }
+
+  int BranchHistory::value(int vId, BoolVar x) const {
+    if (x.assigned()) return x.val();
+    return (score(vId,1) > score(vId,0)) ? 1 : 0;
+  }
+
+  namespace {
+    /// Offset basis of the 64 bits FNV-1a hash
+    const uint64_t fnvBasis = 14695981039346656037ULL;
+    /// Mix the bytes of \a x into the FNV-1a hash \a h
+    void fnv(uint64_t& h, unsigned int x) {
+      for (int i=0; i<4; i++) {
+        h ^= (x >> (8*i)) & 0xff;
+        h *= 1099511628211ULL;
+      }
+    }
   }
 
   QSpaceInfo::QSpaceSharedInfoO::QSpaceSharedInfoO(StrategyMethod sm)
-    : s(NULL) {
+    : s(NULL), memoryBudget(0), _unbranchedLinks(false), _replay(false),
+      _replayedId(-1), _replayedInf(0), _replayedSup(0), _fingerprint(fnvBasis) {
     if (sm & StrategyMethodValues::BUILD) {
       if (sm & StrategyMethodValues::DYNAMIC) {
         if (sm & StrategyMethodValues::EXPAND) s = new DynamicExpandStrategy();
@@ -204,8 +506,10 @@ namespace Gecode {
   }
 
   QSpaceInfo::QSpaceSharedInfoO::QSpaceSharedInfoO(const QSpaceSharedInfoO& qsi)
-    : _linkIdVars(qsi._linkIdVars), v(qsi.v), s(NULL) {
-      s = qsi.s->copy();
+    : _linkIdVars(qsi._linkIdVars), v(qsi.v), s(NULL), memoryBudget(qsi.memoryBudget), h(qsi.h),
+      _links(qsi._links), _varLinks(qsi._varLinks), _unbranchedLinks(qsi._unbranchedLinks), _replay(false),
+      _replayedId(-1), _replayedInf(0), _replayedSup(0), _fingerprint(qsi._fingerprint) {
+      if (qsi.s) s = qsi.s->copy();
     }
 
   QSpaceInfo::QSpaceSharedInfoO::~QSpaceSharedInfoO(void) {
@@ -221,10 +525,14 @@ namespace Gecode {
     if (v.size() > 0) offset = v[v.size()-1].offset + v[v.size()-1].size;
     v.resize(v.size() + 1);
     v[v.size()-1] = QBI(_q,offset,x.size());
+    fnv(_fingerprint,_q);
+    fnv(_fingerprint,LkBinderVarObj::BOOL);
+    fnv(_fingerprint,static_cast<unsigned int>(x.size()));
     for (int i=0; i<x.size(); i++) {
-      if (qsi.curStrategyMethod & StrategyMethodValues::EXPAND)
-        _linkIdVars.push_back(LkBinderVarObj(qsi._boolVars.size()+i,LkBinderVarObj::BOOL));
-      if (s) s->add(offset+i,((_q==EXISTS)?1:x[i].size()));
+      _linkIdVars.push_back(LkBinderVarObj(qsi._boolVars.size()+i,LkBinderVarObj::BOOL));
+      fnv(_fingerprint,static_cast<unsigned int>(x[i].min()));
+      fnv(_fingerprint,static_cast<unsigned int>(x[i].max()));
+      if (s) s->add(offset+i,_q,((_q==EXISTS)?1:x[i].size()),x[i].min(),x[i].max());
     }
   }
 
@@ -236,10 +544,71 @@ namespace Gecode {
     if (v.size() > 0) offset = v[v.size()-1].offset + v[v.size()-1].size;
     v.resize(v.size() + 1);
     v[v.size()-1] = QBI(_q,offset,x.size());
+    fnv(_fingerprint,_q);
+    fnv(_fingerprint,LkBinderVarObj::INT);
+    fnv(_fingerprint,static_cast<unsigned int>(x.size()));
     for (int i=0; i<x.size() ; i++) {
-      if (qsi.curStrategyMethod & StrategyMethodValues::EXPAND)
-        _linkIdVars.push_back(LkBinderVarObj(qsi._intVars.size()+i,LkBinderVarObj::INT));
-      if (s) s->add(offset+i,((_q==EXISTS)?1:x[i].size()));
+      _linkIdVars.push_back(LkBinderVarObj(qsi._intVars.size()+i,LkBinderVarObj::INT));
+      // The domain is given by its size and its ranges
+      fnv(_fingerprint,x[i].size());
+      for (IntVarRanges r(x[i]); r(); ++r) {
+        fnv(_fingerprint,static_cast<unsigned int>(r.min()));
+        fnv(_fingerprint,static_cast<unsigned int>(r.max()));
+      }
+      if (s) s->add(offset+i,_q,((_q==EXISTS)?1:x[i].size()),x[i].min(),x[i].max());
+    }
+  }
+
+  void
+  QSpaceInfo::QSpaceSharedInfoO::link(const std::vector<int>& vIds) {
+    for (std::vector<int>::size_type i=0; i<vIds.size(); i++) {
+      if (static_cast<std::size_t>(vIds[i]) >= _varLinks.size())
+        _varLinks.resize(vIds[i]+1);
+      _varLinks[vIds[i]].push_back(static_cast<int>(_links.size()));
+    }
+    _links.push_back(vIds);
+  }
+
+  void
+  QSpaceInfo::QSpaceSharedInfoO::strategySave(std::ostream& os) const {
+    os << "strategy ";
+    if ((s == NULL) || !s->save(os))
+      os << "none" << std::endl;
+  }
+
+  bool
+  QSpaceInfo::QSpaceSharedInfoO::strategyLoad(std::istream& is) {
+    std::string kind;
+    if (!(is >> kind) || (kind != "strategy")) return false;
+    if (s == NULL) return true;
+    if (s->load(is)) return true;
+    LOG_OUT("Strategy: not restored from checkpoint, not built\n");
+    delete s;
+    s = NULL;
+    return false;
+  }
+
+  void
+  QSpaceInfo::QSpaceSharedInfoO::toDynamic(StrategyMethod sm) {
+    Strategy *_s = NULL;
+    if (sm & StrategyMethodValues::EXPAND)
+      _s = DynamicExpandStrategy::fromStaticStrategy(*s);
+    else
+      _s = DynamicStrategy::fromStaticStrategy(*s);
+    delete s;
+    s = _s;
+  }
+
+  namespace {
+    /// Default memory budget of the automatic method: half of the physical memory, 0 if unknown
+    std::size_t defaultMemoryBudget(void) {
+#if defined(_SC_PHYS_PAGES) && defined(_SC_PAGESIZE)
+      long int pages = sysconf(_SC_PHYS_PAGES);
+      long int pageSize = sysconf(_SC_PAGESIZE);
+      if ((pages > 0) && (pageSize > 0))
+        return static_cast<std::size_t>(pages) / 2 * static_cast<std::size_t>(pageSize);
+#endif
+      return 0;
     }
   }
 
@@ -247,27 +616,40 @@ namespace Gecode {
   QSpaceInfo::QSpaceSharedInfoO::strategyInit(StrategyMethod sm) {
     if (sm & StrategyMethodValues::BUILD) {
       assert(s && !s->allocated());
+      s->budget(memoryBudget);
+      if (sm & StrategyMethodValues::AUTO) {
+        // Choose the data structure before allocating anything
+        std::size_t b = memoryBudget ? memoryBudget : defaultMemoryBudget();
+        double m = s->worstCaseMemory();
+        bool isDynamic = (dynamic_cast<DynamicStrategy*>(s) != NULL);
+        if (!isDynamic && (!b || (m <= b))) {
+          sm = sm & ~StrategyMethodValues::DYNAMIC;
+          LOG_OUT("Strategy: static data structure (" << m << " bytes at worst, budget " << static_cast<double>(b) << " bytes)\n");
+        } else {
+          sm = sm | StrategyMethodValues::DYNAMIC;
+          s->budget(b);
+          LOG_OUT("Strategy: dynamic data structure (" << m << " bytes at worst, budget " << static_cast<double>(b) << " bytes)\n");
+        }
+      }
       if (sm & StrategyMethodValues::DYNAMIC) {
+        if (dynamic_cast<DynamicStrategy*>(s) == NULL) toDynamic(sm);
         LABEL_PREFER_DYNAMIC:
         if (!s->strategyInit()) goto LABEL_NO_BUILD;
       } else {
         assert((dynamic_cast<Strategy*>(s) != NULL) || (dynamic_cast<StaticExpandStrategy*>(s) != NULL));
         if (!s->strategyInit()) {
-          if (sm & StrategyMethodValues::FAILTHROUGH) {
+          // The automatic method always falls back to the dynamic strategy
+          if (sm & (StrategyMethodValues::FAILTHROUGH | StrategyMethodValues::AUTO)) {
+            LOG_OUT("Strategy: static data structure can't be allocated, switch to dynamic one\n");
             sm = sm | StrategyMethodValues::DYNAMIC;
-            Strategy *_s = NULL;
-            if (sm & StrategyMethodValues::EXPAND)
-              _s = DynamicExpandStrategy::fromStaticStrategy(*s);
-            else
-              _s = DynamicStrategy::fromStaticStrategy(*s);
-            delete s;
-            s = _s;
+            toDynamic(sm);
             goto LABEL_PREFER_DYNAMIC;
           } else goto LABEL_NO_BUILD;
         }
       }
     } else {
       LABEL_NO_BUILD:
+      LOG_OUT("Strategy: not built\n");
       delete s;
       s = NULL;
       sm = 0; // No build
@@ -288,13 +670,15 @@ namespace Gecode {
   }
 
   QSpaceInfo::QSpaceInfo(void)
-    : bRecordStrategy(false),
+    : bRecordStrategy(false), bRefutationOrder(false), bActivityOrder(false), bHistory(false),
       curStrategyMethod(StrategyMethodValues::BUILD
 //                        | StrategyMethodValues::DYNAMIC
                         | StrategyMethodValues::FAILTHROUGH
 //                        | StrategyMethodValues::EXPAND
+//                        | StrategyMethodValues::AUTO
                         )
-      , nbWatchConstraint(0) {
+      , nbWatchConstraint(0), bTrackVariables(false),
+      bComponents(false), nbComponentBranchers(0), _component(NULL) {
       sharedInfo.init(curStrategyMethod);
     }
 
@@ -302,10 +686,17 @@ namespace Gecode {
 
   QSpaceInfo::QSpaceInfo(Space& home, bool share, QSpaceInfo& qs)
     : bRecordStrategy(qs.bRecordStrategy),
+      bRefutationOrder(qs.bRefutationOrder),
+      bActivityOrder(qs.bActivityOrder),
+      bHistory(qs.bHistory),
       curStrategyMethod(qs.curStrategyMethod),
-      nbWatchConstraint(qs.nbWatchConstraint) {
+      nbWatchConstraint(qs.nbWatchConstraint),
+      bTrackVariables(qs.bTrackVariables),
+      bComponents(qs.bComponents),
+      nbComponentBranchers(qs.nbComponentBranchers),
+      _component(qs._component) {
       sharedInfo.update(home, share, qs.sharedInfo);
-      if (qs.curStrategyMethod & StrategyMethodValues::EXPAND) {
+      if (qs.trackedVariables()) {
         _boolVars.update(home, share, qs._boolVars);
         _intVars.update(home, share, qs._intVars);
       }
@@ -329,16 +720,142 @@ namespace Gecode {
   QSpaceInfo::updateQSpaceInfo(TQuantifier _q,
                                const BoolVarArgs& x) {
     sharedInfo.add(*this,_q,x);
-    if (curStrategyMethod & StrategyMethodValues::EXPAND)
-      _boolVars = BoolVarArray(dynamic_cast<Space&>(*this),_boolVars+x);
+    // Branched variables are always recorded during modeling, they are
+    // maintained during cloning only if needed
+    _boolVars = BoolVarArray(dynamic_cast<Space&>(*this),_boolVars+x);
   }
 
   void
   QSpaceInfo::updateQSpaceInfo(TQuantifier _q,
                                const IntVarArgs& x) {
     sharedInfo.add(*this,_q,x);
-    if (curStrategyMethod & StrategyMethodValues::EXPAND)
-      _intVars = IntVarArray(dynamic_cast<Space&>(*this),_intVars+x);
+    // Branched variables are always recorded during modeling, they are
+    // maintained during cloning only if needed
+    _intVars = IntVarArray(dynamic_cast<Space&>(*this),_intVars+x);
+  }
+
+  template<class VarType, unsigned int id> int
+  QSpaceInfo::refutationValue(const Space& home, VarType x, int pos) {
+    const QSpaceInfo& qsi = dynamic_cast<const QSpaceInfo&>(home);
+    return qsi.sharedInfo.history().value(qsi.sharedInfo.brancherOffset(id) + pos, x);
+  }
+
+  template<class VarType, unsigned int id> double
+  QSpaceInfo::activityMerit(const Space& home, VarType, int pos) {
+    const QSpaceInfo& qsi = dynamic_cast<const QSpaceInfo&>(home);
+    return qsi.sharedInfo.history().activity(qsi.sharedInfo.brancherOffset(id) + pos);
+  }
+
+  template<class VarType, unsigned int id> bool
+  QSpaceInfo::componentFilter(const Space& home, VarType x, int pos) {
+    const QSpaceInfo& qsi = dynamic_cast<const QSpaceInfo&>(home);
+    if (qsi._component && !(*qsi._component)[qsi.sharedInfo.brancherOffset(id) + pos])
+      return false;
+    return qsi.sharedInfo.filter(home,id,x,pos);
+  }
+
+  // Template loop to get one value (merit or filter) function per brancher id
+  template<unsigned int id>
+  struct QSpaceInfo::BrancherTable {
+    template<class VarType, class BranchVal>
+    static void values(BranchVal t[]) {
+      t[id] = &QSpaceInfo::refutationValue<VarType,id>;
+      BrancherTable<id-1>::template values<VarType>(t);
+    }
+    template<class VarType, class BranchMerit>
+    static void merits(BranchMerit t[]) {
+      t[id] = &QSpaceInfo::activityMerit<VarType,id>;
+      BrancherTable<id-1>::template merits<VarType>(t);
+    }
+    template<class VarType, class BranchFilter>
+    static void filters(BranchFilter t[]) {
+      t[id] = &QSpaceInfo::componentFilter<VarType,id>;
+      BrancherTable<id-1>::template filters<VarType>(t);
+    }
+  };
+  template<>
+  struct QSpaceInfo::BrancherTable<0> {
+    // Brancher ids start at 1
+    template<class VarType, class BranchVal>
+    static void values(BranchVal t[]) {
+      t[0] = NULL;
+    }
+    template<class VarType, class BranchMerit>
+    static void merits(BranchMerit t[]) {
+      t[0] = NULL;
+    }
+    template<class VarType, class BranchFilter>
+    static void filters(BranchFilter t[]) {
+      t[0] = NULL;
+    }
+  };
+
+  IntBranchVal
+  QSpaceInfo::refutationIntValue(unsigned int id) {
+    static IntBranchVal t[orderedBranchers + 1];
+    static bool filled = (BrancherTable<orderedBranchers>::values<IntVar>(t), true);
+    (void) filled;
+    return (id <= orderedBranchers) ? t[id] : NULL;
+  }
+
+  BoolBranchVal
+  QSpaceInfo::refutationBoolValue(unsigned int id) {
+    static BoolBranchVal t[orderedBranchers + 1];
+    static bool filled = (BrancherTable<orderedBranchers>::values<BoolVar>(t), true);
+    (void) filled;
+    return (id <= orderedBranchers) ? t[id] : NULL;
+  }
+
+  IntBranchMerit
+  QSpaceInfo::activityIntMerit(unsigned int id) {
+    static IntBranchMerit t[orderedBranchers + 1];
+    static bool filled = (BrancherTable<orderedBranchers>::merits<IntVar>(t), true);
+    (void) filled;
+    return (id <= orderedBranchers) ? t[id] : NULL;
+  }
+
+  BoolBranchMerit
+  QSpaceInfo::activityBoolMerit(unsigned int id) {
+    static BoolBranchMerit t[orderedBranchers + 1];
+    static bool filled = (BrancherTable<orderedBranchers>::merits<BoolVar>(t), true);
+    (void) filled;
+    return (id <= orderedBranchers) ? t[id] : NULL;
+  }
+
+  IntBranchFilter
+  QSpaceInfo::componentIntFilter(unsigned int id) {
+    static IntBranchFilter t[orderedBranchers + 1];
+    static bool filled = (BrancherTable<orderedBranchers>::filters<IntVar>(t), true);
+    (void) filled;
+    return (id <= orderedBranchers) ? t[id] : NULL;
+  }
+
+  BoolBranchFilter
+  QSpaceInfo::componentBoolFilter(unsigned int id) {
+    static BoolBranchFilter t[orderedBranchers + 1];
+    static bool filled = (BrancherTable<orderedBranchers>::filters<BoolVar>(t), true);
+    (void) filled;
+    return (id <= orderedBranchers) ? t[id] : NULL;
+  }
+
+  template<class BranchType> void
+  QSpaceInfo::branchBlock(Home home, const BoolVarArgs& x, BranchType vars, IntValBranch vals, BoolBranchFilter bf, BoolVarValPrint vvp) {
+    if (vvp) {
+      customBoolVVP = vvp;
+      Gecode::branch(home,x,vars,vals,bf,&tripleChoice);
+    } else {
+      Gecode::branch(home,x,vars,vals,bf,&doubleChoice);
+    }
+  }
+
+  template<class BranchType> void
+  QSpaceInfo::branchBlock(Home home, const IntVarArgs& x, BranchType vars, IntValBranch vals, IntBranchFilter bf, IntVarValPrint vvp) {
+    if (vvp) {
+      customIntVVP = vvp;
+      Gecode::branch(home,x,vars,vals,bf,&tripleChoice);
+    } else {
+      Gecode::branch(home,x,vars,vals,bf,&doubleChoice);
+    }
   }
 
   template<class BranchType> void
@@ -373,6 +890,7 @@ namespace Gecode {
     // We iterate over blocks of variables with the same quantifier
     while (i < x.size()) {
       BoolVarArgs UW_X;
+      int first = i;
       BoolVar* uwxi = NULL;
       TQuantifier qi = EXISTS;
 
@@ -390,16 +908,39 @@ namespace Gecode {
         i++;
       }
 
-      // Add brancher for unwatched variables
-      if (vvp) {
-	customBoolVVP = vvp;
-        Gecode::branch(home,UW_X,vars,vals,bf,&tripleChoice);
+      // Universal values follow the refutation order if asked
+      unsigned int id = sharedInfo.getLastBrancherId() + 1;
+      IntValBranch uvals = vals;
+      if ((curQ == FORALL) && bRefutationOrder) {
+        BoolBranchVal rv = refutationBoolValue(id);
+        if (rv) {
+          uvals = INT_VAL(rv);
+          bHistory = true;
+        }
+      }
+
+      // Add brancher for unwatched variables, they follow the activity order if asked
+      // and are restricted to the current component if asked (bf is then called by the component filter)
+      BoolBranchMerit am = bActivityOrder ? activityBoolMerit(id) : NULL;
+      BoolBranchFilter cf = bComponents ? componentBoolFilter(id) : NULL;
+      if (am) {
+        bHistory = true;
+        branchBlock(home,UW_X,INT_VAR_MERIT_MAX(am),uvals,cf ? cf : bf,vvp);
       } else {
-        Gecode::branch(home,UW_X,vars,vals,bf,&doubleChoice);
+        branchBlock(home,UW_X,vars,uvals,cf ? cf : bf,vvp);
       }
 
       // Update shared info
       updateQSpaceInfo(curQ,UW_X);
+      if (cf) {
+        sharedInfo.filter(id,bf);
+        nbComponentBranchers++;
+        // Record the ids of the watched and unwatched variables for link
+        for (int j=0; j<UW_X.size(); j++) {
+          _varIds[UW_X[j].varimp()] = sharedInfo.brancherOffset(id) + j;
+          _varIds[x[first+j].varimp()] = sharedInfo.brancherOffset(id) + j;
+        }
+      }
       // Update current quantifier
       curQ = qi;
     }
@@ -420,6 +961,7 @@ namespace Gecode {
     // We iterate over blocks of variables with the same quantifier
     while (i < x.size()) {
       IntVarArgs UW_X;
+      int first = i;
       IntVar* uwxi = NULL;
       TQuantifier qi = EXISTS;
 
@@ -437,16 +979,39 @@ namespace Gecode {
         i++;
       }
 
-      // Add brancher for unwatched variables
-      if (vvp) {
-	customIntVVP = vvp;
-        Gecode::branch(home,UW_X,vars,vals,bf,&tripleChoice);
+      // Universal values follow the refutation order if asked
+      unsigned int id = sharedInfo.getLastBrancherId() + 1;
+      IntValBranch uvals = vals;
+      if ((curQ == FORALL) && bRefutationOrder) {
+        IntBranchVal rv = refutationIntValue(id);
+        if (rv) {
+          uvals = INT_VAL(rv);
+          bHistory = true;
+        }
+      }
+
+      // Add brancher for unwatched variables, they follow the activity order if asked
+      // and are restricted to the current component if asked (bf is then called by the component filter)
+      IntBranchMerit am = bActivityOrder ? activityIntMerit(id) : NULL;
+      IntBranchFilter cf = bComponents ? componentIntFilter(id) : NULL;
+      if (am) {
+        bHistory = true;
+        branchBlock(home,UW_X,INT_VAR_MERIT_MAX(am),uvals,cf ? cf : bf,vvp);
       } else {
-        Gecode::branch(home,UW_X,vars,vals,bf,&doubleChoice);
+        branchBlock(home,UW_X,vars,uvals,cf ? cf : bf,vvp);
       }
 
       // Update shared info
       updateQSpaceInfo(curQ,UW_X);
+      if (cf) {
+        sharedInfo.filter(id,bf);
+        nbComponentBranchers++;
+        // Record the ids of the watched and unwatched variables for link
+        for (int j=0; j<UW_X.size(); j++) {
+          _varIds[UW_X[j].varimp()] = sharedInfo.brancherOffset(id) + j;
+          _varIds[x[first+j].varimp()] = sharedInfo.brancherOffset(id) + j;
+        }
+      }
       // Update current quantifier
       curQ = qi;
     }
@@ -455,4 +1020,153 @@ namespace Gecode {
   template QUACODE_EXPORT void QSpaceInfo::branch<>(Home home, const IntVarArgs& x, IntVarBranch vars, IntValBranch vals, IntBranchFilter bf, IntVarValPrint vvp);
   template QUACODE_EXPORT void QSpaceInfo::branch<>(Home home, const IntVarArgs& x, TieBreak<IntVarBranch> vars, IntValBranch vals, IntBranchFilter bf, IntVarValPrint vvp);
 
+  void
+  QSpaceInfo::link(const BoolVarArgs& x) {
+    // A constraint on a single variable never links two components
+    if (x.size() < 2) return;
+    std::vector<int> vIds;
+    for (int i=0; i<x.size(); i++) {
+      std::unordered_map<const void*,int>::const_iterator it = _varIds.find(x[i].varimp());
+      if (it != _varIds.end()) vIds.push_back(it->second);
+      else if (!x[i].assigned()) sharedInfo.linkUnbranched();
+    }
+    if (vIds.size() > 1) sharedInfo.link(vIds);
+  }
+
+  void
+  QSpaceInfo::link(const IntVarArgs& x) {
+    // A constraint on a single variable never links two components
+    if (x.size() < 2) return;
+    std::vector<int> vIds;
+    for (int i=0; i<x.size(); i++) {
+      std::unordered_map<const void*,int>::const_iterator it = _varIds.find(x[i].varimp());
+      if (it != _varIds.end()) vIds.push_back(it->second);
+      else if (!x[i].assigned()) sharedInfo.linkUnbranched();
+    }
+    if (vIds.size() > 1) sharedInfo.link(vIds);
+  }
+
+  namespace {
+    /// Return the representative of \a i in the union-find \a parent
+    int findComponent(std::vector<int>& parent, int i) {
+      while (parent[i] != i) {
+        parent[i] = parent[parent[i]];
+        i = parent[i];
+      }
+      return i;
+    }
+  }
+
+  void
+  QSpaceInfo::strategySave(std::ostream& os) const {
+    sharedInfo.strategySave(os);
+  }
+
+  bool
+  QSpaceInfo::strategyLoad(std::istream& is) {
+    if (sharedInfo.strategyLoad(is)) return true;
+    curStrategyMethod = 0;
+    bRecordStrategy = false;
+    return false;
+  }
+
+  unsigned int
+  QSpaceInfo::components(std::vector<int>& comp) const {
+    comp.clear();
+    // All the branchers have to be restricted to the current component
+    if (!bComponents || bRecordStrategy || sharedInfo.unbranchedLinks() ||
+        (nbComponentBranchers != static_cast<unsigned int>(sharedInfo.getLastBrancherId())))
+      return 0;
+    const std::vector< std::vector<int> >& links = sharedInfo.links();
+    int n = static_cast<int>(sharedInfo.linkIdVars().size());
+    // Union-find over the unassigned variables of the current component
+    std::vector<int> parent(n,-1);
+    for (int vId=0; vId<n; vId++)
+      if ((!_component || (*_component)[vId]) && !varAssigned(vId))
+        parent[vId] = vId;
+    for (std::vector< std::vector<int> >::size_type l=0; l<links.size(); l++) {
+      int r = -1;
+      for (std::vector<int>::size_type i=0; i<links[l].size(); i++) {
+        if (parent[links[l][i]] < 0) continue;
+        int ri = findComponent(parent,links[l][i]);
+        if (r < 0) r = ri;
+        else if (ri != r) parent[ri] = r;
+      }
+    }
+    // Number the components by their first variable
+    comp.assign(n,-1);
+    std::vector<int> number(n,-1);
+    unsigned int nb = 0;
+    for (int vId=0; vId<n; vId++) {
+      if (parent[vId] < 0) continue;
+      int r = findComponent(parent,vId);
+      if (number[r] < 0) number[r] = static_cast<int>(nb++);
+      comp[vId] = number[r];
+    }
+    return nb;
+  }
+
+  void
+  QSpaceInfo::componentSignature(const std::vector<int>& comp, int c, std::vector<int>& sig) const {
+    const std::vector<LkBinderVarObj>& lk = sharedInfo.linkIdVars();
+    const std::vector< std::vector<int> >& links = sharedInfo.links();
+    const std::vector< std::vector<int> >& varLinks = sharedInfo.varLinks();
+    std::vector<int> touched;
+    sig.clear();
+    // The variables of the component with their domains
+    for (std::vector<int>::size_type vId=0; vId<comp.size(); vId++) {
+      if (comp[vId] != c) continue;
+      sig.push_back(static_cast<int>(vId));
+      if (lk[vId].type == LkBinderVarObj::BOOL) {
+        sig.push_back(1);
+        sig.push_back(_boolVars[lk[vId].id].min());
+        sig.push_back(_boolVars[lk[vId].id].max());
+      } else {
+        std::vector<int>::size_type n = sig.size();
+        sig.push_back(0);
+        for (IntVarRanges r(_intVars[lk[vId].id]); r(); ++r) {
+          sig.push_back(r.min());
+          sig.push_back(r.max());
+          sig[n]++;
+        }
+      }
+      if (vId < varLinks.size())
+        touched.insert(touched.end(),varLinks[vId].begin(),varLinks[vId].end());
+    }
+    // The constraints linking the component to the assigned variables with their values
+    std::sort(touched.begin(),touched.end());
+    touched.erase(std::unique(touched.begin(),touched.end()),touched.end());
+    sig.push_back(-1);
+    for (std::vector<int>::size_type l=0; l<touched.size(); l++) {
+      sig.push_back(touched[l]);
+      const std::vector<int>& vIds = links[touched[l]];
+      for (std::vector<int>::size_type i=0; i<vIds.size(); i++) {
+        if (comp[vIds[i]] == c) continue;
+        assert(varAssigned(vIds[i]));
+        if (lk[vIds[i]].type == LkBinderVarObj::BOOL)
+          sig.push_back(_boolVars[lk[vIds[i]].id].val());
+        else
+          sig.push_back(_intVars[lk[vIds[i]].id].val());
+      }
+    }
+  }
+
+  void
+  QSpaceInfo::assume(Home home, unsigned int vId, int min, int max) {
+    assert(trackedVariables());
+    if (vId >= branchedVariables())
+      throw Int::OutOfLimits("QSpaceInfo::assume");
+    const LkBinderVarObj& lk = sharedInfo.linkIdVars()[vId];
+    if (lk.type == LkBinderVarObj::BOOL)
+      dom(home, _boolVars[lk.id], min, max);
+    else
+      dom(home, _intVars[lk.id], min, max);
+  }
+
+  void
+  QSpaceInfo::learnHistory(const QSpaceInfo& s) {
+    sharedInfo.history() = s.sharedInfo.history();
+    sharedInfo.history().reset();
+  }
+
 }
@@ -36,8 +36,14 @@
 #ifndef __GECODE_QSPACEINFO_HH__
 #define __GECODE_QSPACEINFO_HH__
 
+#include <climits>
+#include <cstddef>
 #include <iomanip>
+#include <map>
 #include <quacode/qcsp.hh>
+#include <quacode/support/profile.hh>
+#include <quacode/support/tracer.hh>
+#include <unordered_map>
 #include <vector>
 
 namespace Gecode {
@@ -50,6 +56,8 @@ namespace Gecode {
     static const unsigned int DYNAMIC     = 2; ///< Select strategy to dynamic instead of static, if not possible the strategy will be not built
     static const unsigned int FAILTHROUGH = 4; ///< If static (not dynamic) strategy is selected but not possible, we go to dynamic strategy, but it may crashes because of lack of memory
     static const unsigned int EXPAND      = 8; ///< Expand all choices of solver (takes more computing time)
+    static const unsigned int MINIMIZE    = 16; ///< Minimize the strategy when the search ends
+    static const unsigned int AUTO        = 32; ///< Select static or dynamic strategy according to its worst case size and the memory budget (not set by default)
   };
   /// The value of the methode used to build the winning strategy
   typedef unsigned int StrategyMethod;
@@ -79,6 +87,8 @@ namespace Gecode {
           virtual PropCost cost(const Space& home, const ModEventDelta& med) const;
           /// Perform propagation
           virtual ExecStatus propagate(Space& home, const ModEventDelta& med);
+          /// Propagation itself, profiled by propagate
+          ExecStatus doPropagate(Space& home, const ModEventDelta& med);
           /// Post watch constraint for x0
           static ExecStatus post(Home home, View x0, View x1, unsigned int _x0Size);
       };
@@ -87,6 +97,7 @@ namespace Gecode {
   class DynamicStrategy;
   class DynamicExpandStrategy;
   class StrategyExplore;
+  class StrategyChecker;
 
   // A strategy corresponds to a way to store values of variable with order.
   // For example, a binder VxEyFz with x in {0,1,2} y in {-1,1} and z in {3,4} will
@@ -111,23 +122,30 @@ namespace Gecode {
     static const unsigned int FAILURE = 3;
 
   protected:
-    union Box { // A box of an array is either a variable id, either a variable idx
+    // A box of an array is either a variable id, either a value, either a link
+    // to the next block. Each box is packed in 64 bits, flags are stored in tag bits.
+    // Values are delta-encoded against the minimum of the domain of the variable:
+    // we store inf - min and sup - inf, so singleton values (the common case) get
+    // a zero width. A value whose width doesn't fit in 31 bits (only possible for
+    // a domain spanning 2^31 values or more) is escaped: its width field is WIDE
+    // and its inf field is the index of the value in wideValues.
+    // A link to a new block uses two boxes: a variable box with the needNewBlock tag
+    // (its id field stores the size of the new block) followed by a box storing the
+    // pointer to the new block.
+    union Box {
       struct {
-        int id; // Id of variable
-        unsigned int nbAlt; // Number of explored boxes of the variable
-        bool needNewBlock; // Flag to know if the variable will be stored in a new linked block
-                           // Useful only for dynamic strategy
+        int id; // Id of variable (or size of next block if needNewBlock is set)
+        unsigned int nbAlt : 31; // Number of explored boxes of the variable
+        unsigned int needNewBlock : 1; // Flag to know if the variable will be stored in a new linked block
+                                       // Useful only for dynamic strategy
       } var;
       struct {
-        int inf; // The inf value of a variable
-        int sup; // The sup value of a variable
-        bool leaf; // Flag to know if box is a leaf or not
+        unsigned int inf; // The inf value of a variable minus the min of its domain
+        unsigned int width : 31; // The sup value of a variable minus its inf value
+        unsigned int leaf : 1; // Flag to know if box is a leaf or not
       } val;
-      struct {
-        Box* ptr; // Ptr to next linked block of strategy
-                  // Useful only for dynamic strategy
-        unsigned int size; // Size of next block
-      } nextBlock;
+      Box* nextBlock; // Ptr to next linked block of strategy
+                      // Useful only for dynamic strategy
     };
 
     // Element of the current branch tree
@@ -150,6 +168,14 @@ namespace Gecode {
 
     Box* bx; /// Array of boxes of the strategy
     std::vector<unsigned int> domSize; // Size of domain of each variable
+    std::vector<int> domMin; // Min of domain of each variable (used to delta-encode values)
+    std::vector<int> domMax; // Max of domain of each variable
+    std::vector<TQuantifier> domQuant; // Quantifier of each variable
+    static const unsigned int WIDE = (1u << 31) - 1; // Width of an escaped value
+    std::vector< std::pair<int,int> > wideValues; // Escaped values, each one is stored once
+    std::map< std::pair<int,int>, unsigned int > wideIndex; // Index of each escaped value in wideValues
+    std::size_t memoryBudget; // Maximum memory (in bytes) used by the strategy, 0 if unlimited
+    bool bOverBudget; // True if the strategy has been dropped because of the memory budget
     std::vector<int> idxInCurBranch; // Index of variable in current branch tree
     unsigned int strategyTotalSize; // Size of all the strategy
     Box* cur; /// Current pointed box of the strategy
@@ -176,6 +202,27 @@ namespace Gecode {
     // Make the last value added to be a leaf
     void makeLeaf(void);
 
+    // Store value [ \a vInf , \a vSup ] of variable \a vId in box \a b
+    void valSet(Box& b, int vId, int vInf, int vSup);
+    // Return the index of the escaped value [ \a vInf , \a vSup ] in wideValues
+    unsigned int wideValue(int vInf, int vSup);
+    // Return the inf value of variable \a vId stored in box \a b
+    int valInf(const Box& b, int vId) const;
+    // Return the sup value of variable \a vId stored in box \a b
+    int valSup(const Box& b, int vId) const;
+    // Return the size of the block pointed by bx
+    virtual unsigned int firstBlockSize(void) const { return strategyTotalSize; }
+    // Return the size of a node of a variable with \a d values and sub-strategies
+    // of size \a below, i.e. 1 + d * (1 + below), saturated to UINT_MAX
+    static unsigned int nodeSize(unsigned int d, unsigned int below);
+
+    // Return true if the sub-strategies rooted at \a p (remaining size \a sp)
+    // and at \a q (remaining size \a sq) are the same
+    bool sameSubtree(const Box* p, unsigned int sp, const Box* q, unsigned int sq) const;
+    // Minimize the sub-strategy rooted at \a p of remaining size \a size.
+    // Return true if the node is a don't-care node which can be removed.
+    bool minimize(Box* p, unsigned int size);
+
     // Copy constructor
     Strategy(const Strategy& s);
   public:
@@ -187,13 +234,23 @@ namespace Gecode {
     // Copy current dynamic strategy
     virtual Strategy* copy(void) const { return new Strategy(*this); }
 
-    // Add new variable to the strategy
-    void add(unsigned int id, unsigned int size);
+    // Add new variable to the strategy, quantified by \a q, with domain
+    // of size \a size included in [ \a min , \a max ]
+    void add(unsigned int id, TQuantifier q, unsigned int size, int min, int max);
     // Build vector of boxes, assumes that modeling is ended
     QUACODE_EXPORT virtual bool strategyInit();
     /// Clear all data of the current strategy (used when search algorithm resets as well)
     QUACODE_EXPORT virtual void strategyReset();
 
+    /// Return the memory (in bytes) needed by the strategy in the worst case
+    QUACODE_EXPORT double worstCaseMemory(void) const;
+    /// Return the memory (in bytes) currently allocated by the strategy
+    virtual std::size_t memory(void) const { return allocated() ? strategyTotalSize * sizeof(Box) : 0; }
+    /// Set the memory budget (in bytes) of the strategy, 0 if unlimited
+    void budget(std::size_t b) { memoryBudget = b; }
+    /// Return true if the strategy has been dropped because of the memory budget
+    bool overBudget(void) const { return bOverBudget; }
+
     // Return current depth of strategy
     int depth(void) const { return curDepth; }
     // Return true if strategy has ever been allocated
@@ -211,6 +268,16 @@ namespace Gecode {
 
     // Print current strategy
     QUACODE_EXPORT virtual void print(std::ostream& os) const;
+    /// Minimize the recorded strategy: values of a universal variable leading to
+    /// the same sub-strategy are merged in ranges and don't-care choices are removed.
+    /// The strategy must not be updated anymore after minimization.
+    QUACODE_EXPORT void minimize(void);
+    /// Write the boxes and the current branch to \a os, return false
+    /// if the strategy can't be saved
+    QUACODE_EXPORT virtual bool save(std::ostream& os) const;
+    /// Read the state written by save from \a is, the strategy must have
+    /// been allocated for the same model. Return false on error
+    QUACODE_EXPORT virtual bool load(std::istream& is);
   };
 
   // This is an expanded strategy. It is based on a static strategy where all choices
@@ -259,6 +326,15 @@ namespace Gecode {
   protected:
     // Size of the first block (the one pointed by the bx member)
     unsigned int bxBlockSize;
+    // Number of allocated blocks (without the first one)
+    unsigned int nbBlocks;
+    // Return the size of the block pointed by bx
+    virtual unsigned int firstBlockSize(void) const { return bxBlockSize; }
+    // Allocate a new block of \a size boxes. Return NULL and drop the
+    // strategy if the memory budget is exceeded
+    Box* newBlock(unsigned int size);
+    // Free the block \a b
+    void deleteBlock(Box* b);
 
     // Convert constructor
     DynamicStrategy(const Strategy& s);
@@ -284,6 +360,12 @@ namespace Gecode {
 
     // Copy current dynamic strategy
     virtual DynamicStrategy* copy(void) const { return new DynamicStrategy(*this); }
+    // The linked blocks of a dynamic strategy are not saved
+    virtual bool save(std::ostream&) const { return false; }
+    virtual bool load(std::istream&) { return false; }
+    /// Return the memory (in bytes) currently allocated by the strategy, counting
+    /// the linked blocks at their maximal size as the budget does
+    virtual std::size_t memory(void) const { return allocated() ? (static_cast<std::size_t>(nbBlocks) * sMaxBlockMemory + bxBlockSize) * sizeof(Box) : 0; }
 
     // Build vector of boxes, assumes that modeling is ended
     QUACODE_EXPORT virtual bool strategyInit();
@@ -348,16 +430,26 @@ namespace Gecode {
      */
     class StrategyExplore {
     private:
+      /// Node of the strategy: box of the variable and remaining size of its block
+      struct Node {
+        Strategy::Box* p;
+        unsigned int size;
+        Node(Strategy::Box* _p, unsigned int _s) : p(_p), size(_s) {}
+      };
       /// current strategy
       const Strategy& s;
       /// Stack of nodes to keep trace of parent
-      std::vector<Strategy::Box*> backStack;
+      std::vector<Node> backStack;
+      /// Push node \a p with remaining block size \a size (follow links to new blocks)
+      void push(Strategy::Box* p, unsigned int size);
+      /// Return the size below each value of the current node
+      unsigned int sizeBelow(void) const;
     public:
       /// Initialize
       StrategyExplore(const Strategy& s);
       /// Test whether there nodes left (not on a leaf)
       bool operator ()(void) const;
-      /// Move iterator to next node below (take the value of the edge)
+      /// Move iterator to next node below, following the edge which contains value \a vEdge
       void operator ++(int vEdge);
       /// Move iterator to node upside (the parent)
       void operator --(void);
@@ -365,14 +457,93 @@ namespace Gecode {
       unsigned int variableId(void) const;
       /// Return the number of values below the current node (i.e. the number of edges)
       unsigned int nbValues(void) const;
-      /// Return the value of i^th edge of current node
+      /// Return the value of i^th edge of current node (the inf value if the edge is a range)
       int value(unsigned int ith) const;
+      /// Return the sup value of i^th edge of current node
+      int valueSup(unsigned int ith) const;
     };
 
+  /**
+   * \brief History of the search used to order variables and values
+   *
+   * The history follows the choices of the search (as the strategy does).
+   *
+   * A universal value is a refutation when the existential player has no
+   * winning choice below it: the search backtracks above it to the last
+   * existential choice. The score of every universal value left by such a
+   * backtrack is bumped, so the values that refuted the recent existential
+   * choices are tried first by the universal branchers (see
+   * QSpaceInfo::refutationOrder).
+   *
+   * On each failure, the activity of the variables of the last round of the
+   * game (the last universal choice and the existential choices below it) is
+   * bumped, as VSIDS does for the variables of a conflict. The branchers
+   * following the activity order pick the most active variable of their
+   * block first (see QSpaceInfo::activityOrder).
+   *
+   * Scores and activities decay over time and are kept when the search
+   * restarts (see QSpaceInfo::strategyReset).
+   */
+  class BranchHistory {
+  private:
+    /// Choice of the current branch
+    struct Choice {
+      int vId;         ///< Id of the variable
+      int val;         ///< Value of the variable (if assigned)
+      bool universal;  ///< Whether the variable is universal
+      bool assigned;   ///< Whether the choice assigned the variable
+      Choice(int _v, bool _u) : vId(_v), val(0), universal(_u), assigned(false) {}
+    };
+    /// Factor applied to the scores after each refutation and to the activities after each failure
+    static const double decay;
+    /// Current branch
+    std::vector<Choice> branch;
+    /// Score of each value, indexed by variable id and value
+    std::unordered_map<unsigned long long,double> scores;
+    /// Bump given to the next refuted values
+    double bump;
+    /// Activity of each variable, indexed by variable id
+    std::vector<double> activities;
+    /// Bump given to the variables of the next failure
+    double activityBump;
+    /// Last recorded event (values of Strategy)
+    unsigned int lastEvent;
+    /// Return the key of value \a val of variable \a vId
+    static unsigned long long key(int vId, int val);
+    /// Return the index in the current branch of the choice on \a vId, -1 if none
+    int find(int vId) const;
+    /// Bump the universal values of the current branch from index \a k
+    void refute(int k);
+    /// Bump the variables of the last round of the current branch
+    void conflict(void);
+  public:
+    /// Constructor
+    BranchHistory(void);
+
+    /// Record a new choice for variable \a vId (universal if \a u) with value [ \a vInf , \a vSup ]
+    void choice(int vId, bool u, int vInf, int vSup);
+    /// Called when a successful scenario was found
+    void success(void);
+    /// Called when a failed scenario was found
+    void failed(void);
+    /// Forget the current branch (the scores and activities are kept)
+    void reset(void);
+
+    /// Return the score of value \a val of variable \a vId
+    double score(int vId, int val) const;
+    /// Return the value of \a x (variable \a vId) with the best score, the smallest one on ties
+    int value(int vId, IntVar x) const;
+    /// Return the value of \a x (variable \a vId) with the best score, the smallest one on ties
+    int value(int vId, BoolVar x) const;
+    /// Return the activity of variable \a vId
+    double activity(int vId) const;
+  };
+
 
   class QSpaceInfo {
   friend class StaticExpandStrategy;
   friend class DynamicExpandStrategy;
+  friend class StrategyChecker;
   template<class View> friend class ::Gecode::Int::Watch;
   /// Data structure to store link between id of variable in the binder
   /// and the Gecode object (index of IntVar or BoolVar in the array of variables)
@@ -392,14 +563,29 @@ namespace Gecode {
         TQuantifier quantifier; // Brancher quantifier
         unsigned int offset; // Brancher offset (number of variables before it)
         unsigned int size; // Brancher size (number of variables in brancher)
-        QBI(void) : quantifier(EXISTS), offset(0), size(0) {}
+        BoolBranchFilter bbf; // Filter given to a boolean brancher restricted to components
+        IntBranchFilter ibf; // Filter given to an integer brancher restricted to components
+        QBI(void) : quantifier(EXISTS), offset(0), size(0), bbf(NULL), ibf(NULL) {}
         QBI(TQuantifier _q, unsigned int _o, unsigned int _s)
-           : quantifier(_q), offset(_o), size(_s) {}
+           : quantifier(_q), offset(_o), size(_s), bbf(NULL), ibf(NULL) {}
       };
 
       std::vector<LkBinderVarObj> _linkIdVars; // Link between id variable in strategy and Gecode object
       std::vector<QBI> v; // Vector of data information about branchers
       Strategy* s; // Current strategy
+      std::size_t memoryBudget; // Memory budget of the strategy (in bytes), 0 if unlimited
+      BranchHistory h; // History of the search (refutations and activities)
+      std::vector< std::vector<int> > _links; // Variables linked by each constraint (see QSpaceInfo::link)
+      std::vector< std::vector<int> > _varLinks; // Constraints linking each variable
+      bool _unbranchedLinks; // True if a constraint links a variable which is not branched
+      bool _replay; // True while a saved path is replayed (see QSpaceInfo::replay)
+      int _replayedId; // Variable of the last choice printed while replaying (-1 if none)
+      int _replayedInf; // Inf value of the last choice printed while replaying
+      int _replayedSup; // Sup value of the last choice printed while replaying
+      uint64_t _fingerprint; // Hash of the branchers and of the initial domains of their variables
+
+      // Replace the current strategy by the dynamic one corresponding to method \a sm
+      void toDynamic(StrategyMethod sm);
 
       // Copy constructor
       QSpaceSharedInfoO(const QSpaceSharedInfoO&);
@@ -416,6 +602,8 @@ namespace Gecode {
       forceinline TQuantifier brancherQuantifier(unsigned int id) const { return v[id-1].quantifier; }
       /// Return the offset computed when the brancher \a bh was added
       forceinline unsigned int brancherOffset(const unsigned int id) const { return v[id-1].offset; }
+      /// Return the quantifier of the variable \a vId
+      TQuantifier varQuantifier(unsigned int vId) const;
       // Return the last id of brancher stored in Shared Info.
       // Return 0 if no brancher recorded.
       forceinline int getLastBrancherId(void) const { return v.size(); }
@@ -426,6 +614,21 @@ namespace Gecode {
       void strategyReset(void);
       /// Print the current strategy
       void strategyPrint(std::ostream& os) const;
+      /// Minimize the current strategy
+      void strategyMinimize(void);
+      /// Write the current strategy to \a os
+      void strategySave(std::ostream& os) const;
+      /// Read the strategy written by strategySave from \a is, drop the
+      /// strategy and return false if it can't be restored
+      bool strategyLoad(std::istream& is);
+      /// Set the memory budget (in bytes) of the strategy, 0 if unlimited
+      void strategyMemoryBudget(std::size_t b);
+      /// Return the memory budget (in bytes) of the strategy
+      std::size_t strategyMemoryBudget(void) const;
+      /// Return the memory (in bytes) needed by the strategy in the worst case
+      double strategyWorstCaseMemory(void) const;
+      /// Return the memory (in bytes) currently allocated by the strategy
+      std::size_t strategyMemory(void) const;
       /// Called when a failed scenario was found
       void scenarioFailed(void);
       /// Called when a successful scenario was found
@@ -433,10 +636,41 @@ namespace Gecode {
       /// Record a new choice event in the scenario, for brancher id \a id,
       /// variable position \a pos and value [ \a vInf , \a vSup ]
       void scenarioChoice(unsigned int id, int pos, int vInf, int vSup);
+      /// Return the history of the search
+      BranchHistory& history(void);
+      /// Set whether a saved path is replayed
+      void replay(bool b);
+      /// Return true if a saved path is replayed
+      bool replay(void) const;
+      /// Record the choice printed while replaying, for brancher id \a id,
+      /// variable position \a pos and value [ \a vInf , \a vSup ]
+      void replayed(unsigned int id, int pos, int vInf, int vSup);
+      /// Return the last choice printed while replaying
+      void replayed(int& vId, int& vInf, int& vSup) const;
+      /// Set the filter \a f of the boolean brancher \a id
+      void filter(unsigned int id, BoolBranchFilter f);
+      /// Set the filter \a f of the integer brancher \a id
+      void filter(unsigned int id, IntBranchFilter f);
+      /// Return true if the filter of the brancher \a id accepts the variable \a x at position \a pos
+      bool filter(const Space& home, unsigned int id, BoolVar x, int pos) const;
+      /// Return true if the filter of the brancher \a id accepts the variable \a x at position \a pos
+      bool filter(const Space& home, unsigned int id, IntVar x, int pos) const;
+      /// Record a constraint linking the variables \a vIds
+      void link(const std::vector<int>& vIds);
+      /// Return the variables linked by each constraint
+      const std::vector< std::vector<int> >& links(void) const;
+      /// Return the constraints linking each variable
+      const std::vector< std::vector<int> >& varLinks(void) const;
+      /// Record a constraint linking a variable which is not branched
+      void linkUnbranched(void);
+      /// Return true if a constraint links a variable which is not branched
+      bool unbranchedLinks(void) const;
 
       // Return the vector of link between the id of variable in the binder and the
       // id of the same variable in its specific data structure
       const std::vector<LkBinderVarObj>& linkIdVars(void) const;
+      /// Return the fingerprint of the model
+      uint64_t fingerprint(void) const;
     };
 
     class QSpaceSharedInfo : public SharedHandle {
@@ -456,12 +690,28 @@ namespace Gecode {
         TQuantifier brancherQuantifier(unsigned int id) const;
         /// Return the offset computed when the brancher \a id was added
         unsigned int brancherOffset(unsigned int id) const;
+        /// Return the quantifier of the variable \a vId
+        TQuantifier varQuantifier(unsigned int vId) const;
         /// Initialize data structures of strategy, may return another method if strategy can't be allocated with given method
         StrategyMethod strategyInit(StrategyMethod sm);
         /// Clear all data of the current strategy (used when search algorithm resets as well)
         void strategyReset(void);
         /// Print the current strategy
         void strategyPrint(std::ostream& os) const;
+        /// Minimize the current strategy
+        void strategyMinimize(void);
+        /// Write the current strategy to \a os
+        void strategySave(std::ostream& os) const;
+        /// Read the strategy written by strategySave from \a is
+        bool strategyLoad(std::istream& is);
+        /// Set the memory budget (in bytes) of the strategy, 0 if unlimited
+        void strategyMemoryBudget(std::size_t b);
+        /// Return the memory budget (in bytes) of the strategy
+        std::size_t strategyMemoryBudget(void) const;
+        /// Return the memory (in bytes) needed by the strategy in the worst case
+        double strategyWorstCaseMemory(void) const;
+        /// Return the memory (in bytes) currently allocated by the strategy
+        std::size_t strategyMemory(void) const;
         /// Called when a failed scenario was found
         void scenarioFailed(void);
         /// Called when no strategy has been found (failed problem)
@@ -470,6 +720,32 @@ namespace Gecode {
         // Record a new choice event in the strategy, for brancher id \a id,
         // variable position \a pos and value [ \a vInf , \a vSup ]
         void scenarioChoice(unsigned int id, int pos, int vInf, int vSup);
+        /// Set whether a saved path is replayed
+        void replay(bool b);
+        /// Return true if a saved path is replayed
+        bool replay(void) const;
+        /// Record the choice printed while replaying
+        void replayed(unsigned int id, int pos, int vInf, int vSup);
+        /// Return the last choice printed while replaying
+        void replayed(int& vId, int& vInf, int& vSup) const;
+        /// Return the history of the search
+        BranchHistory& history(void) const;
+        /// Set the filter \a f of the brancher \a id
+        void filter(unsigned int id, BoolBranchFilter f);
+        void filter(unsigned int id, IntBranchFilter f);
+        /// Return true if the filter of the brancher \a id accepts the variable \a x at position \a pos
+        bool filter(const Space& home, unsigned int id, BoolVar x, int pos) const;
+        bool filter(const Space& home, unsigned int id, IntVar x, int pos) const;
+        /// Record a constraint linking the variables \a vIds
+        void link(const std::vector<int>& vIds);
+        /// Return the variables linked by each constraint
+        const std::vector< std::vector<int> >& links(void) const;
+        /// Return the constraints linking each variable
+        const std::vector< std::vector<int> >& varLinks(void) const;
+        /// Record a constraint linking a variable which is not branched
+        void linkUnbranched(void);
+        /// Return true if a constraint links a variable which is not branched
+        bool unbranchedLinks(void) const;
 
         // Return the last id of brancher stored in Shared Info.
         // Return -1 if not brancher recorded.
@@ -477,12 +753,46 @@ namespace Gecode {
         // Return the vector of link between the id of variable in the binder and the
         // id of the same variable in its specific data structure
         const std::vector<LkBinderVarObj>& linkIdVars(void) const;
+        /// Return the fingerprint of the model
+        uint64_t fingerprint(void) const;
     };
 
     /// Wrapper function to record choice in scenario
     static void scenarioChoice(const Space &home, unsigned int a, BoolVar x, int i, const int& n, std::ostream& );
     static void scenarioChoice(const Space &home, unsigned int a, IntVar x, int i, const int& n, std::ostream& );
 
+    /// Number of branchers which can follow the refutation or the activity order
+    static const unsigned int orderedBranchers = 128;
+    /// Table of the value and merit functions of the orders, one per brancher id
+    template<unsigned int id> struct BrancherTable;
+    /// Value function of the refutation order for the brancher \a id
+    template<class VarType, unsigned int id>
+    static int refutationValue(const Space& home, VarType x, int pos);
+    /// Return the value function of the refutation order for the integer brancher \a id
+    static IntBranchVal refutationIntValue(unsigned int id);
+    /// Return the value function of the refutation order for the boolean brancher \a id
+    static BoolBranchVal refutationBoolValue(unsigned int id);
+    /// Merit function of the activity order for the brancher \a id
+    template<class VarType, unsigned int id>
+    static double activityMerit(const Space& home, VarType x, int pos);
+    /// Return the merit function of the activity order for the integer brancher \a id
+    static IntBranchMerit activityIntMerit(unsigned int id);
+    /// Return the merit function of the activity order for the boolean brancher \a id
+    static BoolBranchMerit activityBoolMerit(unsigned int id);
+    /// Filter function restricting the brancher \a id to the current component
+    template<class VarType, unsigned int id>
+    static bool componentFilter(const Space& home, VarType x, int pos);
+    /// Return the component filter function for the integer brancher \a id
+    static IntBranchFilter componentIntFilter(unsigned int id);
+    /// Return the component filter function for the boolean brancher \a id
+    static BoolBranchFilter componentBoolFilter(unsigned int id);
+    /// Post the brancher of block \a x
+    template<class BranchType>
+    static void branchBlock(Home home, const BoolVarArgs& x, BranchType vars, IntValBranch vals, BoolBranchFilter bf, BoolVarValPrint vvp);
+    /// Post the brancher of block \a x
+    template<class BranchType>
+    static void branchBlock(Home home, const IntVarArgs& x, BranchType vars, IntValBranch vals, IntBranchFilter bf, IntVarValPrint vvp);
+
     /// The following arrays are not maintained during cloning !!!
     /// Only meaningful during modeling
     IntVarArgs _watchedIntVariables;
@@ -495,12 +805,22 @@ namespace Gecode {
     /// Return the corresponding unWatched variable if founded, NULL otherwise.
     /// If Null is returned, it means that the variable isn't universally quantified.
     IntVar* unWatched(IntVar x);
+    /// Id in the binder of the branched variables (watched and unwatched ones)
+    std::unordered_map<const void*,int> _varIds;
 
     /// Shared information among all spaces
     QSpaceSharedInfo sharedInfo;
 
     /// Boolean flag to know if we have to record the winning strategy
     bool bRecordStrategy;
+    /// Boolean flag to know if the universal values follow the refutation order
+    bool bRefutationOrder;
+    /// Boolean flag to know if the variables of a block follow the activity order
+    bool bActivityOrder;
+    /// Boolean flag to know if a posted brancher follows the history of the search
+    bool bHistory;
+    /// Return true if the history of the search is needed
+    bool historyNeeded(void) const;
     /// The current strategy method to use during search
     StrategyMethod curStrategyMethod;
 
@@ -511,6 +831,21 @@ namespace Gecode {
     /// Remove a watch constraint of space
     void delWatchConstraint(void);
 
+    /// Boolean flag to know if the arrays of branched variables are maintained
+    /// during cloning (always the case with StrategyMethodValues::EXPAND)
+    bool bTrackVariables;
+    /// Return true if the arrays of branched variables are maintained during cloning
+    bool trackedVariables(void) const;
+
+    /// Boolean flag to know if the search decomposes the problem into components
+    bool bComponents;
+    /// Number of branchers restricted to the current component
+    unsigned int nbComponentBranchers;
+    /// Variables of the current component (NULL if the branchers are not restricted)
+    const std::vector<char>* _component;
+    /// Return true if the variable \a vId is assigned
+    bool varAssigned(int vId) const;
+
     /// Array of all boolean variables to branch with
     BoolVarArray _boolVars;
     /// Array of all integer variables to branch with
@@ -537,6 +872,80 @@ namespace Gecode {
     unsigned int brancherOffset(unsigned int id) const;
     /// Return the number of recorded watch constraints in space
     unsigned int watchConstraints(void) const;
+    /// Return the number of branched variables, their ids in the binder start from 0
+    unsigned int branchedVariables(void) const;
+    /// Return a fingerprint of the model: a hash of the quantifier, the type and
+    /// the size of the branchers and of the domains of their variables when they
+    /// were branched. It is the same for all the spaces sharing the model.
+    uint64_t fingerprint(void) const;
+    /// Return the quantifier of the branched variable \a vId.
+    /// Throws Int::OutOfLimits if \a vId is not a branched variable.
+    TQuantifier varQuantifier(unsigned int vId) const;
+    /// Restrict the branched variable \a vId to [\a min, \a max], for a universal
+    /// variable its unwatched variable is restricted. The branched variables
+    /// have to be maintained during cloning (see trackVariables).
+    /// Throws Int::OutOfLimits if \a vId is not a branched variable.
+    QUACODE_EXPORT void assume(Home home, unsigned int vId, int min, int max);
+    /// Take over the history of the search of \a s, a space sharing the model of
+    /// this one, so that the next searches from this space follow it
+    QUACODE_EXPORT void learnHistory(const QSpaceInfo& s);
+    /// Maintain (or not) the branched variables during cloning. It is needed
+    /// to replay a strategy on clones of this space (see StrategyChecker).
+    void trackVariables(bool b);
+    /// Replay (or not) a saved path. While it is replayed, the choices of the
+    /// spaces sharing this model only update the history of the search, the
+    /// strategy and the trace are left as they are (see Support::Checkpoint).
+    void replay(bool b);
+    /// Return in \a vId the branched variable of the last choice printed while
+    /// a path is replayed and in [ \a vInf , \a vSup ] its value after the
+    /// commit, as the strategy would record it. \a vId is -1 if no choice of a
+    /// quantified brancher has been printed since replay(true) was called.
+    void replayed(int& vId, int& vInf, int& vSup) const;
+    /// Order the values of the next universal branchers by their refutations (or not).
+    /// A universal brancher following the refutation order tries first the values which
+    /// recently left its existential player without winning choice (see BranchHistory),
+    /// the \a vals given to branch are then only used for the existential branchers.
+    /// It is only meaningful with the QDFS search engine.
+    void refutationOrder(bool b);
+    /// Return true if the next universal branchers follow the refutation order
+    bool refutationOrder(void) const;
+    /// Order the variables of the next blocks by their activity (or not). A block
+    /// following the activity order picks first its variable with the highest
+    /// activity, bumped on failures (see BranchHistory). The order of the blocks is
+    /// kept, the \a vars given to branch are then ignored.
+    /// It is only meaningful with the QDFS search engine.
+    void activityOrder(bool b);
+    /// Return true if the variables of the next blocks follow the activity order
+    bool activityOrder(void) const;
+    /// Decompose (or not) the problem into independent components during search.
+    /// The components are computed from the constraints declared with link, so
+    /// every constraint posted on more than one branched variable has to be declared.
+    /// The decomposition is not done while the winning strategy is recorded.
+    /// It is only meaningful with the QDFS search engine.
+    void componentDecomposition(bool b);
+    /// Return true if the problem is decomposed into independent components during search
+    bool componentDecomposition(void) const;
+    /// Declare a constraint posted on the variables \a x. The variables have to be
+    /// branched before. As the variables which are not branched (auxiliary ones)
+    /// may link components through other constraints, such a constraint
+    /// prevents the decomposition.
+    QUACODE_EXPORT void link(const BoolVarArgs& x);
+    /// Declare a constraint posted on the variables \a x. The variables have to be
+    /// branched before. As the variables which are not branched (auxiliary ones)
+    /// may link components through other constraints, such a constraint
+    /// prevents the decomposition.
+    QUACODE_EXPORT void link(const IntVarArgs& x);
+    /// Compute the components of the unassigned variables of the current component,
+    /// \a comp gives the component of each variable (-1 if it belongs to none).
+    /// Return the number of components, 0 if the problem can't be decomposed.
+    QUACODE_EXPORT unsigned int components(std::vector<int>& comp) const;
+    /// Compute in \a sig the signature of the component \a c: the domains of its
+    /// variables and the values of the variables of the constraints linking it
+    /// to the assigned part. Two components with the same signature have the same truth value.
+    QUACODE_EXPORT void componentSignature(const std::vector<int>& comp, int c, std::vector<int>& sig) const;
+    /// Restrict the branchers to the variables \a vId such that \a c[vId] is set
+    /// (all variables if \a c is NULL), \a c must outlive the space and its clones
+    void restrictComponent(const std::vector<char>* c);
 
     /// Return the quantifier of the given integer variable
     TQuantifier quantifier(IntVar x) { return (unWatched(x)?FORALL:EXISTS); };
@@ -547,6 +956,17 @@ namespace Gecode {
     StrategyMethod strategyMethod(void) const;
     /// Set the current method used to build strategy
     void strategyMethod(StrategyMethod sm);
+    /// Set the memory budget (in bytes) of the strategy, 0 if unlimited. With the
+    /// StrategyMethodValues::AUTO method, an unlimited budget stands for half of the
+    /// physical memory. A dynamic strategy exceeding its budget is dropped.
+    void strategyMemoryBudget(std::size_t b);
+    /// Return the memory budget (in bytes) of the strategy
+    std::size_t strategyMemoryBudget(void) const;
+    /// Return the memory (in bytes) needed by the strategy in the worst case,
+    /// it can be called once the modeling is ended
+    double strategyWorstCaseMemory(void) const;
+    /// Return the memory (in bytes) currently allocated by the strategy
+    std::size_t strategyMemory(void) const;
     /// Initialize data structures of strategy. If the current strategy method can't
     /// be used, it will update the strategy method value and returns it.
     StrategyMethod strategyInit();
@@ -554,6 +974,17 @@ namespace Gecode {
     void strategyReset();
     /// Print the current strategy
     void strategyPrint(std::ostream& os) const;
+    /// Minimize the current strategy (merge equivalent universal branches and remove
+    /// don't-care choices). Done at the end of the search if the strategy method
+    /// includes StrategyMethodValues::MINIMIZE.
+    void strategyMinimize(void);
+    /// Write the strategy built so far to \a os (used by the checkpoints of
+    /// the search). Only a static strategy is saved, a dynamic one is written as empty.
+    QUACODE_EXPORT void strategySave(std::ostream& os) const;
+    /// Restore the strategy written by strategySave from \a is. If it can't be
+    /// restored (dynamic or different strategy), the strategy is not built anymore
+    /// and false is returned.
+    QUACODE_EXPORT bool strategyLoad(std::istream& is);
     /// Called when no strategy has been found (failed problem)
     void strategyFailed();
     /// Called when a strategy has been found (satisfiable problem)
@@ -50,12 +50,12 @@ namespace Gecode {
 
   forceinline
   Strategy::Strategy()
-    : bx(NULL), strategyTotalSize(0), cur(NULL), curDepth(0), lastEvent(NONE)
+    : bx(NULL), memoryBudget(0), bOverBudget(false), strategyTotalSize(0), cur(NULL), curDepth(0), lastEvent(NONE)
   {}
 
   forceinline
   Strategy::Strategy(const Strategy& s)
-    : bx(NULL), domSize(s.domSize), idxInCurBranch(s.idxInCurBranch), strategyTotalSize(s.strategyTotalSize), cur(NULL), curBranch(s.curBranch), curDepth(s.curDepth), lastEvent(s.lastEvent) {
+    : bx(NULL), domSize(s.domSize), domMin(s.domMin), domMax(s.domMax), domQuant(s.domQuant), wideValues(s.wideValues), wideIndex(s.wideIndex), memoryBudget(s.memoryBudget), bOverBudget(s.bOverBudget), idxInCurBranch(s.idxInCurBranch), strategyTotalSize(s.strategyTotalSize), cur(NULL), curBranch(s.curBranch), curDepth(s.curDepth), lastEvent(s.lastEvent) {
       if (s.bx) {
         bx = new (std::nothrow) Box[strategyTotalSize];
         Box* p = bx;
@@ -66,6 +66,12 @@ namespace Gecode {
       }
     }
 
+  forceinline unsigned int
+  Strategy::nodeSize(unsigned int d, unsigned int below) {
+    unsigned long long int size = 1ULL + static_cast<unsigned long long int>(d) * (1ULL + below);
+    return (size >= UINT_MAX) ? UINT_MAX : static_cast<unsigned int>(size);
+  }
+
   forceinline
   Strategy::~Strategy() {
     if (bx) delete [] bx;
@@ -75,7 +81,32 @@ namespace Gecode {
 
   forceinline void
   Strategy::makeLeaf(void) {
-    if (curDepth) (cur - 1)->val.leaf = true;
+    if (curDepth) (cur - 1)->val.leaf = 1;
+  }
+
+  forceinline void
+  Strategy::valSet(Box& b, int vId, int vInf, int vSup) {
+    assert((vInf >= domMin[vId]) && (vInf <= vSup));
+    unsigned int width = static_cast<unsigned int>(vSup) - static_cast<unsigned int>(vInf);
+    if (width < WIDE) {
+      b.val.inf = static_cast<unsigned int>(vInf) - static_cast<unsigned int>(domMin[vId]);
+      b.val.width = width;
+    } else {
+      b.val.inf = wideValue(vInf,vSup);
+      b.val.width = WIDE;
+    }
+  }
+
+  forceinline int
+  Strategy::valInf(const Box& b, int vId) const {
+    if (b.val.width == WIDE) return wideValues[b.val.inf].first;
+    return static_cast<int>(static_cast<unsigned int>(domMin[vId]) + b.val.inf);
+  }
+
+  forceinline int
+  Strategy::valSup(const Box& b, int vId) const {
+    if (b.val.width == WIDE) return wideValues[b.val.inf].second;
+    return static_cast<int>(static_cast<unsigned int>(domMin[vId]) + b.val.inf + b.val.width);
   }
 
   forceinline void
@@ -106,21 +137,20 @@ namespace Gecode {
       sizeBelow = (sizeBelow - 1) / domSize[vId] - 1;
       idxInCurBranch[vId] = curDepth;
       (*cur).var.id = vId;
-      (*cur).var.needNewBlock = false;
+      (*cur).var.needNewBlock = 0;
       (*cur++).var.nbAlt = 1;
        curBranch[curDepth] = BPtr(vId,cur-1,sizeBelow);
     }
   }
 
   forceinline void
-  Strategy::addValue(int, int vInf, int vSup) {
+  Strategy::addValue(int vId, int vInf, int vSup) {
     BPtr& bPtr = curBranch[curDepth++];
     bPtr.vInf = vInf;
     bPtr.vSup = vSup;
     bPtr.ptrCur = cur;
-    (*cur).val.leaf = false;
-    (*cur).val.inf = vInf;
-    (*cur++).val.sup = vSup;
+    (*cur).val.leaf = 0;
+    valSet(*cur++,vId,vInf,vSup);
   }
 
   forceinline void
@@ -169,15 +199,14 @@ namespace Gecode {
     // Compute address of value of variable depending on the number of alternative
     if (bForce || ((*cur).var.id != vId)) {
       (*cur).var.id = vId;
-      (*cur).var.needNewBlock = false;
+      (*cur).var.needNewBlock = 0;
       (*cur++).var.nbAlt = 1;
-      (*cur).val.leaf = false;
-      (*cur).val.inf = vInf;
-      (*cur++).val.sup = vSup;
+      (*cur).val.leaf = 0;
+      valSet(*cur++,vId,vInf,vSup);
       bForce = true;
     } else {
       Box* ptrVal = cur + 1 + ((*cur).var.nbAlt - 1) * (1 + sizeBelow);
-      if (((*ptrVal).val.inf != vInf) || ((*ptrVal).val.sup != vSup)) {
+      if ((valInf(*ptrVal,vId) != vInf) || (valSup(*ptrVal,vId) != vSup)) {
         if ((*cur).var.nbAlt < domSize[vId]) {
           ptrVal +=  1 + sizeBelow;
           (*cur).var.nbAlt++;
@@ -186,9 +215,8 @@ namespace Gecode {
           (*cur).var.nbAlt = 1;
         }
         cur = ptrVal;
-        (*cur).val.leaf = false;
-        (*cur).val.inf = vInf;
-        (*cur++).val.sup = vSup;
+        (*cur).val.leaf = 0;
+        valSet(*cur++,vId,vInf,vSup);
         bForce = true;
       } else {
         // Its the same variable and value so we go next one
@@ -217,7 +245,7 @@ namespace Gecode {
         addValue(i,x.min(),x.max(),sizeBelow,bForce);
       }
     }
-    (cur - 1)->val.leaf = true; // Make last print to be a leaf
+    (cur - 1)->val.leaf = 1; // Make last print to be a leaf
     lastEvent = Strategy::SUCCESS;
   }
 
@@ -226,19 +254,37 @@ namespace Gecode {
 
   forceinline
   DynamicStrategy::DynamicStrategy()
-    : Strategy(), bxBlockSize(0) {}
+    : Strategy(), bxBlockSize(0), nbBlocks(0) {}
 
   forceinline
   DynamicStrategy::DynamicStrategy(const DynamicStrategy& s)
-    : Strategy(s), bxBlockSize(s.bxBlockSize) {
+    : Strategy(s), bxBlockSize(s.bxBlockSize), nbBlocks(s.nbBlocks) {
     }
 
   forceinline
   DynamicStrategy::DynamicStrategy(const Strategy& s)
-    : Strategy(s), bxBlockSize(0) {
+    : Strategy(s), bxBlockSize(0), nbBlocks(0) {
       assert(bx == NULL);
     }
 
+  forceinline Strategy::Box*
+  DynamicStrategy::newBlock(unsigned int size) {
+    // Blocks are never greater than sMaxBlockMemory boxes
+    if (memoryBudget &&
+        (((static_cast<std::size_t>(nbBlocks) + 1) * sMaxBlockMemory + bxBlockSize) * sizeof(Box) > memoryBudget)) {
+      bOverBudget = true;
+      return NULL;
+    }
+    nbBlocks++;
+    return new Box[size];
+  }
+
+  forceinline void
+  DynamicStrategy::deleteBlock(Box* b) {
+    nbBlocks--;
+    delete [] b;
+  }
+
   forceinline
   DynamicStrategy::~DynamicStrategy() {
     int i = curDepth;
@@ -246,7 +292,7 @@ namespace Gecode {
       if (!curBranch[i].blocks.empty()) {
         std::vector<Box*>::iterator it = curBranch[i].blocks.begin();
         std::vector<Box*>::iterator itEnd = curBranch[i].blocks.end();
-        for ( ; it != itEnd; ++it) delete [] *it;
+        for ( ; it != itEnd; ++it) deleteBlock(*it);
         curBranch[i].blocks.clear();
       }
       i--;
@@ -279,7 +325,7 @@ namespace Gecode {
       if (!curBranch[curDepth].blocks.empty()) {
         std::vector<Box*>::iterator it = curBranch[curDepth].blocks.begin();
         std::vector<Box*>::iterator itEnd = curBranch[curDepth].blocks.end();
-        for ( ; it != itEnd; ++it) delete [] *it;
+        for ( ; it != itEnd; ++it) deleteBlock(*it);
         curBranch[curDepth].blocks.clear();
       }
       curDepth--;
@@ -304,7 +350,7 @@ namespace Gecode {
         sizeBelow = 0;
         int k = domSize.size()-1;
         for (int i = k; i >= vId; i-- ) {
-          if (domSize[i] > 0) sizeBelow = 1 + domSize[i] * (1 + sizeBelow);
+          if (domSize[i] > 0) sizeBelow = nodeSize(domSize[i],sizeBelow);
         }
         k--;
 
@@ -320,15 +366,16 @@ namespace Gecode {
           allocatedBlockSize = 2; // We save space for writing the flag to know that we have to allocate a new block plus the ptr to the new block
           for (int i = k; i >= vId; i-- )
             if (domSize[i] > 0) {
-              sizeBelow = 1 + domSize[i] * (1 + sizeBelow);
-              allocatedBlockSize = 1 + domSize[i] * (1 + allocatedBlockSize);
+              sizeBelow = nodeSize(domSize[i],sizeBelow);
+              allocatedBlockSize = nodeSize(domSize[i],allocatedBlockSize);
             }
         }
-        newAllocatedBlock = new Box[allocatedBlockSize];
-        (*cur).var.id = -1;
-        (*cur++).var.needNewBlock = true;
-        (*cur).nextBlock.ptr = newAllocatedBlock;
-        (*cur).nextBlock.size = allocatedBlockSize;
+        newAllocatedBlock = newBlock(allocatedBlockSize);
+        if (newAllocatedBlock == NULL) return;
+        (*cur).var.id = static_cast<int>(allocatedBlockSize); // The flag box stores the size of the new block
+        (*cur).var.nbAlt = 0;
+        (*cur++).var.needNewBlock = 1;
+        (*cur).nextBlock = newAllocatedBlock;
         cur = newAllocatedBlock;
       }
 
@@ -336,7 +383,7 @@ namespace Gecode {
       allocatedBlockSize = (allocatedBlockSize - 1) / domSize[vId] - 1;
       idxInCurBranch[vId] = curDepth;
       (*cur).var.id = vId;
-      (*cur).var.needNewBlock = false;
+      (*cur).var.needNewBlock = 0;
       (*cur++).var.nbAlt = 1;
        curBranch[curDepth] = BPtr(vId,cur-1,sizeBelow,newAllocatedBlock,allocatedBlockSize);
     }
@@ -344,18 +391,21 @@ namespace Gecode {
 
   forceinline void
   DynamicStrategy::scenarioFailed(void) {
+    if (bOverBudget) return;
     lastEvent = Strategy::FAILURE;
     makeLeaf();
   }
 
   forceinline void
   DynamicStrategy::scenarioSuccess(const QSpaceInfo&) {
+    if (bOverBudget) return;
     lastEvent = Strategy::SUCCESS;
     makeLeaf();
   }
 
   forceinline void
   DynamicStrategy::scenarioChoice(int vId, int vInf, int vSup) {
+    if (bOverBudget) return;
     switch (lastEvent) {
       case Strategy::FAILURE:
         backtrackFromFailure(vId);
@@ -366,6 +416,7 @@ namespace Gecode {
       case Strategy::NONE:
       case Strategy::CHOICE:
           addVariable(vId);
+          if (bOverBudget) return;
         branching:
           lastEvent = Strategy::CHOICE;
           addValue(vId,vInf,vSup);
@@ -397,7 +448,7 @@ namespace Gecode {
       sizeBelow = 0;
       int k = domSize.size()-1;
       for (int i = k; i >= vId; i-- ) {
-        if (domSize[i] > 0) sizeBelow = 1 + domSize[i] * (1 + sizeBelow);
+        if (domSize[i] > 0) sizeBelow = nodeSize(domSize[i],sizeBelow);
       }
       k--;
 
@@ -413,20 +464,20 @@ namespace Gecode {
         allocatedBlockSizeBelow = 2; // We save space for writing the flag to know that we have to allocate a new block plus the ptr to the new block
         for (int i = k; i >= vId; i-- )
           if (domSize[i] > 0) {
-            sizeBelow = 1 + domSize[i] * (1 + sizeBelow);
-            allocatedBlockSizeBelow = 1 + domSize[i] * (1 + allocatedBlockSizeBelow);
+            sizeBelow = nodeSize(domSize[i],sizeBelow);
+            allocatedBlockSizeBelow = nodeSize(domSize[i],allocatedBlockSizeBelow);
           }
       }
-      Box* newAllocatedBlock = new Box[allocatedBlockSizeBelow];
+      Box* newAllocatedBlock = newBlock(allocatedBlockSizeBelow);
+      if (newAllocatedBlock == NULL) return;
       // We remember the new allocated block in the curBranch data structure to free it when
       // backtrack
       curBranch[vId].blocks.push_back(newAllocatedBlock);
       // Link new block to previous one
-      (*cur).var.id = -1;
+      (*cur).var.id = static_cast<int>(allocatedBlockSizeBelow); // The flag box stores the size of the new block
       (*cur).var.nbAlt = sizeBelow; // This block doesn't need the nbAlt field, so we use it to store sizeBelow
-      (*cur++).var.needNewBlock = true;
-      (*cur).nextBlock.ptr = newAllocatedBlock;
-      (*cur).nextBlock.size = allocatedBlockSizeBelow;
+      (*cur++).var.needNewBlock = 1;
+      (*cur).nextBlock = newAllocatedBlock;
       cur = newAllocatedBlock;
       bForce = true;
     }
@@ -437,15 +488,14 @@ namespace Gecode {
     if (bForce || ((*cur).var.id != vId)) {
       // Add the current value and variable
       (*cur).var.id = vId;
-      (*cur).var.needNewBlock = false;
+      (*cur).var.needNewBlock = 0;
       (*cur++).var.nbAlt = 1;
-      (*cur).val.leaf = false;
-      (*cur).val.inf = vInf;
-      (*cur++).val.sup = vSup;
+      (*cur).val.leaf = 0;
+      valSet(*cur++,vId,vInf,vSup);
       bForce = true;
     } else {
       Box* ptrVal = cur + 1 + ((*cur).var.nbAlt - 1) * (1 + allocatedBlockSizeBelow);
-      if (((*ptrVal).val.inf != vInf) || ((*ptrVal).val.sup != vSup)) {
+      if ((valInf(*ptrVal,vId) != vInf) || (valSup(*ptrVal,vId) != vSup)) {
         if ((*cur).var.nbAlt < domSize[vId]) {
           ptrVal +=  1 + allocatedBlockSizeBelow;
           (*cur).var.nbAlt++;
@@ -469,25 +519,24 @@ namespace Gecode {
             if (!curBranch[curDepth].blocks.empty()) {
               std::vector<Box*>::iterator it = curBranch[curDepth].blocks.begin();
               std::vector<Box*>::iterator itEnd = curBranch[curDepth].blocks.end();
-              for ( ; it != itEnd; ++it) delete [] *it;
+              for ( ; it != itEnd; ++it) deleteBlock(*it);
               curBranch[curDepth].blocks.clear();
             }
             curDepth--;
           }
         }
         cur = ptrVal;
-        (*cur).val.leaf = false;
-        (*cur).val.inf = vInf;
-        (*cur++).val.sup = vSup;
+        (*cur).val.leaf = 0;
+        valSet(*cur++,vId,vInf,vSup);
         bForce = true;
       } else {
         // Its the same variable and value so we go next one
         cur = ptrVal + 1;
         if (cur->var.needNewBlock) {
           sizeBelow = cur->var.nbAlt; // This block doesn't need the nbAlt field, so we use it to store sizeBelow
+          allocatedBlockSizeBelow = static_cast<unsigned int>(cur->var.id);
           cur++;
-          allocatedBlockSizeBelow = cur->nextBlock.size;
-          cur = cur->nextBlock.ptr;
+          cur = cur->nextBlock;
         }
       }
     }
@@ -498,6 +547,7 @@ namespace Gecode {
 
   forceinline void
   DynamicExpandStrategy::scenarioSuccess(const QSpaceInfo& qsi) {
+    if (bOverBudget) return;
     bool bForce = false;
     unsigned int sizeBelow = strategyTotalSize;
     unsigned int allocatedBlockSizeBelow = bxBlockSize;
@@ -512,17 +562,141 @@ namespace Gecode {
         const IntVar& x = qsi._intVars[_linkIdVars[i].id];
         addValue(i,x.min(),x.max(),sizeBelow,allocatedBlockSizeBelow,bForce);
       }
+      if (bOverBudget) return;
     }
-    (cur - 1)->val.leaf = true; // Make last print to be a leaf
+    (cur - 1)->val.leaf = 1; // Make last print to be a leaf
     lastEvent = Strategy::SUCCESS;
   }
 
   forceinline void
   DynamicExpandStrategy::scenarioChoice(int, int, int) { }
 
+  forceinline
+  StrategyExplore::StrategyExplore(const Strategy& s0)
+    : s(s0) {
+    // An empty strategy has no node
+    if (s.bx && (s.cur != s.bx)) push(s.bx,s.firstBlockSize());
+    else backStack.push_back(Node(NULL,0));
+  }
+
+  forceinline void
+  StrategyExplore::push(Strategy::Box* p, unsigned int size) {
+    if (p->var.needNewBlock) {
+      size = static_cast<unsigned int>(p->var.id);
+      p = (p+1)->nextBlock;
+    }
+    backStack.push_back(Node(p,size));
+  }
+
+  forceinline unsigned int
+  StrategyExplore::sizeBelow(void) const {
+    const Node& n = backStack.back();
+    return (n.size - 1) / s.domSize[n.p->var.id] - 1;
+  }
+
+  forceinline bool
+  StrategyExplore::operator ()(void) const {
+    return (backStack.back().p != NULL);
+  }
+
+  forceinline void
+  StrategyExplore::operator ++(int vEdge) {
+    assert((*this)());
+    const Node& n = backStack.back();
+    int vId = n.p->var.id;
+    unsigned int stride = 1 + sizeBelow();
+    Strategy::Box* p = n.p + 1;
+    for (unsigned int i=0; i<n.p->var.nbAlt; i++, p += stride)
+      if ((s.valInf(*p,vId) <= vEdge) && (vEdge <= s.valSup(*p,vId))) {
+        if (p->val.leaf) backStack.push_back(Node(NULL,0));
+        else push(p+1,stride-1);
+        return;
+      }
+    // No edge with this value, we reach the bottom of the strategy
+    backStack.push_back(Node(NULL,0));
+  }
+
+  forceinline void
+  StrategyExplore::operator --(void) {
+    assert(backStack.size() > 1);
+    backStack.pop_back();
+  }
+
+  forceinline unsigned int
+  StrategyExplore::variableId(void) const {
+    assert((*this)());
+    return static_cast<unsigned int>(backStack.back().p->var.id);
+  }
+
+  forceinline unsigned int
+  StrategyExplore::nbValues(void) const {
+    assert((*this)());
+    return backStack.back().p->var.nbAlt;
+  }
+
+  forceinline int
+  StrategyExplore::value(unsigned int ith) const {
+    assert((*this)() && (ith < nbValues()));
+    const Node& n = backStack.back();
+    return s.valInf(*(n.p + 1 + ith * (1 + sizeBelow())),n.p->var.id);
+  }
+
+  forceinline int
+  StrategyExplore::valueSup(unsigned int ith) const {
+    assert((*this)() && (ith < nbValues()));
+    const Node& n = backStack.back();
+    return s.valSup(*(n.p + 1 + ith * (1 + sizeBelow())),n.p->var.id);
+  }
+
+  forceinline
+  BranchHistory::BranchHistory(void)
+    : bump(1.0), activityBump(1.0), lastEvent(Strategy::NONE) {}
+
+  forceinline unsigned long long
+  BranchHistory::key(int vId, int val) {
+    return (static_cast<unsigned long long>(static_cast<unsigned int>(vId)) << 32)
+           | static_cast<unsigned int>(val);
+  }
+
+  forceinline int
+  BranchHistory::find(int vId) const {
+    for (int i=static_cast<int>(branch.size()); i--; )
+      if (branch[i].vId == vId) return i;
+    return -1;
+  }
+
+  forceinline void
+  BranchHistory::success(void) {
+    lastEvent = Strategy::SUCCESS;
+  }
+
+  forceinline void
+  BranchHistory::failed(void) {
+    conflict();
+    lastEvent = Strategy::FAILURE;
+  }
+
+  forceinline void
+  BranchHistory::reset(void) {
+    branch.clear();
+    lastEvent = Strategy::NONE;
+  }
+
+  forceinline double
+  BranchHistory::score(int vId, int val) const {
+    std::unordered_map<unsigned long long,double>::const_iterator it = scores.find(key(vId,val));
+    return (it == scores.end()) ? 0.0 : it->second;
+  }
+
+  forceinline double
+  BranchHistory::activity(int vId) const {
+    return (vId < static_cast<int>(activities.size())) ? activities[vId] : 0.0;
+  }
+
   forceinline void
   QSpaceInfo::QSpaceSharedInfoO::strategyReset(void) {
     if (s) s->strategyReset();
+    h.reset();
   }
 
   forceinline void
@@ -530,6 +704,31 @@ namespace Gecode {
     if (s) s->print(os);
   }
 
+  forceinline void
+  QSpaceInfo::QSpaceSharedInfoO::strategyMinimize(void) {
+    if (s) s->minimize();
+  }
+
+  forceinline void
+  QSpaceInfo::QSpaceSharedInfoO::strategyMemoryBudget(std::size_t b) {
+    memoryBudget = b;
+  }
+
+  forceinline std::size_t
+  QSpaceInfo::QSpaceSharedInfoO::strategyMemoryBudget(void) const {
+    return memoryBudget;
+  }
+
+  forceinline double
+  QSpaceInfo::QSpaceSharedInfoO::strategyWorstCaseMemory(void) const {
+    return s ? s->worstCaseMemory() : 0;
+  }
+
+  forceinline std::size_t
+  QSpaceInfo::QSpaceSharedInfoO::strategyMemory(void) const {
+    return s ? s->memory() : 0;
+  }
+
   forceinline void
   QSpaceInfo::QSpaceSharedInfoO::scenarioSuccess(const QSpaceInfo& qsi) {
     s->scenarioSuccess(qsi);
@@ -546,11 +745,99 @@ namespace Gecode {
     s->scenarioChoice(vId,vInf,vSup);
   }
 
+  forceinline BranchHistory&
+  QSpaceInfo::QSpaceSharedInfoO::history(void) {
+    return h;
+  }
+
+  forceinline void
+  QSpaceInfo::QSpaceSharedInfoO::replay(bool b) {
+    _replay = b;
+    if (b) _replayedId = -1;
+  }
+
+  forceinline bool
+  QSpaceInfo::QSpaceSharedInfoO::replay(void) const {
+    return _replay;
+  }
+
+  forceinline void
+  QSpaceInfo::QSpaceSharedInfoO::replayed(unsigned int id, int pos, int vInf, int vSup) {
+    _replayedId = v[id-1].offset + pos;
+    _replayedInf = vInf;
+    _replayedSup = vSup;
+  }
+
+  forceinline void
+  QSpaceInfo::QSpaceSharedInfoO::replayed(int& vId, int& vInf, int& vSup) const {
+    vId = _replayedId;
+    vInf = _replayedInf;
+    vSup = _replayedSup;
+  }
+
+  forceinline void
+  QSpaceInfo::QSpaceSharedInfoO::filter(unsigned int id, BoolBranchFilter f) {
+    v[id-1].bbf = f;
+  }
+
+  forceinline void
+  QSpaceInfo::QSpaceSharedInfoO::filter(unsigned int id, IntBranchFilter f) {
+    v[id-1].ibf = f;
+  }
+
+  forceinline bool
+  QSpaceInfo::QSpaceSharedInfoO::filter(const Space& home, unsigned int id, BoolVar x, int pos) const {
+    return (v[id-1].bbf == NULL) || v[id-1].bbf(home,x,pos);
+  }
+
+  forceinline bool
+  QSpaceInfo::QSpaceSharedInfoO::filter(const Space& home, unsigned int id, IntVar x, int pos) const {
+    return (v[id-1].ibf == NULL) || v[id-1].ibf(home,x,pos);
+  }
+
+  forceinline const std::vector< std::vector<int> >&
+  QSpaceInfo::QSpaceSharedInfoO::links(void) const {
+    return _links;
+  }
+
+  forceinline const std::vector< std::vector<int> >&
+  QSpaceInfo::QSpaceSharedInfoO::varLinks(void) const {
+    return _varLinks;
+  }
+
+  forceinline void
+  QSpaceInfo::QSpaceSharedInfoO::linkUnbranched(void) {
+    _unbranchedLinks = true;
+  }
+
+  forceinline bool
+  QSpaceInfo::QSpaceSharedInfoO::unbranchedLinks(void) const {
+    return _unbranchedLinks;
+  }
+
+  forceinline TQuantifier
+  QSpaceInfo::QSpaceSharedInfoO::varQuantifier(unsigned int vId) const {
+    if (vId >= _linkIdVars.size())
+      throw Int::OutOfLimits("QSpaceInfo::varQuantifier");
+    // Branchers are sorted by offset
+    unsigned int l = 0, u = v.size();
+    while (u - l > 1) {
+      unsigned int m = (l + u) / 2;
+      if (v[m].offset <= vId) l = m; else u = m;
+    }
+    return v[l].quantifier;
+  }
+
   forceinline const std::vector<QSpaceInfo::LkBinderVarObj>&
   QSpaceInfo::QSpaceSharedInfoO::linkIdVars(void) const {
     return _linkIdVars;
   }
 
+  forceinline uint64_t
+  QSpaceInfo::QSpaceSharedInfoO::fingerprint(void) const {
+    return _fingerprint;
+  }
+
   forceinline StrategyMethod
   QSpaceInfo::QSpaceSharedInfo::strategyInit(StrategyMethod sm) {
     return static_cast<QSpaceSharedInfoO*>(object())->strategyInit(sm);
@@ -566,6 +853,41 @@ namespace Gecode {
     return static_cast<QSpaceSharedInfoO*>(object())->strategyPrint(os);
   }
 
+  forceinline void
+  QSpaceInfo::QSpaceSharedInfo::strategyMinimize(void) {
+    return static_cast<QSpaceSharedInfoO*>(object())->strategyMinimize();
+  }
+
+  forceinline void
+  QSpaceInfo::QSpaceSharedInfo::strategySave(std::ostream& os) const {
+    return static_cast<QSpaceSharedInfoO*>(object())->strategySave(os);
+  }
+
+  forceinline bool
+  QSpaceInfo::QSpaceSharedInfo::strategyLoad(std::istream& is) {
+    return static_cast<QSpaceSharedInfoO*>(object())->strategyLoad(is);
+  }
+
+  forceinline void
+  QSpaceInfo::QSpaceSharedInfo::strategyMemoryBudget(std::size_t b) {
+    return static_cast<QSpaceSharedInfoO*>(object())->strategyMemoryBudget(b);
+  }
+
+  forceinline std::size_t
+  QSpaceInfo::QSpaceSharedInfo::strategyMemoryBudget(void) const {
+    return static_cast<QSpaceSharedInfoO*>(object())->strategyMemoryBudget();
+  }
+
+  forceinline double
+  QSpaceInfo::QSpaceSharedInfo::strategyWorstCaseMemory(void) const {
+    return static_cast<QSpaceSharedInfoO*>(object())->strategyWorstCaseMemory();
+  }
+
+  forceinline std::size_t
+  QSpaceInfo::QSpaceSharedInfo::strategyMemory(void) const {
+    return static_cast<QSpaceSharedInfoO*>(object())->strategyMemory();
+  }
+
   forceinline void
   QSpaceInfo::QSpaceSharedInfo::scenarioSuccess(const QSpaceInfo& qsi) {
     return static_cast<QSpaceSharedInfoO*>(object())->scenarioSuccess(qsi);
@@ -581,6 +903,76 @@ namespace Gecode {
     return static_cast<QSpaceSharedInfoO*>(object())->scenarioChoice(id,pos,vInf,vSup);
   }
 
+  forceinline BranchHistory&
+  QSpaceInfo::QSpaceSharedInfo::history(void) const {
+    return static_cast<QSpaceSharedInfoO*>(object())->history();
+  }
+
+  forceinline void
+  QSpaceInfo::QSpaceSharedInfo::replay(bool b) {
+    static_cast<QSpaceSharedInfoO*>(object())->replay(b);
+  }
+
+  forceinline bool
+  QSpaceInfo::QSpaceSharedInfo::replay(void) const {
+    return static_cast<QSpaceSharedInfoO*>(object())->replay();
+  }
+
+  forceinline void
+  QSpaceInfo::QSpaceSharedInfo::replayed(unsigned int id, int pos, int vInf, int vSup) {
+    static_cast<QSpaceSharedInfoO*>(object())->replayed(id,pos,vInf,vSup);
+  }
+
+  forceinline void
+  QSpaceInfo::QSpaceSharedInfo::replayed(int& vId, int& vInf, int& vSup) const {
+    static_cast<QSpaceSharedInfoO*>(object())->replayed(vId,vInf,vSup);
+  }
+
+  forceinline void
+  QSpaceInfo::QSpaceSharedInfo::filter(unsigned int id, BoolBranchFilter f) {
+    return static_cast<QSpaceSharedInfoO*>(object())->filter(id,f);
+  }
+
+  forceinline void
+  QSpaceInfo::QSpaceSharedInfo::filter(unsigned int id, IntBranchFilter f) {
+    return static_cast<QSpaceSharedInfoO*>(object())->filter(id,f);
+  }
+
+  forceinline bool
+  QSpaceInfo::QSpaceSharedInfo::filter(const Space& home, unsigned int id, BoolVar x, int pos) const {
+    return static_cast<QSpaceSharedInfoO*>(object())->filter(home,id,x,pos);
+  }
+
+  forceinline bool
+  QSpaceInfo::QSpaceSharedInfo::filter(const Space& home, unsigned int id, IntVar x, int pos) const {
+    return static_cast<QSpaceSharedInfoO*>(object())->filter(home,id,x,pos);
+  }
+
+  forceinline void
+  QSpaceInfo::QSpaceSharedInfo::link(const std::vector<int>& vIds) {
+    return static_cast<QSpaceSharedInfoO*>(object())->link(vIds);
+  }
+
+  forceinline const std::vector< std::vector<int> >&
+  QSpaceInfo::QSpaceSharedInfo::links(void) const {
+    return static_cast<QSpaceSharedInfoO*>(object())->links();
+  }
+
+  forceinline const std::vector< std::vector<int> >&
+  QSpaceInfo::QSpaceSharedInfo::varLinks(void) const {
+    return static_cast<QSpaceSharedInfoO*>(object())->varLinks();
+  }
+
+  forceinline void
+  QSpaceInfo::QSpaceSharedInfo::linkUnbranched(void) {
+    static_cast<QSpaceSharedInfoO*>(object())->linkUnbranched();
+  }
+
+  forceinline bool
+  QSpaceInfo::QSpaceSharedInfo::unbranchedLinks(void) const {
+    return static_cast<QSpaceSharedInfoO*>(object())->unbranchedLinks();
+  }
+
   forceinline TQuantifier
   QSpaceInfo::QSpaceSharedInfo::brancherQuantifier(unsigned int id) const {
     return static_cast<QSpaceSharedInfoO*>(object())->brancherQuantifier(id);
@@ -591,6 +983,11 @@ namespace Gecode {
     return static_cast<QSpaceSharedInfoO*>(object())->brancherOffset(id);
   }
 
+  forceinline TQuantifier
+  QSpaceInfo::QSpaceSharedInfo::varQuantifier(unsigned int vId) const {
+    return static_cast<QSpaceSharedInfoO*>(object())->varQuantifier(vId);
+  }
+
   forceinline int
   QSpaceInfo::QSpaceSharedInfo::getLastBrancherId(void) const {
     return static_cast<QSpaceSharedInfoO*>(object())->getLastBrancherId();
@@ -601,6 +998,11 @@ namespace Gecode {
     return static_cast<QSpaceSharedInfoO*>(object())->linkIdVars();
   }
 
+  forceinline uint64_t
+  QSpaceInfo::QSpaceSharedInfo::fingerprint(void) const {
+    return static_cast<QSpaceSharedInfoO*>(object())->fingerprint();
+  }
+
   forceinline void
   QSpaceInfo::eventNewInstance(void) const { }
 
@@ -616,6 +1018,21 @@ namespace Gecode {
     return sharedInfo.brancherOffset(id);
   }
 
+  forceinline unsigned int
+  QSpaceInfo::branchedVariables(void) const {
+    return static_cast<unsigned int>(sharedInfo.linkIdVars().size());
+  }
+
+  forceinline uint64_t
+  QSpaceInfo::fingerprint(void) const {
+    return sharedInfo.fingerprint();
+  }
+
+  forceinline TQuantifier
+  QSpaceInfo::varQuantifier(unsigned int vId) const {
+    return sharedInfo.varQuantifier(vId);
+  }
+
   forceinline StrategyMethod
   QSpaceInfo::strategyMethod(void) const {
     return curStrategyMethod;
@@ -626,6 +1043,26 @@ namespace Gecode {
     curStrategyMethod = sm;
   }
 
+  forceinline void
+  QSpaceInfo::strategyMemoryBudget(std::size_t b) {
+    sharedInfo.strategyMemoryBudget(b);
+  }
+
+  forceinline std::size_t
+  QSpaceInfo::strategyMemoryBudget(void) const {
+    return sharedInfo.strategyMemoryBudget();
+  }
+
+  forceinline double
+  QSpaceInfo::strategyWorstCaseMemory(void) const {
+    return sharedInfo.strategyWorstCaseMemory();
+  }
+
+  forceinline std::size_t
+  QSpaceInfo::strategyMemory(void) const {
+    return sharedInfo.strategyMemory();
+  }
+
   forceinline StrategyMethod
   QSpaceInfo::strategyInit(void) {
     curStrategyMethod = sharedInfo.strategyInit(curStrategyMethod);
@@ -643,8 +1080,15 @@ namespace Gecode {
     return sharedInfo.strategyPrint(os);
   }
 
+  forceinline void
+  QSpaceInfo::strategyMinimize(void) {
+    return sharedInfo.strategyMinimize();
+  }
+
   forceinline void
   QSpaceInfo::strategySuccess(void) {
+    if (bRecordStrategy && (curStrategyMethod & StrategyMethodValues::MINIMIZE))
+      sharedInfo.strategyMinimize();
   }
 
   forceinline void
@@ -654,11 +1098,13 @@ namespace Gecode {
   forceinline void
   QSpaceInfo::scenarioSuccess(void) {
     if (bRecordStrategy) sharedInfo.scenarioSuccess(*this);
+    if (historyNeeded()) sharedInfo.history().success();
   }
 
   forceinline void
   QSpaceInfo::scenarioFailed(void) {
     if (bRecordStrategy) sharedInfo.scenarioFailed();
+    if (historyNeeded()) sharedInfo.history().failed();
   }
 
   template<class VarType> forceinline
@@ -666,7 +1112,16 @@ namespace Gecode {
                                  VarType x, int pos, const int&,
                                  std::ostream& ) {
     const QSpaceInfo& qsi = dynamic_cast<const QSpaceInfo&>(home);
-    if (qsi.bRecordStrategy) const_cast<QSpaceInfo&>(qsi).sharedInfo.scenarioChoice(bh.id(),pos,x.min(),x.max());  
+    if (!qsi.sharedInfo.replay()) {
+      if (qsi.bRecordStrategy) const_cast<QSpaceInfo&>(qsi).sharedInfo.scenarioChoice(bh.id(),pos,x.min(),x.max());
+      if (Support::TraceBuffer* tb = Support::TraceBuffer::current()) tb->choice(pos,x.min(),x.max());
+    } else {
+      const_cast<QSpaceInfo&>(qsi).sharedInfo.replayed(bh.id(),pos,x.min(),x.max());
+    }
+    if (qsi.historyNeeded())
+      qsi.sharedInfo.history().choice(qsi.sharedInfo.brancherOffset(bh.id())+pos,
+                                          qsi.sharedInfo.brancherQuantifier(bh.id()) == FORALL,
+                                          x.min(),x.max());
   }
 
   template<> forceinline
@@ -693,8 +1148,17 @@ namespace Gecode {
                                  VarType x, int pos, const int& val,
                                  std::ostream& os) {
     const QSpaceInfo& qsi = dynamic_cast<const QSpaceInfo&>(home);
-    if (qsi.bRecordStrategy) const_cast<QSpaceInfo&>(qsi).sharedInfo.scenarioChoice(bh.id(),pos,x.min(),x.max());
-    runCustomChoice(home,bh,alt,x,pos,val,os);
+    if (!qsi.sharedInfo.replay()) {
+      if (qsi.bRecordStrategy) const_cast<QSpaceInfo&>(qsi).sharedInfo.scenarioChoice(bh.id(),pos,x.min(),x.max());
+      if (Support::TraceBuffer* tb = Support::TraceBuffer::current()) tb->choice(pos,x.min(),x.max());
+    } else {
+      const_cast<QSpaceInfo&>(qsi).sharedInfo.replayed(bh.id(),pos,x.min(),x.max());
+    }
+    if (qsi.historyNeeded())
+      qsi.sharedInfo.history().choice(qsi.sharedInfo.brancherOffset(bh.id())+pos,
+                                          qsi.sharedInfo.brancherQuantifier(bh.id()) == FORALL,
+                                          x.min(),x.max());
+    if (!qsi.sharedInfo.replay()) runCustomChoice(home,bh,alt,x,pos,val,os);
   }
 
   forceinline unsigned int
@@ -702,6 +1166,73 @@ namespace Gecode {
     return nbWatchConstraint;
   }
 
+  forceinline void
+  QSpaceInfo::trackVariables(bool b) {
+    bTrackVariables = b;
+  }
+
+  forceinline void
+  QSpaceInfo::replay(bool b) {
+    sharedInfo.replay(b);
+  }
+
+  forceinline void
+  QSpaceInfo::replayed(int& vId, int& vInf, int& vSup) const {
+    sharedInfo.replayed(vId,vInf,vSup);
+  }
+
+  forceinline void
+  QSpaceInfo::refutationOrder(bool b) {
+    bRefutationOrder = b;
+  }
+
+  forceinline bool
+  QSpaceInfo::refutationOrder(void) const {
+    return bRefutationOrder;
+  }
+
+  forceinline void
+  QSpaceInfo::activityOrder(bool b) {
+    bActivityOrder = b;
+  }
+
+  forceinline bool
+  QSpaceInfo::activityOrder(void) const {
+    return bActivityOrder;
+  }
+
+  forceinline void
+  QSpaceInfo::componentDecomposition(bool b) {
+    bComponents = b;
+  }
+
+  forceinline bool
+  QSpaceInfo::componentDecomposition(void) const {
+    return bComponents;
+  }
+
+  forceinline void
+  QSpaceInfo::restrictComponent(const std::vector<char>* c) {
+    _component = c;
+  }
+
+  forceinline bool
+  QSpaceInfo::varAssigned(int vId) const {
+    const LkBinderVarObj& lk = sharedInfo.linkIdVars()[vId];
+    if (lk.type == LkBinderVarObj::BOOL) return _boolVars[lk.id].assigned();
+    return _intVars[lk.id].assigned();
+  }
+
+  forceinline bool
+  QSpaceInfo::historyNeeded(void) const {
+    return bHistory;
+  }
+
+  forceinline bool
+  QSpaceInfo::trackedVariables(void) const {
+    return bTrackVariables || bComponents || (curStrategyMethod & StrategyMethodValues::EXPAND);
+  }
+
   forceinline void
   QSpaceInfo::addWatchConstraint(void) {
     ++nbWatchConstraint;
@@ -0,0 +1,175 @@
+/* -*- mode: C++; c-basic-offset: 2; indent-tabs-mode: nil -*- */
+/*
+ *  Main authors:
+ *     Vincent Barichard <Vincent.Barichard@univ-angers.fr>
+ *
+ *  Copyright:
+ *     Vincent Barichard, 2014
+ *
+ *  Last modified:
+ *     $Date$ by $Author$
+ *     $Revision$
+ *
+ *  This file is part of Quacode:
+ *     http://quacode.barichard.com
+ *
+ *  Permission is hereby granted, free of charge, to any person obtaining
+ *  a copy of this software and associated documentation files (the
+ *  "Software"), to deal in the Software without restriction, including
+ *  without limitation the rights to use, copy, modify, merge, publish,
+ *  distribute, sublicense, and/or sell copies of the Software, and to
+ *  permit persons to whom the Software is furnished to do so, subject to
+ *  the following conditions:
+ *
+ *  The above copyright notice and this permission notice shall be
+ *  included in all copies or substantial portions of the Software.
+ *
+ *  THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND,
+ *  EXPRESS OR IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF
+ *  MERCHANTABILITY, FITNESS FOR A PARTICULAR PURPOSE AND
+ *  NONINFRINGEMENT. IN NO EVENT SHALL THE AUTHORS OR COPYRIGHT HOLDERS BE
+ *  LIABLE FOR ANY CLAIM, DAMAGES OR OTHER LIABILITY, WHETHER IN AN ACTION
+ *  OF CONTRACT, TORT OR OTHERWISE, ARISING FROM, OUT OF OR IN CONNECTION
+ *  WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE SOFTWARE.
+ *
+ */
+
+#include <quacode/qstrategy.hh>
+#include <cstdlib>
+#include <iomanip>
+#include <string>
+
+namespace Gecode {
+
+  StrategyNode::~StrategyNode(void) {
+    for (std::vector<Edge*>::size_type i=0; i<edges.size(); i++)
+      delete edges[i];
+  }
+
+  SharedStrategy::SharedStrategy(void) : top(0,0) {}
+
+  StrategyNode::Edge*
+  SharedStrategy::choice(StrategyNode::Edge* e, int vId, int inf, int sup) {
+    if (e->child == NULL) e->child = new StrategyNode(vId);
+    else if (e->child->vId != vId) return NULL;
+    StrategyNode::Edge* c = new StrategyNode::Edge(inf,sup);
+    e->child->edges.push_back(c);
+    return c;
+  }
+
+  bool
+  SharedStrategy::graft(StrategyNode::Edge* e, std::istream& is) {
+    if (e->child != NULL) return false;
+    StrategyNode* root = NULL;
+    // Last node opened at each depth
+    std::vector<StrategyNode*> nodeAtDepth;
+    // All the nodes read and the number of values they announce
+    std::vector<StrategyNode*> nodes;
+    std::vector<unsigned int> nbAlt;
+    std::string line;
+    bool ok = true;
+    while (ok && std::getline(is,line)) {
+      // Each level of depth is printed in a cell of 4 characters starting with '|'
+      std::string::size_type i = 0;
+      unsigned int depth = 0;
+      while ((i < line.size()) && (line[i] == '|')) {
+        depth++;
+        i += 4;
+      }
+      std::string rest = (i < line.size()) ? line.substr(i) : std::string();
+      while (!rest.empty() && ((rest[rest.size()-1] == ' ') || (rest[rest.size()-1] == '\r')))
+        rest.erase(rest.size()-1);
+
+      if (rest.empty()) {
+        // A blank line ends the strategy
+        if (root != NULL) break;
+        continue;
+      }
+
+      char* end;
+      if ((rest.size() > 2) && (rest[0] == 'v') && (rest[1] == '_')) {
+        // Node: "v_<id>(<number of values>)"
+        int vId = static_cast<int>(std::strtol(rest.c_str()+2,&end,10));
+        if (*end != '(') { ok = false; break; }
+        unsigned int n = static_cast<unsigned int>(std::strtol(end+1,&end,10));
+        if (*end != ')') { ok = false; break; }
+        if (root != NULL) {
+          // Only the first strategy of the stream is read
+          if (depth == 0) break;
+          if (depth > nodeAtDepth.size()) { ok = false; break; }
+          StrategyNode* p = nodeAtDepth[depth-1];
+          if (p->edges.empty() || (p->edges.back()->child != NULL)) { ok = false; break; }
+          p->edges.back()->child = new StrategyNode(vId);
+          nodeAtDepth.resize(depth);
+          nodeAtDepth.push_back(p->edges.back()->child);
+        } else {
+          if (depth != 0) { ok = false; break; }
+          root = new StrategyNode(vId);
+          nodeAtDepth.push_back(root);
+        }
+        nodes.push_back(nodeAtDepth.back());
+        nbAlt.push_back(n);
+      } else {
+        // A strategy starts with a node (a dropped strategy prints a message)
+        if (root == NULL) { ok = false; break; }
+        // Value: "<v>" or "[<inf>,<sup>]"
+        int inf, sup;
+        if (rest[0] == '[') {
+          inf = static_cast<int>(std::strtol(rest.c_str()+1,&end,10));
+          if (*end != ',') { ok = false; break; }
+          sup = static_cast<int>(std::strtol(end+1,&end,10));
+          if (*end != ']') { ok = false; break; }
+        } else {
+          inf = sup = static_cast<int>(std::strtol(rest.c_str(),&end,10));
+          if ((*end != 0) || (end == rest.c_str())) { ok = false; break; }
+        }
+        if ((inf > sup) || (depth >= nodeAtDepth.size())) { ok = false; break; }
+        nodeAtDepth.resize(depth+1);
+        nodeAtDepth[depth]->edges.push_back(new StrategyNode::Edge(inf,sup));
+      }
+    }
+    for (std::vector<StrategyNode*>::size_type i=0; ok && (i<nodes.size()); i++)
+      ok = (nodes[i]->edges.size() == nbAlt[i]);
+    if (!ok) {
+      delete root;
+      return false;
+    }
+    e->child = root;
+    return true;
+  }
+
+  void
+  SharedStrategy::edges(const StrategyNode* n, std::vector<const StrategyNode::Edge*>& e) {
+    for (std::vector<StrategyNode::Edge*>::size_type i=0; i<n->edges.size(); i++) {
+      const StrategyNode::Edge* c = n->edges[i];
+      if ((c->child != NULL) && (c->child->vId == n->vId)) edges(c->child,e);
+      else e.push_back(c);
+    }
+  }
+
+  void
+  SharedStrategy::print(std::ostream& os, const StrategyNode* n, int depth) {
+    std::vector<const StrategyNode::Edge*> e;
+    edges(n,e);
+    if (depth > 0) {
+      for (int i=depth-1; i--; ) os << std::setfill(' ') << std::setw(4) << std::left << "|";
+      os << std::setfill('-') << std::setw(4) << std::left << "|";
+    }
+    os << "v_" << n->vId << "(" << e.size() << ")" << std::endl;
+    for (std::vector<const StrategyNode::Edge*>::size_type k=0; k<e.size(); k++) {
+      for (int i=depth; i--; ) os << std::setfill(' ') << std::setw(4) << std::left << "|";
+      if (e[k]->inf == e[k]->sup) os << e[k]->inf << std::endl;
+      else os << "[" << e[k]->inf << "," << e[k]->sup << "]" << std::endl;
+      if (e[k]->child != NULL) print(os, e[k]->child, depth+1);
+    }
+  }
+
+  void
+  SharedStrategy::print(std::ostream& os) const {
+    if (top.child != NULL) print(os,top.child,0);
+    os << std::endl;
+  }
+
+}
+
+// STATISTICS: search-other
@@ -0,0 +1,135 @@
+/* -*- mode: C++; c-basic-offset: 2; indent-tabs-mode: nil -*- */
+/*
+ *  Main authors:
+ *     Vincent Barichard <Vincent.Barichard@univ-angers.fr>
+ *
+ *  Copyright:
+ *     Vincent Barichard, 2014
+ *
+ *  Last modified:
+ *     $Date$ by $Author$
+ *     $Revision$
+ *
+ *  This file is part of Quacode:
+ *     http://quacode.barichard.com
+ *
+ *  Permission is hereby granted, free of charge, to any person obtaining
+ *  a copy of this software and associated documentation files (the
+ *  "Software"), to deal in the Software without restriction, including
+ *  without limitation the rights to use, copy, modify, merge, publish,
+ *  distribute, sublicense, and/or sell copies of the Software, and to
+ *  permit persons to whom the Software is furnished to do so, subject to
+ *  the following conditions:
+ *
+ *  The above copyright notice and this permission notice shall be
+ *  included in all copies or substantial portions of the Software.
+ *
+ *  THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND,
+ *  EXPRESS OR IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF
+ *  MERCHANTABILITY, FITNESS FOR A PARTICULAR PURPOSE AND
+ *  NONINFRINGEMENT. IN NO EVENT SHALL THE AUTHORS OR COPYRIGHT HOLDERS BE
+ *  LIABLE FOR ANY CLAIM, DAMAGES OR OTHER LIABILITY, WHETHER IN AN ACTION
+ *  OF CONTRACT, TORT OR OTHERWISE, ARISING FROM, OUT OF OR IN CONNECTION
+ *  WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE SOFTWARE.
+ *
+ */
+
+#ifndef __GECODE_QSTRATEGY_HH__
+#define __GECODE_QSTRATEGY_HH__
+
+#include <quacode/qcsp.hh>
+#include <iostream>
+#include <vector>
+
+namespace Gecode {
+
+  /**
+   * \brief Node of a strategy built from sub-strategies
+   *
+   * A node is a choice on a branched variable, each edge a value (or a
+   * range of values) of this variable. An edge without node below is a
+   * leaf of the strategy.
+   */
+  class StrategyNode {
+  public:
+    /// Edge of a node
+    class Edge {
+    public:
+      /// Inf value of the range
+      int inf;
+      /// Sup value of the range
+      int sup;
+      /// Node below the edge (NULL for a leaf)
+      StrategyNode* child;
+      /// Constructor
+      Edge(int i, int s) : inf(i), sup(s), child(NULL) {}
+      /// Destructor (free the nodes below)
+      ~Edge(void) { delete child; }
+    private:
+      /// Copy constructor (disabled)
+      Edge(const Edge&);
+      /// Assignment operator (disabled)
+      Edge& operator =(const Edge&);
+    };
+    /// Id of the variable
+    int vId;
+    /// Edges of the node, in the order of the search
+    std::vector<Edge*> edges;
+    /// Constructor
+    StrategyNode(int v) : vId(v) {}
+    /// Destructor (free the edges)
+    QUACODE_EXPORT ~StrategyNode(void);
+  private:
+    /// Copy constructor (disabled)
+    StrategyNode(const StrategyNode&);
+    /// Assignment operator (disabled)
+    StrategyNode& operator =(const StrategyNode&);
+  };
+
+  /**
+   * \brief Strategy grafted from the sub-strategies of several searches
+   *
+   * A parallel search (see QDistributed) splits the search tree into
+   * jobs, each one solved by its own search which records the sub-strategy
+   * below the node of the job. The searches don't share any strategy: once
+   * a job is proven, its sub-strategy is grafted at the edge of its node,
+   * the edges above being the choices leading to the node from the root.
+   *
+   * Successive choices on the same variable are merged when the strategy
+   * is printed, as QSpaceInfo::strategyPrint does: a value refined by the
+   * choice below it is replaced by the values of this choice.
+   */
+  class SharedStrategy {
+  private:
+    /// Edge above the root node
+    StrategyNode::Edge top;
+    /// Append to \a e the edges of \a n, with the edges refined by a choice
+    /// on the same variable replaced by the edges of this choice
+    static void edges(const StrategyNode* n, std::vector<const StrategyNode::Edge*>& e);
+    /// Print the sub-strategy rooted at \a n
+    static void print(std::ostream& os, const StrategyNode* n, int depth);
+    /// Copy constructor (disabled)
+    SharedStrategy(const SharedStrategy&);
+    /// Assignment operator (disabled)
+    SharedStrategy& operator =(const SharedStrategy&);
+  public:
+    /// Constructor of an empty strategy
+    QUACODE_EXPORT SharedStrategy(void);
+    /// Return the edge above the root of the strategy
+    StrategyNode::Edge* root(void) { return &top; }
+    /// Add below edge \a e the value [ \a inf , \a sup ] of the variable \a vId
+    /// and return its edge. Return NULL if another variable is already chosen
+    /// below \a e.
+    QUACODE_EXPORT StrategyNode::Edge* choice(StrategyNode::Edge* e, int vId, int inf, int sup);
+    /// Graft below the leaf \a e the sub-strategy printed by
+    /// QSpaceInfo::strategyPrint read from \a is (\a e stays a leaf if the
+    /// sub-strategy is empty). Return false if \a e is not a leaf or if the
+    /// sub-strategy can't be read.
+    QUACODE_EXPORT bool graft(StrategyNode::Edge* e, std::istream& is);
+    /// Print the strategy in the format of QSpaceInfo::strategyPrint
+    QUACODE_EXPORT void print(std::ostream& os) const;
+  };
+
+}
+
+#endif
@@ -0,0 +1,238 @@
+/* -*- mode: C++; c-basic-offset: 2; indent-tabs-mode: nil -*- */
+/*
+ *  Main authors:
+ *     Vincent Barichard <Vincent.Barichard@univ-angers.fr>
+ *
+ *  Copyright:
+ *     Vincent Barichard, 2014
+ *
+ *  Last modified:
+ *     $Date$ by $Author$
+ *     $Revision$
+ *
+ *  This file is part of Quacode:
+ *     http://quacode.barichard.com
+ *
+ *  Permission is hereby granted, free of charge, to any person obtaining
+ *  a copy of this software and associated documentation files (the
+ *  "Software"), to deal in the Software without restriction, including
+ *  without limitation the rights to use, copy, modify, merge, publish,
+ *  distribute, sublicense, and/or sell copies of the Software, and to
+ *  permit persons to whom the Software is furnished to do so, subject to
+ *  the following conditions:
+ *
+ *  The above copyright notice and this permission notice shall be
+ *  included in all copies or substantial portions of the Software.
+ *
+ *  THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND,
+ *  EXPRESS OR IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF
+ *  MERCHANTABILITY, FITNESS FOR A PARTICULAR PURPOSE AND
+ *  NONINFRINGEMENT. IN NO EVENT SHALL THE AUTHORS OR COPYRIGHT HOLDERS BE
+ *  LIABLE FOR ANY CLAIM, DAMAGES OR OTHER LIABILITY, WHETHER IN AN ACTION
+ *  OF CONTRACT, TORT OR OTHERWISE, ARISING FROM, OUT OF OR IN CONNECTION
+ *  WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE SOFTWARE.
+ *
+ */
+
+#include <algorithm>
+#include <climits>
+
+namespace Gecode {
+
+  forceinline
+  QAssumption::QAssumption(unsigned int v, int l, int u)
+    : vId(v), min(l), max(u) {}
+
+  template<class T>
+  forceinline
+  QAssumptions<T>::QAssumptions(T* s)
+    : root(s), nQueries(0), nSearches(0), nHits(0), bStopped(false) {
+    // The assumptions are posted on the branched variables of the clones
+    root->trackVariables(true);
+    if (root->status() == SS_FAILED) {
+      delete root;
+      root = NULL;
+    }
+  }
+
+  template<class T>
+  forceinline bool
+  QAssumptions<T>::less(const QAssumption& a, const QAssumption& b) {
+    return a.vId < b.vId;
+  }
+
+  template<class T>
+  std::vector<QAssumption>
+  QAssumptions<T>::normalize(const std::vector<QAssumption>& a) const {
+    std::vector<QAssumption> n(a);
+    std::sort(n.begin(), n.end(), less);
+    // The assumptions on the same variable are intersected
+    std::vector<QAssumption>::size_type k = 0;
+    for (std::vector<QAssumption>::size_type i=0; i<n.size(); i++) {
+      if ((k > 0) && (n[k-1].vId == n[i].vId)) {
+        n[k-1].min = std::max(n[k-1].min, n[i].min);
+        n[k-1].max = std::min(n[k-1].max, n[i].max);
+      } else {
+        n[k++] = n[i];
+      }
+    }
+    n.resize(k);
+    return n;
+  }
+
+  template<class T>
+  bool
+  QAssumptions<T>::harder(const std::vector<QAssumption>& q,
+                          const std::vector<QAssumption>& e) const {
+    // A variable without assumption is unrestricted
+    std::vector<QAssumption>::size_type i = 0, j = 0;
+    while ((i < q.size()) || (j < e.size())) {
+      unsigned int v;
+      if (j == e.size()) v = q[i].vId;
+      else if (i == q.size()) v = e[j].vId;
+      else v = std::min(q[i].vId, e[j].vId);
+      int qMin = INT_MIN, qMax = INT_MAX, eMin = INT_MIN, eMax = INT_MAX;
+      if ((i < q.size()) && (q[i].vId == v)) {
+        qMin = q[i].min; qMax = q[i].max; i++;
+      }
+      if ((j < e.size()) && (e[j].vId == v)) {
+        eMin = e[j].min; eMax = e[j].max; j++;
+      }
+      // Harder: narrower existential domains and wider universal domains
+      if (root->varQuantifier(v) == EXISTS) {
+        if ((qMin < eMin) || (qMax > eMax)) return false;
+      } else {
+        if ((eMin < qMin) || (eMax > qMax)) return false;
+      }
+    }
+    return true;
+  }
+
+  template<class T>
+  int
+  QAssumptions<T>::run(const std::vector<QAssumption>& a, const Search::Options& o) {
+    if (root == NULL) return 0;
+    // Without sharing, the strategy of the clone is its own
+    T* c = static_cast<T*>(root->clone(false));
+    for (std::vector<QAssumption>::size_type i=0; i<a.size(); i++)
+      c->assume(*c, a[i].vId, a[i].min, a[i].max);
+    // An empty universal domain makes the problem false, so the previous
+    // answers only hold once the domains are known to be non empty
+    if (c->status() == SS_FAILED) {
+      delete c;
+      return 0;
+    }
+    for (typename std::vector<Answer>::size_type i=0; i<answers.size(); i++) {
+      if ((!answers[i].value && harder(a, answers[i].a)) ||
+          (answers[i].value && harder(answers[i].a, a))) {
+        nHits++;
+        delete c;
+        return answers[i].value ? 1 : 0;
+      }
+    }
+    nSearches++;
+    int r;
+    {
+      // The spaces of the engine share the history of c
+      Search::Options co(o);
+      co.clone = true;
+      Support::CheckpointHide h;
+      QDFS<T> e(c,co);
+      T* s = e.next();
+      qs += e.qstatistics();
+      r = e.stopped() ? -1 : ((s != NULL) ? 1 : 0);
+      delete s;
+    }
+    root->learnHistory(*c);
+    delete c;
+    if (r >= 0) {
+      Answer an;
+      an.a = a;
+      an.value = (r == 1);
+      answers.push_back(an);
+    }
+    return r;
+  }
+
+  template<class T>
+  bool
+  QAssumptions<T>::solve(const std::vector<QAssumption>& a, std::vector<QAssumption>* core,
+                         const Search::Options& o) {
+    if (root != NULL)
+      for (std::vector<QAssumption>::size_type i=0; i<a.size(); i++)
+        if (a[i].vId >= root->branchedVariables())
+          throw Int::OutOfLimits("QAssumptions::solve");
+    nQueries++;
+    bStopped = false;
+    if (core) core->clear();
+    std::vector<QAssumption> n = normalize(a);
+    int r = run(n, o);
+    if (r == 1) return true;
+    if (r < 0) {
+      bStopped = true;
+      return false;
+    }
+    if ((core == NULL) || (root == NULL)) return false;
+    // The universal assumptions come first: without them the problem is harder,
+    // so their removal is mostly answered by the previous answers
+    std::vector<QAssumption> k;
+    for (std::vector<QAssumption>::size_type i=0; i<n.size(); i++)
+      if (root->varQuantifier(n[i].vId) == FORALL) k.push_back(n[i]);
+    for (std::vector<QAssumption>::size_type i=0; i<n.size(); i++)
+      if (root->varQuantifier(n[i].vId) == EXISTS) k.push_back(n[i]);
+    // Remove the assumptions one by one while the problem stays false
+    std::vector<QAssumption>::size_type i = 0;
+    while (i < k.size()) {
+      std::vector<QAssumption> t(k);
+      t.erase(t.begin() + i);
+      int rt = run(t, o);
+      if (rt < 0) break;
+      if (rt == 0) k.swap(t); else i++;
+    }
+    // The core is made of the given assumptions
+    for (std::vector<QAssumption>::size_type j=0; j<a.size(); j++)
+      for (std::vector<QAssumption>::size_type l=0; l<k.size(); l++)
+        if (a[j].vId == k[l].vId) {
+          core->push_back(a[j]);
+          break;
+        }
+    return false;
+  }
+
+  template<class T>
+  forceinline unsigned long int
+  QAssumptions<T>::queries(void) const {
+    return nQueries;
+  }
+
+  template<class T>
+  forceinline unsigned long int
+  QAssumptions<T>::searches(void) const {
+    return nSearches;
+  }
+
+  template<class T>
+  forceinline unsigned long int
+  QAssumptions<T>::hits(void) const {
+    return nHits;
+  }
+
+  template<class T>
+  forceinline const Search::QStatistics&
+  QAssumptions<T>::qstatistics(void) const {
+    return qs;
+  }
+
+  template<class T>
+  forceinline bool
+  QAssumptions<T>::stopped(void) const {
+    return bStopped;
+  }
+
+  template<class T>
+  forceinline
+  QAssumptions<T>::~QAssumptions(void) {
+    delete root;
+  }
+
+}
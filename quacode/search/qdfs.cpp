@@ -53,9 +53,30 @@
 
 namespace Gecode { namespace Search {
 
+    namespace {
+      /// Engine giving access to the detailed statistics of its worker
+      class QDFSEngine : public WorkerToEngine<Sequential::QDFS> {
+      public:
+        /// Initialize for space \a s with options \a o
+        QDFSEngine(Space* s, const Options& o)
+          : WorkerToEngine<Sequential::QDFS>(s,o) {}
+        /// Return detailed statistics
+        QStatistics qstatistics(void) const {
+          return w.qstatistics();
+        }
+      };
+    }
+
     Engine*
     qdfs(Space* s, const Options& o) {
-      return new WorkerToEngine<Sequential::QDFS>(s,o);
+      return new QDFSEngine(s,o);
+    }
+
+    QStatistics
+    qstatistics(const Engine* e) {
+      // Engines not created by qdfs have no detailed statistics
+      const QDFSEngine* q = dynamic_cast<const QDFSEngine*>(e);
+      return (q != NULL) ? q->qstatistics() : QStatistics();
     }
   }
 }
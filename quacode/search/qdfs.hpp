@@ -52,6 +52,8 @@ namespace Gecode {
   namespace Search {
     /// Create depth-first engine for quantified variables
     QUACODE_EXPORT Engine* qdfs(Space* s, const Options& o);
+    /// Return the detailed statistics of engine \a e created by qdfs (empty for other engines)
+    QUACODE_EXPORT QStatistics qstatistics(const Engine* e);
   }
 
   template<class T>
@@ -71,6 +73,12 @@ namespace Gecode {
     return e->statistics();
   }
 
+  template<class T>
+  forceinline Search::QStatistics
+  QDFS<T>::qstatistics(void) const {
+    return Search::qstatistics(e);
+  }
+
   template<class T>
   forceinline bool
   QDFS<T>::stopped(void) const {
@@ -0,0 +1,700 @@
+/* -*- mode: C++; c-basic-offset: 2; indent-tabs-mode: nil -*- */
+/*
+ *  Main authors:
+ *     Vincent Barichard <Vincent.Barichard@univ-angers.fr>
+ *
+ *  Copyright:
+ *     Vincent Barichard, 2014
+ *
+ *  Last modified:
+ *     $Date$ by $Author$
+ *     $Revision$
+ *
+ *  This file is part of Quacode:
+ *     http://quacode.barichard.com
+ *
+ *  Permission is hereby granted, free of charge, to any person obtaining
+ *  a copy of this software and associated documentation files (the
+ *  "Software"), to deal in the Software without restriction, including
+ *  without limitation the rights to use, copy, modify, merge, publish,
+ *  distribute, sublicense, and/or sell copies of the Software, and to
+ *  permit persons to whom the Software is furnished to do so, subject to
+ *  the following conditions:
+ *
+ *  The above copyright notice and this permission notice shall be
+ *  included in all copies or substantial portions of the Software.
+ *
+ *  THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND,
+ *  EXPRESS OR IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF
+ *  MERCHANTABILITY, FITNESS FOR A PARTICULAR PURPOSE AND
+ *  NONINFRINGEMENT. IN NO EVENT SHALL THE AUTHORS OR COPYRIGHT HOLDERS BE
+ *  LIABLE FOR ANY CLAIM, DAMAGES OR OTHER LIABILITY, WHETHER IN AN ACTION
+ *  OF CONTRACT, TORT OR OTHERWISE, ARISING FROM, OUT OF OR IN CONNECTION
+ *  WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE SOFTWARE.
+ *
+ */
+#include <quacode/search/qdistributed.hh>
+#include <quacode/support/log.hh>
+#include <quacode/support/telemetry.hh>
+#include <quacode/support/tracer.hh>
+#include <sstream>
+
+#ifndef _WIN32
+#include <cerrno>
+#include <csignal>
+#include <cstdlib>
+#include <poll.h>
+#include <sys/socket.h>
+#include <sys/types.h>
+#include <sys/wait.h>
+#include <unistd.h>
+#endif
+
+namespace Gecode {
+
+  namespace {
+    /// Commits leading to a node from the root
+    typedef std::vector<Support::Checkpoint::Edge> Prefix;
+
+    /// Write the commits \a p to \a os
+    void writePrefix(std::ostream& os, const Prefix& p) {
+      os << p.size();
+      for (Prefix::size_type i=0; i<p.size(); i++) {
+        os << " " << p[i].alt << " " << p[i].choice.size();
+        for (std::vector<unsigned int>::size_type j=0; j<p[i].choice.size(); j++)
+          os << " " << p[i].choice[j];
+      }
+    }
+
+    /// Read the commits \a p from \a is
+    bool readPrefix(std::istream& is, Prefix& p) {
+      Prefix::size_type n;
+      if (!(is >> n)) return false;
+      p.resize(n);
+      for (Prefix::size_type i=0; i<n; i++) {
+        std::vector<unsigned int>::size_type k;
+        if (!(is >> p[i].alt >> k) || (k == 0)) return false;
+        p[i].choice.resize(k);
+        for (std::vector<unsigned int>::size_type j=0; j<k; j++)
+          if (!(is >> p[i].choice[j])) return false;
+      }
+      return true;
+    }
+
+    /// Stop object adding the statistics of the rest of the search to the ones of a job
+    class BaseStop : public Search::Stop {
+    private:
+      /// Stop object of the job
+      Search::Stop* so;
+      /// Statistics of the rest of the search
+      Search::Statistics base;
+    public:
+      /// Initialize with stop object \a s and statistics \a b
+      BaseStop(Search::Stop* s, const Search::Statistics& b) : so(s), base(b) {}
+      /// Return true if \a so stops the search with the statistics \a s added to \a base
+      virtual bool stop(const Search::Statistics& s, const Search::Options& o) {
+        Search::Statistics t(base);
+        t += s;
+        return so->stop(t,o);
+      }
+    };
+
+#ifndef _WIN32
+    /**
+     * \brief Buffered channel over a socket
+     *
+     * The messages are lines. A result is a line "result ID VALUE SLEN TLEN"
+     * followed by the statistics (SLEN bytes) and the sub-strategy (TLEN bytes).
+     */
+    class Channel {
+    private:
+      /// Socket
+      int fd;
+      /// Bytes read and not consumed yet
+      std::string buf;
+    public:
+      /// Initialize with socket \a f
+      Channel(int f) : fd(f) {}
+      /// Return the socket
+      int socket(void) const { return fd; }
+      /// Read the available bytes, return false at end of file
+      bool fill(void) {
+        char b[4096];
+        ssize_t n;
+        do {
+          n = read(fd, b, sizeof(b));
+        } while ((n < 0) && (errno == EINTR));
+        if (n <= 0) return false;
+        buf.append(b, static_cast<std::string::size_type>(n));
+        return true;
+      }
+      /// Return true if a line can be read without waiting for it
+      bool ready(void) const {
+        if (buf.find('\n') != std::string::npos) return true;
+        pollfd p;
+        p.fd = fd;
+        p.events = POLLIN;
+        p.revents = 0;
+        return poll(&p, 1, 0) > 0;
+      }
+      /// Read line \a l, return false at end of file
+      bool line(std::string& l) {
+        std::string::size_type e;
+        while ((e = buf.find('\n')) == std::string::npos)
+          if (!fill()) return false;
+        l = buf.substr(0, e);
+        buf.erase(0, e+1);
+        return true;
+      }
+      /// Read \a n bytes into \a s, return false at end of file
+      bool take(std::string::size_type n, std::string& s) {
+        while (buf.size() < n)
+          if (!fill()) return false;
+        s = buf.substr(0, n);
+        buf.erase(0, n);
+        return true;
+      }
+      /// Return true if a whole message is buffered
+      bool message(void) const {
+        std::string::size_type e = buf.find('\n');
+        if (e == std::string::npos) return false;
+        std::istringstream is(buf.substr(0, e));
+        std::string cmd;
+        int id, v;
+        std::string::size_type sl, tl;
+        if (!(is >> cmd) || (cmd != "result") || !(is >> id >> v >> sl >> tl))
+          return true;
+        return buf.size() >= e + 1 + sl + tl;
+      }
+      /// Send \a s, return false on error
+      bool send(const std::string& s) {
+        std::string::size_type o = 0;
+        while (o < s.size()) {
+          ssize_t n = write(fd, s.data() + o, s.size() - o);
+          if (n < 0) {
+            if (errno == EINTR) continue;
+            return false;
+          }
+          o += static_cast<std::string::size_type>(n);
+        }
+        return true;
+      }
+    };
+
+    /// Stop object of a job solved by a worker, the job is cancelled by the coordinator
+    class CancelStop : public Search::Stop {
+    private:
+      /// Channel to the coordinator
+      Channel& ch;
+      /// Stop object of the search options (NULL if none)
+      Search::Stop* so;
+      /// Message cancelling the job
+      std::string cancel;
+      /// Number of calls
+      unsigned int n;
+      /// Whether the job has been cancelled
+      bool bCancelled;
+    public:
+      /// Initialize for job \a id with channel \a c and stop object \a s
+      CancelStop(Channel& c, Search::Stop* s, int id)
+        : ch(c), so(s), n(0), bCancelled(false) {
+        std::ostringstream os;
+        os << "cancel " << id;
+        cancel = os.str();
+      }
+      /// Return true if the job has been cancelled or if \a so stops it
+      virtual bool stop(const Search::Statistics& s, const Search::Options& o) {
+        // The socket is only polled every 256 nodes
+        if (!bCancelled && ((++n & 255) == 0) && ch.ready()) {
+          std::string l;
+          // The cancellation of a job already solved is ignored
+          if (!ch.line(l) || (l == cancel) || (l == "quit")) bCancelled = true;
+        }
+        return bCancelled || ((so != NULL) && so->stop(s,o));
+      }
+      /// Return true if the job has been cancelled
+      bool cancelled(void) const { return bCancelled; }
+    };
+#endif
+  }
+
+  QDistributed::QDistributed(Space* s, unsigned int w, unsigned int d,
+                             const Search::Options& o)
+    : root(s), nWorkers(w), depth(d), opt(o), nCancelled(0), bStopped(false) {
+#ifdef _WIN32
+    nWorkers = 0;
+#endif
+  }
+
+  int
+  QDistributed::child(int p) {
+    Node n;
+    n.parent = p;
+    n.q = EXISTS;
+    n.open = 0;
+    n.value = -1;
+    n.vId = -1;
+    n.inf = 0;
+    n.sup = 0;
+    n.part = -1;
+    nodes.push_back(n);
+    return static_cast<int>(nodes.size()) - 1;
+  }
+
+  void
+  QDistributed::resolve(int n, bool v) {
+    nodes[n].value = v ? 1 : 0;
+    int p = nodes[n].parent;
+    if ((p < 0) || (nodes[p].value != -1)) return;
+    // A won child decides an existential node and a lost one a universal node,
+    // otherwise the node takes the value of its last child
+    if (((nodes[p].q == EXISTS) == v) || (--nodes[p].open == 0))
+      resolve(p, v);
+  }
+
+  bool
+  QDistributed::dead(int n) const {
+    for (int i=n; i>=0; i=nodes[i].parent)
+      if (nodes[i].value != -1) return true;
+    return false;
+  }
+
+  void
+  QDistributed::expand(Space* s, int n, unsigned int d, Prefix& p) {
+    SpaceStatus st = s->status(qs);
+    qs.node++;
+    // As in QDFS, a space with only watch propagators left is solved
+    if ((st != SS_FAILED) &&
+        (Home(*s).propagatorgroup().size(*s) == dynamic_cast<QSpaceInfo*>(s)->watchConstraints()))
+      st = SS_SOLVED;
+    if (st != SS_BRANCH) {
+      if (st == SS_FAILED) qs.fail++;
+      delete s;
+      resolve(n, st == SS_SOLVED);
+      return;
+    }
+    if (d == depth) {
+      Job j;
+      j.node = n;
+      j.prefix = p;
+      jobs.push_back(j);
+      delete s;
+      return;
+    }
+    const Choice* ch = s->choice();
+    Archive a;
+    ch->archive(a);
+    Support::Checkpoint::Edge e;
+    e.choice.resize(static_cast<std::size_t>(a.size()));
+    for (int i=0; i<a.size(); i++)
+      e.choice[i] = a[i];
+    nodes[n].q = dynamic_cast<QSpaceInfo*>(s)->brancherQuantifier(a[0]);
+    nodes[n].open = ch->alternatives();
+    for (unsigned int i=0; (i<ch->alternatives()) && !dead(n); i++) {
+      Space* c = s->clone();
+      c->commit(*ch, i);
+      // The value of the choice is given by its print, replayed so that
+      // neither the strategy nor the trace record it
+      QSpaceInfo* qc = dynamic_cast<QSpaceInfo*>(c);
+      int m = child(n);
+      std::ostringstream discard;
+      qc->replay(true);
+      c->print(*ch, i, discard);
+      qc->replayed(nodes[m].vId, nodes[m].inf, nodes[m].sup);
+      qc->replay(false);
+      e.alt = i;
+      p.push_back(e);
+      expand(c, m, d+1, p);
+      p.pop_back();
+    }
+    delete ch;
+    delete s;
+  }
+
+  bool
+  QDistributed::run(const Job& j, Search::Stop* st, const Search::Statistics& b,
+                    Part& p, Search::QStatistics& s) const {
+    // The job is solved on an unshared clone, so that it builds its own strategy
+    Space* c = root->clone(false);
+    for (Prefix::size_type i=0; i<j.prefix.size(); i++) {
+      Archive a;
+      for (std::vector<unsigned int>::size_type k=0; k<j.prefix[i].choice.size(); k++)
+        a << j.prefix[i].choice[k];
+      const Choice* ch = c->choice(a);
+      c->commit(*ch, j.prefix[i].alt);
+      delete ch;
+    }
+    Search::Options o(opt);
+    o.clone = false;
+    // As in QDFS::halt, the limits apply to the whole search
+    BaseStop bs(st, b);
+    o.stop = (st != NULL) ? &bs : NULL;
+    Support::CheckpointHide h;
+    Search::Engine* e = Search::qdfs(c, o);
+    Space* sol = e->next();
+    s = Search::qstatistics(e);
+    bool stop = e->stopped();
+    p.prefix = j.prefix;
+    p.value = (sol != NULL);
+    p.strategy.clear();
+    if (sol != NULL) {
+      std::ostringstream os;
+      dynamic_cast<QSpaceInfo*>(sol)->strategyPrint(os);
+      p.strategy = os.str();
+    }
+    delete sol;
+    delete e;
+    return !stop;
+  }
+
+  void
+  QDistributed::done(const Job& j, const Part& p, const Search::QStatistics& s) {
+    qs += s;
+    if (!dead(j.node)) {
+      nodes[j.node].part = static_cast<int>(solved.size());
+      solved.push_back(p);
+      resolve(j.node, p.value);
+    }
+    // The running jobs only know the statistics of the search when they started
+    if ((nodes[0].value == -1) && (opt.stop != NULL) && opt.stop->stop(qs,opt))
+      bStopped = true;
+  }
+
+  bool
+  QDistributed::local(std::vector<Job>::size_type i) {
+    if (dead(jobs[i].node)) {
+      nCancelled++;
+      return true;
+    }
+    Part p;
+    Search::QStatistics s;
+    if (!run(jobs[i], opt.stop, qs, p, s)) {
+      qs += s;
+      bStopped = true;
+      return false;
+    }
+    done(jobs[i], p, s);
+    return !bStopped;
+  }
+
+  void
+  QDistributed::sequential(void) {
+    for (std::vector<Job>::size_type i=0; i<jobs.size(); i++)
+      if (!local(i)) return;
+  }
+
+  bool
+  QDistributed::coordinate(void) {
+#ifdef _WIN32
+    return false;
+#else
+    /// Worker process
+    struct Worker {
+      pid_t pid;    ///< Process id
+      Channel* ch;  ///< Channel to the worker
+      int job;      ///< Running job (-1 if idle)
+      bool cancel;  ///< Whether the running job has been cancelled
+      bool alive;   ///< Whether the worker still answers
+    };
+    std::vector<Worker> w;
+    std::cout.flush();
+    std::cerr.flush();
+    // A dead worker is seen by a failed send instead of killing the coordinator
+    void (*pipe)(int) = signal(SIGPIPE, SIG_IGN);
+    for (unsigned int i=0; i<nWorkers; i++) {
+      int fds[2];
+      if (socketpair(AF_UNIX, SOCK_STREAM, 0, fds) != 0) break;
+      pid_t pid = fork();
+      if (pid == -1) {
+        close(fds[0]);
+        close(fds[1]);
+        break;
+      }
+      if (pid == 0) {
+        // Only this thread exists in the worker: the trace and the telemetry
+        // of the coordinator are left aside, the log has its own flusher
+        Support::TraceBuffer::detach();
+        Support::TelemetryProbe::detach();
+        close(fds[0]);
+        for (std::vector<Worker>::size_type k=0; k<w.size(); k++)
+          close(w[k].ch->socket());
+        work(fds[1]);
+        Support::Log::sync();
+        _exit(0);
+      }
+      close(fds[1]);
+      Worker x;
+      x.pid = pid;
+      x.ch = new Channel(fds[0]);
+      x.job = -1;
+      x.cancel = false;
+      x.alive = true;
+      w.push_back(x);
+    }
+    if (w.empty()) {
+      signal(SIGPIPE, pipe);
+      return false;
+    }
+
+    std::vector<Job>::size_type next = 0;
+    // Jobs of the workers which have died, solved by the coordinator
+    std::vector<std::vector<Job>::size_type> orphans;
+    std::vector<pollfd> pf;
+    while (!bStopped && !w.empty()) {
+      // Give the waiting jobs to the idle workers
+      bool busy = false;
+      for (std::vector<Worker>::size_type k=0; k<w.size(); k++) {
+        if (w[k].job == -1) {
+          while ((next < jobs.size()) && dead(jobs[next].node)) {
+            next++;
+            nCancelled++;
+          }
+          if (next < jobs.size()) {
+            std::ostringstream os;
+            // The job starts from the statistics of the search so far
+            os << "job " << next << " " << qs.node << " " << qs.fail << " ";
+            writePrefix(os, jobs[next].prefix);
+            os << "\n";
+            w[k].job = static_cast<int>(next++);
+            w[k].cancel = false;
+            if (!w[k].ch->send(os.str())) w[k].alive = false;
+          }
+        }
+        busy = busy || (w[k].job != -1);
+      }
+      if (!busy) break;
+
+      pf.resize(w.size());
+      for (std::vector<Worker>::size_type k=0; k<w.size(); k++) {
+        pf[k].fd = w[k].ch->socket();
+        pf[k].events = POLLIN;
+        pf[k].revents = 0;
+      }
+      if (poll(&pf[0], static_cast<nfds_t>(pf.size()), -1) < 0) {
+        if (errno == EINTR) continue;
+        bStopped = true;
+        break;
+      }
+      for (std::vector<Worker>::size_type k=0; k<w.size(); k++) {
+        if (!w[k].alive || (pf[k].revents == 0)) continue;
+        // A worker which has exited can't solve its job anymore
+        if (!w[k].ch->fill()) {
+          w[k].alive = false;
+          continue;
+        }
+        while (w[k].alive && w[k].ch->message()) {
+          std::string l;
+          w[k].ch->line(l);
+          std::istringstream is(l);
+          std::string cmd;
+          int id = -1;
+          is >> cmd >> id;
+          if ((id < 0) || (id >= static_cast<int>(jobs.size()))) continue;
+          if (cmd == "result") {
+            int v;
+            std::string::size_type sl, tl;
+            std::string ss;
+            Part p;
+            Search::QStatistics s;
+            is >> v >> sl >> tl;
+            // A result which can't be read comes from a broken worker
+            if (!w[k].ch->take(sl, ss) || !w[k].ch->take(tl, p.strategy)) {
+              w[k].alive = false;
+              break;
+            }
+            std::istringstream sis(ss);
+            if (!s.load(sis)) {
+              w[k].alive = false;
+              break;
+            }
+            p.prefix = jobs[id].prefix;
+            p.value = (v != 0);
+            done(jobs[id], p, s);
+          } else if (cmd == "stopped") {
+            bStopped = true;
+          }
+          if (id == w[k].job) w[k].job = -1;
+        }
+      }
+      // Cancel the running jobs whose value is not needed anymore
+      for (std::vector<Worker>::size_type k=0; k<w.size(); k++)
+        if (w[k].alive && (w[k].job != -1) && !w[k].cancel && dead(jobs[w[k].job].node)) {
+          std::ostringstream os;
+          os << "cancel " << w[k].job << "\n";
+          w[k].ch->send(os.str());
+          w[k].cancel = true;
+          nCancelled++;
+        }
+      // The job of a dead worker is given back to the coordinator
+      std::vector<Worker>::size_type a = 0;
+      for (std::vector<Worker>::size_type k=0; k<w.size(); k++) {
+        if (w[k].alive) {
+          w[a++] = w[k];
+          continue;
+        }
+        if ((w[k].job != -1) && !w[k].cancel)
+          orphans.push_back(static_cast<std::vector<Job>::size_type>(w[k].job));
+        close(w[k].ch->socket());
+        delete w[k].ch;
+        waitpid(w[k].pid, NULL, 0);
+      }
+      w.resize(a);
+    }
+    // A running worker takes the last message as a cancellation
+    for (std::vector<Worker>::size_type k=0; k<w.size(); k++) {
+      w[k].ch->send("quit\n");
+      close(w[k].ch->socket());
+      delete w[k].ch;
+      waitpid(w[k].pid, NULL, 0);
+    }
+    // Without workers left, the coordinator solves the remaining jobs
+    for (std::vector<std::vector<Job>::size_type>::size_type i=0;
+         !bStopped && (i<orphans.size()); i++)
+      local(orphans[i]);
+    for (; !bStopped && (next<jobs.size()); next++)
+      local(next);
+    signal(SIGPIPE, pipe);
+    return true;
+#endif
+  }
+
+  void
+  QDistributed::work(int fd) const {
+#ifdef _WIN32
+    (void) fd;
+#else
+    // The coordinator may close the socket before reading the last answer
+    signal(SIGPIPE, SIG_IGN);
+    // For the tests, the worker given this job dies without answering
+    const char* k = std::getenv("QUACODE_KILL_JOB");
+    int killed = (k != NULL) ? std::atoi(k) : -1;
+    Channel ch(fd);
+    std::string l;
+    while (ch.line(l)) {
+      std::istringstream is(l);
+      std::string cmd;
+      int id;
+      if (!(is >> cmd) || (cmd == "quit")) break;
+      Job j;
+      Search::Statistics b;
+      // The cancellation of a job already solved is ignored
+      if ((cmd != "job") || !(is >> id >> b.node >> b.fail) || !readPrefix(is, j.prefix))
+        continue;
+      if (id == killed) _exit(1);
+      CancelStop st(ch, opt.stop, id);
+      Part p;
+      Search::QStatistics s;
+      std::ostringstream os;
+      if (run(j, &st, b, p, s)) {
+        std::ostringstream ss;
+        s.save(ss);
+        os << "result " << id << " " << p.value << " " << ss.str().size()
+           << " " << p.strategy.size() << "\n" << ss.str() << p.strategy;
+      } else {
+        os << (st.cancelled() ? "cancelled " : "stopped ") << id << "\n";
+      }
+      if (!ch.send(os.str())) break;
+    }
+    close(fd);
+#endif
+  }
+
+  int
+  QDistributed::solve(void) {
+    nodes.clear();
+    jobs.clear();
+    solved.clear();
+    qs.reset();
+    nCancelled = 0;
+    bStopped = false;
+    if (root == NULL) return 0;
+    int r = child(-1);
+    if (root->status(qs) == SS_FAILED) {
+      qs.node++;
+      qs.fail++;
+      return 0;
+    }
+    Prefix p;
+    expand(root->clone(), r, 0, p);
+    if (nodes[r].value == -1)
+      if ((nWorkers == 0) || !coordinate())
+        sequential();
+    if (bStopped) return -1;
+    return nodes[r].value;
+  }
+
+  unsigned long int
+  QDistributed::frontier(void) const {
+    return jobs.size();
+  }
+
+  unsigned long int
+  QDistributed::cancelled(void) const {
+    return nCancelled;
+  }
+
+  const std::vector<QDistributed::Part>&
+  QDistributed::parts(void) const {
+    return solved;
+  }
+
+  bool
+  QDistributed::graft(SharedStrategy& ss, StrategyNode::Edge* e, int n,
+                      const std::vector< std::vector<int> >& c) const {
+    if (nodes[n].part != -1) {
+      std::istringstream is(solved[nodes[n].part].strategy);
+      return ss.graft(e, is);
+    }
+    for (std::vector<int>::size_type i=0; i<c[n].size(); i++) {
+      const Node& k = nodes[c[n][i]];
+      if (k.value != 1) continue;
+      // The choices of the branchers which are not quantified are not in the strategy
+      StrategyNode::Edge* f = (k.vId < 0) ? e : ss.choice(e, k.vId, k.inf, k.sup);
+      if ((f == NULL) || !graft(ss, f, c[n][i], c)) return false;
+      // A single won value is kept for an existential choice
+      if (nodes[n].q == EXISTS) break;
+    }
+    return true;
+  }
+
+  void
+  QDistributed::print(std::ostream& os) const {
+    QSpaceInfo* qsi = dynamic_cast<QSpaceInfo*>(root);
+    if ((qsi != NULL) && (qsi->strategyMethod() & StrategyMethodValues::BUILD) &&
+        !nodes.empty() && (nodes[0].value == 1)) {
+      std::vector< std::vector<int> > c(nodes.size());
+      for (std::vector<Node>::size_type i=1; i<nodes.size(); i++)
+        c[nodes[i].parent].push_back(static_cast<int>(i));
+      SharedStrategy ss;
+      if (graft(ss, ss.root(), 0, c)) {
+        ss.print(os);
+        return;
+      }
+    }
+    for (std::vector<Part>::size_type i=0; i<solved.size(); i++) {
+      os << "job";
+      // A commit is printed as brancher:alternative
+      for (Prefix::size_type j=0; j<solved[i].prefix.size(); j++)
+        os << " " << solved[i].prefix[j].choice[0] << ":" << solved[i].prefix[j].alt;
+      os << (solved[i].value ? " won" : " lost") << std::endl
+         << solved[i].strategy;
+    }
+  }
+
+  const Search::QStatistics&
+  QDistributed::qstatistics(void) const {
+    return qs;
+  }
+
+  bool
+  QDistributed::stopped(void) const {
+    return bStopped;
+  }
+
+  QDistributed::~QDistributed(void) {
+    delete root;
+  }
+
+}
+
+// STATISTICS: search-other
@@ -0,0 +1,207 @@
+/* -*- mode: C++; c-basic-offset: 2; indent-tabs-mode: nil -*- */
+/*
+ *  Main authors:
+ *     Vincent Barichard <Vincent.Barichard@univ-angers.fr>
+ *
+ *  Copyright:
+ *     Vincent Barichard, 2014
+ *
+ *  Last modified:
+ *     $Date$ by $Author$
+ *     $Revision$
+ *
+ *  This file is part of Quacode:
+ *     http://quacode.barichard.com
+ *
+ *  Permission is hereby granted, free of charge, to any person obtaining
+ *  a copy of this software and associated documentation files (the
+ *  "Software"), to deal in the Software without restriction, including
+ *  without limitation the rights to use, copy, modify, merge, publish,
+ *  distribute, sublicense, and/or sell copies of the Software, and to
+ *  permit persons to whom the Software is furnished to do so, subject to
+ *  the following conditions:
+ *
+ *  The above copyright notice and this permission notice shall be
+ *  included in all copies or substantial portions of the Software.
+ *
+ *  THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND,
+ *  EXPRESS OR IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF
+ *  MERCHANTABILITY, FITNESS FOR A PARTICULAR PURPOSE AND
+ *  NONINFRINGEMENT. IN NO EVENT SHALL THE AUTHORS OR COPYRIGHT HOLDERS BE
+ *  LIABLE FOR ANY CLAIM, DAMAGES OR OTHER LIABILITY, WHETHER IN AN ACTION
+ *  OF CONTRACT, TORT OR OTHERWISE, ARISING FROM, OUT OF OR IN CONNECTION
+ *  WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE SOFTWARE.
+ *
+ */
+
+#ifndef __GECODE_SEARCH_QDISTRIBUTED_HH__
+#define __GECODE_SEARCH_QDISTRIBUTED_HH__
+
+#include <quacode/qcsp.hh>
+#include <quacode/qspaceinfo.hh>
+#include <quacode/qstrategy.hh>
+#include <quacode/support/checkpoint.hh>
+#include <iostream>
+#include <string>
+#include <vector>
+
+namespace Gecode {
+
+  /**
+   * \brief Search of a quantified problem distributed over processes
+   *
+   * The coordinator expands the search tree up to the frontier of the
+   * nodes at \a depth choices from the root. Each node of the frontier is
+   * a job, given by the commits leading to it from the root in the format
+   * of the checkpoints (see Support::Checkpoint). The jobs are solved by
+   * \a workers processes forked from the coordinator, each one connected
+   * to it by a local socket pair. A worker rebuilds the node of a job from
+   * its copy of the root, solves it with QDFS and reports whether the job
+   * is won or lost, its statistics and its sub-strategy if the strategy is
+   * built.
+   *
+   * The results are aggregated up the expanded tree: a node whose choice
+   * is existential is won as soon as one of its children is won, a node
+   * whose choice is universal is lost as soon as one of its children is
+   * lost. Once the value of a node is known, the jobs below it are
+   * cancelled.
+   *
+   * The statistics of the jobs are added to the ones of the coordinator,
+   * the depths of a job are counted from its node.
+   *
+   * If the strategy is built, the sub-strategies of the won jobs are
+   * grafted below the choices leading to them from the root into a single
+   * strategy (see SharedStrategy). As the workers are processes, only the
+   * coordinator builds it, once the search is over.
+   *
+   * The stop object of the search options applies to the whole search. A
+   * job gives it the statistics of the search when the job started added
+   * to its own ones, and the coordinator checks it with the statistics of
+   * all the jobs each time a job ends. Without workers (and on Windows),
+   * the jobs are solved by the coordinator. The job of a worker which dies
+   * or sends a result which can't be read is solved by the coordinator
+   * once the other workers are done. For the tests, a worker dies when it
+   * receives the job whose number is given by the environment variable
+   * QUACODE_KILL_JOB.
+   * \ingroup TaskModelSearch
+   */
+  class QUACODE_EXPORT QDistributed {
+  public:
+    /// Solved job
+    class Part {
+    public:
+      /// Commits leading to the node of the job from the root
+      std::vector<Support::Checkpoint::Edge> prefix;
+      /// Whether the job is won
+      bool value;
+      /// Sub-strategy of the job (empty if the strategy is not built)
+      std::string strategy;
+    };
+  private:
+    /// Node of the expanded tree
+    struct Node {
+      /// Parent node (-1 for the root)
+      int parent;
+      /// Quantifier of the choice of the node
+      TQuantifier q;
+      /// Number of children whose value is unknown
+      unsigned int open;
+      /// Value of the node (-1 if unknown)
+      int value;
+      /// Branched variable of the choice leading to the node (-1 if not quantified)
+      int vId;
+      /// Inf value of the variable after the choice leading to the node
+      int inf;
+      /// Sup value of the variable after the choice leading to the node
+      int sup;
+      /// Solved job of the node (-1 if none)
+      int part;
+    };
+    /// Job of the frontier
+    struct Job {
+      /// Node of the job
+      int node;
+      /// Commits leading to the node from the root
+      std::vector<Support::Checkpoint::Edge> prefix;
+    };
+    /// The model (NULL if failed)
+    Space* root;
+    /// Number of worker processes
+    unsigned int nWorkers;
+    /// Depth of the frontier
+    unsigned int depth;
+    /// Search options
+    Search::Options opt;
+    /// Expanded tree
+    std::vector<Node> nodes;
+    /// Jobs of the frontier
+    std::vector<Job> jobs;
+    /// Solved jobs
+    std::vector<Part> solved;
+    /// Statistics of the coordinator and of all the jobs
+    Search::QStatistics qs;
+    /// Number of cancelled jobs
+    unsigned long int nCancelled;
+    /// Whether a job has been stopped
+    bool bStopped;
+    /// Expand space \a s of node \a n at \a d choices from the root, \a p gives the commits leading to it
+    void expand(Space* s, int n, unsigned int d, std::vector<Support::Checkpoint::Edge>& p);
+    /// Add a child to node \a p and return it
+    int child(int p);
+    /// Record the value \a v of node \a n and aggregate it up the tree
+    void resolve(int n, bool v);
+    /// Return true if the value of node \a n or of one of its ancestors is known
+    bool dead(int n) const;
+    /// Solve job \a j with stop object \a st, store the result in \a p and
+    /// the statistics in \a s. The statistics \a b of the rest of the search
+    /// are added to the ones of the job for \a st. Return false if the
+    /// search has been stopped
+    bool run(const Job& j, Search::Stop* st, const Search::Statistics& b,
+             Part& p, Search::QStatistics& s) const;
+    /// Record the result of job \a j
+    void done(const Job& j, const Part& p, const Search::QStatistics& s);
+    /// Solve the job \a i in this process, return false if it has been stopped
+    bool local(std::vector<Job>::size_type i);
+    /// Solve the jobs in this process
+    void sequential(void);
+    /// Solve the jobs with the worker processes, return false if they can't be created
+    bool coordinate(void);
+    /// Body of a worker process reading its jobs from \a fd
+    void work(int fd) const;
+    /// Graft below edge \a e of \a ss the strategy of the won node \a n,
+    /// \a c gives the children of the nodes. Return false if a sub-strategy
+    /// can't be grafted.
+    bool graft(SharedStrategy& ss, StrategyNode::Edge* e, int n,
+               const std::vector< std::vector<int> >& c) const;
+    /// Copy constructor (disabled)
+    QDistributed(const QDistributed&);
+  public:
+    /// Initialize with the model \a s (the object takes it over), \a w worker
+    /// processes, a frontier at depth \a d and options \a o
+    QDistributed(Space* s, unsigned int w, unsigned int d,
+                 const Search::Options& o=Search::Options::def);
+    /// Return 1 if the problem is true, 0 if it is false and -1 if the search has been stopped
+    int solve(void);
+    /// Return the number of jobs of the frontier
+    unsigned long int frontier(void) const;
+    /// Return the number of cancelled jobs
+    unsigned long int cancelled(void) const;
+    /// Return the solved jobs
+    const std::vector<Part>& parts(void) const;
+    /// Print the strategy of a true problem to \a os, in the format of
+    /// QSpaceInfo::strategyPrint. Otherwise (or if a sub-strategy can't be
+    /// grafted), print the prefix and the sub-strategy of each solved job.
+    void print(std::ostream& os) const;
+    /// Return the statistics of the coordinator and of all the jobs
+    const Search::QStatistics& qstatistics(void) const;
+    /// Check whether a job has been stopped
+    bool stopped(void) const;
+    /// Destructor
+    ~QDistributed(void);
+  };
+
+}
+
+#endif
+
+// STATISTICS: search-other
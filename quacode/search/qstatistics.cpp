@@ -0,0 +1,158 @@
+/* -*- mode: C++; c-basic-offset: 2; indent-tabs-mode: nil -*- */
+/*
+ *  Main authors:
+ *     Vincent Barichard <Vincent.Barichard@univ-angers.fr>
+ *
+ *  Copyright:
+ *     Vincent Barichard, 2014
+ *
+ *  Last modified:
+ *     $Date$ by $Author$
+ *     $Revision$
+ *
+ *  This file is part of Quacode:
+ *     http://quacode.barichard.com
+ *
+ *  Permission is hereby granted, free of charge, to any person obtaining
+ *  a copy of this software and associated documentation files (the
+ *  "Software"), to deal in the Software without restriction, including
+ *  without limitation the rights to use, copy, modify, merge, publish,
+ *  distribute, sublicense, and/or sell copies of the Software, and to
+ *  permit persons to whom the Software is furnished to do so, subject to
+ *  the following conditions:
+ *
+ *  The above copyright notice and this permission notice shall be
+ *  included in all copies or substantial portions of the Software.
+ *
+ *  THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND,
+ *  EXPRESS OR IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF
+ *  MERCHANTABILITY, FITNESS FOR A PARTICULAR PURPOSE AND
+ *  NONINFRINGEMENT. IN NO EVENT SHALL THE AUTHORS OR COPYRIGHT HOLDERS BE
+ *  LIABLE FOR ANY CLAIM, DAMAGES OR OTHER LIABILITY, WHETHER IN AN ACTION
+ *  OF CONTRACT, TORT OR OTHERWISE, ARISING FROM, OUT OF OR IN CONNECTION
+ *  WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE SOFTWARE.
+ *
+ */
+
+#include <quacode/qcsp.hh>
+#include <algorithm>
+#include <iomanip>
+#include <sstream>
+
+namespace Gecode { namespace Search {
+
+  QStatistics&
+  QStatistics::operator +=(const QStatistics& s) {
+    Statistics::operator +=(s);
+    for (std::vector<Counters>::size_type i=0; i<s.block.size(); i++)
+      atBlock(static_cast<unsigned int>(i), s.quantifier[i]) += s.block[i];
+    for (std::vector<Counters>::size_type i=0; i<s.depth.size(); i++)
+      atDepth(static_cast<unsigned int>(i)) += s.depth[i];
+    existPrunedBySuccess += s.existPrunedBySuccess;
+    forallPrunedByFailure += s.forallPrunedByFailure;
+    cloneMemory += s.cloneMemory;
+    pathMemory = std::max(pathMemory, s.pathMemory);
+    strategyMemory = std::max(strategyMemory, s.strategyMemory);
+    decomposition += s.decomposition;
+    componentHit += s.componentHit;
+    return *this;
+  }
+
+  namespace {
+    /// Print the counters \a c in a row of width \a w
+    void printCounters(std::ostream& os, const QStatistics::Counters& c, int w) {
+      os << std::setw(w) << c.node << std::setw(w) << c.fail
+         << std::setw(w) << c.success << std::setw(w) << c.recomputation
+         << std::setw(w) << c.clone << std::endl;
+    }
+    /// Write the counters \a c to \a os
+    void saveCounters(std::ostream& os, const QStatistics::Counters& c) {
+      os << " " << c.node << " " << c.fail << " " << c.success
+         << " " << c.recomputation << " " << c.clone;
+    }
+    /// Read the counters \a c from \a is
+    bool loadCounters(std::istream& is, QStatistics::Counters& c) {
+      return static_cast<bool>(is >> c.node >> c.fail >> c.success
+                                  >> c.recomputation >> c.clone);
+    }
+    /// Print the header of the counters, \a f is the name of the first column
+    void printHeader(std::ostream& os, const char* f, int w) {
+      os << "\t" << std::setw(12) << std::left << f << std::right
+         << std::setw(w) << "nodes" << std::setw(w) << "failures"
+         << std::setw(w) << "successes" << std::setw(w) << "recomputations"
+         << std::setw(w) << "clones" << std::endl;
+    }
+  }
+
+  void
+  QStatistics::print(std::ostream& os) const {
+    const int w = 15;
+    printHeader(os, "block", w);
+    for (std::vector<Counters>::size_type i=0; i<block.size(); i++) {
+      if (block[i].node == 0) continue;
+      std::ostringstream b;
+      if (i == 0) b << "root";
+      else b << i << ((quantifier[i] == FORALL) ? " (forall)" : " (exists)");
+      os << "\t" << std::setw(12) << std::left << b.str() << std::right;
+      printCounters(os, block[i], w);
+    }
+    printHeader(os, "depth", w);
+    for (std::vector<Counters>::size_type i=0; i<depth.size(); i++) {
+      if (depth[i].node == 0) continue;
+      os << "\t" << std::setw(12) << std::left << i << std::right;
+      printCounters(os, depth[i], w);
+    }
+    os << "\texistential alternatives pruned by success: " << existPrunedBySuccess << std::endl
+       << "\tuniversal alternatives pruned by failure:   " << forallPrunedByFailure << std::endl
+       << "\tmemory of clones:                           " << cloneMemory << " bytes ("
+       << static_cast<unsigned long int>(cloneSize()) << " bytes per clone)" << std::endl
+       << "\tpeak path memory:                           " << pathMemory << " bytes" << std::endl
+       << "\tpeak strategy memory:                       " << strategyMemory << " bytes" << std::endl;
+    if (decomposition > 0)
+      os << "\tnodes split into components:                " << decomposition << std::endl
+         << "\tcomponents found in cache:                  " << componentHit << std::endl;
+  }
+
+  void
+  QStatistics::save(std::ostream& os) const {
+    os << fail << " " << node << " " << depth.size() << " " << restart
+       << " " << nogood << " " << propagate << " " << Statistics::depth
+       << " " << existPrunedBySuccess << " " << forallPrunedByFailure
+       << " " << cloneMemory << " " << pathMemory << " " << strategyMemory
+       << " " << decomposition << " " << componentHit << std::endl;
+    os << block.size();
+    for (std::vector<Counters>::size_type i=0; i<block.size(); i++) {
+      os << " " << quantifier[i];
+      saveCounters(os, block[i]);
+    }
+    os << std::endl;
+    for (std::vector<Counters>::size_type i=0; i<depth.size(); i++)
+      saveCounters(os, depth[i]);
+    os << std::endl;
+  }
+
+  bool
+  QStatistics::load(std::istream& is) {
+    reset();
+    std::vector<Counters>::size_type nd, nb;
+    if (!(is >> fail >> node >> nd >> restart >> nogood >> propagate >> Statistics::depth
+             >> existPrunedBySuccess >> forallPrunedByFailure
+             >> cloneMemory >> pathMemory >> strategyMemory
+             >> decomposition >> componentHit >> nb))
+      return false;
+    block.resize(nb);
+    quantifier.resize(nb, EXISTS);
+    for (std::vector<Counters>::size_type i=0; i<nb; i++) {
+      int q;
+      if (!(is >> q) || !loadCounters(is, block[i])) return false;
+      quantifier[i] = (q == FORALL) ? FORALL : EXISTS;
+    }
+    depth.resize(nd);
+    for (std::vector<Counters>::size_type i=0; i<nd; i++)
+      if (!loadCounters(is, depth[i])) return false;
+    return true;
+  }
+
+}}
+
+// STATISTICS: search-other
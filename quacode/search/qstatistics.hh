@@ -0,0 +1,195 @@
+/* -*- mode: C++; c-basic-offset: 2; indent-tabs-mode: nil -*- */
+/*
+ *  Main authors:
+ *     Vincent Barichard <Vincent.Barichard@univ-angers.fr>
+ *
+ *  Copyright:
+ *     Vincent Barichard, 2014
+ *
+ *  Last modified:
+ *     $Date$ by $Author$
+ *     $Revision$
+ *
+ *  This file is part of Quacode:
+ *     http://quacode.barichard.com
+ *
+ *  Permission is hereby granted, free of charge, to any person obtaining
+ *  a copy of this software and associated documentation files (the
+ *  "Software"), to deal in the Software without restriction, including
+ *  without limitation the rights to use, copy, modify, merge, publish,
+ *  distribute, sublicense, and/or sell copies of the Software, and to
+ *  permit persons to whom the Software is furnished to do so, subject to
+ *  the following conditions:
+ *
+ *  The above copyright notice and this permission notice shall be
+ *  included in all copies or substantial portions of the Software.
+ *
+ *  THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND,
+ *  EXPRESS OR IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF
+ *  MERCHANTABILITY, FITNESS FOR A PARTICULAR PURPOSE AND
+ *  NONINFRINGEMENT. IN NO EVENT SHALL THE AUTHORS OR COPYRIGHT HOLDERS BE
+ *  LIABLE FOR ANY CLAIM, DAMAGES OR OTHER LIABILITY, WHETHER IN AN ACTION
+ *  OF CONTRACT, TORT OR OTHERWISE, ARISING FROM, OUT OF OR IN CONNECTION
+ *  WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE SOFTWARE.
+ *
+ */
+
+#ifndef __GECODE_SEARCH_QSTATISTICS_HH__
+#define __GECODE_SEARCH_QSTATISTICS_HH__
+
+#include <gecode/search.hh>
+#include <iostream>
+#include <vector>
+
+namespace Gecode { namespace Search {
+
+  /**
+   * \brief %Search statistics of quantified search engines
+   *
+   * In addition to the usual statistics, the counters of the search are
+   * given for each quantified brancher (a block of the binder) and for
+   * each depth. A node is accounted to the brancher of the choice which
+   * created it (the root node belongs to the pseudo-block 0) and to the
+   * number of choices above it.
+   *
+   * The pruning done by the quantifiers is counted as well: after a
+   * success, the remaining alternatives of the existential choices met
+   * while backtracking are not explored, after a failure the remaining
+   * alternatives of the universal choices are not explored.
+   *
+   * The memory is accounted with Space::allocated(): the bytes of the
+   * clones made for the path, the peak of the memory held by the clones
+   * of the path and the peak of the memory of the winning strategy.
+   *
+   * With the component decomposition, the nodes split into independent
+   * components and the components found in the cache are counted.
+   */
+  class QStatistics : public Statistics {
+  public:
+    /// Counters of a part of the search tree
+    class Counters {
+    public:
+      /// Number of nodes
+      unsigned long int node;
+      /// Number of failed nodes
+      unsigned long int fail;
+      /// Number of solved nodes
+      unsigned long int success;
+      /// Number of recomputed spaces
+      unsigned long int recomputation;
+      /// Number of clones
+      unsigned long int clone;
+      /// Initialize
+      Counters(void);
+      /// Reset
+      void reset(void);
+      /// Add counters \a c
+      Counters& operator +=(const Counters& c);
+    };
+    /// Counters of the blocks, indexed by brancher id (0 for the root)
+    std::vector<Counters> block;
+    /// Quantifier of the blocks
+    std::vector<TQuantifier> quantifier;
+    /// Counters of the depths
+    std::vector<Counters> depth;
+    /// Number of existential alternatives pruned by a success
+    unsigned long int existPrunedBySuccess;
+    /// Number of universal alternatives pruned by a failure
+    unsigned long int forallPrunedByFailure;
+    /// Total memory of the clones (in bytes)
+    unsigned long int cloneMemory;
+    /// Peak memory of the clones stored in the path (in bytes)
+    unsigned long int pathMemory;
+    /// Peak memory of the strategy (in bytes)
+    unsigned long int strategyMemory;
+    /// Number of nodes split into independent components
+    unsigned long int decomposition;
+    /// Number of components whose truth value was found in the cache
+    unsigned long int componentHit;
+    /// Return the mean memory of a clone (in bytes)
+    double cloneSize(void) const;
+    /// Initialize
+    QStatistics(void);
+    /// Reset
+    void reset(void);
+    /// Return counters of block \a b (of quantifier \a q)
+    Counters& atBlock(unsigned int b, TQuantifier q);
+    /// Return counters of depth \a d
+    Counters& atDepth(unsigned int d);
+    /// Add statistics \a s
+    QUACODE_EXPORT QStatistics& operator +=(const QStatistics& s);
+    /// Print the statistics of the blocks and depths
+    QUACODE_EXPORT void print(std::ostream& os) const;
+    /// Write all the statistics to \a os in a form read by load
+    QUACODE_EXPORT void save(std::ostream& os) const;
+    /// Read the statistics written by save from \a is, return false on error
+    QUACODE_EXPORT bool load(std::istream& is);
+  };
+
+
+  forceinline
+  QStatistics::Counters::Counters(void)
+    : node(0), fail(0), success(0), recomputation(0), clone(0) {}
+
+  forceinline void
+  QStatistics::Counters::reset(void) {
+    node = fail = success = recomputation = clone = 0;
+  }
+
+  forceinline QStatistics::Counters&
+  QStatistics::Counters::operator +=(const Counters& c) {
+    node += c.node;
+    fail += c.fail;
+    success += c.success;
+    recomputation += c.recomputation;
+    clone += c.clone;
+    return *this;
+  }
+
+  forceinline
+  QStatistics::QStatistics(void)
+    : existPrunedBySuccess(0), forallPrunedByFailure(0),
+      cloneMemory(0), pathMemory(0), strategyMemory(0),
+      decomposition(0), componentHit(0) {}
+
+  forceinline void
+  QStatistics::reset(void) {
+    Statistics::reset();
+    block.clear();
+    quantifier.clear();
+    depth.clear();
+    existPrunedBySuccess = forallPrunedByFailure = 0;
+    cloneMemory = pathMemory = strategyMemory = 0;
+    decomposition = componentHit = 0;
+  }
+
+  forceinline double
+  QStatistics::cloneSize(void) const {
+    unsigned long int n = 0;
+    for (std::vector<Counters>::size_type i=0; i<depth.size(); i++)
+      n += depth[i].clone;
+    return (n > 0) ? static_cast<double>(cloneMemory) / n : 0.0;
+  }
+
+  forceinline QStatistics::Counters&
+  QStatistics::atBlock(unsigned int b, TQuantifier q) {
+    if (b >= block.size()) {
+      block.resize(b+1);
+      quantifier.resize(b+1, EXISTS);
+    }
+    quantifier[b] = q;
+    return block[b];
+  }
+
+  forceinline QStatistics::Counters&
+  QStatistics::atDepth(unsigned int d) {
+    if (d >= depth.size())
+      depth.resize(d+1);
+    return depth[d];
+  }
+
+}}
+
+#endif
+
+// STATISTICS: search-other
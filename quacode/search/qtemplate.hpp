@@ -0,0 +1,100 @@
+/* -*- mode: C++; c-basic-offset: 2; indent-tabs-mode: nil -*- */
+/*
+ *  Main authors:
+ *     Vincent Barichard <Vincent.Barichard@univ-angers.fr>
+ *
+ *  Copyright:
+ *     Vincent Barichard, 2014
+ *
+ *  Last modified:
+ *     $Date$ by $Author$
+ *     $Revision$
+ *
+ *  This file is part of Quacode:
+ *     http://quacode.barichard.com
+ *
+ *  Permission is hereby granted, free of charge, to any person obtaining
+ *  a copy of this software and associated documentation files (the
+ *  "Software"), to deal in the Software without restriction, including
+ *  without limitation the rights to use, copy, modify, merge, publish,
+ *  distribute, sublicense, and/or sell copies of the Software, and to
+ *  permit persons to whom the Software is furnished to do so, subject to
+ *  the following conditions:
+ *
+ *  The above copyright notice and this permission notice shall be
+ *  included in all copies or substantial portions of the Software.
+ *
+ *  THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND,
+ *  EXPRESS OR IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF
+ *  MERCHANTABILITY, FITNESS FOR A PARTICULAR PURPOSE AND
+ *  NONINFRINGEMENT. IN NO EVENT SHALL THE AUTHORS OR COPYRIGHT HOLDERS BE
+ *  LIABLE FOR ANY CLAIM, DAMAGES OR OTHER LIABILITY, WHETHER IN AN ACTION
+ *  OF CONTRACT, TORT OR OTHERWISE, ARISING FROM, OUT OF OR IN CONNECTION
+ *  WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE SOFTWARE.
+ *
+ */
+
+namespace Gecode {
+
+  template<class T>
+  forceinline
+  QTemplate<T>::QTemplate(T* s) : root(s), n(0), bStopped(false) {
+    // The model is propagated once for all the instances
+    if (root->status() == SS_FAILED) {
+      delete root;
+      root = NULL;
+    }
+  }
+
+  template<class T>
+  forceinline bool
+  QTemplate<T>::failed(void) const {
+    return root == NULL;
+  }
+
+  template<class T>
+  template<class Delta>
+  forceinline T*
+  QTemplate<T>::solve(Delta d, const Search::Options& o) {
+    n++;
+    qs.reset();
+    bStopped = false;
+    if (root == NULL) return NULL;
+    // Without sharing, the strategy and the history of the clone are its own
+    T* c = static_cast<T*>(root->clone(false));
+    d(*c);
+    Search::Options co(o);
+    co.clone = false;
+    Support::CheckpointHide h;
+    QDFS<T> e(c,co);
+    T* s = e.next();
+    qs = e.qstatistics();
+    bStopped = e.stopped();
+    return s;
+  }
+
+  template<class T>
+  forceinline unsigned long int
+  QTemplate<T>::instances(void) const {
+    return n;
+  }
+
+  template<class T>
+  forceinline const Search::QStatistics&
+  QTemplate<T>::qstatistics(void) const {
+    return qs;
+  }
+
+  template<class T>
+  forceinline bool
+  QTemplate<T>::stopped(void) const {
+    return bStopped;
+  }
+
+  template<class T>
+  forceinline
+  QTemplate<T>::~QTemplate(void) {
+    delete root;
+  }
+
+}
@@ -55,9 +55,66 @@
 #include <gecode/search/worker.hh>
 
 #include <quacode/search/sequential/qpath.hh>
+#include <quacode/support/checkpoint.hh>
+#include <quacode/support/telemetry.hh>
+
+#include <algorithm>
+#include <unordered_map>
+#include <vector>
 
 namespace Gecode { namespace Search { namespace Sequential {
 
+  /**
+   * \brief Cache of the truth values of the solved components
+   *
+   * The components are identified by their signature (see
+   * QSpaceInfo::componentSignature). The cache is cleared when it
+   * reaches its maximal number of entries.
+   */
+  class QComponentCache {
+  private:
+    /// Hash function of the signatures
+    struct Hash {
+      std::size_t operator ()(const std::vector<int>& sig) const;
+    };
+    /// Truth values of the components
+    std::unordered_map<std::vector<int>,bool,Hash> values;
+    /// Maximal number of entries
+    std::size_t maxEntries;
+  public:
+    /// Initialize with at most \a m entries
+    QComponentCache(std::size_t m = 1 << 16);
+    /// Return true if the component \a sig is in the cache, its truth value is then stored in \a b
+    bool find(const std::vector<int>& sig, bool& b) const;
+    /// Record the truth value \a b of the component \a sig
+    void add(const std::vector<int>& sig, bool b);
+  };
+
+  forceinline std::size_t
+  QComponentCache::Hash::operator ()(const std::vector<int>& sig) const {
+    std::size_t h = 14695981039346656037ULL;
+    for (std::vector<int>::size_type i=0; i<sig.size(); i++)
+      h = (h ^ static_cast<unsigned int>(sig[i])) * 1099511628211ULL;
+    return h;
+  }
+
+  forceinline
+  QComponentCache::QComponentCache(std::size_t m) : maxEntries(m) {}
+
+  forceinline bool
+  QComponentCache::find(const std::vector<int>& sig, bool& b) const {
+    std::unordered_map<std::vector<int>,bool,Hash>::const_iterator it = values.find(sig);
+    if (it == values.end()) return false;
+    b = it->second;
+    return true;
+  }
+
+  forceinline void
+  QComponentCache::add(const std::vector<int>& sig, bool b) {
+    if (values.size() >= maxEntries) values.clear();
+    values[sig] = b;
+  }
+
   /// Depth-first search engine implementation
   class QDFS : public Worker {
   private:
@@ -69,6 +126,43 @@ namespace Gecode { namespace Search { namespace Sequential {
     Space* cur;
     /// Distance until next clone
     unsigned int d;
+    /// Statistics detailed by block and depth
+    QStatistics qs;
+    /// Id of the current node in the trace (0 if not traced)
+    uint64_t curId;
+    /// Telemetry of the thread (NULL if none)
+    Support::TelemetryProbe* tp;
+    /// Checkpoint bound to the engine (NULL if none)
+    Support::Checkpoint* cp;
+    /// Cache of the components, shared with the engines solving the components
+    QComponentCache* cache;
+    /// True if the cache belongs to this engine
+    bool ownCache;
+    /// Id in the trace of the parent of the root node (0 if none)
+    uint64_t rootParent;
+    /// Statistics of the engines solving the enclosing components
+    Statistics base;
+    /// Initialize for the component of space \a s with options \a o and cache \a c,
+    /// \a b gives the statistics of the engines solving the enclosing components
+    QDFS(Space* s, const Options& o, QComponentCache* c, uint64_t p, const Statistics& b);
+    /// Check the stop object against the statistics of the whole search
+    bool halt(void);
+    /// Solve the components of space \a s (if more than one), return 1 if they
+    /// are all true, 0 if one is false, 2 if the search was stopped and -1 if
+    /// the space was not decomposed
+    int components(Space* s);
+    /// Publish the current values to the telemetry, \a s gives the strategy
+    void publish(const Space* s);
+    /// Record the memory of the path and of the strategy of \a s
+    void memory(const Space* s);
+    /// Save the path leading to the current space to the checkpoint
+    void checkpoint(void);
+    /// Replay the path saved in the checkpoint from the current space
+    void resume(void);
+    /// Return counters of the block of the current node
+    QStatistics::Counters& curBlock(void);
+    /// Return counters of the depth of the current node
+    QStatistics::Counters& curDepth(void);
   public:
     /// Initialize for space \a s with options \a o
     QDFS(Space* s, const Options& o);
@@ -76,6 +170,8 @@ namespace Gecode { namespace Search { namespace Sequential {
     Space* next(void);
     /// Return statistics
     Statistics statistics(void) const;
+    /// Return statistics detailed by block and depth
+    QStatistics qstatistics(void) const;
     /// Constrain future solutions to be better than \a b (should never be called)
     void constrain(const Space& b);
     /// Reset engine to restart at space \a s
@@ -88,9 +184,13 @@ namespace Gecode { namespace Search { namespace Sequential {
 
   forceinline 
   QDFS::QDFS(Space* s, const Options& o)
-    : opt(o), path(static_cast<int>(opt.nogoods_limit)), d(0) {
+    : opt(o), path(static_cast<int>(opt.nogoods_limit)), d(0), curId(0),
+      tp(Support::TelemetryProbe::current()), cp(Support::Checkpoint::bind()),
+      cache(new QComponentCache()), ownCache(true), rootParent(0) {
     if ((s == NULL) || (s->status(*this) == SS_FAILED)) {
       fail++;
+      qs.atBlock(0,EXISTS).fail++;
+      qs.atDepth(0).fail++;
       cur = NULL;
       if (s) dynamic_cast<QSpaceInfo*>(s)->strategyFailed();
       if (!opt.clone)
@@ -98,6 +198,23 @@ namespace Gecode { namespace Search { namespace Sequential {
     } else {
       cur = snapshot(s,opt);
       dynamic_cast<QSpaceInfo*>(cur)->strategyInit();
+      if (cp && cp->resume()) resume();
+    }
+  }
+
+  forceinline
+  QDFS::QDFS(Space* s, const Options& o, QComponentCache* c, uint64_t p, const Statistics& b)
+    : opt(o), path(static_cast<int>(opt.nogoods_limit)), d(0), curId(0),
+      tp(NULL), cp(NULL), cache(c), ownCache(false), rootParent(p), base(b) {
+    // The space is a clone owned by the engine, there is no strategy to build
+    if (s->status(*this) == SS_FAILED) {
+      fail++;
+      qs.atBlock(0,EXISTS).fail++;
+      qs.atDepth(0).fail++;
+      cur = NULL;
+      delete s;
+    } else {
+      cur = s;
     }
   }
 
@@ -105,6 +222,7 @@ namespace Gecode { namespace Search { namespace Sequential {
   QDFS::reset(Space* s) {
     delete cur;
     path.reset();
+    qs.reset();
     d = 0;
     if ((s == NULL) || (s->status(*this) == SS_FAILED)) {
       cur = NULL;
@@ -121,6 +239,139 @@ namespace Gecode { namespace Search { namespace Sequential {
     return path;
   }
 
+  forceinline QStatistics::Counters&
+  QDFS::curBlock(void) {
+    if (path.empty())
+      return qs.atBlock(0,EXISTS);
+    return qs.atBlock(path.top().brancher(),path.top().quantifier());
+  }
+
+  forceinline QStatistics::Counters&
+  QDFS::curDepth(void) {
+    return qs.atDepth(static_cast<unsigned int>(path.entries()));
+  }
+
+  forceinline void
+  QDFS::publish(const Space* s) {
+    Support::TelemetrySample ts;
+    ts.node = node;
+    ts.fail = fail;
+    ts.clone = 0;
+    for (std::size_t i = 0; i < qs.depth.size(); i++)
+      ts.clone += qs.depth[i].clone;
+    ts.depth = static_cast<unsigned int>(path.entries());
+    ts.brancher = path.empty() ? 0 : path.top().brancher();
+    ts.quantifier = path.empty() ? EXISTS : path.top().quantifier();
+    ts.strategyMemory = s ? dynamic_cast<const QSpaceInfo*>(s)->strategyMemory() : 0;
+    ts.cloneMemory = qs.cloneMemory;
+    ts.pathMemory = path.memory();
+    tp->publish(ts);
+  }
+
+  forceinline void
+  QDFS::memory(const Space* s) {
+    if (path.memory() > qs.pathMemory)
+      qs.pathMemory = path.memory();
+    if (s != NULL) {
+      std::size_t m = dynamic_cast<const QSpaceInfo*>(s)->strategyMemory();
+      if (m > qs.strategyMemory) qs.strategyMemory = m;
+    }
+  }
+
+  forceinline void
+  QDFS::checkpoint(void) {
+    std::vector<Support::Checkpoint::Edge> p(static_cast<std::size_t>(path.entries()));
+    for (int i=0; i<path.entries(); i++) {
+      Archive a;
+      path.edge(i).choice()->archive(a);
+      p[i].choice.resize(static_cast<std::size_t>(a.size()));
+      for (int j=0; j<a.size(); j++)
+        p[i].choice[j] = a[j];
+      p[i].alt = path.edge(i).alt();
+    }
+    cp->save(p,qstatistics(),*dynamic_cast<QSpaceInfo*>(cur));
+  }
+
+  forceinline void
+  QDFS::resume(void) {
+    std::vector<Support::Checkpoint::Edge> p;
+    QStatistics s;
+    if (!cp->load(p,s,*dynamic_cast<QSpaceInfo*>(cur)))
+      return;
+    static_cast<Statistics&>(*this) = s;
+    qs = s;
+    // The choices are rebuilt from their archives, they don't depend on the
+    // heuristics of the branchers. The root is kept as the clone of the path.
+    // As in next, each commit is printed so that the history of the search
+    // follows the path, the strategy is the saved one.
+    QSpaceInfo* qsi = dynamic_cast<QSpaceInfo*>(cur);
+    qsi->replay(true);
+    for (std::vector<Support::Checkpoint::Edge>::size_type i=0; i<p.size(); i++) {
+      Archive a;
+      for (std::vector<unsigned int>::size_type j=0; j<p[i].choice.size(); j++)
+        a << p[i].choice[j];
+      const Choice* ch = cur->choice(a);
+      path.push(*this,cur,(i == 0) ? cur->clone() : NULL,ch,p[i].alt);
+      // The alternative of a reused (LAO) edge is past the last one
+      unsigned int alt = std::min(p[i].alt,ch->alternatives()-1);
+      cur->commit(*ch,alt);
+      cur->print(*ch,alt,UNUSED_STREAM);
+    }
+    qsi->replay(false);
+    d = static_cast<unsigned int>(path.entries());
+    memory(NULL);
+  }
+
+  forceinline bool
+  QDFS::halt(void) {
+    if (opt.stop == NULL) return false;
+    // The limits apply to the whole search, not to the current component
+    Statistics t(base);
+    t += *this;
+    if (opt.stop->stop(t,opt)) _stopped = true;
+    return _stopped;
+  }
+
+  forceinline int
+  QDFS::components(Space* s) {
+    QSpaceInfo* qsi = dynamic_cast<QSpaceInfo*>(s);
+    std::vector<int> comp;
+    unsigned int n = qsi->components(comp);
+    if (n < 2) return -1;
+    qs.decomposition++;
+    std::vector<int> sig;
+    std::vector<char> inComp(comp.size());
+    for (unsigned int c=0; c<n; c++) {
+      qsi->componentSignature(comp,static_cast<int>(c),sig);
+      bool b;
+      if (cache->find(sig,b)) {
+        qs.componentHit++;
+      } else {
+        for (std::vector<int>::size_type i=0; i<comp.size(); i++)
+          inComp[i] = (comp[i] == static_cast<int>(c));
+        // Solve the component on a clone whose branchers are restricted to it
+        Space* cs = s->clone();
+        dynamic_cast<QSpaceInfo*>(cs)->restrictComponent(&inComp);
+        // In the trace, the root of the component is a child without choice of the current node
+        if (Support::TraceBuffer* tb = Support::TraceBuffer::current())
+          tb->choice(-1,0,0);
+        Statistics b(base);
+        b += *this;
+        QDFS sub(cs,opt,cache,curId,b);
+        Space* sol = sub.next();
+        b = (sol != NULL);
+        delete sol;
+        QStatistics ss = sub.qstatistics();
+        static_cast<Statistics&>(*this) += ss;
+        qs += ss;
+        if (sub.stopped()) return 2;
+        cache->add(sig,b);
+      }
+      if (!b) return 0;
+    }
+    return 1;
+  }
+
   forceinline Space*
   QDFS::next(void) {
     Space * solvedSpace = NULL;
@@ -129,9 +380,16 @@ namespace Gecode { namespace Search { namespace Sequential {
     start();
     while (true) {
       while (cur) {
-        if (stop(opt))
+        if (halt()) {
+          if (tp) publish(cur);
+          if (cp) checkpoint();
           return NULL;
+        }
+        if (cp && cp->due()) checkpoint();
         node++;
+        curBlock().node++;
+        curDepth().node++;
+        if (tp && tp->wanted()) publish(cur);
 
         SpaceStatus curStatus = cur->status(*this);
         // If no more propagators in space then all is succes below.
@@ -139,19 +397,51 @@ namespace Gecode { namespace Search { namespace Sequential {
         // If it remains only Watch Propagators, then it is a success!
         if ((!cur->failed()) && (Home(*cur).propagatorgroup().size(*cur) == dynamic_cast<QSpaceInfo*>(cur)->watchConstraints())) curStatus = SS_SOLVED;
 
+        curId = 0;
+        if (Support::TraceBuffer* tb = Support::TraceBuffer::current()) {
+          curId = tb->id();
+          tb->node(curId, path.empty() ? rootParent : path.top().node(),
+                   path.empty() ? 0 : path.top().brancher(),
+                   path.empty() ? EXISTS : path.top().quantifier(),
+                   (curStatus == SS_FAILED) ? Support::TraceRecord::FAILED :
+                   ((curStatus == SS_SOLVED) ? Support::TraceRecord::SOLVED :
+                                               Support::TraceRecord::BRANCH));
+        }
+
+        // The value of a node split into independent components is the
+        // conjunction of the values of the components
+        if ((curStatus == SS_BRANCH) && dynamic_cast<QSpaceInfo*>(cur)->componentDecomposition()) {
+          switch (components(cur)) {
+          case 0: curStatus = SS_FAILED; break;
+          case 1: curStatus = SS_SOLVED; break;
+          case 2:
+            _stopped = true;
+            if (tp) publish(cur);
+            if (cp) checkpoint();
+            return NULL;
+          default: break;
+          }
+        }
+
         switch (curStatus) {
         case SS_FAILED:
           dynamic_cast<QSpaceInfo*>(cur)->scenarioFailed();
+          memory(cur);
           // On devra dépiler jusqu'au dernier existentiel
           bckQuant = EXISTS;
           fail++;
+          curBlock().fail++;
+          curDepth().fail++;
           failedSpace = cur;
           cur = NULL;
           break;
         case SS_SOLVED:
           dynamic_cast<QSpaceInfo*>(cur)->scenarioSuccess();
+          memory(cur);
           // We will must go back to the last universal variable
           bckQuant = FORALL;
+          curBlock().success++;
+          curDepth().success++;
           // Deletes all pending branchers
           {
             const Choice* ch = cur->choice();
@@ -166,11 +456,18 @@ namespace Gecode { namespace Search { namespace Sequential {
             if ((d == 0) || (d >= opt.c_d)) {
               c = cur->clone();
               d = 1;
+              curBlock().clone++;
+              curDepth().clone++;
             } else {
               c = NULL;
               d++;
             }
             const Choice* ch = path.push(*this,cur,c);
+            path.top().node(curId);
+            if (c != NULL) {
+              qs.cloneMemory += path.top().bytes();
+              memory(NULL);
+            }
             cur->commit(*ch,0);
             cur->print(*ch,0,UNUSED_STREAM);
             break;
@@ -180,9 +477,11 @@ namespace Gecode { namespace Search { namespace Sequential {
         }
       }
       do {
-        if (!path.next(bckQuant))
+        if (!path.next(bckQuant,qs))
         {
           cur = NULL;
+          if (tp) publish(solvedSpace ? solvedSpace : failedSpace);
+          if (cp) cp->remove();
           if (solvedSpace)
           {
             dynamic_cast<QSpaceInfo*>(solvedSpace)->strategySuccess();
@@ -197,7 +496,13 @@ namespace Gecode { namespace Search { namespace Sequential {
             return NULL;
           }
         }
-        cur = path.recompute(d,opt.a_d,*this);
+        cur = path.recompute(d,opt.a_d,*this,qs);
+        memory(NULL);
+        // A distance of 0 means that the clone of the edge was reused
+        if ((cur != NULL) && (d > 0)) {
+          curBlock().recomputation++;
+          curDepth().recomputation++;
+        }
       } while (cur == NULL);
       if (solvedSpace)
       {
@@ -219,6 +524,13 @@ namespace Gecode { namespace Search { namespace Sequential {
     return *this;
   }
 
+  forceinline QStatistics
+  QDFS::qstatistics(void) const {
+    QStatistics s(qs);
+    static_cast<Statistics&>(s) = *this;
+    return s;
+  }
+
   forceinline void
   QDFS::constrain(const Space& b) {
     (void) b;
@@ -229,6 +541,7 @@ namespace Gecode { namespace Search { namespace Sequential {
   QDFS::~QDFS(void) {
     delete cur;
     path.reset();
+    if (ownCache) delete cache;
   }
 
 }}}
@@ -88,21 +88,37 @@ namespace Gecode { namespace Search { namespace Sequential {
       const Choice* _choice;
       /// Quantifier of edge
       TQuantifier _quantifier;
+      /// Id of the brancher of the choice
+      unsigned int _brancher;
+      /// Id of the node of the choice in the trace (0 if not traced)
+      uint64_t _node;
+      /// Memory allocated by the space of the edge (in bytes)
+      std::size_t _bytes;
     public:
       /// Default constructor
       Edge(void);
       /// Edge for space \a s with clone \a c (possibly NULL)
       Edge(Space* s, Space* c);
+      /// Edge for choice \a ch of space \a s with clone \a c (possibly NULL), at alternative \a a
+      Edge(Space* s, Space* c, const Choice* ch, unsigned int a);
 
       /// Return space for edge
       Space* space(void) const;
       /// Set space to \a s
       void space(Space* s);
+      /// Return memory allocated by the space of the edge (in bytes)
+      std::size_t bytes(void) const;
 
       /// Return choice
       const Choice* choice(void) const;
       /// Return quantifier
       TQuantifier quantifier(void) const;
+      /// Return id of the brancher of the choice
+      unsigned int brancher(void) const;
+      /// Return id of the node of the choice in the trace
+      uint64_t node(void) const;
+      /// Set id of the node of the choice in the trace to \a n
+      void node(uint64_t n);
 
       /// Return number for alternatives
       unsigned int alt(void) const;
@@ -125,6 +141,12 @@ namespace Gecode { namespace Search { namespace Sequential {
     Support::DynamicStack<Edge,Heap> ds;
     /// Depth limit for no-good generation
     int _ngdl;
+    /// Memory allocated by the spaces of the stack (in bytes)
+    std::size_t _memory;
+    /// Pop and dispose the topmost edge
+    void pop(void);
+    /// Set the space of the entry at position \a i to \a s
+    void space(int i, Space* s);
   public:
     /// Initialize with no-good depth limit \a l
     QPath(int l);
@@ -134,10 +156,16 @@ namespace Gecode { namespace Search { namespace Sequential {
     void ngdl(int l);
     /// Push space \a c (a clone of \a s or NULL)
     const Choice* push(Worker& stat, Space* s, Space* c);
-    /// Generate path for next node with the given quantifier and return whether a next node exists
-    bool next(TQuantifier q);
+    /// Push space \a c (a clone of \a s or NULL) with choice \a ch at alternative \a a
+    /// (when the path is restored from a checkpoint)
+    void push(Worker& stat, Space* s, Space* c, const Choice* ch, unsigned int a);
+    /// Generate path for next node with the given quantifier and return whether a next node exists,
+    /// the alternatives pruned are recorded in \a qs
+    bool next(TQuantifier q, QStatistics& qs);
     /// Provide access to topmost edge
     Edge& top(void) const;
+    /// Provide access to edge at position \a i
+    const Edge& edge(int i) const;
     /// Test whether path is empty
     bool empty(void) const;
     /// Return position on stack of last copy
@@ -146,13 +174,15 @@ namespace Gecode { namespace Search { namespace Sequential {
     void unwind(int l);
     /// Commit space \a s as described by stack entry at position \a i
     void commit(Space* s, int i) const;
-    /// Recompute space according to path 
-    Space* recompute(unsigned int& d, unsigned int a_d, Worker& s);
+    /// Recompute space according to path, the clones are recorded in \a qs
+    Space* recompute(unsigned int& d, unsigned int a_d, Worker& s, QStatistics& qs);
     /// Recompute space according to path
     Space* recompute(unsigned int& d, unsigned int a_d, Worker& s,
                      const Space* best, int& mark);
     /// Return number of entries on stack
     int entries(void) const;
+    /// Return memory allocated by the spaces of the stack (in bytes)
+    std::size_t memory(void) const;
     /// Reset stack
     void reset(void);
     /// Post no-goods
@@ -169,12 +199,24 @@ namespace Gecode { namespace Search { namespace Sequential {
 
   forceinline
   QPath::Edge::Edge(Space* s, Space* c)
-    : _space(c), _alt(0), _choice(s->choice()) {
+    : _space(c), _alt(0), _choice(s->choice()), _node(0),
+      _bytes(c ? c->allocated() : 0) {
     QSpaceInfo* qSpaceInfo = dynamic_cast<QSpaceInfo*>(s);
     Archive a;
     _choice->archive(a);
-    unsigned int brancherId = static_cast<unsigned int>(a[0]);
-    _quantifier = qSpaceInfo->brancherQuantifier(brancherId);
+    _brancher = static_cast<unsigned int>(a[0]);
+    _quantifier = qSpaceInfo->brancherQuantifier(_brancher);
+  }
+
+  forceinline
+  QPath::Edge::Edge(Space* s, Space* c, const Choice* ch, unsigned int a)
+    : _space(c), _alt(a), _choice(ch), _node(0),
+      _bytes(c ? c->allocated() : 0) {
+    QSpaceInfo* qSpaceInfo = dynamic_cast<QSpaceInfo*>(s);
+    Archive ar;
+    _choice->archive(ar);
+    _brancher = static_cast<unsigned int>(ar[0]);
+    _quantifier = qSpaceInfo->brancherQuantifier(_brancher);
   }
 
   forceinline Space*
@@ -184,6 +226,12 @@ namespace Gecode { namespace Search { namespace Sequential {
   forceinline void
   QPath::Edge::space(Space* s) {
     _space = s;
+    _bytes = s ? s->allocated() : 0;
+  }
+
+  forceinline std::size_t
+  QPath::Edge::bytes(void) const {
+    return _bytes;
   }
 
   forceinline unsigned int
@@ -222,6 +270,20 @@ namespace Gecode { namespace Search { namespace Sequential {
     return _quantifier;
   }
 
+  forceinline unsigned int
+  QPath::Edge::brancher(void) const {
+    return _brancher;
+  }
+
+  forceinline uint64_t
+  QPath::Edge::node(void) const {
+    return _node;
+  }
+  forceinline void
+  QPath::Edge::node(uint64_t n) {
+    _node = n;
+  }
+
   forceinline void
   QPath::Edge::dispose(void) {
     delete _space;
@@ -237,7 +299,7 @@ namespace Gecode { namespace Search { namespace Sequential {
 
   forceinline
   QPath::QPath(int l) 
-    : ds(heap), _ngdl(l) {}
+    : ds(heap), _ngdl(l), _memory(0) {}
 
   forceinline int
   QPath::ngdl(void) const {
@@ -249,28 +311,61 @@ namespace Gecode { namespace Search { namespace Sequential {
     _ngdl = l;
   }
 
+  forceinline void
+  QPath::pop(void) {
+    _memory -= ds.top().bytes();
+    ds.pop().dispose();
+  }
+
+  forceinline void
+  QPath::space(int i, Space* s) {
+    _memory -= ds[i].bytes();
+    ds[i].space(s);
+    _memory += ds[i].bytes();
+  }
+
+  forceinline std::size_t
+  QPath::memory(void) const {
+    return _memory;
+  }
+
   forceinline const Choice*
   QPath::push(Worker& stat, Space* s, Space* c) {
     if (!ds.empty() && ds.top().lao()) {
       // Topmost stack entry was LAO -> reuse
-      ds.pop().dispose();
+      pop();
     }
     Edge sn(s,c);
     ds.push(sn);
+    _memory += sn.bytes();
     stat.stack_depth(static_cast<unsigned long int>(ds.entries()));
     return sn.choice();
   }
 
+  forceinline void
+  QPath::push(Worker& stat, Space* s, Space* c, const Choice* ch, unsigned int a) {
+    if (!ds.empty() && ds.top().lao())
+      pop();
+    Edge sn(s,c,ch,a);
+    ds.push(sn);
+    _memory += sn.bytes();
+    stat.stack_depth(static_cast<unsigned long int>(ds.entries()));
+  }
+
   forceinline bool
-  QPath::next(TQuantifier q) {
+  QPath::next(TQuantifier q, QStatistics& qs) {
     // Generate path for next node with quantifier q and return whether node exists.
     while (!ds.empty())
     {
     	if (ds.top().rightmost())
     	{
-        ds.pop().dispose();
+        pop();
       } else if (q != ds.top().quantifier()) {
-        ds.pop().dispose();
+        // The remaining alternatives are pruned by the quantifier
+        unsigned long int pruned = ds.top().choice()->alternatives() - ds.top().alt() - 1;
+        if (q == FORALL) qs.existPrunedBySuccess += pruned;
+        else qs.forallPrunedByFailure += pruned;
+        pop();
       } else {
         ds.top().next();
         return true;
@@ -285,6 +380,11 @@ namespace Gecode { namespace Search { namespace Sequential {
     return ds.top();
   }
 
+  forceinline const QPath::Edge&
+  QPath::edge(int i) const {
+    return ds[i];
+  }
+
   forceinline bool
   QPath::empty(void) const {
     return ds.empty();
@@ -314,18 +414,18 @@ namespace Gecode { namespace Search { namespace Sequential {
     assert((ds[l].space() == NULL) || ds[l].space()->failed());
     int n = ds.entries();
     for (int i=l; i<n; i++)
-      ds.pop().dispose();
+      pop();
     assert(ds.entries() == l);
   }
 
   inline void
   QPath::reset(void) {
     while (!ds.empty())
-      ds.pop().dispose();
+      pop();
   }
 
   forceinline Space*
-  QPath::recompute(unsigned int& d, unsigned int a_d, Worker& stat) {
+  QPath::recompute(unsigned int& d, unsigned int a_d, Worker& stat, QStatistics& qs) {
     assert(!ds.empty());
     // Recompute space according to path
     // Also say distance to copy (d == 0) requires immediate copying
@@ -336,7 +436,7 @@ namespace Gecode { namespace Search { namespace Sequential {
       s->commit(*ds.top().choice(),ds.top().alt());
       s->print(*ds.top().choice(),ds.top().alt(),UNUSED_STREAM);
       assert(ds.entries()-1 == lc());
-      ds.top().space(NULL);
+      space(ds.entries()-1,NULL);
       // Mark as reusable
       if (ds.entries() > ngdl())
         ds.top().next();
@@ -376,10 +476,18 @@ namespace Gecode { namespace Search { namespace Sequential {
           // s must be deleted as it is not on the stack
           delete s;
           stat.fail++;
+          if (i > 0) qs.atBlock(ds[i-1].brancher(), ds[i-1].quantifier()).fail++;
+          else qs.atBlock(0, EXISTS).fail++;
+          qs.atDepth(static_cast<unsigned int>(i)).fail++;
           unwind(i);
           return NULL;
         }
-        ds[i].space(s->clone());
+        space(i,s->clone());
+        qs.cloneMemory += ds[i].bytes();
+        // The clone is the node created by the edge above entry i
+        if (i > 0) qs.atBlock(ds[i-1].brancher(), ds[i-1].quantifier()).clone++;
+        else qs.atBlock(0, EXISTS).clone++;
+        qs.atDepth(static_cast<unsigned int>(i)).clone++;
         d = static_cast<unsigned int>(n-i);
       }
       // Finally do the remaining commits
@@ -407,7 +515,7 @@ namespace Gecode { namespace Search { namespace Sequential {
         mark = ds.entries()-1;
         s->constrain(*best);
       }
-      ds.top().space(NULL);
+      space(ds.entries()-1,NULL);
       // Mark as reusable
       if (ds.entries() > ngdl())
         ds.top().next();
@@ -437,7 +545,7 @@ namespace Gecode { namespace Search { namespace Sequential {
       // copy: a copy might be much smaller due to flushed caches
       // of propagators
       Space* c = s->clone();
-      ds[l].space(c);
+      space(l,c);
     } else {
       s = s->clone();
     }
@@ -473,7 +581,7 @@ namespace Gecode { namespace Search { namespace Sequential {
           unwind(i);
           return NULL;
         }
-        ds[i].space(s->clone());
+        space(i,s->clone());
         d = static_cast<unsigned int>(n-i);
       }
       // Finally do the remaining commits
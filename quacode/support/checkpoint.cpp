@@ -0,0 +1,172 @@
+/* -*- mode: C++; c-basic-offset: 2; indent-tabs-mode: nil -*- */
+/*
+ *  Main authors:
+ *     Vincent Barichard <Vincent.Barichard@univ-angers.fr>
+ *
+ *  Copyright:
+ *     Vincent Barichard, 2014
+ *
+ *  Last modified:
+ *     $Date$ by $Author$
+ *     $Revision$
+ *
+ *  This file is part of Quacode:
+ *     http://quacode.barichard.com
+ *
+ *  Permission is hereby granted, free of charge, to any person obtaining
+ *  a copy of this software and associated documentation files (the
+ *  "Software"), to deal in the Software without restriction, including
+ *  without limitation the rights to use, copy, modify, merge, publish,
+ *  distribute, sublicense, and/or sell copies of the Software, and to
+ *  permit persons to whom the Software is furnished to do so, subject to
+ *  the following conditions:
+ *
+ *  The above copyright notice and this permission notice shall be
+ *  included in all copies or substantial portions of the Software.
+ *
+ *  THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND,
+ *  EXPRESS OR IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF
+ *  MERCHANTABILITY, FITNESS FOR A PARTICULAR PURPOSE AND
+ *  NONINFRINGEMENT. IN NO EVENT SHALL THE AUTHORS OR COPYRIGHT HOLDERS BE
+ *  LIABLE FOR ANY CLAIM, DAMAGES OR OTHER LIABILITY, WHETHER IN AN ACTION
+ *  OF CONTRACT, TORT OR OTHERWISE, ARISING FROM, OUT OF OR IN CONNECTION
+ *  WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE SOFTWARE.
+ *
+ */
+#include <quacode/support/checkpoint.hh>
+#include <quacode/support/clock.hh>
+#include <algorithm>
+#include <cstdio>
+#include <fstream>
+#include <iostream>
+
+namespace Gecode { namespace Support {
+
+  namespace {
+    /// First line of a checkpoint file
+    const char* header = "quacode-checkpoint 2";
+  }
+
+  thread_local Checkpoint* Checkpoint::cur = NULL;
+
+  Checkpoint::Checkpoint(const char* f, unsigned int ms, bool resume)
+    : previous(cur), fn(f), interval(static_cast<uint64_t>(ms) * 1000000),
+      last(clockNow()), cost(0), calls(period), bResume(resume), bBound(false) {
+    cur = this;
+  }
+
+  Checkpoint::~Checkpoint(void) {
+    cur = previous;
+  }
+
+  Checkpoint*
+  Checkpoint::current(void) {
+    return cur;
+  }
+
+  Checkpoint*
+  Checkpoint::bind(void) {
+    if ((cur == NULL) || cur->bBound) return NULL;
+    cur->bBound = true;
+    return cur;
+  }
+
+  CheckpointHide::CheckpointHide(void) : cp(Checkpoint::cur) {
+    Checkpoint::cur = NULL;
+  }
+
+  CheckpointHide::~CheckpointHide(void) {
+    Checkpoint::cur = cp;
+  }
+
+  const char*
+  Checkpoint::file(void) const {
+    return fn.c_str();
+  }
+
+  bool
+  Checkpoint::elapsed(void) const {
+    return clockNow() - last >= std::max(interval, 10 * cost);
+  }
+
+  bool
+  Checkpoint::resume(void) {
+    bool r = bResume;
+    bResume = false;
+    return r;
+  }
+
+  bool
+  Checkpoint::save(const std::vector<Edge>& p, const Search::QStatistics& s,
+                   const QSpaceInfo& qsi) {
+    uint64_t start = clockNow();
+    bool ok = write(p, s, qsi);
+    last = clockNow();
+    cost = last - start;
+    return ok;
+  }
+
+  bool
+  Checkpoint::write(const std::vector<Edge>& p, const Search::QStatistics& s,
+                    const QSpaceInfo& qsi) const {
+    // The file is replaced only once the new checkpoint is complete
+    std::string tmp = fn + ".tmp";
+    {
+      std::ofstream os(tmp.c_str());
+      if (!os) return false;
+      os << header << std::endl
+         << "model " << qsi.fingerprint() << std::endl;
+      s.save(os);
+      os << p.size() << std::endl;
+      for (std::vector<Edge>::size_type i=0; i<p.size(); i++) {
+        os << p[i].alt << " " << p[i].choice.size();
+        for (std::vector<unsigned int>::size_type j=0; j<p[i].choice.size(); j++)
+          os << " " << p[i].choice[j];
+        os << std::endl;
+      }
+      qsi.strategySave(os);
+      if (!os.flush()) return false;
+    }
+#ifdef _WIN32
+    std::remove(fn.c_str());
+#endif
+    return std::rename(tmp.c_str(), fn.c_str()) == 0;
+  }
+
+  bool
+  Checkpoint::load(std::vector<Edge>& p, Search::QStatistics& s, QSpaceInfo& qsi) {
+    std::ifstream is(fn.c_str());
+    std::string h, m;
+    uint64_t fp;
+    if (!std::getline(is, h) || (h != header) || !(is >> m >> fp) || (m != "model"))
+      return false;
+    // The path and the strategy are only meaningful for the model which saved them
+    if (fp != qsi.fingerprint()) {
+      std::cerr << "Checkpoint '" << fn << "' ignored: saved by another model" << std::endl;
+      return false;
+    }
+    if (!s.load(is)) return false;
+    std::vector<Edge>::size_type n;
+    if (!(is >> n)) return false;
+    p.resize(n);
+    for (std::vector<Edge>::size_type i=0; i<n; i++) {
+      std::vector<unsigned int>::size_type k;
+      if (!(is >> p[i].alt >> k) || (k == 0)) return false;
+      p[i].choice.resize(k);
+      for (std::vector<unsigned int>::size_type j=0; j<k; j++)
+        if (!(is >> p[i].choice[j])) return false;
+    }
+    // A strategy which can't be restored is not built anymore
+    qsi.strategyLoad(is);
+    last = clockNow();
+    return true;
+  }
+
+  void
+  Checkpoint::remove(void) {
+    std::remove(fn.c_str());
+  }
+
+}}
+
+// STATISTICS: support-any
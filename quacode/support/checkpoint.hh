@@ -0,0 +1,150 @@
+/* -*- mode: C++; c-basic-offset: 2; indent-tabs-mode: nil -*- */
+/*
+ *  Main authors:
+ *     Vincent Barichard <Vincent.Barichard@univ-angers.fr>
+ *
+ *  Copyright:
+ *     Vincent Barichard, 2014
+ *
+ *  Last modified:
+ *     $Date$ by $Author$
+ *     $Revision$
+ *
+ *  This file is part of Quacode:
+ *     http://quacode.barichard.com
+ *
+ *  Permission is hereby granted, free of charge, to any person obtaining
+ *  a copy of this software and associated documentation files (the
+ *  "Software"), to deal in the Software without restriction, including
+ *  without limitation the rights to use, copy, modify, merge, publish,
+ *  distribute, sublicense, and/or sell copies of the Software, and to
+ *  permit persons to whom the Software is furnished to do so, subject to
+ *  the following conditions:
+ *
+ *  The above copyright notice and this permission notice shall be
+ *  included in all copies or substantial portions of the Software.
+ *
+ *  THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND,
+ *  EXPRESS OR IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF
+ *  MERCHANTABILITY, FITNESS FOR A PARTICULAR PURPOSE AND
+ *  NONINFRINGEMENT. IN NO EVENT SHALL THE AUTHORS OR COPYRIGHT HOLDERS BE
+ *  LIABLE FOR ANY CLAIM, DAMAGES OR OTHER LIABILITY, WHETHER IN AN ACTION
+ *  OF CONTRACT, TORT OR OTHERWISE, ARISING FROM, OUT OF OR IN CONNECTION
+ *  WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE SOFTWARE.
+ *
+ */
+
+#ifndef __GECODE_SUPPORT_CHECKPOINT_HH__
+#define __GECODE_SUPPORT_CHECKPOINT_HH__
+
+#include <quacode/qcsp.hh>
+#include <quacode/qspaceinfo.hh>
+#include <gecode/support.hh>
+#include <string>
+#include <vector>
+#include <stdint.h>
+
+namespace Gecode { namespace Support {
+
+  /**
+   * \brief Checkpoints of the search of a thread
+   *
+   * Creating a checkpoint attaches it to the calling thread until it is
+   * destroyed. The first QDFS engine created by the thread afterwards
+   * binds it (see Checkpoint::bind), the engines of the components and
+   * the ones created under a CheckpointHide don't. The engine saves, at
+   * most every \a interval milliseconds and when it is stopped, the
+   * current path of the search to the file. An edge of the path is saved
+   * as the archive of its choice (the first value is the id of the
+   * brancher) and the alternative committed. The statistics and the
+   * strategy built so far are saved as well (see QSpaceInfo::strategySave).
+   *
+   * The clock is only read every few nodes. A save writes the whole
+   * strategy, its cost grows with the memory of the strategy: the time
+   * between two saves is kept above ten times the duration of the last
+   * one, so that saving takes at most a tenth of the search.
+   *
+   * In resume mode, the engine bound to the checkpoint rebuilds the root from
+   * the model, replays the saved path and continues the search from its
+   * last node. The file must have been written with the same search
+   * options. It records the fingerprint of the model (see
+   * QSpaceInfo::fingerprint): the file of another model is ignored and the
+   * search starts from the root. The file is removed once the search is
+   * completed.
+   */
+  class QUACODE_EXPORT Checkpoint {
+    friend class CheckpointHide;
+  public:
+    /// Saved edge of the path
+    struct Edge {
+      /// Archive of the choice
+      std::vector<unsigned int> choice;
+      /// Alternative committed
+      unsigned int alt;
+    };
+  private:
+    /// Checkpoint of the thread
+    static thread_local Checkpoint* cur;
+    /// Checkpoint of the thread before this one
+    Checkpoint* previous;
+    /// File name
+    std::string fn;
+    /// Interval between two saves (nanoseconds)
+    uint64_t interval;
+    /// Time of the last save (nanoseconds)
+    uint64_t last;
+    /// Duration of the last save (nanoseconds)
+    uint64_t cost;
+    /// Calls to due left before the clock is read
+    unsigned int calls;
+    /// Calls to due between two reads of the clock
+    static const unsigned int period = 1024;
+    /// Return true if the time between two saves has elapsed since the last one
+    bool elapsed(void) const;
+    /// Write the path \a p, the statistics \a s and the strategy of \a qsi
+    bool write(const std::vector<Edge>& p, const Search::QStatistics& s,
+               const QSpaceInfo& qsi) const;
+    /// Whether the search has still to be resumed from the file
+    bool bResume;
+    /// Whether an engine is bound to the checkpoint
+    bool bBound;
+  public:
+    /// Save to file \a f every \a ms milliseconds, resume from it first if \a resume
+    Checkpoint(const char* f, unsigned int ms = 60000, bool resume = false);
+    /// Detach the checkpoint from the thread
+    ~Checkpoint(void);
+    /// Return the checkpoint of the calling thread (NULL if none)
+    static Checkpoint* current(void);
+    /// Bind the checkpoint of the calling thread to the caller and return it,
+    /// NULL if there is none or if it is already bound to an engine
+    static Checkpoint* bind(void);
+    /// Return the file name
+    const char* file(void) const;
+    /// Return true if the checkpoint has to be saved (called once per node)
+    bool due(void);
+    /// Return true, only once, if the search has to be resumed from the file
+    bool resume(void);
+    /// Save the path \a p, the statistics \a s and the strategy of \a qsi,
+    /// return false if the file can't be written
+    bool save(const std::vector<Edge>& p, const Search::QStatistics& s,
+              const QSpaceInfo& qsi);
+    /// Read the path \a p, the statistics \a s and the strategy of \a qsi,
+    /// return false if the file can't be read
+    bool load(std::vector<Edge>& p, Search::QStatistics& s, QSpaceInfo& qsi);
+    /// Remove the file (the search is completed)
+    void remove(void);
+  };
+
+
+  forceinline bool
+  Checkpoint::due(void) {
+    if (--calls > 0) return false;
+    calls = period;
+    return elapsed();
+  }
+
+}}
+
+#endif
+
+// STATISTICS: support-any
@@ -35,6 +35,193 @@
  */
 
 #include <quacode/support/log.hh>
+#include <new>
+#ifndef _WIN32
+#include <pthread.h>
+#endif
 
-// Initialisation of instance of Log
-Gecode::Support::Log* Gecode::Support::Log::m_pLog = new Log();
+namespace Gecode { namespace Support {
+
+  thread_local Log::Queue* Log::m_queue = NULL;
+  Log* Log::m_log = NULL;
+
+  Log::Queue::Queue(void) : head(0), tail(0), next(NULL) {}
+
+  Log::Log(void) : m_queues(NULL), m_stop(false), m_sleeping(false), m_blocked(0) {
+    m_flusher = new std::thread(&Log::run, this);
+#ifndef _WIN32
+    // The handlers stay registered, they do nothing once the log is destroyed
+    static bool registered = false;
+    if (!registered) {
+      pthread_atfork(&Log::prepare, &Log::parent, &Log::child);
+      registered = true;
+    }
+#endif
+    m_log = this;
+  }
+
+  Log::~Log(void) {
+    {
+      std::lock_guard<std::mutex> l(m_wait);
+      m_stop.store(true);
+    }
+    m_wake.notify_all();
+    m_room.notify_all();
+    m_log = NULL;
+    m_flusher->join();
+    delete m_flusher;
+    drain();
+    // Queues are not freed: threads still running at exit may own one
+  }
+
+  Log&
+  Log::instance(void) {
+    static Log log;
+    return log;
+  }
+
+  void
+  Log::push(int th, const LogObject& lo) {
+    Queue& q = queue();
+    unsigned int h = q.head.load(std::memory_order_relaxed);
+    while (h - q.tail.load() >= queueSize) {
+      // Queue full: never drop an audit line, wait for the flusher
+      if (m_stop.load()) {
+        drain();
+        continue;
+      }
+      std::unique_lock<std::mutex> l(m_wait);
+      m_blocked.fetch_add(1);
+      m_wake.notify_one();
+      while ((h - q.tail.load() >= queueSize) && !m_stop.load())
+        m_room.wait(l);
+      m_blocked.fetch_sub(1);
+    }
+    Record& r = q.r[h % queueSize];
+    r.th = th;
+    memcpy(r.text, lo.m_buffer, lo.m_size);
+    r.size = lo.m_size;
+    if (lo.m_truncated) {
+      memcpy(r.text + r.size, "...", 3);
+      r.size += 3;
+    }
+    // Sequentially consistent with the flusher going to sleep (see run),
+    // only the producer clearing m_sleeping takes the mutex to wake it
+    q.head.store(h + 1);
+    if (m_sleeping.load() && m_sleeping.exchange(false)) {
+      std::lock_guard<std::mutex> l(m_wait);
+      m_wake.notify_one();
+    }
+  }
+
+  bool
+  Log::pending(void) const {
+    for (Queue* q = m_queues.load(); q; q = q->next)
+      if (q->head.load() != q->tail.load(std::memory_order_relaxed))
+        return true;
+    return false;
+  }
+
+  unsigned int
+  Log::drain(void) {
+    Lock l(m_drain);
+    char buf[8192];
+    unsigned int used = 0;
+    unsigned int n = 0;
+    for (Queue* q = m_queues.load(std::memory_order_acquire); q; q = q->next) {
+      unsigned int t = q->tail.load(std::memory_order_relaxed);
+      unsigned int h = q->head.load(std::memory_order_acquire);
+      for (; t != h; t++, n++) {
+        const Record& r = q->r[t % queueSize];
+        if (used + r.size + 16 > sizeof(buf)) {
+          fwrite(buf, 1, used, stdout);
+          used = 0;
+        }
+        if (r.th >= 0)
+          used += static_cast<unsigned int>(snprintf(buf + used, 16, "[%d] ", r.th));
+        memcpy(buf + used, r.text, r.size);
+        used += r.size;
+        q->tail.store(t + 1);
+      }
+    }
+    if (used) fwrite(buf, 1, used, stdout);
+    if (n) fflush(stdout);
+    // Wake the producers waiting for room, sequentially consistent with
+    // their check of the tail of their queue (see push)
+    if ((n > 0) && (m_blocked.load() > 0)) {
+      std::lock_guard<std::mutex> l(m_wait);
+      m_room.notify_all();
+    }
+    return n;
+  }
+
+  void
+  Log::run(void) {
+    while (!m_stop.load()) {
+      if (drain() > 0) continue;
+      // A producer either sees m_sleeping set and wakes the flusher,
+      // or its line is seen by pending() before the flusher sleeps. As the
+      // waking producer clears m_sleeping, it is set again at each wakeup
+      // (the lines may have been drained by an explicit flush meanwhile)
+      std::unique_lock<std::mutex> l(m_wait);
+      for (;;) {
+        m_sleeping.store(true);
+        if (m_stop.load() || pending()) break;
+        m_wake.wait(l);
+      }
+      m_sleeping.store(false);
+    }
+  }
+
+  void
+  Log::flush(void) {
+    Queue& q = queue();
+    unsigned int h = q.head.load(std::memory_order_relaxed);
+    while (q.tail.load(std::memory_order_acquire) != h)
+      drain();
+  }
+
+  void
+  Log::sync(void) {
+    if (m_log == NULL) return;
+    while (m_log->pending())
+      m_log->drain();
+  }
+
+  void
+  Log::prepare(void) {
+    if (m_log == NULL) return;
+    // Same order as drain
+    m_log->m_drain.acquire();
+    m_log->m_wait.lock();
+  }
+
+  void
+  Log::parent(void) {
+    if (m_log == NULL) return;
+    m_log->m_wait.unlock();
+    m_log->m_drain.release();
+  }
+
+  void
+  Log::child(void) {
+    Log* l = m_log;
+    if (l == NULL) return;
+    // Only the forking thread exists in the child: the waiters of the
+    // condition variables and the flusher are gone, the pending lines
+    // are written by the parent
+    for (Queue* q = l->m_queues.load(); q; q = q->next)
+      q->tail.store(q->head.load());
+    l->m_sleeping.store(false);
+    l->m_blocked.store(0);
+    new (&l->m_wake) std::condition_variable();
+    new (&l->m_room) std::condition_variable();
+    l->m_wait.unlock();
+    l->m_drain.release();
+    // The thread object of the parent's flusher is left as it is
+    l->m_flusher = new std::thread(&Log::run, l);
+  }
+
+}}
+
+// STATISTICS: support-any
@@ -36,10 +36,15 @@
 #ifndef __GECODE_SEARCH_PARALLEL_LOG_HH__
 #define __GECODE_SEARCH_PARALLEL_LOG_HH__
 
+#include <quacode/qcsp.hh>
 #include <gecode/support.hh>
 #include <string>
-#include <sstream>
-#include <iostream>
+#include <cstring>
+#include <cstdio>
+#include <atomic>
+#include <condition_variable>
+#include <mutex>
+#include <thread>
 
 namespace Gecode { namespace Support {
   class Log;
@@ -47,14 +52,28 @@ namespace Gecode { namespace Support {
   /**
    * \brief Class to log object used to be printed
    *
+   * The text is formatted in place in a fixed-size buffer, so building
+   * a log line never allocates. Text beyond the capacity is truncated
+   * and the line ends with "...".
+   *
    * \ingroup FuncSupport
    */
   class LogObject {
   friend class Log;
-  private:
   public:
+    /// Maximal number of characters of a log line
+    static const unsigned int capacity = 240;
+  private:
     /// Output buffer of object
-    std::string m_buffer;
+    char m_buffer[capacity];
+    /// Number of characters used in the buffer
+    unsigned int m_size;
+    /// Whether some text has been dropped
+    bool m_truncated;
+    /// Append \a n characters of \a str
+    void append(const char* str, unsigned int n);
+    /// Append the decimal representation of \a u, with a minus sign if \a neg
+    void append(unsigned long long int u, bool neg);
   public:
     /// Constructors
     LogObject(void);
@@ -66,128 +85,325 @@ namespace Gecode { namespace Support {
     LogObject(float f);
     LogObject(double d);
     LogObject(const char * str);
-    LogObject(std::string std);
+    LogObject(const std::string& std);
 
     /// Overload of += operator
     LogObject& operator +=(const LogObject& o);
+
+    /// \name Formatting without temporary objects
+    //@{
+    LogObject& operator <<(const LogObject& o);
+    LogObject& operator <<(bool b);
+    LogObject& operator <<(char c);
+    LogObject& operator <<(int i);
+    LogObject& operator <<(unsigned int u);
+    LogObject& operator <<(long int l);
+    LogObject& operator <<(unsigned long int ul);
+    LogObject& operator <<(long long int ll);
+    LogObject& operator <<(unsigned long long int ull);
+    LogObject& operator <<(float f);
+    LogObject& operator <<(double d);
+    LogObject& operator <<(const char* str);
+    LogObject& operator <<(const std::string& str);
+    //@}
+
+    /// Return the formatted text (not null-terminated)
+    const char* data(void) const;
+    /// Return the number of characters of the formatted text
+    unsigned int size(void) const;
   };
 
+  forceinline void
+  LogObject::append(const char* str, unsigned int n) {
+    unsigned int room = capacity - m_size;
+    if (n > room) { n = room; m_truncated = true; }
+    memcpy(m_buffer + m_size, str, n);
+    m_size += n;
+  }
+
+  forceinline void
+  LogObject::append(unsigned long long int u, bool neg) {
+    char tmp[24];
+    char* p = tmp + sizeof(tmp);
+    do {
+      *--p = static_cast<char>('0' + (u % 10));
+      u /= 10;
+    } while (u);
+    if (neg) *--p = '-';
+    append(p, static_cast<unsigned int>(tmp + sizeof(tmp) - p));
+  }
+
   forceinline
-  LogObject::LogObject(void) { }
+  LogObject::LogObject(void) : m_size(0), m_truncated(false) { }
 
   forceinline
-  LogObject::LogObject(const LogObject& lo) {
-    m_buffer += lo.m_buffer;
+  LogObject::LogObject(const LogObject& lo)
+    : m_size(lo.m_size), m_truncated(lo.m_truncated) {
+    memcpy(m_buffer, lo.m_buffer, m_size);
   }
 
   forceinline
-  LogObject::LogObject(bool b) {
-    m_buffer += (b?"TRUE":"FALSE");
+  LogObject::LogObject(bool b) : m_size(0), m_truncated(false) {
+    *this << b;
   }
 
   forceinline
-  LogObject::LogObject(int i) {
-    std::ostringstream oss;
-    oss << i;
-    m_buffer += oss.str();
+  LogObject::LogObject(int i) : m_size(0), m_truncated(false) {
+    *this << i;
   }
 
   forceinline
-  LogObject::LogObject(unsigned int u) {
-    std::ostringstream oss;
-    oss << u;
-    m_buffer += oss.str();
+  LogObject::LogObject(unsigned int u) : m_size(0), m_truncated(false) {
+    *this << u;
   }
 
   forceinline
-  LogObject::LogObject(unsigned long int ul) {
-    std::ostringstream oss;
-    oss << ul;
-    m_buffer += oss.str();
+  LogObject::LogObject(unsigned long int ul) : m_size(0), m_truncated(false) {
+    *this << ul;
   }
 
   forceinline
-  LogObject::LogObject(float f) {
-    std::ostringstream oss;
-    oss << f;
-    m_buffer += oss.str();
+  LogObject::LogObject(float f) : m_size(0), m_truncated(false) {
+    *this << f;
   }
 
   forceinline
-  LogObject::LogObject(double d) {
-    std::ostringstream oss;
-    oss << d;
-    m_buffer += oss.str();
+  LogObject::LogObject(double d) : m_size(0), m_truncated(false) {
+    *this << d;
   }
 
   forceinline
-  LogObject::LogObject(const char * str) {
-    std::ostringstream oss;
-    oss << str;
-    m_buffer += oss.str();
+  LogObject::LogObject(const char * str) : m_size(0), m_truncated(false) {
+    *this << str;
   }
 
   forceinline
-  LogObject::LogObject(std::string std) {
-    m_buffer += std;
+  LogObject::LogObject(const std::string& std) : m_size(0), m_truncated(false) {
+    *this << std;
   }
 
-  forceinline
-  LogObject& LogObject::operator +=(const LogObject& o) {
-    m_buffer += o.m_buffer;
+  forceinline LogObject&
+  LogObject::operator +=(const LogObject& o) {
+    append(o.m_buffer, o.m_size);
+    m_truncated = m_truncated || o.m_truncated;
+    return *this;
+  }
+
+  forceinline LogObject&
+  LogObject::operator <<(const LogObject& o) {
+    return *this += o;
+  }
+
+  forceinline LogObject&
+  LogObject::operator <<(bool b) {
+    if (b) append("TRUE", 4); else append("FALSE", 5);
+    return *this;
+  }
+
+  forceinline LogObject&
+  LogObject::operator <<(char c) {
+    append(&c, 1);
+    return *this;
+  }
+
+  forceinline LogObject&
+  LogObject::operator <<(int i) {
+    return *this << static_cast<long long int>(i);
+  }
+
+  forceinline LogObject&
+  LogObject::operator <<(unsigned int u) {
+    append(static_cast<unsigned long long int>(u), false);
+    return *this;
+  }
+
+  forceinline LogObject&
+  LogObject::operator <<(long int l) {
+    return *this << static_cast<long long int>(l);
+  }
+
+  forceinline LogObject&
+  LogObject::operator <<(unsigned long int ul) {
+    append(static_cast<unsigned long long int>(ul), false);
+    return *this;
+  }
+
+  forceinline LogObject&
+  LogObject::operator <<(long long int ll) {
+    // Negate in unsigned arithmetic so that LLONG_MIN is printed correctly
+    unsigned long long int u = static_cast<unsigned long long int>(ll);
+    append((ll < 0) ? (0ULL - u) : u, ll < 0);
+    return *this;
+  }
+
+  forceinline LogObject&
+  LogObject::operator <<(unsigned long long int ull) {
+    append(ull, false);
     return *this;
   }
 
-  template <class T>
-  LogObject operator <<(LogObject lo, T e) {
-    LogObject o1(lo);
-    LogObject o2(e);
-    o1 += o2;
-    return o1;
+  forceinline LogObject&
+  LogObject::operator <<(float f) {
+    return *this << static_cast<double>(f);
+  }
+
+  forceinline LogObject&
+  LogObject::operator <<(double d) {
+    char tmp[32];
+    int n = snprintf(tmp, sizeof(tmp), "%g", d);
+    if (n > 0) append(tmp, static_cast<unsigned int>(n));
+    return *this;
+  }
+
+  forceinline LogObject&
+  LogObject::operator <<(const char* str) {
+    append(str, static_cast<unsigned int>(strlen(str)));
+    return *this;
+  }
+
+  forceinline LogObject&
+  LogObject::operator <<(const std::string& str) {
+    append(str.data(), static_cast<unsigned int>(str.size()));
+    return *this;
+  }
+
+  forceinline const char*
+  LogObject::data(void) const {
+    return m_buffer;
+  }
+
+  forceinline unsigned int
+  LogObject::size(void) const {
+    return m_size;
   }
 
   /**
    * \brief Class to output log
    *
-   * Support log from multi-thread search engines
+   * Support log from multi-thread search engines. Each thread owns a
+   * lock-free single-producer queue of preformatted lines, and a
+   * background thread drains all queues to the standard output. The
+   * flusher sleeps while the queues are empty and is woken by the
+   * producers. A producer only blocks when its own queue is full, until
+   * the flusher makes room (audit lines are never dropped).
+   *
+   * A process forked while the log exists gets its own flusher: the locks
+   * are held across the fork, and the child drops the copy of the lines
+   * still pending, which are written by the parent. A child which ends
+   * with _exit has to call sync first.
    *
    * \ingroup FuncSupport
    */
-  class Log {
+  class QUACODE_EXPORT Log {
+  public:
+    /// Number of lines a thread can have pending
+    static const unsigned int queueSize = 1024;
   private:
-    // Singleton instance
-    static Log* m_pLog;
+    /// A preformatted line
+    struct Record {
+      /// Thread number to print as prefix, or -1 for none
+      int th;
+      /// Number of characters of \a text
+      unsigned int size;
+      /// Text of the line
+      char text[LogObject::capacity + 4];
+    };
+    /// Single-producer single-consumer ring of records
+    struct Queue {
+      /// Records
+      Record r[queueSize];
+      /// Next record to write (only modified by the producer)
+      std::atomic<unsigned int> head;
+      /// Next record to read (only modified by the flusher or an explicit flush)
+      std::atomic<unsigned int> tail;
+      /// Next queue in the list of registered queues
+      Queue* next;
+      /// Constructor
+      Queue(void);
+    };
+    /// Queue of the current thread
+    static thread_local Queue* m_queue;
+    /// The log (NULL if not created or destroyed)
+    static Log* m_log;
+    /// Registered queues, pushed without locking
+    std::atomic<Queue*> m_queues;
+    /// Whether the flusher thread has to stop
+    std::atomic<bool> m_stop;
+    /// Whether the flusher sleeps (or is about to)
+    std::atomic<bool> m_sleeping;
+    /// Number of producers waiting for room in their queue
+    std::atomic<unsigned int> m_blocked;
+    /// Background flusher
+    std::thread* m_flusher;
+    /// Mutex serializing drains (flusher against explicit flush)
+    Support::Mutex m_drain;
+    /// Mutex of the condition variables
+    std::mutex m_wait;
+    /// Condition variable waking the flusher
+    std::condition_variable m_wake;
+    /// Condition variable waking the producers waiting for room
+    std::condition_variable m_room;
+
     /// Default constructor (disabled)
-    Log(void) {}
+    Log(void);
     /// Copy constructor (disabled)
-    Log(const Log&) {}
+    Log(const Log&);
     /// Assignment operator (disabled)
-    const Log& operator =(const Log&) { return *this; }
-  protected:
-    /// Mutex for access to output stream
-    Support::Mutex _m_output;
+    const Log& operator =(const Log&);
+    /// Return the queue of the current thread, registering it if needed
+    Queue& queue(void);
+    /// Enqueue text of \a lo with prefix \a th
+    void push(int th, const LogObject& lo);
+    /// Write all pending lines to the output, return their number
+    unsigned int drain(void);
+    /// Return true if a line is pending in a queue
+    bool pending(void) const;
+    /// Body of the flusher thread
+    void run(void);
+    /// Take the locks before a fork
+    static void prepare(void);
+    /// Release the locks in the parent after a fork
+    static void parent(void);
+    /// Release the locks and start a flusher in the child after a fork
+    static void child(void);
   public:
+    /// Destructor, writes the pending lines and stops the flusher
+    ~Log(void);
     // Static method to get the instance
-    static Log& instance() { assert(m_pLog); return *m_pLog; }
+    static Log& instance(void);
 
     // Write buffer of LogObject \a lo
-    void write(LogObject lo);
+    void write(const LogObject& lo);
     // Write buffer of LogObject \a lo, when thread \th is known
-    void write(int th, LogObject lo);
+    void write(int th, const LogObject& lo);
+    /// Write all the lines pending from the calling thread before returning
+    void flush(void);
+    /// Write all the pending lines of all the threads, if the log exists
+    static void sync(void);
   };
 
-  forceinline
-  void Log::write(LogObject lo) {
-    _m_output.acquire();
-    std::cout << lo.m_buffer << std::flush;
-    _m_output.release();
+  forceinline Log::Queue&
+  Log::queue(void) {
+    Queue* q = m_queue;
+    if (q == NULL) {
+      q = new Queue();
+      q->next = m_queues.load(std::memory_order_relaxed);
+      while (!m_queues.compare_exchange_weak(q->next, q,
+                                             std::memory_order_release,
+                                             std::memory_order_relaxed)) {}
+      m_queue = q;
+    }
+    return *q;
   }
 
-  forceinline
-  void Log::write(int th, LogObject lo) {
-    _m_output.acquire();
-    std::cout << "[" << th << "] " << lo.m_buffer;
-    _m_output.release();
+  forceinline void
+  Log::write(const LogObject& lo) {
+    push(-1, lo);
+  }
+
+  forceinline void
+  Log::write(int th, const LogObject& lo) {
+    push(th, lo);
   }
 
 }}
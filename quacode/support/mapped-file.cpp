@@ -0,0 +1,117 @@
+/* -*- mode: C++; c-basic-offset: 2; indent-tabs-mode: nil -*- */
+/*
+ *  Main authors:
+ *     Vincent Barichard <Vincent.Barichard@univ-angers.fr>
+ *
+ *  Copyright:
+ *     Vincent Barichard, 2014
+ *
+ *  Last modified:
+ *     $Date$ by $Author$
+ *     $Revision$
+ *
+ *  This file is part of Quacode:
+ *     http://quacode.barichard.com
+ *
+ *  Permission is hereby granted, free of charge, to any person obtaining
+ *  a copy of this software and associated documentation files (the
+ *  "Software"), to deal in the Software without restriction, including
+ *  without limitation the rights to use, copy, modify, merge, publish,
+ *  distribute, sublicense, and/or sell copies of the Software, and to
+ *  permit persons to whom the Software is furnished to do so, subject to
+ *  the following conditions:
+ *
+ *  The above copyright notice and this permission notice shall be
+ *  included in all copies or substantial portions of the Software.
+ *
+ *  THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND,
+ *  EXPRESS OR IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF
+ *  MERCHANTABILITY, FITNESS FOR A PARTICULAR PURPOSE AND
+ *  NONINFRINGEMENT. IN NO EVENT SHALL THE AUTHORS OR COPYRIGHT HOLDERS BE
+ *  LIABLE FOR ANY CLAIM, DAMAGES OR OTHER LIABILITY, WHETHER IN AN ACTION
+ *  OF CONTRACT, TORT OR OTHERWISE, ARISING FROM, OUT OF OR IN CONNECTION
+ *  WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE SOFTWARE.
+ *
+ */
+
+#include <quacode/support/mapped-file.hh>
+
+#if defined(__unix__) || defined(__APPLE__)
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+#define QUACODE_HAS_MMAP
+#else
+#include <fstream>
+#include <iterator>
+#endif
+
+namespace Gecode { namespace Support {
+
+  MappedFile::MappedFile(void) : b(""), n(0), mapped(false) {}
+
+  MappedFile::~MappedFile(void) {
+    close();
+  }
+
+  bool MappedFile::open(const char* f) {
+    close();
+#ifdef QUACODE_HAS_MMAP
+    int fd = ::open(f, O_RDONLY);
+    if (fd < 0) return false;
+    struct stat st;
+    if (fstat(fd, &st) != 0) {
+      ::close(fd);
+      return false;
+    }
+    std::size_t s = static_cast<std::size_t>(st.st_size);
+    if (s > 0) {
+      void* m = mmap(NULL, s, PROT_READ, MAP_PRIVATE, fd, 0);
+      if (m != MAP_FAILED) {
+#ifdef MADV_SEQUENTIAL
+        madvise(m, s, MADV_SEQUENTIAL);
+#endif
+        b = static_cast<const char*>(m);
+        n = s;
+        mapped = true;
+        ::close(fd);
+        return true;
+      }
+      // Not a regular file (pipe, ...), we read it in a buffer
+      char tmp[65536];
+      ssize_t r;
+      while ((r = ::read(fd, tmp, sizeof(tmp))) > 0)
+        buffer.insert(buffer.end(), tmp, tmp + r);
+      if (r < 0) {
+        ::close(fd);
+        buffer.clear();
+        return false;
+      }
+    }
+    ::close(fd);
+#else
+    std::ifstream in(f, std::ios::binary);
+    if (!in) return false;
+    buffer.assign(std::istreambuf_iterator<char>(in), std::istreambuf_iterator<char>());
+#endif
+    if (!buffer.empty()) {
+      b = &buffer[0];
+      n = buffer.size();
+    }
+    return true;
+  }
+
+  void MappedFile::close(void) {
+#ifdef QUACODE_HAS_MMAP
+    if (mapped) munmap(const_cast<char*>(b), n);
+#endif
+    std::vector<char>().swap(buffer);
+    b = "";
+    n = 0;
+    mapped = false;
+  }
+
+}}
+
+// STATISTICS: support-any
@@ -0,0 +1,95 @@
+/* -*- mode: C++; c-basic-offset: 2; indent-tabs-mode: nil -*- */
+/*
+ *  Main authors:
+ *     Vincent Barichard <Vincent.Barichard@univ-angers.fr>
+ *
+ *  Copyright:
+ *     Vincent Barichard, 2014
+ *
+ *  Last modified:
+ *     $Date$ by $Author$
+ *     $Revision$
+ *
+ *  This file is part of Quacode:
+ *     http://quacode.barichard.com
+ *
+ *  Permission is hereby granted, free of charge, to any person obtaining
+ *  a copy of this software and associated documentation files (the
+ *  "Software"), to deal in the Software without restriction, including
+ *  without limitation the rights to use, copy, modify, merge, publish,
+ *  distribute, sublicense, and/or sell copies of the Software, and to
+ *  permit persons to whom the Software is furnished to do so, subject to
+ *  the following conditions:
+ *
+ *  The above copyright notice and this permission notice shall be
+ *  included in all copies or substantial portions of the Software.
+ *
+ *  THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND,
+ *  EXPRESS OR IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF
+ *  MERCHANTABILITY, FITNESS FOR A PARTICULAR PURPOSE AND
+ *  NONINFRINGEMENT. IN NO EVENT SHALL THE AUTHORS OR COPYRIGHT HOLDERS BE
+ *  LIABLE FOR ANY CLAIM, DAMAGES OR OTHER LIABILITY, WHETHER IN AN ACTION
+ *  OF CONTRACT, TORT OR OTHERWISE, ARISING FROM, OUT OF OR IN CONNECTION
+ *  WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE SOFTWARE.
+ *
+ */
+
+#ifndef __GECODE_SUPPORT_MAPPED_FILE_HH__
+#define __GECODE_SUPPORT_MAPPED_FILE_HH__
+
+#include <quacode/qcsp.hh>
+#include <cstddef>
+#include <vector>
+
+namespace Gecode { namespace Support {
+
+  /**
+   * \brief Read-only file mapped in memory
+   *
+   * The file is mapped in memory on POSIX systems, it is read in a buffer
+   * on other systems. The content is available until the object is closed
+   * or deleted.
+   *
+   * \ingroup FuncSupport
+   */
+  class MappedFile {
+  private:
+    /// Content of the file
+    const char* b;
+    /// Size of the file
+    std::size_t n;
+    /// True if the content is a memory mapping
+    bool mapped;
+    /// Buffer used when the file can't be mapped
+    std::vector<char> buffer;
+    /// Avoid copies
+    MappedFile(const MappedFile&);
+    MappedFile& operator =(const MappedFile&);
+  public:
+    /// Constructor
+    QUACODE_EXPORT MappedFile(void);
+    /// Destructor
+    QUACODE_EXPORT ~MappedFile(void);
+    /// Open file \a f, return false if it can't be read
+    QUACODE_EXPORT bool open(const char* f);
+    /// Release the content of the file
+    QUACODE_EXPORT void close(void);
+    /// Return the content of the file
+    const char* data(void) const;
+    /// Return the size of the file
+    std::size_t size(void) const;
+  };
+
+  forceinline const char*
+  MappedFile::data(void) const {
+    return b;
+  }
+
+  forceinline std::size_t
+  MappedFile::size(void) const {
+    return n;
+  }
+
+}}
+
+#endif
@@ -0,0 +1,160 @@
+/* -*- mode: C++; c-basic-offset: 2; indent-tabs-mode: nil -*- */
+/*
+ *  Main authors:
+ *     Vincent Barichard <Vincent.Barichard@univ-angers.fr>
+ *
+ *  Copyright:
+ *     Vincent Barichard, 2014
+ *
+ *  Last modified:
+ *     $Date$ by $Author$
+ *     $Revision$
+ *
+ *  This file is part of Quacode:
+ *     http://quacode.barichard.com
+ *
+ *  Permission is hereby granted, free of charge, to any person obtaining
+ *  a copy of this software and associated documentation files (the
+ *  "Software"), to deal in the Software without restriction, including
+ *  without limitation the rights to use, copy, modify, merge, publish,
+ *  distribute, sublicense, and/or sell copies of the Software, and to
+ *  permit persons to whom the Software is furnished to do so, subject to
+ *  the following conditions:
+ *
+ *  The above copyright notice and this permission notice shall be
+ *  included in all copies or substantial portions of the Software.
+ *
+ *  THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND,
+ *  EXPRESS OR IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF
+ *  MERCHANTABILITY, FITNESS FOR A PARTICULAR PURPOSE AND
+ *  NONINFRINGEMENT. IN NO EVENT SHALL THE AUTHORS OR COPYRIGHT HOLDERS BE
+ *  LIABLE FOR ANY CLAIM, DAMAGES OR OTHER LIABILITY, WHETHER IN AN ACTION
+ *  OF CONTRACT, TORT OR OTHERWISE, ARISING FROM, OUT OF OR IN CONNECTION
+ *  WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE SOFTWARE.
+ *
+ */
+#include <quacode/support/profile.hh>
+#include <quacode/support/clock.hh>
+#include <iomanip>
+#include <mutex>
+#include <string>
+#include <vector>
+
+#if defined(__GNUC__) && (defined(__x86_64__) || defined(__i386__))
+#include <x86intrin.h>
+#define QUACODE_HAS_RDTSC
+#endif
+
+namespace Gecode { namespace Support {
+
+  namespace {
+    /// Counters of all the threads
+    class Registry {
+    public:
+      /// Mutex protecting the list
+      std::mutex m;
+      /// Counters of the threads, never freed so that they outlive the threads
+      std::vector<Profile::Counters*> threads;
+      /// Print the profile at exit, if anything was profiled
+      ~Registry(void) {
+        bool used = false;
+        for (std::size_t i = 0; i < threads.size(); i++)
+          for (int k = 0; k < Profile::CLASSES; k++)
+            used = used || (threads[i][k].propagate > 0) || (threads[i][k].copies > 0);
+        if (used) Profile::print(std::cerr);
+      }
+    };
+
+    Registry& registry(void) {
+      static Registry r;
+      return r;
+    }
+  }
+
+  thread_local ProfileScope* ProfileScope::cur = NULL;
+
+  Profile::Counters*
+  Profile::local(void) {
+    static thread_local Counters* l = NULL;
+    if (l == NULL) {
+      l = new Counters[CLASSES]();
+      Registry& r = registry();
+      std::lock_guard<std::mutex> g(r.m);
+      r.threads.push_back(l);
+    }
+    return l;
+  }
+
+  uint64_t
+  Profile::cycles(void) {
+#ifdef QUACODE_HAS_RDTSC
+    return __rdtsc();
+#else
+    return clockNow();
+#endif
+  }
+
+  const char*
+  Profile::name(PropClass c) {
+    static const char* n[CLASSES] = {
+      "QEq", "QXor", "QBinOrTrue", "QOr", "QNaryOr", "QNaryOrTrue",
+      "QEqv", "QXorv", "QClause", "QClauseTrue", "Watch"
+    };
+    return n[c];
+  }
+
+  void
+  Profile::print(std::ostream& os) {
+    Counters s[CLASSES] = {};
+    {
+      Registry& r = registry();
+      std::lock_guard<std::mutex> g(r.m);
+      for (std::size_t i = 0; i < r.threads.size(); i++)
+        for (int k = 0; k < CLASSES; k++) {
+          s[k].propagate += r.threads[i][k].propagate;
+          s[k].subsumed += r.threads[i][k].subsumed;
+          s[k].failed += r.threads[i][k].failed;
+          s[k].rewrite += r.threads[i][k].rewrite;
+          s[k].cycles += r.threads[i][k].cycles;
+          s[k].copies += r.threads[i][k].copies;
+          s[k].bytes += r.threads[i][k].bytes;
+        }
+    }
+    uint64_t total = 0;
+    for (int k = 0; k < CLASSES; k++) total += s[k].cycles;
+#ifdef QUACODE_HAS_RDTSC
+    const char* unit = "cycles";
+#else
+    const char* unit = "ns";
+#endif
+    std::ios::fmtflags f = os.flags();
+    std::streamsize p = os.precision();
+    os << "Propagator profile:" << std::endl
+       << std::setw(12) << "class" << std::setw(14) << "propagate"
+       << std::setw(12) << "subsumed" << std::setw(12) << "failed"
+       << std::setw(10) << "rewrite" << std::setw(16) << unit
+       << std::setw(15) << (std::string(unit) + "/call")
+       << std::setw(8) << "%" << std::setw(12) << "copies"
+       << std::setw(16) << "copied bytes" << std::endl;
+    for (int k = 0; k < CLASSES; k++) {
+      if ((s[k].propagate == 0) && (s[k].copies == 0)) continue;
+      os << std::setw(12) << name(static_cast<PropClass>(k))
+         << std::setw(14) << s[k].propagate
+         << std::setw(12) << s[k].subsumed
+         << std::setw(12) << s[k].failed
+         << std::setw(10) << s[k].rewrite
+         << std::setw(16) << s[k].cycles
+         << std::setw(15) << (s[k].propagate ? s[k].cycles / s[k].propagate : 0)
+         << std::setw(8) << std::fixed << std::setprecision(1)
+         << (total ? 100.0 * s[k].cycles / total : 0.0)
+         << std::setw(12) << s[k].copies
+         << std::setw(16) << s[k].bytes
+         << std::endl;
+    }
+    os.flags(f);
+    os.precision(p);
+  }
+
+}}
+
+// STATISTICS: support-any
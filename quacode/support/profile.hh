@@ -0,0 +1,168 @@
+/* -*- mode: C++; c-basic-offset: 2; indent-tabs-mode: nil -*- */
+/*
+ *  Main authors:
+ *     Vincent Barichard <Vincent.Barichard@univ-angers.fr>
+ *
+ *  Copyright:
+ *     Vincent Barichard, 2014
+ *
+ *  Last modified:
+ *     $Date$ by $Author$
+ *     $Revision$
+ *
+ *  This file is part of Quacode:
+ *     http://quacode.barichard.com
+ *
+ *  Permission is hereby granted, free of charge, to any person obtaining
+ *  a copy of this software and associated documentation files (the
+ *  "Software"), to deal in the Software without restriction, including
+ *  without limitation the rights to use, copy, modify, merge, publish,
+ *  distribute, sublicense, and/or sell copies of the Software, and to
+ *  permit persons to whom the Software is furnished to do so, subject to
+ *  the following conditions:
+ *
+ *  The above copyright notice and this permission notice shall be
+ *  included in all copies or substantial portions of the Software.
+ *
+ *  THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND,
+ *  EXPRESS OR IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF
+ *  MERCHANTABILITY, FITNESS FOR A PARTICULAR PURPOSE AND
+ *  NONINFRINGEMENT. IN NO EVENT SHALL THE AUTHORS OR COPYRIGHT HOLDERS BE
+ *  LIABLE FOR ANY CLAIM, DAMAGES OR OTHER LIABILITY, WHETHER IN AN ACTION
+ *  OF CONTRACT, TORT OR OTHERWISE, ARISING FROM, OUT OF OR IN CONNECTION
+ *  WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE SOFTWARE.
+ *
+ */
+#ifndef __GECODE_SUPPORT_PROFILE_HH__
+#define __GECODE_SUPPORT_PROFILE_HH__
+
+#include <quacode/qcsp.hh>
+#include <gecode/kernel.hh>
+#include <iostream>
+#include <stdint.h>
+
+namespace Gecode { namespace Support {
+
+  /**
+   * \brief Profile of the quantified propagators
+   *
+   * When Quacode is compiled with QUACODE_PROFILE, the propagate() calls
+   * of the quantified propagators are counted for each propagator class,
+   * with the number of subsumptions, failures and rewrites they end
+   * with and the cycles they take (nanoseconds on non-x86 platforms).
+   * The copies of the propagators made by the clones are counted as well,
+   * with their memory (the propagator, its views and its arrays).
+   * Each thread has its own counters, the sum is printed to std::cerr at
+   * the end of the run. Without QUACODE_PROFILE, the macros below expand
+   * to the plain calls and nothing is counted.
+   */
+  class QUACODE_EXPORT Profile {
+  public:
+    /// Profiled propagator classes
+    enum PropClass {
+      QEQ, QXOR, QBINORTRUE, QOR, QNARYOR, QNARYORTRUE,
+      QEQV, QXORV, QCLAUSE, QCLAUSETRUE, WATCH,
+      CLASSES ///< Number of classes
+    };
+    /// Counters of a propagator class
+    struct Counters {
+      uint64_t propagate;  ///< Calls to propagate()
+      uint64_t subsumed;   ///< Calls ending with a subsumption
+      uint64_t failed;     ///< Calls ending with a failure
+      uint64_t rewrite;    ///< Calls ending with a rewrite
+      uint64_t cycles;     ///< Cycles spent in propagate()
+      uint64_t copies;     ///< Copies made by clones
+      uint64_t bytes;      ///< Memory of the copies (in bytes)
+    };
+    /// Return the counters of the calling thread (indexed by PropClass)
+    static Counters* local(void);
+    /// Return the current cycle count
+    static uint64_t cycles(void);
+    /// Record a copy of \a b bytes of a propagator of class \a pc
+    static void copy(PropClass pc, std::size_t b);
+    /// Return the name of class \a c
+    static const char* name(PropClass c);
+    /// Print the counters summed over all threads
+    static void print(std::ostream& os);
+  };
+
+  /**
+   * \brief Profile of one propagate() call
+   */
+  class QUACODE_EXPORT ProfileScope {
+  private:
+    /// Innermost scope of the thread
+    static thread_local ProfileScope* cur;
+    /// Counters of the class of the propagator
+    Profile::Counters& c;
+    /// Cycle count at the beginning of the call
+    uint64_t start;
+    /// Whether the propagator has been rewritten
+    bool rewritten;
+    /// Scope of the thread before this one
+    ProfileScope* previous;
+  public:
+    /// Start the profile of a call of a propagator of class \a pc
+    ProfileScope(Profile::PropClass pc);
+    /// Record status \a es of the call and return it
+    ExecStatus result(ExecStatus es);
+    /// Mark the propagator of the innermost scope as rewritten
+    static void rewrite(void);
+    /// Account the cycles of the call
+    ~ProfileScope(void);
+  };
+
+
+  forceinline void
+  Profile::copy(PropClass pc, std::size_t b) {
+    Counters& c = local()[pc];
+    c.copies++;
+    c.bytes += b;
+  }
+
+  forceinline
+  ProfileScope::ProfileScope(Profile::PropClass pc)
+    : c(Profile::local()[pc]), start(Profile::cycles()), rewritten(false),
+      previous(cur) {
+    cur = this;
+    c.propagate++;
+  }
+
+  forceinline ExecStatus
+  ProfileScope::result(ExecStatus es) {
+    if (es == ES_FAILED)
+      c.failed++;
+    else if (es == __ES_SUBSUMED)
+      (rewritten ? c.rewrite : c.subsumed)++;
+    return es;
+  }
+
+  forceinline void
+  ProfileScope::rewrite(void) {
+    if (cur != NULL) cur->rewritten = true;
+  }
+
+  forceinline
+  ProfileScope::~ProfileScope(void) {
+    c.cycles += Profile::cycles() - start;
+    cur = previous;
+  }
+
+}}
+
+#ifdef QUACODE_PROFILE
+  /// Return the status of \a E, a propagation of a propagator of class \a C
+  #define QUACODE_PROFILE_PROPAGATE(C,E) { Gecode::Support::ProfileScope __ps__(Gecode::Support::Profile::C); return __ps__.result(E); }
+  /// Record that the propagator being propagated is rewritten
+  #define QUACODE_PROFILE_REWRITE() Gecode::Support::ProfileScope::rewrite()
+  /// Record a copy of \a B bytes of a propagator of class \a C
+  #define QUACODE_PROFILE_COPY(C,B) Gecode::Support::Profile::copy(Gecode::Support::Profile::C,B)
+#else
+  #define QUACODE_PROFILE_PROPAGATE(C,E) { return E; }
+  #define QUACODE_PROFILE_REWRITE()
+  #define QUACODE_PROFILE_COPY(C,B)
+#endif
+
+#endif
+
+// STATISTICS: support-any
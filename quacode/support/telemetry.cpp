@@ -0,0 +1,228 @@
+/* -*- mode: C++; c-basic-offset: 2; indent-tabs-mode: nil -*- */
+/*
+ *  Main authors:
+ *     Vincent Barichard <Vincent.Barichard@univ-angers.fr>
+ *
+ *  Copyright:
+ *     Vincent Barichard, 2014
+ *
+ *  Last modified:
+ *     $Date$ by $Author$
+ *     $Revision$
+ *
+ *  This file is part of Quacode:
+ *     http://quacode.barichard.com
+ *
+ *  Permission is hereby granted, free of charge, to any person obtaining
+ *  a copy of this software and associated documentation files (the
+ *  "Software"), to deal in the Software without restriction, including
+ *  without limitation the rights to use, copy, modify, merge, publish,
+ *  distribute, sublicense, and/or sell copies of the Software, and to
+ *  permit persons to whom the Software is furnished to do so, subject to
+ *  the following conditions:
+ *
+ *  The above copyright notice and this permission notice shall be
+ *  included in all copies or substantial portions of the Software.
+ *
+ *  THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND,
+ *  EXPRESS OR IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF
+ *  MERCHANTABILITY, FITNESS FOR A PARTICULAR PURPOSE AND
+ *  NONINFRINGEMENT. IN NO EVENT SHALL THE AUTHORS OR COPYRIGHT HOLDERS BE
+ *  LIABLE FOR ANY CLAIM, DAMAGES OR OTHER LIABILITY, WHETHER IN AN ACTION
+ *  OF CONTRACT, TORT OR OTHERWISE, ARISING FROM, OUT OF OR IN CONNECTION
+ *  WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE SOFTWARE.
+ *
+ */
+#include <quacode/support/telemetry.hh>
+#include <quacode/support/clock.hh>
+#include <algorithm>
+#include <chrono>
+#include <cstring>
+
+#ifndef _WIN32
+#include <sys/socket.h>
+#include <sys/un.h>
+#include <unistd.h>
+#endif
+
+namespace Gecode { namespace Support {
+
+  namespace {
+#ifndef _WIN32
+    /// Return a stream socket connected to \a path, -1 on error
+    int connectTo(const char* path) {
+      sockaddr_un a;
+      if (std::strlen(path) >= sizeof(a.sun_path)) return -1;
+      int s = socket(AF_UNIX, SOCK_STREAM, 0);
+      if (s < 0) return -1;
+      std::memset(&a, 0, sizeof(a));
+      a.sun_family = AF_UNIX;
+      std::strcpy(a.sun_path, path);
+      if (connect(s, reinterpret_cast<sockaddr*>(&a), sizeof(a)) != 0) {
+        close(s);
+        return -1;
+      }
+      return s;
+    }
+#endif
+  }
+
+  Telemetry::Telemetry(const char* dest, unsigned int ms)
+    : f(NULL), fd(-1), interval(ms > 0 ? ms : 1), start(clockNow()),
+      stopping(false), threads(0) {
+    if (std::strncmp(dest, "unix:", 5) == 0) {
+#ifndef _WIN32
+      fd = connectTo(dest + 5);
+#endif
+    } else {
+      f = std::fopen(dest, "w");
+    }
+    if (ok())
+      reporter = std::thread(&Telemetry::run, this);
+  }
+
+  Telemetry::~Telemetry(void) {
+    {
+      std::lock_guard<std::mutex> l(m);
+      stopping = true;
+    }
+    cv.notify_all();
+    if (reporter.joinable()) reporter.join();
+    if (f != NULL) std::fclose(f);
+#ifndef _WIN32
+    if (fd >= 0) close(fd);
+#endif
+  }
+
+  uint64_t
+  Telemetry::now(void) const {
+    return clockNow() - start;
+  }
+
+  void
+  Telemetry::output(const char* s, std::size_t n) {
+    std::lock_guard<std::mutex> l(mOut);
+    if (f != NULL) {
+      std::fwrite(s, 1, n, f);
+      std::fflush(f);
+    }
+#ifndef _WIN32
+    // A reader which went away must not kill the solver with SIGPIPE
+    while ((fd >= 0) && (n > 0)) {
+#ifdef MSG_NOSIGNAL
+      ssize_t w = send(fd, s, n, MSG_NOSIGNAL);
+#else
+      ssize_t w = send(fd, s, n, 0);
+#endif
+      if (w <= 0) {
+        close(fd);
+        fd = -1;
+        break;
+      }
+      s += w;
+      n -= static_cast<std::size_t>(w);
+    }
+#endif
+  }
+
+  void
+  Telemetry::report(TelemetryProbe& p, bool final, std::string& out) {
+    uint64_t t = now();
+    {
+      uint64_t pt = p.time.load(std::memory_order_relaxed);
+      uint64_t pn = p.node.load(std::memory_order_relaxed);
+      double rate = (pt > p.lastTime) ?
+        (pn - p.lastNode) * 1e9 / static_cast<double>(pt - p.lastTime) : 0.0;
+      if (pt > p.lastTime) {
+        p.lastNode = pn;
+        p.lastTime = pt;
+      }
+      uint64_t pc = p.clone.load(std::memory_order_relaxed);
+      char line[640];
+      int n = std::snprintf(line, sizeof(line),
+        "{\"time\":%.3f,\"thread\":%u,\"nodes\":%llu,\"nodes_per_s\":%.1f,"
+        "\"failures\":%llu,\"clones\":%llu,\"depth\":%u,\"block\":%u,"
+        "\"quantifier\":\"%s\",\"strategy_memory\":%llu,\"clone_bytes\":%.1f,"
+        "\"path_memory\":%llu,\"age\":%.3f%s}\n",
+        t / 1e9, p.thread,
+        static_cast<unsigned long long>(pn), rate,
+        static_cast<unsigned long long>(p.fail.load(std::memory_order_relaxed)),
+        static_cast<unsigned long long>(pc),
+        p.depth.load(std::memory_order_relaxed),
+        p.brancher.load(std::memory_order_relaxed),
+        (p.quantifier.load(std::memory_order_relaxed) == FORALL) ? "forall" : "exists",
+        static_cast<unsigned long long>(p.strategyMemory.load(std::memory_order_relaxed)),
+        pc ? p.cloneMemory.load(std::memory_order_relaxed) / static_cast<double>(pc) : 0.0,
+        static_cast<unsigned long long>(p.pathMemory.load(std::memory_order_relaxed)),
+        (t - pt) / 1e9, final ? ",\"final\":true" : "");
+      if (n > 0) out.append(line, std::min(static_cast<std::size_t>(n), sizeof(line) - 1));
+    }
+  }
+
+  void
+  Telemetry::run(void) {
+    // Fresh values are asked for a tenth of the interval before the report,
+    // an engine which does not answer in time shows up with a growing age
+    unsigned int lead = (interval >= 10) ? interval / 10 : 1;
+    std::string out;
+    std::unique_lock<std::mutex> l(m);
+    while (true) {
+      if (cv.wait_for(l, std::chrono::milliseconds(interval - lead),
+                      [this]{ return stopping; }))
+        break;
+      for (std::size_t i = 0; i < probes.size(); i++)
+        probes[i]->request.store(true, std::memory_order_relaxed);
+      if (cv.wait_for(l, std::chrono::milliseconds(lead),
+                      [this]{ return stopping; }))
+        break;
+      out.clear();
+      for (std::size_t i = 0; i < probes.size(); i++)
+        report(*probes[i], false, out);
+      // The lines are written without the lock, the probes go on meanwhile
+      l.unlock();
+      output(out.data(), out.size());
+      l.lock();
+    }
+  }
+
+  thread_local TelemetryProbe* TelemetryProbe::cur = NULL;
+
+  TelemetryProbe::TelemetryProbe(Telemetry& t0)
+    : t(t0), previous(cur), request(true), time(0), node(0), fail(0),
+      clone(0), depth(0), brancher(0), quantifier(EXISTS), strategyMemory(0),
+      cloneMemory(0), pathMemory(0),
+      lastNode(0), lastTime(0) {
+    std::lock_guard<std::mutex> l(t.m);
+    thread = t.threads++;
+    t.probes.push_back(this);
+    cur = this;
+  }
+
+  TelemetryProbe::~TelemetryProbe(void) {
+    std::string out;
+    {
+      std::lock_guard<std::mutex> l(t.m);
+      t.report(*this, true, out);
+      for (std::size_t i = 0; i < t.probes.size(); i++)
+        if (t.probes[i] == this) {
+          t.probes.erase(t.probes.begin() + static_cast<long>(i));
+          break;
+        }
+    }
+    t.output(out.data(), out.size());
+    cur = previous;
+  }
+
+  TelemetryProbe*
+  TelemetryProbe::current(void) {
+    return cur;
+  }
+
+  void
+  TelemetryProbe::detach(void) {
+    cur = NULL;
+  }
+
+}}
+
+// STATISTICS: support-any
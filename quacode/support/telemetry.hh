@@ -0,0 +1,215 @@
+/* -*- mode: C++; c-basic-offset: 2; indent-tabs-mode: nil -*- */
+/*
+ *  Main authors:
+ *     Vincent Barichard <Vincent.Barichard@univ-angers.fr>
+ *
+ *  Copyright:
+ *     Vincent Barichard, 2014
+ *
+ *  Last modified:
+ *     $Date$ by $Author$
+ *     $Revision$
+ *
+ *  This file is part of Quacode:
+ *     http://quacode.barichard.com
+ *
+ *  Permission is hereby granted, free of charge, to any person obtaining
+ *  a copy of this software and associated documentation files (the
+ *  "Software"), to deal in the Software without restriction, including
+ *  without limitation the rights to use, copy, modify, merge, publish,
+ *  distribute, sublicense, and/or sell copies of the Software, and to
+ *  permit persons to whom the Software is furnished to do so, subject to
+ *  the following conditions:
+ *
+ *  The above copyright notice and this permission notice shall be
+ *  included in all copies or substantial portions of the Software.
+ *
+ *  THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND,
+ *  EXPRESS OR IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF
+ *  MERCHANTABILITY, FITNESS FOR A PARTICULAR PURPOSE AND
+ *  NONINFRINGEMENT. IN NO EVENT SHALL THE AUTHORS OR COPYRIGHT HOLDERS BE
+ *  LIABLE FOR ANY CLAIM, DAMAGES OR OTHER LIABILITY, WHETHER IN AN ACTION
+ *  OF CONTRACT, TORT OR OTHERWISE, ARISING FROM, OUT OF OR IN CONNECTION
+ *  WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE SOFTWARE.
+ *
+ */
+#ifndef __GECODE_SUPPORT_TELEMETRY_HH__
+#define __GECODE_SUPPORT_TELEMETRY_HH__
+
+#include <quacode/qcsp.hh>
+#include <gecode/support.hh>
+#include <atomic>
+#include <condition_variable>
+#include <cstdio>
+#include <mutex>
+#include <string>
+#include <thread>
+#include <vector>
+#include <stdint.h>
+
+namespace Gecode { namespace Support {
+
+  class TelemetryProbe;
+
+  /**
+   * \brief Periodic report of the progress of the search
+   *
+   * A background thread writes, every \a interval milliseconds, one JSON
+   * line per attached thread to a file or, if the destination is of the
+   * form "unix:PATH", to the Unix stream socket PATH. A line looks like
+   * \code
+   * {"time":2.001,"thread":0,"nodes":81234,"nodes_per_s":40551.2,
+   *  "failures":40117,"clones":11602,"depth":17,"block":5,
+   *  "quantifier":"forall","strategy_memory":1536,"clone_bytes":2144.0,
+   *  "path_memory":36448,"age":0.012}
+   * \endcode
+   * where \a time is the time of the report in seconds, \a block and
+   * \a quantifier give the position in the prefix of the current node,
+   * \a clone_bytes is the mean memory of a clone, \a path_memory the
+   * memory held by the clones of the path (bytes),
+   * and \a age is the time since the values were sampled. A growing age
+   * means that the search is stuck in a single node. A last line with
+   * \a "final":true is written when a thread detaches.
+   */
+  class QUACODE_EXPORT Telemetry {
+    friend class TelemetryProbe;
+  private:
+    /// Output file (NULL if writing to a socket)
+    std::FILE* f;
+    /// Output socket (-1 if writing to a file)
+    int fd;
+    /// Interval between two reports (milliseconds)
+    unsigned int interval;
+    /// Start time (nanoseconds)
+    uint64_t start;
+    /// Mutex protecting the probes and the stop flag
+    std::mutex m;
+    /// Wakes up the reporter when stopping
+    std::condition_variable cv;
+    /// Whether the reporter must stop
+    bool stopping;
+    /// Attached probes
+    std::vector<TelemetryProbe*> probes;
+    /// Number of threads attached so far
+    unsigned int threads;
+    /// Reporter thread
+    std::thread reporter;
+    /// Mutex serializing the writes to the destination
+    std::mutex mOut;
+    /// Append the report of probe \a p to \a out (\a m must be held)
+    void report(TelemetryProbe& p, bool final, std::string& out);
+    /// Write \a n characters of \a s to the destination (\a m must not be held,
+    /// a slow reader would block the probes)
+    void output(const char* s, std::size_t n);
+    /// Body of the reporter thread
+    void run(void);
+  public:
+    /// Report to \a dest (file name or "unix:PATH") every \a ms milliseconds
+    Telemetry(const char* dest, unsigned int ms = 1000);
+    /// Return true if the destination could be opened
+    bool ok(void) const;
+    /// Return the time in nanoseconds since the creation of the telemetry
+    uint64_t now(void) const;
+    /// Stop reporting (the probes must be destroyed before)
+    ~Telemetry(void);
+  };
+
+  /**
+   * \brief Values published by a search engine
+   */
+  struct TelemetrySample {
+    uint64_t node;            ///< Number of nodes
+    uint64_t fail;            ///< Number of failures
+    uint64_t clone;           ///< Number of clones
+    unsigned int depth;       ///< Depth of the current node
+    unsigned int brancher;    ///< Brancher of the choice which created the current node
+    TQuantifier quantifier;   ///< Quantifier of this brancher
+    uint64_t strategyMemory;  ///< Memory used by the strategy (bytes)
+    uint64_t cloneMemory;     ///< Total memory of the clones (bytes)
+    uint64_t pathMemory;      ///< Memory of the clones of the path (bytes)
+  };
+
+  /**
+   * \brief Telemetry of a thread
+   *
+   * Creating a probe attaches the calling thread to a telemetry until the
+   * probe is destroyed. The search engines of the thread find it with
+   * TelemetryProbe::current(). On the hot path, an engine only checks
+   * wanted(), a relaxed load of a flag raised by the reporter once per
+   * interval, and then publishes its values with relaxed stores.
+   */
+  class QUACODE_EXPORT TelemetryProbe {
+    friend class Telemetry;
+  private:
+    /// Probe of the thread
+    static thread_local TelemetryProbe* cur;
+    /// Telemetry
+    Telemetry& t;
+    /// Thread number
+    unsigned int thread;
+    /// Probe of the thread before this one
+    TelemetryProbe* previous;
+    /// Whether the reporter waits for new values
+    std::atomic<bool> request;
+    /// \name Published values
+    //@{
+    std::atomic<uint64_t> time;
+    std::atomic<uint64_t> node;
+    std::atomic<uint64_t> fail;
+    std::atomic<uint64_t> clone;
+    std::atomic<unsigned int> depth;
+    std::atomic<unsigned int> brancher;
+    std::atomic<unsigned int> quantifier;
+    std::atomic<uint64_t> strategyMemory;
+    std::atomic<uint64_t> cloneMemory;
+    std::atomic<uint64_t> pathMemory;
+    //@}
+    /// Nodes and time of the previous report
+    uint64_t lastNode, lastTime;
+  public:
+    /// Attach the calling thread to telemetry \a t0
+    TelemetryProbe(Telemetry& t0);
+    /// Write the final report of the thread and detach it
+    ~TelemetryProbe(void);
+    /// Return the probe of the calling thread (NULL if none)
+    static TelemetryProbe* current(void);
+    /// Detach the calling thread from its probe. Used in a forked process,
+    /// where the reporter thread of the telemetry doesn't exist.
+    static void detach(void);
+    /// Return true if new values have to be published
+    bool wanted(void) const;
+    /// Publish the values \a s
+    void publish(const TelemetrySample& s);
+  };
+
+
+  forceinline bool
+  Telemetry::ok(void) const {
+    return (f != NULL) || (fd >= 0);
+  }
+
+  forceinline bool
+  TelemetryProbe::wanted(void) const {
+    return request.load(std::memory_order_relaxed);
+  }
+
+  forceinline void
+  TelemetryProbe::publish(const TelemetrySample& s) {
+    node.store(s.node, std::memory_order_relaxed);
+    fail.store(s.fail, std::memory_order_relaxed);
+    clone.store(s.clone, std::memory_order_relaxed);
+    depth.store(s.depth, std::memory_order_relaxed);
+    brancher.store(s.brancher, std::memory_order_relaxed);
+    quantifier.store(s.quantifier, std::memory_order_relaxed);
+    strategyMemory.store(s.strategyMemory, std::memory_order_relaxed);
+    cloneMemory.store(s.cloneMemory, std::memory_order_relaxed);
+    pathMemory.store(s.pathMemory, std::memory_order_relaxed);
+    time.store(t.now(), std::memory_order_relaxed);
+    request.store(false, std::memory_order_relaxed);
+  }
+
+}}
+
+#endif
+
+// STATISTICS: support-any
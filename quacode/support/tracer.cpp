@@ -0,0 +1,180 @@
+/* -*- mode: C++; c-basic-offset: 2; indent-tabs-mode: nil -*- */
+/*
+ *  Main authors:
+ *     Vincent Barichard <Vincent.Barichard@univ-angers.fr>
+ *
+ *  Copyright:
+ *     Vincent Barichard, 2014
+ *
+ *  Last modified:
+ *     $Date$ by $Author$
+ *     $Revision$
+ *
+ *  This file is part of Quacode:
+ *     http://quacode.barichard.com
+ *
+ *  Permission is hereby granted, free of charge, to any person obtaining
+ *  a copy of this software and associated documentation files (the
+ *  "Software"), to deal in the Software without restriction, including
+ *  without limitation the rights to use, copy, modify, merge, publish,
+ *  distribute, sublicense, and/or sell copies of the Software, and to
+ *  permit persons to whom the Software is furnished to do so, subject to
+ *  the following conditions:
+ *
+ *  The above copyright notice and this permission notice shall be
+ *  included in all copies or substantial portions of the Software.
+ *
+ *  THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND,
+ *  EXPRESS OR IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF
+ *  MERCHANTABILITY, FITNESS FOR A PARTICULAR PURPOSE AND
+ *  NONINFRINGEMENT. IN NO EVENT SHALL THE AUTHORS OR COPYRIGHT HOLDERS BE
+ *  LIABLE FOR ANY CLAIM, DAMAGES OR OTHER LIABILITY, WHETHER IN AN ACTION
+ *  OF CONTRACT, TORT OR OTHERWISE, ARISING FROM, OUT OF OR IN CONNECTION
+ *  WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE SOFTWARE.
+ *
+ */
+
+#include <quacode/support/tracer.hh>
+#include <quacode/support/clock.hh>
+#include <cstring>
+
+namespace Gecode { namespace Support {
+
+  Tracer::Tracer(const char* fn, unsigned int cap)
+    : f(std::fopen(fn, "wb")), blocks(0), bStop(false), start(clockNow()), threads(0),
+      capacity(cap > 0 ? cap : 1) {
+    if (f == NULL) return;
+    TraceHeader h;
+    std::memcpy(h.magic, "QTRACE01", 8);
+    h.size = sizeof(TraceRecord);
+    h.pad = 0;
+    std::fwrite(&h, sizeof(h), 1, f);
+    writer = std::thread(&Tracer::run, this);
+  }
+
+  Tracer::~Tracer(void) {
+    {
+      Lock l(m);
+      bStop = true;
+    }
+    eFull.signal();
+    if (writer.joinable()) writer.join();
+    for (std::vector<Block*>::size_type i=0; i<spare.size(); i++)
+      delete spare[i];
+    if (f != NULL) std::fclose(f);
+  }
+
+  uint64_t
+  Tracer::now(void) const {
+    return clockNow() - start;
+  }
+
+  void
+  Tracer::run(void) {
+    while (true) {
+      Block* b = NULL;
+      bool stop;
+      {
+        Lock l(m);
+        if (!full.empty()) {
+          b = full.front();
+          full.pop_front();
+        }
+        stop = bStop;
+      }
+      if (b == NULL) {
+        // The remaining blocks are written before the writer ends
+        if (stop) break;
+        eFull.wait();
+        continue;
+      }
+      // Only the writer uses the file once the header is written
+      std::fwrite(&b->r[0], sizeof(TraceRecord), b->n, f);
+      b->n = 0;
+      {
+        Lock l(m);
+        spare.push_back(b);
+      }
+      eSpare.signal();
+    }
+  }
+
+  Tracer::Block*
+  Tracer::acquire(void) {
+    while (true) {
+      {
+        Lock l(m);
+        if (!spare.empty()) {
+          Block* b = spare.back();
+          spare.pop_back();
+          // Signals of the event may have been merged, pass them on
+          if (!spare.empty()) eSpare.signal();
+          return b;
+        }
+        // Two blocks per thread: one being filled, one being written
+        if ((f == NULL) || (blocks < 2 * threads + 2)) {
+          blocks++;
+          break;
+        }
+      }
+      eSpare.wait();
+    }
+    Block* b = new Block;
+    b->r.resize(capacity);
+    std::memset(&b->r[0], 0, b->r.size() * sizeof(TraceRecord));
+    b->n = 0;
+    return b;
+  }
+
+  void
+  Tracer::release(Block* b) {
+    {
+      Lock l(m);
+      if ((b->n == 0) || (f == NULL)) {
+        b->n = 0;
+        spare.push_back(b);
+      } else {
+        full.push_back(b);
+      }
+    }
+    eFull.signal();
+    eSpare.signal();
+  }
+
+  thread_local TraceBuffer* TraceBuffer::cur = NULL;
+
+  TraceBuffer::TraceBuffer(Tracer& t0)
+    : t(t0), lastId(0), previous(cur), pPos(-1), pInf(0), pSup(0) {
+    {
+      Lock l(t.m);
+      thread = static_cast<uint16_t>(t.threads++);
+    }
+    block = t.acquire();
+    cur = this;
+  }
+
+  TraceBuffer::~TraceBuffer(void) {
+    t.release(block);
+    cur = previous;
+  }
+
+  TraceBuffer*
+  TraceBuffer::current(void) {
+    return cur;
+  }
+
+  void
+  TraceBuffer::detach(void) {
+    cur = NULL;
+  }
+
+  void
+  TraceBuffer::flush(void) {
+    if (block->n == 0) return;
+    t.release(block);
+    block = t.acquire();
+  }
+
+}}
+
+// STATISTICS: support-any
@@ -0,0 +1,237 @@
+/* -*- mode: C++; c-basic-offset: 2; indent-tabs-mode: nil -*- */
+/*
+ *  Main authors:
+ *     Vincent Barichard <Vincent.Barichard@univ-angers.fr>
+ *
+ *  Copyright:
+ *     Vincent Barichard, 2014
+ *
+ *  Last modified:
+ *     $Date$ by $Author$
+ *     $Revision$
+ *
+ *  This file is part of Quacode:
+ *     http://quacode.barichard.com
+ *
+ *  Permission is hereby granted, free of charge, to any person obtaining
+ *  a copy of this software and associated documentation files (the
+ *  "Software"), to deal in the Software without restriction, including
+ *  without limitation the rights to use, copy, modify, merge, publish,
+ *  distribute, sublicense, and/or sell copies of the Software, and to
+ *  permit persons to whom the Software is furnished to do so, subject to
+ *  the following conditions:
+ *
+ *  The above copyright notice and this permission notice shall be
+ *  included in all copies or substantial portions of the Software.
+ *
+ *  THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND,
+ *  EXPRESS OR IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF
+ *  MERCHANTABILITY, FITNESS FOR A PARTICULAR PURPOSE AND
+ *  NONINFRINGEMENT. IN NO EVENT SHALL THE AUTHORS OR COPYRIGHT HOLDERS BE
+ *  LIABLE FOR ANY CLAIM, DAMAGES OR OTHER LIABILITY, WHETHER IN AN ACTION
+ *  OF CONTRACT, TORT OR OTHERWISE, ARISING FROM, OUT OF OR IN CONNECTION
+ *  WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE SOFTWARE.
+ *
+ */
+
+#ifndef __GECODE_SUPPORT_TRACER_HH__
+#define __GECODE_SUPPORT_TRACER_HH__
+
+#include <quacode/qcsp.hh>
+#include <gecode/support.hh>
+#include <cstdio>
+#include <deque>
+#include <thread>
+#include <vector>
+#include <stdint.h>
+
+namespace Gecode { namespace Support {
+
+  /**
+   * \brief Record of a search trace
+   *
+   * Each node explored by the search gives one record of fixed size. The
+   * brancher, quantifier and value are the ones of the choice which
+   * created the node (brancher 0 for the root). Node ids are unique
+   * for a thread, so a node is identified by its thread and its id.
+   */
+  struct TraceRecord {
+    /// Status of a node
+    enum Status {
+      BRANCH = 0, ///< Node with a choice
+      FAILED = 1, ///< Failed node
+      SOLVED = 2  ///< Solved node
+    };
+    uint64_t node;       ///< Id of the node (from 1)
+    uint64_t parent;     ///< Id of the parent (0 for the root)
+    uint64_t time;       ///< Time in nanoseconds since the creation of the tracer
+    uint32_t brancher;   ///< Id of the brancher of the choice
+    int32_t pos;         ///< Position of the variable in the brancher
+    int32_t inf;         ///< Minimum of the variable after the choice
+    int32_t sup;         ///< Maximum of the variable after the choice
+    uint16_t thread;     ///< Thread which explored the node
+    uint8_t quantifier;  ///< Quantifier of the choice
+    uint8_t status;      ///< Status of the node
+    uint8_t pad[4];      ///< Unused
+  };
+
+  /// Header of a trace file
+  struct TraceHeader {
+    char magic[8];       ///< "QTRACE01"
+    uint32_t size;       ///< Size of a record
+    uint32_t pad;        ///< Unused
+  };
+
+  class TraceBuffer;
+
+  /**
+   * \brief Tracer of the search tree
+   *
+   * The tracer writes the records of the search to a binary file (a
+   * TraceHeader followed by the records). Each thread taking part to the
+   * search attaches itself to the tracer with a TraceBuffer, its records
+   * are kept in a block and full blocks are handed to a writer thread of
+   * the tracer, so the search only pays for the copy of a record. A search
+   * thread only waits when the writer is late by too many blocks.
+   */
+  class QUACODE_EXPORT Tracer {
+    friend class TraceBuffer;
+  private:
+    /// Block of records
+    struct Block {
+      /// Records
+      std::vector<TraceRecord> r;
+      /// Number of records in the block
+      unsigned int n;
+    };
+    /// Trace file
+    std::FILE* f;
+    /// Mutex protecting the blocks
+    Mutex m;
+    /// Event signaled when a block is full or the tracer stops
+    Event eFull;
+    /// Event signaled when a block is given back by the writer
+    Event eSpare;
+    /// Full blocks, in the order they must be written
+    std::deque<Block*> full;
+    /// Blocks ready to be filled
+    std::vector<Block*> spare;
+    /// Number of blocks allocated
+    unsigned int blocks;
+    /// Whether the tracer stops
+    bool bStop;
+    /// Start time (nanoseconds)
+    uint64_t start;
+    /// Number of threads attached so far
+    unsigned int threads;
+    /// Number of records of a block
+    unsigned int capacity;
+    /// Writer thread
+    std::thread writer;
+    /// Write the full blocks until the tracer stops
+    void run(void);
+    /// Return an empty block, wait for the writer if too many blocks are allocated
+    Block* acquire(void);
+    /// Hand block \a b to the writer (it is only given back if \a b is not empty)
+    void release(Block* b);
+  public:
+    /// Create tracer writing to file \a fn with blocks of \a cap records
+    Tracer(const char* fn, unsigned int cap = 4096);
+    /// Return true if the file could be opened
+    bool ok(void) const;
+    /// Return the time in nanoseconds since the creation of the tracer
+    uint64_t now(void) const;
+    /// Write the remaining blocks and close the file (the buffers must be destroyed before)
+    ~Tracer(void);
+  };
+
+  /**
+   * \brief Buffer of the records of a thread
+   *
+   * Creating a buffer attaches the calling thread to a tracer until the
+   * buffer is destroyed. The search engines of the thread find it with
+   * TraceBuffer::current().
+   */
+  class QUACODE_EXPORT TraceBuffer {
+  private:
+    /// Buffer of the thread
+    static thread_local TraceBuffer* cur;
+    /// Tracer
+    Tracer& t;
+    /// Block being filled
+    Tracer::Block* block;
+    /// Thread number
+    uint16_t thread;
+    /// Last node id given
+    uint64_t lastId;
+    /// Buffer of the thread before this one
+    TraceBuffer* previous;
+    /// Value of the pending choice
+    int32_t pPos, pInf, pSup;
+  public:
+    /// Attach the calling thread to tracer \a t0
+    TraceBuffer(Tracer& t0);
+    /// Hand the remaining records to the tracer and detach the thread
+    ~TraceBuffer(void);
+    /// Return the buffer of the calling thread (NULL if none)
+    static TraceBuffer* current(void);
+    /// Detach the calling thread from its buffer without writing it. Used in a
+    /// forked process, where the writer thread of the tracer doesn't exist.
+    static void detach(void);
+    /// Return a new node id
+    uint64_t id(void);
+    /// Record the value of the choice committed (variable at \a pos in [\a inf, \a sup])
+    void choice(int pos, int inf, int sup);
+    /// Record node \a node of parent \a parent, created by a choice of brancher \a b
+    /// with quantifier \a q, with status \a s
+    void node(uint64_t node, uint64_t parent, unsigned int b, TQuantifier q,
+              TraceRecord::Status s);
+    /// Hand the records of the buffer to the writer of the tracer
+    void flush(void);
+  };
+
+
+  forceinline bool
+  Tracer::ok(void) const {
+    return f != NULL;
+  }
+
+  forceinline uint64_t
+  TraceBuffer::id(void) {
+    return ++lastId;
+  }
+
+  forceinline void
+  TraceBuffer::choice(int pos, int inf, int sup) {
+    pPos = pos;
+    pInf = inf;
+    pSup = sup;
+  }
+
+  forceinline void
+  TraceBuffer::node(uint64_t node, uint64_t parent, unsigned int b, TQuantifier q,
+                    TraceRecord::Status s) {
+    if (block->n == block->r.size()) flush();
+    TraceRecord& x = block->r[block->n++];
+    x.node = node;
+    x.parent = parent;
+    x.time = t.now();
+    x.brancher = b;
+    x.quantifier = static_cast<uint8_t>(q);
+    x.status = static_cast<uint8_t>(s);
+    x.thread = thread;
+    if (parent == 0) {
+      x.pos = -1;
+      x.inf = x.sup = 0;
+    } else {
+      x.pos = pPos;
+      x.inf = pInf;
+      x.sup = pSup;
+    }
+  }
+
+}}
+
+#endif
+
+// STATISTICS: support-any
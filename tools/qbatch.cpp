@@ -0,0 +1,492 @@
+/* -*- mode: C++; c-basic-offset: 2; indent-tabs-mode: nil -*- */
+/*
+ *  Main authors:
+ *     Vincent Barichard <Vincent.Barichard@univ-angers.fr>
+ *
+ *  Copyright:
+ *     Vincent Barichard, 2014
+ *
+ *  Last modified:
+ *     $Date$ by $Author$
+ *     $Revision$
+ *
+ *  This file is part of Quacode:
+ *     http://quacode.barichard.com
+ *
+ *  Permission is hereby granted, free of charge, to any person obtaining
+ *  a copy of this software and associated documentation files (the
+ *  "Software"), to deal in the Software without restriction, including
+ *  without limitation the rights to use, copy, modify, merge, publish,
+ *  distribute, sublicense, and/or sell copies of the Software, and to
+ *  permit persons to whom the Software is furnished to do so, subject to
+ *  the following conditions:
+ *
+ *  The above copyright notice and this permission notice shall be
+ *  included in all copies or substantial portions of the Software.
+ *
+ *  THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND,
+ *  EXPRESS OR IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF
+ *  MERCHANTABILITY, FITNESS FOR A PARTICULAR PURPOSE AND
+ *  NONINFRINGEMENT. IN NO EVENT SHALL THE AUTHORS OR COPYRIGHT HOLDERS BE
+ *  LIABLE FOR ANY CLAIM, DAMAGES OR OTHER LIABILITY, WHETHER IN AN ACTION
+ *  OF CONTRACT, TORT OR OTHERWISE, ARISING FROM, OUT OF OR IN CONNECTION
+ *  WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE SOFTWARE.
+ *
+ */
+
+#include <algorithm>
+#include <cerrno>
+#include <csignal>
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
+#include <iostream>
+#include <new>
+#include <sstream>
+#include <string>
+#include <vector>
+
+#include <dirent.h>
+#include <sys/resource.h>
+#include <sys/stat.h>
+#include <sys/time.h>
+#include <sys/types.h>
+#include <sys/wait.h>
+#include <unistd.h>
+
+#include <quacode/qbf/qdimacs.hh>
+#include <quacode/qbf/qcir.hh>
+#include <quacode/qbf/qpreprocess.hh>
+#include <quacode/qbf/qdependency.hh>
+#include <quacode/flatzinc/qflatzinc.hh>
+
+using namespace Gecode;
+
+/**
+ * \brief Batch solver for directories of instances
+ *
+ * Every file found (recursively) in the directories given on the command
+ * line is solved \a runs times. Up to \a jobs instances are solved
+ * concurrently, each one in a child process forked from the driver, so
+ * that the time and memory limits are enforced for each instance and a
+ * crash only loses one row. QDIMACS (.qdimacs, .qdm, .cnf), QCIR (.qcir)
+ * and FlatZinc (.fzn) files are read and solved by the library directly.
+ * Other files are solved by the command given with -exec, in which {} is
+ * replaced by the file name and {time} by the time limit, and the statistics printed by the Gecode
+ * driver are collected from its output.
+ *
+ * A row is printed as soon as an instance is solved, in CSV
+ * (separated by ";" as privateMisc/results.csv) or in JSON lines.
+ */
+
+namespace {
+
+  /// Status of a run
+  enum Status { ST_TRUE, ST_FALSE, ST_TIMEOUT, ST_MEMOUT, ST_ERROR, ST_CRASH, ST_UNSUPPORTED };
+
+  /// Names of the status
+  const char* statusName[] = {
+    "true", "false", "timeout", "memout", "error", "crash", "unsupported"
+  };
+
+  /// Result sent by a child to the driver
+  struct Result {
+    int status;                ///< Status of the run
+    unsigned long int propagations; ///< Number of propagations
+    unsigned long int nodes;   ///< Number of nodes
+    unsigned long int failures;///< Number of failures
+    unsigned long int depth;   ///< Peak depth
+    double runtime;            ///< Runtime in milliseconds
+    char message[128];         ///< Error message
+  };
+
+  /// Options of the driver
+  struct BatchOptions {
+    unsigned int jobs;        ///< Number of concurrent instances
+    unsigned int runs;        ///< Number of runs of each instance
+    unsigned int time;        ///< Time limit in milliseconds (0 for none)
+    unsigned int memory;      ///< Memory limit in megabytes (0 for none)
+    bool json;                ///< JSON lines instead of CSV
+    bool qc;                  ///< Use the quantified constraints
+    bool preprocess;          ///< Preprocess QDIMACS instances
+    bool dependencies;        ///< Relax the prefix of QDIMACS instances
+    bool components;          ///< Decompose QDIMACS instances into components
+    std::string exec;         ///< Command for other instances
+    std::vector<std::string> paths; ///< Directories and files to solve
+    BatchOptions(void)
+      : jobs(1), runs(1), time(0), memory(0), json(false), qc(true), preprocess(false),
+        dependencies(false), components(false) {
+      long int n = sysconf(_SC_NPROCESSORS_ONLN);
+      if (n > 0) jobs = static_cast<unsigned int>(n);
+    }
+  };
+
+  /// Running instance
+  struct Job {
+    pid_t pid;            ///< Process of the child
+    int fd;               ///< Pipe to read the result from
+    std::string file;     ///< Instance
+    unsigned int run;     ///< Number of the run
+  };
+
+  /// Return true if file name \a f ends with \a e
+  bool endsWith(const std::string& f, const char* e) {
+    std::size_t n = std::strlen(e);
+    return (f.size() >= n) && (f.compare(f.size()-n, n, e) == 0);
+  }
+
+  /// Add the regular files of \a p (recursively if it is a directory) to \a files
+  void collect(const std::string& p, std::vector<std::string>& files) {
+    struct stat st;
+    if (stat(p.c_str(), &st) != 0) {
+      std::cerr << "qbatch: cannot access '" << p << "'" << std::endl;
+      return;
+    }
+    if (S_ISREG(st.st_mode)) {
+      files.push_back(p);
+      return;
+    }
+    if (!S_ISDIR(st.st_mode)) return;
+    DIR* d = opendir(p.c_str());
+    if (d == NULL) return;
+    std::vector<std::string> entries;
+    while (struct dirent* e = readdir(d)) {
+      if (e->d_name[0] != '.') entries.push_back(p + "/" + e->d_name);
+    }
+    closedir(d);
+    std::sort(entries.begin(), entries.end());
+    for (std::vector<std::string>::size_type i=0; i<entries.size(); i++)
+      collect(entries[i], files);
+  }
+
+  /// Solve space \a s and fill \a r
+  void solve(QFlatZincSpace* s, const BatchOptions& opt, Result& r) {
+    Search::Options o;
+    Search::TimeStop* ts = NULL;
+    if (opt.time > 0) {
+      ts = new Search::TimeStop(opt.time);
+      o.stop = ts;
+    }
+    QDFS<QFlatZincSpace> e(s, o);
+    delete s;
+    QFlatZincSpace* sol = e.next();
+    if (sol != NULL) r.status = ST_TRUE;
+    else r.status = e.stopped() ? ST_TIMEOUT : ST_FALSE;
+    delete sol;
+    Search::Statistics stat = e.statistics();
+    r.propagations = stat.propagate;
+    r.nodes = stat.node;
+    r.failures = stat.fail;
+    r.depth = stat.depth;
+    delete ts;
+  }
+
+  /// Solve instance \a f with the library (returns false if the format is unknown)
+  bool solveNative(const std::string& f, const BatchOptions& opt, Result& r) {
+    QFlatZincSpace* s = NULL;
+    if (endsWith(f, ".qdimacs") || endsWith(f, ".qdm") || endsWith(f, ".cnf")) {
+      QDimacsReader reader;
+      reader.parse(f.c_str());
+      if (opt.preprocess && !QBFPreprocessor().run(reader)) {
+        r.status = ST_FALSE;
+        return true;
+      }
+      if (opt.dependencies) QBFDependencies().relax(reader);
+      s = new QFlatZincSpace();
+      s->strategyMethod(0);
+      s->componentDecomposition(opt.components);
+      std::vector<BoolVarArray> blocks;
+      reader.post(*s, *s, s->bv, blocks, opt.qc);
+      for (std::vector<BoolVarArray>::size_type i=0; i<blocks.size(); i++)
+        s->branch(*s, blocks[i], INT_VAR_NONE(), INT_VAL_MIN());
+      if (opt.components) reader.link(*s, s->bv);
+    } else if (endsWith(f, ".qcir")) {
+      QCirReader reader;
+      reader.parse(f.c_str());
+      s = new QFlatZincSpace();
+      s->strategyMethod(0);
+      std::vector<BoolVarArray> blocks;
+      reader.post(*s, *s, s->bv, blocks, opt.qc);
+      for (std::vector<BoolVarArray>::size_type i=0; i<blocks.size(); i++)
+        s->branch(*s, blocks[i], INT_VAR_NONE(), INT_VAL_MIN());
+    } else if (endsWith(f, ".fzn")) {
+      s = new QFlatZincSpace();
+      s->strategyMethod(0);
+      QFlatZincParser(opt.qc).parse(f.c_str(), *s);
+    } else {
+      return false;
+    }
+    solve(s, opt, r);
+    return true;
+  }
+
+  /// Return \a s where all occurrences of \a w are replaced by \a v
+  std::string replace(std::string s, const char* w, const std::string& v) {
+    std::size_t n = std::strlen(w);
+    for (std::size_t p = s.find(w); p != std::string::npos; p = s.find(w, p + v.size()))
+      s.replace(p, n, v);
+    return s;
+  }
+
+  /// Read value of statistic \a key in output \a out of the Gecode driver
+  unsigned long int statistic(const std::string& out, const char* key) {
+    std::size_t p = out.find(key);
+    if (p == std::string::npos) return 0;
+    return std::strtoul(out.c_str() + p + std::strlen(key), NULL, 10);
+  }
+
+  /// Solve instance \a f with the command of the options
+  void solveExec(const std::string& f, const BatchOptions& opt, Result& r) {
+    std::ostringstream t;
+    t << opt.time;
+    std::string cmd = replace(replace(opt.exec, "{time}", t.str()), "{}", f);
+    FILE* in = popen(cmd.c_str(), "r");
+    if (in == NULL) {
+      r.status = ST_ERROR;
+      std::strncpy(r.message, "cannot run command", sizeof(r.message)-1);
+      return;
+    }
+    std::string out;
+    char buf[4096];
+    for (std::size_t n; (n = std::fread(buf, 1, sizeof(buf), in)) > 0; )
+      out.append(buf, n);
+    int ws = pclose(in);
+    r.propagations = statistic(out, "propagations:");
+    r.nodes = statistic(out, "nodes:");
+    r.failures = statistic(out, "failures:");
+    r.depth = statistic(out, "peak depth:");
+    if (out.find("time limit reached") != std::string::npos)
+      r.status = ST_TIMEOUT;
+    else if ((ws == -1) || !WIFEXITED(ws) || (WEXITSTATUS(ws) != 0))
+      r.status = ST_ERROR;
+    else
+      r.status = (statistic(out, "solutions:") > 0) ? ST_TRUE : ST_FALSE;
+  }
+
+  /// Body of the child solving instance \a f
+  void child(const std::string& f, const BatchOptions& opt, int fd) {
+    if (opt.memory > 0) {
+      struct rlimit rl;
+      rl.rlim_cur = rl.rlim_max = static_cast<rlim_t>(opt.memory) * 1024 * 1024;
+      setrlimit(RLIMIT_AS, &rl);
+    }
+    if (opt.time > 0) {
+      // The search stops itself, the CPU limit catches parsing and posting
+      struct rlimit rl;
+      rl.rlim_cur = opt.time / 1000 + 2;
+      rl.rlim_max = rl.rlim_cur + 1;
+      setrlimit(RLIMIT_CPU, &rl);
+    }
+    Result r;
+    std::memset(&r, 0, sizeof(r));
+    Support::Timer t;
+    t.start();
+    try {
+      if (!solveNative(f, opt, r)) {
+        if (opt.exec.empty()) r.status = ST_UNSUPPORTED;
+        else solveExec(f, opt, r);
+      }
+    } catch (MemoryExhausted&) {
+      r.status = ST_MEMOUT;
+    } catch (std::bad_alloc&) {
+      r.status = ST_MEMOUT;
+    } catch (Exception& e) {
+      r.status = ST_ERROR;
+      std::strncpy(r.message, e.what(), sizeof(r.message)-1);
+    }
+    r.runtime = t.stop();
+    ssize_t w = write(fd, &r, sizeof(r));
+    (void) w;
+    close(fd);
+  }
+
+  /// Print string \a s escaped for CSV or JSON
+  void printEscaped(std::ostream& os, const std::string& s, bool json) {
+    for (std::string::size_type i=0; i<s.size(); i++) {
+      char c = s[i];
+      if (json && ((c == '"') || (c == '\\'))) os << '\\' << c;
+      else if (!json && (c == ';')) os << ',';
+      else if ((c == '\n') || (c == '\r')) os << ' ';
+      else os << c;
+    }
+  }
+
+  /// Print the row of run \a run of instance \a f
+  void print(std::ostream& os, const std::string& f, unsigned int run, const Result& r,
+             long int memory, bool json) {
+    if (json) {
+      os << "{\"instance\":\"";
+      printEscaped(os, f, true);
+      os << "\",\"run\":" << run
+         << ",\"status\":\"" << statusName[r.status] << "\""
+         << ",\"propagations\":" << r.propagations
+         << ",\"nodes\":" << r.nodes
+         << ",\"failures\":" << r.failures
+         << ",\"depth\":" << r.depth
+         << ",\"runtime\":" << r.runtime
+         << ",\"memory\":" << memory;
+      if (r.message[0] != 0) {
+        os << ",\"message\":\"";
+        printEscaped(os, r.message, true);
+        os << "\"";
+      }
+      os << "}" << std::endl;
+    } else {
+      printEscaped(os, f, false);
+      os << ";" << run << ";" << statusName[r.status]
+         << ";" << r.propagations << ";" << r.nodes << ";" << r.failures
+         << ";" << r.depth << ";" << r.runtime << ";" << memory << ";";
+      printEscaped(os, r.message, false);
+      os << std::endl;
+    }
+  }
+
+  /// Wait for the end of one of the jobs in \a jobs and print its row
+  void reap(std::vector<Job>& jobs, const BatchOptions& opt) {
+    int ws;
+    struct rusage ru;
+    pid_t pid;
+    while (((pid = wait4(-1, &ws, 0, &ru)) == -1) && (errno == EINTR)) {}
+    if (pid == -1) {
+      std::cerr << "qbatch: wait failed" << std::endl;
+      std::exit(EXIT_FAILURE);
+    }
+    for (std::vector<Job>::size_type i=0; i<jobs.size(); i++) {
+      if (jobs[i].pid != pid) continue;
+      Result r;
+      std::memset(&r, 0, sizeof(r));
+      if (read(jobs[i].fd, &r, sizeof(r)) != static_cast<ssize_t>(sizeof(r))) {
+        // The child died before sending its result
+        std::memset(&r, 0, sizeof(r));
+        if (WIFSIGNALED(ws) && ((WTERMSIG(ws) == SIGXCPU) || (WTERMSIG(ws) == SIGKILL)))
+          r.status = ST_TIMEOUT;
+        else
+          r.status = ST_CRASH;
+        r.runtime = (ru.ru_utime.tv_sec + ru.ru_stime.tv_sec) * 1000.0 +
+                    (ru.ru_utime.tv_usec + ru.ru_stime.tv_usec) / 1000.0;
+      }
+      close(jobs[i].fd);
+      print(std::cout, jobs[i].file, jobs[i].run, r, ru.ru_maxrss, opt.json);
+      jobs.erase(jobs.begin() + i);
+      return;
+    }
+  }
+
+  /// Print help message
+  void help(void) {
+    std::cerr << "Usage: qbatch [options] <directory or file>..." << std::endl
+              << "Options:" << std::endl
+              << "\t-j (unsigned int) default: number of processors" << std::endl
+              << "\t\tnumber of instances solved concurrently" << std::endl
+              << "\t-runs (unsigned int) default: 1" << std::endl
+              << "\t\tnumber of runs of each instance" << std::endl
+              << "\t-time (unsigned int) default: 0 (none)" << std::endl
+              << "\t\ttime limit of each run in milliseconds" << std::endl
+              << "\t-memory (unsigned int) default: 0 (none)" << std::endl
+              << "\t\tmemory limit of each run in megabytes" << std::endl
+              << "\t-format (csv, json) default: csv" << std::endl
+              << "\t\tformat of the rows" << std::endl
+              << "\t-quantifiedConstraints (true, false) default: true" << std::endl
+              << "\t\twhether to use quantified optimized constraints" << std::endl
+              << "\t-preprocess (true, false) default: false" << std::endl
+              << "\t\tpreprocess the QDIMACS instances" << std::endl
+              << "\t-dependencies (true, false) default: false" << std::endl
+              << "\t\trelax the prefix of the QDIMACS instances with their dependencies" << std::endl
+              << "\t-components (true, false) default: false" << std::endl
+              << "\t\tdecompose the QDIMACS instances into independent components" << std::endl
+              << "\t-exec (string) default: none" << std::endl
+              << "\t\tcommand solving the other instances ({} is replaced by the" << std::endl
+              << "\t\tfile name, {time} by the time limit)" << std::endl;
+  }
+
+  /// Parse Boolean value \a s
+  bool boolean(const char* s) {
+    return (std::strcmp(s, "true") == 0) || (std::strcmp(s, "1") == 0);
+  }
+
+}
+
+/** \brief Main-function
+ */
+int main(int argc, char* argv[]) {
+  BatchOptions opt;
+  for (int i=1; i<argc; i++) {
+    std::string a = argv[i];
+    bool value = (i+1 < argc);
+    if ((a == "-help") || (a == "--help")) {
+      help();
+      return 0;
+    } else if ((a == "-j") && value) {
+      opt.jobs = std::max(1, std::atoi(argv[++i]));
+    } else if ((a == "-runs") && value) {
+      opt.runs = std::max(1, std::atoi(argv[++i]));
+    } else if ((a == "-time") && value) {
+      opt.time = std::max(0, std::atoi(argv[++i]));
+    } else if ((a == "-memory") && value) {
+      opt.memory = std::max(0, std::atoi(argv[++i]));
+    } else if ((a == "-format") && value) {
+      opt.json = (std::strcmp(argv[++i], "json") == 0);
+    } else if ((a == "-quantifiedConstraints") && value) {
+      opt.qc = boolean(argv[++i]);
+    } else if ((a == "-preprocess") && value) {
+      opt.preprocess = boolean(argv[++i]);
+    } else if ((a == "-dependencies") && value) {
+      opt.dependencies = boolean(argv[++i]);
+    } else if ((a == "-components") && value) {
+      opt.components = boolean(argv[++i]);
+    } else if ((a == "-exec") && value) {
+      opt.exec = argv[++i];
+    } else if (a[0] == '-') {
+      std::cerr << "Could not parse all arguments." << std::endl;
+      help();
+      return EXIT_FAILURE;
+    } else {
+      opt.paths.push_back(a);
+    }
+  }
+  if (opt.paths.empty()) {
+    help();
+    return EXIT_FAILURE;
+  }
+
+  std::vector<std::string> files;
+  for (std::vector<std::string>::size_type i=0; i<opt.paths.size(); i++)
+    collect(opt.paths[i], files);
+
+  if (!opt.json)
+    std::cout << "#instance;run;status;propagations;nodes;failures;depth;runtime(ms);memory(kB);message"
+              << std::endl;
+
+  std::vector<Job> jobs;
+  for (std::vector<std::string>::size_type i=0; i<files.size(); i++)
+    for (unsigned int run=1; run<=opt.runs; run++) {
+      if (jobs.size() >= opt.jobs) reap(jobs, opt);
+      int fds[2];
+      if (pipe(fds) != 0) {
+        std::cerr << "qbatch: cannot create pipe" << std::endl;
+        return EXIT_FAILURE;
+      }
+      std::cout.flush();
+      pid_t pid = fork();
+      if (pid == -1) {
+        std::cerr << "qbatch: cannot fork" << std::endl;
+        return EXIT_FAILURE;
+      }
+      if (pid == 0) {
+        close(fds[0]);
+        child(files[i], opt, fds[1]);
+        _exit(0);
+      }
+      close(fds[1]);
+      Job j;
+      j.pid = pid;
+      j.fd = fds[0];
+      j.file = files[i];
+      j.run = run;
+      jobs.push_back(j);
+    }
+  while (!jobs.empty()) reap(jobs, opt);
+  return 0;
+}
+
+// STATISTICS: example-any
@@ -0,0 +1,415 @@
+/* -*- mode: C++; c-basic-offset: 2; indent-tabs-mode: nil -*- */
+/*
+ *  Main authors:
+ *     Vincent Barichard <Vincent.Barichard@univ-angers.fr>
+ *
+ *  Copyright:
+ *     Vincent Barichard, 2014
+ *
+ *  Last modified:
+ *     $Date$ by $Author$
+ *     $Revision$
+ *
+ *  This file is part of Quacode:
+ *     http://quacode.barichard.com
+ *
+ *  Permission is hereby granted, free of charge, to any person obtaining
+ *  a copy of this software and associated documentation files (the
+ *  "Software"), to deal in the Software without restriction, including
+ *  without limitation the rights to use, copy, modify, merge, publish,
+ *  distribute, sublicense, and/or sell copies of the Software, and to
+ *  permit persons to whom the Software is furnished to do so, subject to
+ *  the following conditions:
+ *
+ *  The above copyright notice and this permission notice shall be
+ *  included in all copies or substantial portions of the Software.
+ *
+ *  THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND,
+ *  EXPRESS OR IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF
+ *  MERCHANTABILITY, FITNESS FOR A PARTICULAR PURPOSE AND
+ *  NONINFRINGEMENT. IN NO EVENT SHALL THE AUTHORS OR COPYRIGHT HOLDERS BE
+ *  LIABLE FOR ANY CLAIM, DAMAGES OR OTHER LIABILITY, WHETHER IN AN ACTION
+ *  OF CONTRACT, TORT OR OTHERWISE, ARISING FROM, OUT OF OR IN CONNECTION
+ *  WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE SOFTWARE.
+ *
+ */
+
+#include <algorithm>
+#include <cerrno>
+#include <cmath>
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
+#include <fstream>
+#include <iomanip>
+#include <iostream>
+#include <map>
+#include <sstream>
+#include <string>
+#include <vector>
+
+#include <sched.h>
+#include <sys/resource.h>
+#include <sys/time.h>
+#include <sys/types.h>
+#include <sys/wait.h>
+#include <time.h>
+#include <unistd.h>
+
+/**
+ * \brief Reproducible benchmarks of the examples
+ *
+ * Every benchmark of the suite (see tools/bench/suite.txt) is run
+ * \a warmup times without measure, then \a runs times. The runtime of a
+ * run is the one printed by the Gecode driver (so it excludes process
+ * start and model loading), the wall time of the process if none is
+ * printed. Runs may be pinned to one CPU to reduce the variance.
+ *
+ * For each benchmark a row is printed with the median runtime, its 95%
+ * confidence interval (order statistics of the runs, no assumption on
+ * the distribution), the 95th percentile, the number of nodes and
+ * propagations and their rates, and the peak resident set size of the
+ * runs. The rows can be stored and given back with -baseline: a
+ * benchmark whose median is more than \a threshold percent slower than
+ * in the baseline, with disjoint confidence intervals, is flagged as a
+ * regression and the exit status is 1. A change of the number of nodes
+ * is flagged too, since the search itself has changed.
+ */
+
+namespace {
+
+  /// Benchmark of the suite
+  struct Bench {
+    std::string name;  ///< Name
+    std::string cmd;   ///< Command
+  };
+
+  /// Measures of one run
+  struct Run {
+    double runtime;              ///< Runtime in milliseconds
+    unsigned long int nodes;     ///< Number of nodes
+    unsigned long int propagations; ///< Number of propagations
+    long int rss;                ///< Peak resident set size in kB
+    bool ok;                     ///< True if the command succeeded
+  };
+
+  /// Summary of the runs of a benchmark
+  struct Summary {
+    std::string name;      ///< Name of the benchmark
+    unsigned int runs;     ///< Number of runs
+    double median;         ///< Median runtime
+    double p95;            ///< 95th percentile of runtime
+    double low;            ///< Lower bound of the confidence interval of the median
+    double high;           ///< Upper bound of the confidence interval of the median
+    unsigned long int nodes;        ///< Number of nodes
+    unsigned long int propagations; ///< Number of propagations
+    long int rss;          ///< Peak resident set size in kB
+    bool stable;           ///< True if all runs explored the same number of nodes
+  };
+
+  /// Options of the benchmarks
+  struct BenchOptions {
+    std::string suite;     ///< Suite file
+    std::string bin;       ///< Directory of the examples
+    std::string src;       ///< Source directory
+    std::string baseline;  ///< Baseline file
+    std::string filter;    ///< Only run benchmarks whose name contains filter
+    unsigned int runs;     ///< Number of measured runs
+    unsigned int warmup;   ///< Number of warm-up runs
+    int cpu;               ///< CPU to pin the runs to (-1 for none)
+    double threshold;      ///< Regression threshold in percent
+    BenchOptions(void)
+      : suite("tools/bench/suite.txt"), bin("."), src("."),
+        runs(10), warmup(1), cpu(-1), threshold(5.0) {}
+  };
+
+  /// Return \a s where all occurrences of \a w are replaced by \a v
+  std::string replace(std::string s, const char* w, const std::string& v) {
+    std::size_t n = std::strlen(w);
+    for (std::size_t p = s.find(w); p != std::string::npos; p = s.find(w, p + v.size()))
+      s.replace(p, n, v);
+    return s;
+  }
+
+  /// Read the suite from file \a f
+  std::vector<Bench> readSuite(const BenchOptions& opt) {
+    std::vector<Bench> suite;
+    std::ifstream in(opt.suite.c_str());
+    if (!in) {
+      std::cerr << "qbench: cannot read suite '" << opt.suite << "'" << std::endl;
+      std::exit(EXIT_FAILURE);
+    }
+    std::string line;
+    while (std::getline(in, line)) {
+      if (line.empty() || (line[0] == '#')) continue;
+      std::size_t p = line.find(';');
+      if (p == std::string::npos) continue;
+      Bench b;
+      b.name = line.substr(0, p);
+      if (b.name.find(opt.filter) == std::string::npos) continue;
+      b.cmd = replace(replace(line.substr(p+1), "{bin}", opt.bin), "{src}", opt.src);
+      suite.push_back(b);
+    }
+    return suite;
+  }
+
+  /// Read value of statistic \a key in output \a out of the Gecode driver
+  unsigned long int statistic(const std::string& out, const char* key) {
+    std::size_t p = out.find(key);
+    if (p == std::string::npos) return 0;
+    return std::strtoul(out.c_str() + p + std::strlen(key), NULL, 10);
+  }
+
+  /// Read the runtime in milliseconds printed by the Gecode driver (negative if none)
+  double runtime(const std::string& out) {
+    std::size_t p = out.find("runtime:");
+    if (p == std::string::npos) return -1.0;
+    p = out.find('(', p);
+    if (p == std::string::npos) return -1.0;
+    return std::strtod(out.c_str() + p + 1, NULL);
+  }
+
+  /// Return the monotonic time in milliseconds
+  double now(void) {
+    struct timespec ts;
+    clock_gettime(CLOCK_MONOTONIC, &ts);
+    return ts.tv_sec * 1000.0 + ts.tv_nsec / 1000000.0;
+  }
+
+  /// Run command \a cmd once
+  Run run(const std::string& cmd, const BenchOptions& opt) {
+    Run r;
+    r.runtime = 0.0;
+    r.nodes = r.propagations = 0;
+    r.rss = 0;
+    r.ok = false;
+    int fds[2];
+    if (pipe(fds) != 0) return r;
+    double start = now();
+    pid_t pid = fork();
+    if (pid == -1) {
+      close(fds[0]);
+      close(fds[1]);
+      return r;
+    }
+    if (pid == 0) {
+      if (opt.cpu >= 0) {
+        cpu_set_t cs;
+        CPU_ZERO(&cs);
+        CPU_SET(opt.cpu, &cs);
+        sched_setaffinity(0, sizeof(cs), &cs);
+      }
+      close(fds[0]);
+      dup2(fds[1], STDOUT_FILENO);
+      close(fds[1]);
+      execl("/bin/sh", "sh", "-c", cmd.c_str(), static_cast<char*>(NULL));
+      _exit(127);
+    }
+    close(fds[1]);
+    std::string out;
+    char buf[4096];
+    for (ssize_t n; ((n = read(fds[0], buf, sizeof(buf))) > 0) || ((n < 0) && (errno == EINTR)); )
+      if (n > 0) out.append(buf, static_cast<std::size_t>(n));
+    close(fds[0]);
+    int ws;
+    struct rusage ru;
+    while ((wait4(pid, &ws, 0, &ru) == -1) && (errno == EINTR)) {}
+    double wall = now() - start;
+    r.ok = WIFEXITED(ws) && (WEXITSTATUS(ws) == 0);
+    r.runtime = runtime(out);
+    if (r.runtime < 0.0) r.runtime = wall;
+    r.nodes = statistic(out, "nodes:");
+    r.propagations = statistic(out, "propagations:");
+    r.rss = ru.ru_maxrss;
+    return r;
+  }
+
+  /// Return the value of rank \a k (from 0) of the sorted values \a v, clamped
+  double rank(const std::vector<double>& v, long int k) {
+    k = std::max(0L, std::min(k, static_cast<long int>(v.size()) - 1));
+    return v[static_cast<std::size_t>(k)];
+  }
+
+  /// Summarize runs \a r of benchmark \a name
+  Summary summarize(const std::string& name, const std::vector<Run>& r) {
+    Summary s;
+    s.name = name;
+    s.runs = static_cast<unsigned int>(r.size());
+    s.nodes = r.empty() ? 0 : r[0].nodes;
+    s.propagations = r.empty() ? 0 : r[0].propagations;
+    s.rss = 0;
+    s.stable = true;
+    std::vector<double> t;
+    for (std::vector<Run>::size_type i=0; i<r.size(); i++) {
+      t.push_back(r[i].runtime);
+      s.rss = std::max(s.rss, r[i].rss);
+      if (r[i].nodes != s.nodes) s.stable = false;
+    }
+    std::sort(t.begin(), t.end());
+    long int n = static_cast<long int>(t.size());
+    if (n == 0) {
+      s.median = s.p95 = s.low = s.high = 0.0;
+      return s;
+    }
+    s.median = (n % 2 == 1) ? t[n/2] : (t[n/2-1] + t[n/2]) / 2.0;
+    s.p95 = rank(t, static_cast<long int>(std::ceil(0.95 * n)) - 1);
+    // Ranks of the 95% confidence interval of the median (normal
+    // approximation of the binomial distribution of the ranks)
+    double h = 1.96 * std::sqrt(static_cast<double>(n)) / 2.0;
+    s.low = rank(t, static_cast<long int>(std::floor(n / 2.0 - h)));
+    s.high = rank(t, static_cast<long int>(std::ceil(n / 2.0 + h)) - 1);
+    return s;
+  }
+
+  /// Print the header of the rows
+  void printHeader(std::ostream& os) {
+    os << "#benchmark;runs;median(ms);ci_low(ms);ci_high(ms);p95(ms);nodes;propagations;"
+       << "nodes/s;propagations/s;rss(kB);status" << std::endl;
+  }
+
+  /// Print summary \a s with status \a status
+  void print(std::ostream& os, const Summary& s, const std::string& status) {
+    double sec = s.median / 1000.0;
+    os << s.name << ";" << s.runs << std::fixed << std::setprecision(3)
+       << ";" << s.median << ";" << s.low << ";" << s.high << ";" << s.p95
+       << ";" << s.nodes << ";" << s.propagations << std::setprecision(0)
+       << ";" << ((sec > 0.0) ? s.nodes / sec : 0.0)
+       << ";" << ((sec > 0.0) ? s.propagations / sec : 0.0)
+       << ";" << s.rss << ";" << status << std::endl;
+    os.unsetf(std::ios::floatfield);
+  }
+
+  /// Read the rows of baseline file \a f
+  std::map<std::string,Summary> readBaseline(const std::string& f) {
+    std::map<std::string,Summary> base;
+    std::ifstream in(f.c_str());
+    if (!in) {
+      std::cerr << "qbench: cannot read baseline '" << f << "'" << std::endl;
+      std::exit(EXIT_FAILURE);
+    }
+    std::string line;
+    while (std::getline(in, line)) {
+      if (line.empty() || (line[0] == '#')) continue;
+      std::istringstream is(line);
+      std::vector<std::string> v;
+      std::string field;
+      while (std::getline(is, field, ';')) v.push_back(field);
+      if (v.size() < 11) continue;
+      Summary s;
+      s.name = v[0];
+      s.runs = static_cast<unsigned int>(std::strtoul(v[1].c_str(), NULL, 10));
+      s.median = std::strtod(v[2].c_str(), NULL);
+      s.low = std::strtod(v[3].c_str(), NULL);
+      s.high = std::strtod(v[4].c_str(), NULL);
+      s.p95 = std::strtod(v[5].c_str(), NULL);
+      s.nodes = std::strtoul(v[6].c_str(), NULL, 10);
+      s.propagations = std::strtoul(v[7].c_str(), NULL, 10);
+      s.rss = std::strtol(v[10].c_str(), NULL, 10);
+      s.stable = true;
+      base[s.name] = s;
+    }
+    return base;
+  }
+
+  /// Print help message
+  void help(void) {
+    std::cerr << "Usage: qbench [options]" << std::endl
+              << "Options:" << std::endl
+              << "\t-suite (string) default: tools/bench/suite.txt" << std::endl
+              << "\t\tfile of the benchmarks" << std::endl
+              << "\t-bin (string) default: ." << std::endl
+              << "\t\tdirectory of the examples" << std::endl
+              << "\t-src (string) default: ." << std::endl
+              << "\t\tsource directory (for the instances)" << std::endl
+              << "\t-filter (string) default: none" << std::endl
+              << "\t\tonly run the benchmarks whose name contains it" << std::endl
+              << "\t-runs (unsigned int) default: 10" << std::endl
+              << "\t\tnumber of measured runs" << std::endl
+              << "\t-warmup (unsigned int) default: 1" << std::endl
+              << "\t\tnumber of runs before measures" << std::endl
+              << "\t-cpu (int) default: -1 (none)" << std::endl
+              << "\t\tCPU the runs are pinned to" << std::endl
+              << "\t-baseline (string) default: none" << std::endl
+              << "\t\trows of a previous run to compare with" << std::endl
+              << "\t-threshold (double) default: 5" << std::endl
+              << "\t\tslowdown in percent flagged as regression" << std::endl;
+  }
+
+}
+
+/** \brief Main-function
+ */
+int main(int argc, char* argv[]) {
+  BenchOptions opt;
+  for (int i=1; i<argc; i++) {
+    std::string a = argv[i];
+    bool value = (i+1 < argc);
+    if ((a == "-help") || (a == "--help")) {
+      help();
+      return 0;
+    } else if ((a == "-suite") && value) {
+      opt.suite = argv[++i];
+    } else if ((a == "-bin") && value) {
+      opt.bin = argv[++i];
+    } else if ((a == "-src") && value) {
+      opt.src = argv[++i];
+    } else if ((a == "-filter") && value) {
+      opt.filter = argv[++i];
+    } else if ((a == "-runs") && value) {
+      opt.runs = std::max(1, std::atoi(argv[++i]));
+    } else if ((a == "-warmup") && value) {
+      opt.warmup = std::max(0, std::atoi(argv[++i]));
+    } else if ((a == "-cpu") && value) {
+      opt.cpu = std::atoi(argv[++i]);
+    } else if ((a == "-baseline") && value) {
+      opt.baseline = argv[++i];
+    } else if ((a == "-threshold") && value) {
+      opt.threshold = std::atof(argv[++i]);
+    } else {
+      std::cerr << "Could not parse all arguments." << std::endl;
+      help();
+      return EXIT_FAILURE;
+    }
+  }
+
+  std::vector<Bench> suite = readSuite(opt);
+  std::map<std::string,Summary> base;
+  if (!opt.baseline.empty()) base = readBaseline(opt.baseline);
+
+  int regressions = 0;
+  printHeader(std::cout);
+  for (std::vector<Bench>::size_type i=0; i<suite.size(); i++) {
+    bool ok = true;
+    for (unsigned int w=0; w<opt.warmup; w++)
+      ok = run(suite[i].cmd, opt).ok && ok;
+    std::vector<Run> r;
+    for (unsigned int k=0; k<opt.runs; k++) {
+      r.push_back(run(suite[i].cmd, opt));
+      ok = r.back().ok && ok;
+    }
+    Summary s = summarize(suite[i].name, r);
+    std::string status = ok ? "ok" : "failed";
+    if (ok && !s.stable) status = "unstable";
+    std::map<std::string,Summary>::const_iterator b = base.find(s.name);
+    if (ok && (b != base.end())) {
+      if (b->second.nodes != s.nodes) {
+        status = "changed";
+      } else if ((s.median > b->second.median * (1.0 + opt.threshold / 100.0)) &&
+                 (s.low > b->second.high)) {
+        std::ostringstream st;
+        st << "regression(+" << std::fixed << std::setprecision(1)
+           << (100.0 * (s.median / b->second.median - 1.0)) << "%)";
+        status = st.str();
+        regressions++;
+      } else if ((s.median < b->second.median * (1.0 - opt.threshold / 100.0)) &&
+                 (s.high < b->second.low)) {
+        status = "improvement";
+      }
+    }
+    if (!ok) regressions++;
+    print(std::cout, s, status);
+  }
+  return (regressions > 0) ? 1 : 0;
+}
+
+// STATISTICS: example-any
@@ -0,0 +1,230 @@
+/* -*- mode: C++; c-basic-offset: 2; indent-tabs-mode: nil -*- */
+/*
+ *  Main authors:
+ *     Vincent Barichard <Vincent.Barichard@univ-angers.fr>
+ *
+ *  Copyright:
+ *     Vincent Barichard, 2014
+ *
+ *  Last modified:
+ *     $Date$ by $Author$
+ *     $Revision$
+ *
+ *  This file is part of Quacode:
+ *     http://quacode.barichard.com
+ *
+ *  Permission is hereby granted, free of charge, to any person obtaining
+ *  a copy of this software and associated documentation files (the
+ *  "Software"), to deal in the Software without restriction, including
+ *  without limitation the rights to use, copy, modify, merge, publish,
+ *  distribute, sublicense, and/or sell copies of the Software, and to
+ *  permit persons to whom the Software is furnished to do so, subject to
+ *  the following conditions:
+ *
+ *  The above copyright notice and this permission notice shall be
+ *  included in all copies or substantial portions of the Software.
+ *
+ *  THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND,
+ *  EXPRESS OR IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF
+ *  MERCHANTABILITY, FITNESS FOR A PARTICULAR PURPOSE AND
+ *  NONINFRINGEMENT. IN NO EVENT SHALL THE AUTHORS OR COPYRIGHT HOLDERS BE
+ *  LIABLE FOR ANY CLAIM, DAMAGES OR OTHER LIABILITY, WHETHER IN AN ACTION
+ *  OF CONTRACT, TORT OR OTHERWISE, ARISING FROM, OUT OF OR IN CONNECTION
+ *  WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE SOFTWARE.
+ *
+ */
+
+#include <algorithm>
+#include <cstdlib>
+#include <cstring>
+#include <fstream>
+#include <iostream>
+#include <string>
+#include <vector>
+
+#include <quacode/qcheck.hh>
+#include <quacode/qbf/qdimacs.hh>
+#include <quacode/qbf/qcir.hh>
+#include <quacode/flatzinc/qflatzinc.hh>
+
+using namespace Gecode;
+
+/**
+ * \brief Checker of the winning strategies of QBF instances
+ *
+ * The QDIMACS (.qdimacs, .qdm, .cnf) or QCIR (.qcir) instance given on
+ * the command line is solved while its winning strategy is recorded, and
+ * the strategy is then replayed on the model by a StrategyChecker. With
+ * -strategy, the strategy is read from a file (in the format printed by
+ * -printStrategy) instead of being searched. With -minimize, the instance
+ * is solved a second time with StrategyMethodValues::MINIMIZE and the
+ * minimized strategy is checked as well.
+ *
+ * The exit status is 0 if every checked strategy is valid, 1 if one is
+ * not, 2 if the instance is false and 3 on errors.
+ */
+
+namespace {
+
+  /// Options of the checker
+  struct CheckOptions {
+    std::string file;      ///< Instance
+    std::string strategy;  ///< File of the strategy to check (searched if empty)
+    unsigned int threads;  ///< Number of threads of the checker
+    bool qc;               ///< Use the quantified constraints
+    bool minimize;         ///< Also check the minimized strategy
+    bool print;            ///< Print the checked strategies
+    CheckOptions(void) : threads(1), qc(true), minimize(false), print(false) {}
+  };
+
+  /// Return true if file name \a f ends with \a e
+  bool endsWith(const std::string& f, const char* e) {
+    std::size_t n = std::strlen(e);
+    return (f.size() >= n) && (f.compare(f.size()-n, n, e) == 0);
+  }
+
+  /// Return the model of instance \a f building its strategy with method \a sm (NULL if the format is unknown)
+  QFlatZincSpace* model(const std::string& f, bool qc, StrategyMethod sm) {
+    QFlatZincSpace* s = new QFlatZincSpace();
+    s->strategyMethod(sm);
+    std::vector<BoolVarArray> blocks;
+    if (endsWith(f, ".qdimacs") || endsWith(f, ".qdm") || endsWith(f, ".cnf")) {
+      QDimacsReader reader;
+      reader.parse(f.c_str());
+      reader.post(*s, *s, s->bv, blocks, qc);
+    } else if (endsWith(f, ".qcir")) {
+      QCirReader reader;
+      reader.parse(f.c_str());
+      reader.post(*s, *s, s->bv, blocks, qc);
+    } else {
+      delete s;
+      return NULL;
+    }
+    for (std::vector<BoolVarArray>::size_type i=0; i<blocks.size(); i++)
+      s->branch(*s, blocks[i], INT_VAR_NONE(), INT_VAL_MIN());
+    return s;
+  }
+
+  /// Solve the instance of \a opt with method \a sm and load its strategy in \a sc, return false if it is false
+  bool solve(const CheckOptions& opt, StrategyMethod sm, StrategyChecker& sc) {
+    QFlatZincSpace* s = model(opt.file, opt.qc, sm);
+    QDFS<QFlatZincSpace> e(s, Search::Options());
+    delete s;
+    QFlatZincSpace* sol = e.next();
+    if (sol == NULL) return false;
+    if (opt.print) sol->strategyPrint(std::cout);
+    bool loaded = sc.load(*sol);
+    delete sol;
+    if (!loaded) throw Exception("qcheck", "the strategy found can't be loaded");
+    return true;
+  }
+
+  /// Check strategy \a sc against the instance of \a opt, return true if it is valid
+  bool check(const CheckOptions& opt, const StrategyChecker& sc) {
+    QFlatZincSpace* root = model(opt.file, opt.qc, 0);
+    StrategyCheckReport r = sc.check(root, opt.threads);
+    delete root;
+    r.print(std::cout);
+    return r.valid();
+  }
+
+  /// Print help message
+  void help(void) {
+    std::cerr << "Usage: qcheck [options] <instance>" << std::endl
+              << "Options:" << std::endl
+              << "\t-strategy (string) default: none" << std::endl
+              << "\t\tcheck the strategy of this file instead of the one found by search" << std::endl
+              << "\t-minimize (true, false) default: false" << std::endl
+              << "\t\talso check the minimized strategy, which must not be larger" << std::endl
+              << "\t-threads (unsigned int) default: 1" << std::endl
+              << "\t\tnumber of threads of the checker" << std::endl
+              << "\t-quantifiedConstraints (true, false) default: true" << std::endl
+              << "\t\twhether to use quantified optimized constraints" << std::endl
+              << "\t-printStrategy (true, false) default: false" << std::endl
+              << "\t\tprint the strategies found by search" << std::endl;
+  }
+
+  /// Parse Boolean value \a s
+  bool boolean(const char* s) {
+    return (std::strcmp(s, "true") == 0) || (std::strcmp(s, "1") == 0);
+  }
+
+}
+
+/** \brief Main-function
+ */
+int main(int argc, char* argv[]) {
+  CheckOptions opt;
+  for (int i=1; i<argc; i++) {
+    std::string a = argv[i];
+    bool value = (i+1 < argc);
+    if ((a == "-help") || (a == "--help")) {
+      help();
+      return 0;
+    } else if ((a == "-strategy") && value) {
+      opt.strategy = argv[++i];
+    } else if ((a == "-minimize") && value) {
+      opt.minimize = boolean(argv[++i]);
+    } else if ((a == "-threads") && value) {
+      opt.threads = std::max(1, std::atoi(argv[++i]));
+    } else if ((a == "-quantifiedConstraints") && value) {
+      opt.qc = boolean(argv[++i]);
+    } else if ((a == "-printStrategy") && value) {
+      opt.print = boolean(argv[++i]);
+    } else if ((a[0] == '-') || !opt.file.empty()) {
+      std::cerr << "Could not parse all arguments." << std::endl;
+      help();
+      return 3;
+    } else {
+      opt.file = a;
+    }
+  }
+  if (opt.file.empty()) {
+    help();
+    return 3;
+  }
+
+  try {
+    QFlatZincSpace* s = model(opt.file, opt.qc, 0);
+    if (s == NULL) {
+      std::cerr << "qcheck: unknown format of '" << opt.file << "'" << std::endl;
+      return 3;
+    }
+    delete s;
+
+    if (!opt.strategy.empty()) {
+      std::ifstream in(opt.strategy.c_str());
+      StrategyChecker sc;
+      if (!in || !sc.load(in)) {
+        std::cerr << "qcheck: cannot read the strategy of '" << opt.strategy << "'" << std::endl;
+        return 3;
+      }
+      std::cout << "Strategy of " << opt.strategy << ": " << sc.size() << " nodes" << std::endl;
+      return check(opt, sc) ? 0 : 1;
+    }
+
+    StrategyMethod sm = StrategyMethodValues::BUILD | StrategyMethodValues::FAILTHROUGH;
+    StrategyChecker sc;
+    if (!solve(opt, sm, sc)) {
+      std::cout << "Instance is false, no strategy to check" << std::endl;
+      return 2;
+    }
+    std::cout << "Strategy found: " << sc.size() << " nodes" << std::endl;
+    bool valid = check(opt, sc);
+
+    if (opt.minimize) {
+      StrategyChecker msc;
+      solve(opt, sm | StrategyMethodValues::MINIMIZE, msc);
+      std::cout << "Strategy minimized: " << sc.size() << " -> " << msc.size() << " nodes ("
+                << ((msc.size() < sc.size()) ? "reduced" : (msc.size() == sc.size()) ? "unchanged" : "LARGER")
+                << ")" << std::endl;
+      valid = check(opt, msc) && valid && (msc.size() <= sc.size());
+    }
+    return valid ? 0 : 1;
+  } catch (Exception& e) {
+    std::cerr << "qcheck: " << e.what() << std::endl;
+    return 3;
+  }
+}
+
+// STATISTICS: example-any
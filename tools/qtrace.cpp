@@ -0,0 +1,246 @@
+/* -*- mode: C++; c-basic-offset: 2; indent-tabs-mode: nil -*- */
+/*
+ *  Main authors:
+ *     Vincent Barichard <Vincent.Barichard@univ-angers.fr>
+ *
+ *  Copyright:
+ *     Vincent Barichard, 2014
+ *
+ *  Last modified:
+ *     $Date$ by $Author$
+ *     $Revision$
+ *
+ *  This file is part of Quacode:
+ *     http://quacode.barichard.com
+ *
+ *  Permission is hereby granted, free of charge, to any person obtaining
+ *  a copy of this software and associated documentation files (the
+ *  "Software"), to deal in the Software without restriction, including
+ *  without limitation the rights to use, copy, modify, merge, publish,
+ *  distribute, sublicense, and/or sell copies of the Software, and to
+ *  permit persons to whom the Software is furnished to do so, subject to
+ *  the following conditions:
+ *
+ *  The above copyright notice and this permission notice shall be
+ *  included in all copies or substantial portions of the Software.
+ *
+ *  THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND,
+ *  EXPRESS OR IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF
+ *  MERCHANTABILITY, FITNESS FOR A PARTICULAR PURPOSE AND
+ *  NONINFRINGEMENT. IN NO EVENT SHALL THE AUTHORS OR COPYRIGHT HOLDERS BE
+ *  LIABLE FOR ANY CLAIM, DAMAGES OR OTHER LIABILITY, WHETHER IN AN ACTION
+ *  OF CONTRACT, TORT OR OTHERWISE, ARISING FROM, OUT OF OR IN CONNECTION
+ *  WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE SOFTWARE.
+ *
+ */
+
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
+#include <fstream>
+#include <iostream>
+#include <map>
+#include <string>
+#include <utility>
+#include <vector>
+
+#include <quacode/support/tracer.hh>
+
+using namespace Gecode;
+using Gecode::Support::TraceRecord;
+using Gecode::Support::TraceHeader;
+
+/**
+ * \brief Tool for the search traces written by Support::Tracer
+ *
+ * It prints a summary of a trace (nodes by status, by brancher and by
+ * depth, exploration rate) and converts it for tree visualizers: DOT
+ * for Graphviz (-dot) or CSV (-csv, one line per node).
+ */
+
+namespace {
+
+  /// Key of a node (thread and id)
+  typedef std::pair<unsigned int, uint64_t> Key;
+
+  /// Counters of nodes by status
+  struct Count {
+    unsigned long int n[3];
+    TQuantifier q;
+    Count(void) : q(EXISTS) { n[0] = n[1] = n[2] = 0; }
+  };
+
+  /// Read the records of trace file \a fn
+  bool read(const char* fn, std::vector<TraceRecord>& r) {
+    std::FILE* f = std::fopen(fn, "rb");
+    if (f == NULL) {
+      std::cerr << "qtrace: cannot read '" << fn << "'" << std::endl;
+      return false;
+    }
+    TraceHeader h;
+    if ((std::fread(&h, sizeof(h), 1, f) != 1) || (std::memcmp(h.magic, "QTRACE01", 8) != 0) ||
+        (h.size != sizeof(TraceRecord))) {
+      std::cerr << "qtrace: '" << fn << "' is not a trace file" << std::endl;
+      std::fclose(f);
+      return false;
+    }
+    TraceRecord x;
+    while (std::fread(&x, sizeof(x), 1, f) == 1)
+      r.push_back(x);
+    std::fclose(f);
+    return true;
+  }
+
+  /// Print the summary of records \a r
+  void summary(std::ostream& os, const std::vector<TraceRecord>& r) {
+    static const char* status[] = { "branch", "failed", "solved" };
+    std::map<Key, unsigned int> depth;
+    std::map<unsigned int, Count> byBrancher;
+    std::map<unsigned int, Count> byDepth;
+    unsigned long int total[3] = { 0, 0, 0 };
+    unsigned int threads = 0;
+    uint64_t tmax = 0;
+    for (std::vector<TraceRecord>::size_type i=0; i<r.size(); i++) {
+      const TraceRecord& x = r[i];
+      unsigned int d = 0;
+      if (x.parent != 0) {
+        std::map<Key, unsigned int>::const_iterator p = depth.find(Key(x.thread, x.parent));
+        if (p != depth.end()) d = p->second + 1;
+      }
+      depth[Key(x.thread, x.node)] = d;
+      unsigned int s = (x.status < 3) ? x.status : 0;
+      total[s]++;
+      byBrancher[x.brancher].n[s]++;
+      byBrancher[x.brancher].q = x.quantifier;
+      byDepth[d].n[s]++;
+      threads = std::max(threads, static_cast<unsigned int>(x.thread) + 1);
+      tmax = std::max(tmax, x.time);
+    }
+    double sec = static_cast<double>(tmax) / 1e9;
+    os << "records:   " << r.size() << std::endl
+       << "threads:   " << threads << std::endl
+       << "duration:  " << sec * 1000.0 << " ms" << std::endl
+       << "rate:      " << ((sec > 0.0) ? r.size() / sec : 0.0) << " nodes/s" << std::endl;
+    for (int s=0; s<3; s++)
+      os << status[s] << ":" << std::string(10 - std::strlen(status[s]), ' ') << total[s] << std::endl;
+    os << std::endl << "brancher\tquantifier\tbranch\tfailed\tsolved" << std::endl;
+    for (std::map<unsigned int, Count>::const_iterator i=byBrancher.begin(); i!=byBrancher.end(); ++i)
+      os << ((i->first == 0) ? std::string("root") : std::to_string(i->first)) << "\t\t"
+         << ((i->second.q == FORALL) ? "forall" : "exists") << "\t\t"
+         << i->second.n[0] << "\t" << i->second.n[1] << "\t" << i->second.n[2] << std::endl;
+    os << std::endl << "depth\tbranch\tfailed\tsolved" << std::endl;
+    for (std::map<unsigned int, Count>::const_iterator i=byDepth.begin(); i!=byDepth.end(); ++i)
+      os << i->first << "\t" << i->second.n[0] << "\t" << i->second.n[1] << "\t"
+         << i->second.n[2] << std::endl;
+  }
+
+  /// Print the label of the choice of record \a x
+  void label(std::ostream& os, const TraceRecord& x) {
+    os << "b" << x.brancher << "[" << x.pos << "]";
+    if (x.inf == x.sup) os << " = " << x.inf;
+    else os << " in " << x.inf << ".." << x.sup;
+  }
+
+  /// Print the first \a max records \a r in DOT format
+  void dot(std::ostream& os, const std::vector<TraceRecord>& r, std::size_t max) {
+    os << "digraph trace {" << std::endl
+       << "  node [label=\"\", width=0.2, height=0.2];" << std::endl;
+    for (std::vector<TraceRecord>::size_type i=0; (i<r.size()) && (i<max); i++) {
+      const TraceRecord& x = r[i];
+      os << "  n" << x.thread << "_" << x.node;
+      switch (x.status) {
+      case TraceRecord::FAILED:
+        os << " [shape=box, style=filled, fillcolor=red];" << std::endl;
+        break;
+      case TraceRecord::SOLVED:
+        os << " [shape=diamond, style=filled, fillcolor=green];" << std::endl;
+        break;
+      default:
+        os << " [shape=circle, style=filled, fillcolor="
+           << ((x.quantifier == FORALL) ? "lightblue" : "white") << "];" << std::endl;
+        break;
+      }
+      if (x.parent != 0) {
+        os << "  n" << x.thread << "_" << x.parent << " -> n" << x.thread << "_" << x.node
+           << " [label=\"";
+        label(os, x);
+        os << "\"" << ((x.quantifier == FORALL) ? ", style=dashed" : "") << "];" << std::endl;
+      }
+    }
+    os << "}" << std::endl;
+  }
+
+  /// Print records \a r in CSV format
+  void csv(std::ostream& os, const std::vector<TraceRecord>& r) {
+    os << "#thread;node;parent;time(ns);brancher;quantifier;pos;inf;sup;status" << std::endl;
+    for (std::vector<TraceRecord>::size_type i=0; i<r.size(); i++) {
+      const TraceRecord& x = r[i];
+      os << x.thread << ";" << x.node << ";" << x.parent << ";" << x.time << ";"
+         << x.brancher << ";" << ((x.quantifier == FORALL) ? "forall" : "exists") << ";"
+         << x.pos << ";" << x.inf << ";" << x.sup << ";"
+         << ((x.status == TraceRecord::FAILED) ? "failed" :
+             ((x.status == TraceRecord::SOLVED) ? "solved" : "branch")) << std::endl;
+    }
+  }
+
+  /// Print help message
+  void help(void) {
+    std::cerr << "Usage: qtrace [options] <trace file>" << std::endl
+              << "Options:" << std::endl
+              << "\t-dot (string) default: none" << std::endl
+              << "\t\twrite the search tree in DOT format to the file" << std::endl
+              << "\t-max (unsigned int) default: 10000" << std::endl
+              << "\t\tmaximal number of nodes written in DOT format" << std::endl
+              << "\t-csv (string) default: none" << std::endl
+              << "\t\twrite the records in CSV format to the file" << std::endl;
+  }
+
+}
+
+/** \brief Main-function
+ */
+int main(int argc, char* argv[]) {
+  const char* dotFile = NULL;
+  const char* csvFile = NULL;
+  const char* traceFile = NULL;
+  std::size_t max = 10000;
+  for (int i=1; i<argc; i++) {
+    std::string a = argv[i];
+    bool value = (i+1 < argc);
+    if ((a == "-help") || (a == "--help")) {
+      help();
+      return 0;
+    } else if ((a == "-dot") && value) {
+      dotFile = argv[++i];
+    } else if ((a == "-csv") && value) {
+      csvFile = argv[++i];
+    } else if ((a == "-max") && value) {
+      max = static_cast<std::size_t>(std::strtoul(argv[++i], NULL, 10));
+    } else if ((a[0] != '-') && (traceFile == NULL)) {
+      traceFile = argv[i];
+    } else {
+      std::cerr << "Could not parse all arguments." << std::endl;
+      help();
+      return EXIT_FAILURE;
+    }
+  }
+  if (traceFile == NULL) {
+    help();
+    return EXIT_FAILURE;
+  }
+
+  std::vector<TraceRecord> r;
+  if (!read(traceFile, r)) return EXIT_FAILURE;
+  summary(std::cout, r);
+  if (dotFile != NULL) {
+    std::ofstream os(dotFile);
+    dot(os, r, max);
+  }
+  if (csvFile != NULL) {
+    std::ofstream os(csvFile);
+    csv(os, r);
+  }
+  return 0;
+}
+
+// STATISTICS: example-any